@@ -13,10 +13,31 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <git2.h>
 
+#include <QDir>
+#include <QFile>
 #include <QTest>
 
 QTEST_MAIN(OverlayTest)
 
+namespace
+{
+
+constexpr int benchmarkDirectories{20};
+
+// A repository of @p directories directories with @p files files each, all of them untracked.
+void createTree(GitTestManager &tm, int directories, int files)
+{
+    tm.init();
+    for (int i = 0; i < directories; ++i) {
+        const auto directory = QStringLiteral("dir%1/sub").arg(i);
+        QDir{}.mkpath(tm.absoluteFilePath(directory));
+        for (int j = 0; j < files; ++j)
+            tm.touch(QStringLiteral("%1/file%2.txt").arg(directory).arg(j));
+    }
+}
+
+}
+
 void OverlayTest::initTestCase()
 {
     git_libgit2_init();
@@ -91,4 +112,128 @@ void OverlayTest::invalidDir()
     plugin.beginRetrieval("/doc/src/cpp/aws-sdk-cpp/install/lib/aws-crt-cpp/cmake");
 }
 
+void OverlayTest::statesBelowDirectory()
+{
+    GitTestManager tm;
+    tm.init();
+    tm.addToIgnore(QStringLiteral("build/"));
+    QDir{}.mkpath(tm.absoluteFilePath(QStringLiteral("sub/deep")));
+    QDir{}.mkpath(tm.absoluteFilePath(QStringLiteral("build/out")));
+    tm.touch(QStringLiteral("top.txt"));
+    tm.touch(QStringLiteral("sub/deep/new.txt"));
+    tm.touch(QStringLiteral("build/out/main.o"));
+
+    StatusCache cache;
+    QVERIFY(cache.setPath(tm.absoluteFilePath({})));
+    QCOMPARE(cache.status(QStringLiteral("top.txt")), KVersionControlPlugin::AddedVersion);
+    QCOMPARE(cache.status(QStringLiteral("sub")), KVersionControlPlugin::AddedVersion);
+    QCOMPARE(cache.status(QStringLiteral("build")), KVersionControlPlugin::IgnoredVersion);
+    QCOMPARE(cache.mScans, 1);
+
+    // The scan of the root found what is below it too.
+    QVERIFY(cache.setPath(tm.absoluteFilePath(QStringLiteral("sub"))));
+    QCOMPARE(cache.status(QStringLiteral("deep")), KVersionControlPlugin::AddedVersion);
+    QVERIFY(cache.setPath(tm.absoluteFilePath(QStringLiteral("sub/deep/"))));
+    QCOMPARE(cache.status(QStringLiteral("new.txt")), KVersionControlPlugin::AddedVersion);
+    QCOMPARE(cache.status(QStringLiteral("top.txt")), KVersionControlPlugin::NormalVersion);
+
+    QVERIFY(cache.setPath(tm.absoluteFilePath(QStringLiteral("build/out"))));
+    QCOMPARE(cache.status(QStringLiteral("main.o")), KVersionControlPlugin::IgnoredVersion);
+
+    QVERIFY(cache.setPath(tm.absoluteFilePath({})));
+    QCOMPARE(cache.mScans, 1);
+
+    QVERIFY(!cache.setPath(QDir::tempPath()));
+}
+
+void OverlayTest::invalidation()
+{
+    GitTestManager tm;
+    tm.init();
+    QDir{}.mkpath(tm.absoluteFilePath(QStringLiteral("sub/deep")));
+    tm.touch(QStringLiteral("sub/deep/new.txt"));
+
+    StatusCache cache;
+    QVERIFY(cache.setPath(tm.absoluteFilePath(QStringLiteral("sub/deep"))));
+    QVERIFY(cache.setPath(tm.absoluteFilePath({})));
+    QCOMPARE(cache.mScans, 2);
+
+    // A file added to a directory visited shows up once the watcher has told.
+    tm.touch(QStringLiteral("sub/deep/other.txt"));
+    QTRY_VERIFY(!cache.mChanges.isEmpty());
+    QVERIFY(cache.setPath(tm.absoluteFilePath(QStringLiteral("sub/deep"))));
+    QCOMPARE(cache.mScans, 3);
+    QCOMPARE(cache.status(QStringLiteral("other.txt")), KVersionControlPlugin::AddedVersion);
+
+    // Writing the index drops everything.
+    QVERIFY(cache.setPath(tm.absoluteFilePath({})));
+    QCOMPARE(cache.mScans, 4);
+    tm.add(QStringLiteral("sub/deep/new.txt"));
+    QTRY_VERIFY(!cache.mChanges.isEmpty());
+    QVERIFY(cache.setPath(tm.absoluteFilePath(QStringLiteral("sub"))));
+    QCOMPARE(cache.mScans, 5);
+}
+
+void OverlayTest::untrackedCache()
+{
+    GitTestManager tm;
+    tm.init();
+    QFile config{tm.absoluteFilePath(QStringLiteral(".git/config"))};
+    QVERIFY(config.open(QIODevice::Append));
+    config.write("[core]\n\tuntrackedCache = true\n");
+    config.close();
+
+    QDir{}.mkpath(tm.absoluteFilePath(QStringLiteral("tracked")));
+    QDir{}.mkpath(tm.absoluteFilePath(QStringLiteral("new/deep")));
+    tm.touch(QStringLiteral("tracked/file.txt"));
+    tm.add();
+    tm.commit(QStringLiteral("initial"));
+    tm.touch(QStringLiteral("new/deep/file.txt"));
+
+    StatusCache cache;
+    QVERIFY(cache.setPath(tm.absoluteFilePath({})));
+    QCOMPARE(cache.status(QStringLiteral("new")), KVersionControlPlugin::AddedVersion);
+    QCOMPARE(cache.status(QStringLiteral("tracked")), KVersionControlPlugin::NormalVersion);
+
+    // Nothing in it is tracked, so everything in it is new, without a look at the status.
+    QVERIFY(cache.setPath(tm.absoluteFilePath(QStringLiteral("new/deep"))));
+    QCOMPARE(cache.status(QStringLiteral("file.txt")), KVersionControlPlugin::AddedVersion);
+    QCOMPARE(cache.mScans, 1);
+
+    QVERIFY(cache.setPath(tm.absoluteFilePath(QStringLiteral("tracked"))));
+    QCOMPARE(cache.status(QStringLiteral("file.txt")), KVersionControlPlugin::NormalVersion);
+}
+
+void OverlayTest::benchmarkFirstRetrieval()
+{
+    GitTestManager tm;
+    createTree(tm, benchmarkDirectories, 100);
+
+    QBENCHMARK {
+        StatusCache cache;
+        QVERIFY(cache.setPath(tm.absoluteFilePath({})));
+        for (int i = 0; i < benchmarkDirectories; ++i)
+            QVERIFY(cache.setPath(tm.absoluteFilePath(QStringLiteral("dir%1/sub").arg(i))));
+    }
+}
+
+void OverlayTest::benchmarkCachedRetrieval()
+{
+    GitTestManager tm;
+    createTree(tm, benchmarkDirectories, 100);
+
+    StatusCache cache;
+    QVERIFY(cache.setPath(tm.absoluteFilePath({})));
+
+    // Going back and forth between directories seen already, as browsing does.
+    QBENCHMARK {
+        for (int i = 0; i < benchmarkDirectories; ++i) {
+            QVERIFY(cache.setPath(tm.absoluteFilePath(QStringLiteral("dir%1/sub").arg(i))));
+            QCOMPARE(cache.status(QStringLiteral("file0.txt")), KVersionControlPlugin::AddedVersion);
+            QVERIFY(cache.setPath(tm.absoluteFilePath({})));
+        }
+    }
+    QCOMPARE(cache.mScans, 1);
+}
+
 #include "moc_overlaytest.cpp"
@@ -19,4 +19,10 @@ private Q_SLOTS:
     void checkRootDir();
     void dirTest();
     void invalidDir();
+    void statesBelowDirectory();
+    void invalidation();
+    void untrackedCache();
+
+    void benchmarkFirstRetrieval();
+    void benchmarkCachedRetrieval();
 };
@@ -7,7 +7,10 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "statuscache.h"
 #include "qdebug.h"
 
+#include <QDateTime>
 #include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
 #include <git2.h>
 
 #define BEGIN int err = 0;
@@ -25,13 +28,9 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 namespace Impl
 {
-struct wrapper {
-    QMap<QString, KVersionControlPlugin::ItemVersion> files;
-    QStringList ignores;
-    QString currentPath;
-    QString rootPath;
+struct Scan {
+    QHash<QString, QHash<QString, KVersionControlPlugin::ItemVersion>> *directories;
     QString prefix;
-    bool allIgnored{false};
 };
 
 KVersionControlPlugin::ItemVersion convertToItemVersion(unsigned int status_flags)
@@ -60,47 +59,64 @@ QString removeSlashAtEnd(const QString &s)
     return s;
 }
 
-auto callback(const char *pa, unsigned int status_flags, void *payload) -> int
+// @p directory relative to @p rootPath, ending in a slash unless it is the root itself.
+QString directoryPrefix(const QString &rootPath, const QString &directory)
 {
-    auto w = reinterpret_cast<wrapper *>(payload);
+    const auto relative = removeSlashAtEnd(directory.mid(rootPath.length()));
+    return relative.isEmpty() ? QString{} : relative + QLatin1Char('/');
+}
 
-    auto path = QString{pa};
+// Whether @p directory, or anything right in it, was modified at @p time or later.
+bool isModifiedSince(const QString &directory, const QDateTime &time)
+{
+    if (QFileInfo{directory}.lastModified() >= time)
+        return true;
 
-    if (w->prefix.startsWith(path) && status_flags & GIT_STATUS_IGNORED) {
-        w->allIgnored = true;
-        return 1;
+    QDirIterator it{directory, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System};
+    while (it.hasNext()) {
+        it.next();
+        if (it.fileInfo().lastModified() >= time)
+            return true;
     }
-    if (!path.startsWith(w->currentPath)) {
+    return false;
+}
+
+// Sets the state of the path in the entries of its directory, and adds it to the state of
+// every directory between that one and the directory scanned.
+auto callback(const char *pa, unsigned int status_flags, void *payload) -> int
+{
+    auto scan = reinterpret_cast<Scan *>(payload);
+
+    const auto path = QString::fromUtf8(pa);
+    if (!path.startsWith(scan->prefix))
         return 0;
-    }
 
-    auto status = convertToItemVersion(status_flags);
+    const auto status = convertToItemVersion(status_flags);
 
-    QString entryName;
-    QString childPath;
-    if (path.indexOf(QLatin1Char('/'), w->prefix.length()) == -1) {
-        entryName = path.mid(w->prefix.length());
-    } else {
-        entryName = path.mid(w->prefix.length(), path.indexOf(QLatin1Char('/'), w->prefix.length()) + 1 - w->prefix.length());
-        childPath = path.mid(w->prefix.length() + entryName.length());
-    }
+    auto directory = scan->prefix;
+    auto from = scan->prefix.length();
+    while (true) {
+        auto &entries = (*scan->directories)[directory];
+        const auto slash = path.indexOf(QLatin1Char('/'), from);
 
-    if (childPath.isEmpty()) {
-        w->files.insert(removeSlashAtEnd(entryName), status);
-    } else {
+        // A directory reported as a whole, as an ignored one is, ends in a slash.
+        if (slash == -1 || slash == path.length() - 1) {
+            entries.insert(path.mid(from, (slash == -1 ? path.length() : slash) - from), status);
+            break;
+        }
+
+        const auto name = path.mid(from, slash - from);
         if (status != KVersionControlPlugin::ItemVersion::IgnoredVersion) {
-            //            if (entryName.count('/') == 1 && entryName.endsWith("/"))
-            //                w->files.insert(childPath, KVersionControlPlugin::ItemVersion::IgnoredVersion);
-            //        } else {
-            auto st = w->files.value(entryName, KVersionControlPlugin::ItemVersion::NormalVersion);
-
-            if (st != status) {
-                if (st == KVersionControlPlugin::ItemVersion::NormalVersion)
-                    w->files.insert(removeSlashAtEnd(entryName), status);
-                else
-                    w->files.insert(removeSlashAtEnd(entryName), KVersionControlPlugin::ItemVersion::LocallyModifiedVersion);
-            }
+            auto st = entries.value(name, KVersionControlPlugin::ItemVersion::NormalVersion);
+
+            if (st == KVersionControlPlugin::ItemVersion::NormalVersion)
+                entries.insert(name, status);
+            else if (st != status)
+                entries.insert(name, KVersionControlPlugin::ItemVersion::LocallyModifiedVersion);
         }
+
+        directory = path.left(slash + 1);
+        from = slash + 1;
     }
     return 0;
 }
@@ -166,79 +182,243 @@ QString submodulePath(const QString &rootPath, const QString &childPath)
 }
 }
 
-StatusCache::StatusCache() = default;
+StatusCache::StatusCache()
+{
+    QObject::connect(&mWatcher, &QFileSystemWatcher::directoryChanged, &mWatcher, [this](const QString &path) {
+        QMutexLocker locker{&mChangesMutex};
+        mChanges.append(path);
+    });
+}
 
 StatusCache::~StatusCache()
 {
-    if (mRepo) {
-        git_repository_free(mRepo);
-        mRepo = nullptr;
-    }
+    closeRepository();
 }
 
 KVersionControlPlugin::ItemVersion StatusCache::status(const QString &name)
 {
     if (mCurrentPathIsIgnored || name.startsWith(QStringLiteral(".git/")) || name == QStringLiteral(".git"))
         return KVersionControlPlugin::IgnoredVersion;
+    if (mCurrentPathIsUntracked)
+        return KVersionControlPlugin::AddedVersion;
 
-    return mStatuses.value(name, KVersionControlPlugin::ItemVersion::NormalVersion);
+    return mDirectories.value(mPrefix).value(name, KVersionControlPlugin::ItemVersion::NormalVersion);
 }
 
 bool StatusCache::setPath(const QString &path)
 {
-    if (mPath == path)
+    mPath = path;
+
+    if (!openRepository(path))
+        return false;
+
+    takeChanges();
+
+    auto directory = Impl::removeSlashAtEnd(path) + QLatin1Char('/');
+    if (!directory.startsWith(mRepoRootPath))
+        directory = QDir{path}.canonicalPath() + QLatin1Char('/');
+    mPrefix = Impl::directoryPrefix(mRepoRootPath, directory);
+
+    int ignored{0};
+    if (mPrefix.startsWith(QStringLiteral(".git/"))
+        || (!mPrefix.isEmpty() && !git_ignore_path_is_ignored(&ignored, mRepo, mPrefix.toUtf8().constData()) && ignored)) {
+        mCurrentPathIsIgnored = true;
         return true;
+    }
+    mCurrentPathIsIgnored = false;
 
-    mPath = path;
+    mCurrentPathIsUntracked = mUntrackedCache && !mPrefix.isEmpty() && isUntracked(mPrefix);
+    if (mCurrentPathIsUntracked)
+        return true;
 
-    if (mRepo) {
-        git_repository_free(mRepo);
-        mRepo = nullptr;
+    watch(directory);
+
+    auto scannedAt = this->scannedAt(mPrefix);
+    if (scannedAt.isValid() && Impl::isModifiedSince(directory, scannedAt)) {
+        invalidate(mPrefix);
+        scannedAt = {};
     }
+    if (!scannedAt.isValid())
+        scan(mPrefix);
 
-    if (git_repository_open_ext(&mRepo, path.toUtf8().data(), 0, NULL)) {
-        mRepo = nullptr;
+    return true;
+}
+
+bool StatusCache::openRepository(const QString &path)
+{
+    git_buf buf = GIT_BUF_INIT;
+    if (git_repository_discover(&buf, path.toUtf8().constData(), 0, nullptr)) {
+        closeRepository();
+        return false;
+    }
+    const auto gitPath = QString::fromUtf8(buf.ptr, static_cast<qsizetype>(buf.size));
+    git_buf_dispose(&buf);
+
+    if (mRepo && gitPath == mGitPath)
+        return true;
+
+    closeRepository();
+
+    if (git_repository_open(&mRepo, gitPath.toUtf8().constData()) || !git_repository_workdir(mRepo)) {
+        closeRepository();
         return false;
     }
 
-    auto rootPath = Impl::findParentContansGit(path);
-    mSubmoduleName = Impl::submodulePath(rootPath, path);
+    mGitPath = gitPath;
+    mRepoRootPath = QString::fromUtf8(git_repository_workdir(mRepo));
+    mSubmoduleName = Impl::submodulePath(Impl::findParentContansGit(mRepoRootPath), mRepoRootPath);
     qDebug() << Q_FUNC_INFO << mSubmoduleName;
 
-    mRepoRootPath = git_repository_workdir(mRepo);
-    if (path.startsWith(mRepoRootPath + QStringLiteral(".git/"))) {
-        mCurrentPathIsIgnored = true;
+    git_config *config{nullptr};
+    int untrackedCache{0};
+    if (!git_repository_config_snapshot(&config, mRepo)) {
+        mUntrackedCache = !git_config_get_bool(&untrackedCache, config, "core.untrackedCache") && untrackedCache;
+        git_config_free(config);
+    }
+
+    watch(mGitPath);
+    return true;
+}
 
+void StatusCache::closeRepository()
+{
+    if (mRepo) {
         git_repository_free(mRepo);
         mRepo = nullptr;
-        return true;
     }
 
-    Impl::wrapper w;
-    w.currentPath = path;
-    if (!w.currentPath.endsWith(QLatin1Char('/')))
-        w.currentPath.append(QLatin1Char('/'));
-    w.rootPath = mRepoRootPath;
-    if (!w.rootPath.endsWith(QLatin1Char('/')))
-        w.rootPath.append(QLatin1Char('/'));
-    w.prefix = w.currentPath.remove(w.rootPath);
+    mGitPath.clear();
+    mRepoRootPath.clear();
+    mSubmoduleName.clear();
+    mDirectories.clear();
+    mScanned.clear();
+    mCurrentPathIsIgnored = false;
+    mCurrentPathIsUntracked = false;
+    mUntrackedCache = false;
+
+    if (!mWatched.isEmpty()) {
+        const auto watched = mWatched.values();
+        QMetaObject::invokeMethod(&mWatcher, [this, watched] {
+            mWatcher.removePaths(watched);
+        });
+        mWatched.clear();
+    }
+
+    QMutexLocker locker{&mChangesMutex};
+    mChanges.clear();
+}
+
+void StatusCache::takeChanges()
+{
+    QStringList changes;
+    {
+        QMutexLocker locker{&mChangesMutex};
+        changes.swap(mChanges);
+    }
+
+    for (const auto &path : std::as_const(changes)) {
+        if (path == mGitPath) {
+            // The index or HEAD may have changed, and with them the state of anything.
+            mDirectories.clear();
+            mScanned.clear();
+            return;
+        }
+        if (path.startsWith(mRepoRootPath))
+            invalidate(Impl::directoryPrefix(mRepoRootPath, path));
+    }
+}
+
+void StatusCache::invalidate(const QString &prefix)
+{
+    // What is known about the directory came from the outermost scan covering it, which
+    // found the states of its parents too; all of it goes.
+    auto from = prefix;
+    for (auto it = mScanned.cbegin(); it != mScanned.cend(); ++it)
+        if (prefix.startsWith(it.key()) && it.key().length() < from.length())
+            from = it.key();
+
+    forget(from);
+}
+
+void StatusCache::forget(const QString &prefix)
+{
+    const auto dropBelow = [&prefix](auto &hash) {
+        for (auto it = hash.begin(); it != hash.end();)
+            it = it.key().startsWith(prefix) ? hash.erase(it) : std::next(it);
+    };
+    dropBelow(mDirectories);
+    dropBelow(mScanned);
+}
+
+QDateTime StatusCache::scannedAt(const QString &prefix) const
+{
+    auto directory = prefix;
+    while (true) {
+        const auto it = mScanned.constFind(directory);
+        if (it != mScanned.cend())
+            return *it;
+        if (directory.isEmpty())
+            return {};
+        directory = directory.left(directory.lastIndexOf(QLatin1Char('/'), -2) + 1);
+    }
+}
+
+void StatusCache::scan(const QString &prefix)
+{
+    // A scan finds everything below the prefix again, so nothing found before may add up
+    // with what it finds.
+    forget(prefix);
+    ++mScans;
+
+    const auto startedAt = QDateTime::currentDateTimeUtc();
+    Impl::Scan data{&mDirectories, prefix};
 
     git_status_options opts;
     git_status_options_init(&opts, GIT_STATUS_OPTIONS_VERSION);
     opts.show = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
-    opts.flags = GIT_STATUS_OPT_DEFAULTS;
+    opts.flags = GIT_STATUS_OPT_DEFAULTS | GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+    // An untracked directory then comes as a whole, "dir/", which the callback records as one
+    // entry of its parent.
+    if (mUntrackedCache)
+        opts.flags &= ~GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS;
+
+    // Taken literally, the directory limits the walk of the working tree to itself.
+    auto pathspec = Impl::removeSlashAtEnd(prefix).toUtf8();
+    char *paths[] = {pathspec.data()};
+    if (!prefix.isEmpty())
+        opts.pathspec = {paths, 1};
 
-    //    if (!w.prefix.isEmpty()) {
-    //        char *paths[] = {w.prefix.mid(0, w.prefix.length() - 1).toLocal8Bit().data()};
-    //        git_strarray array = {paths, 1};
-    //        opts.pathspec = array;
-    //    }
+    BEGIN
+    STEP git_status_foreach_ext(mRepo, &opts, Impl::callback, &data);
+    if (err) {
+        PRINT_ERROR;
+        return;
+    }
 
-    git_status_foreach_ext(mRepo, &opts, Impl::callback, &w);
-    mStatuses = w.files;
-    mCurrentPathIsIgnored = w.allIgnored;
+    mScanned.insert(prefix, startedAt);
+}
 
-    return true;
+bool StatusCache::isUntracked(const QString &prefix) const
+{
+    git_index *index{nullptr};
+    if (git_repository_index(&index, mRepo))
+        return false;
+
+    size_t pos;
+    const auto untracked = !git_index_read(index, false) && git_index_find_prefix(&pos, index, prefix.toUtf8().constData()) == GIT_ENOTFOUND;
+    git_index_free(index);
+    return untracked;
+}
+
+void StatusCache::watch(const QString &path)
+{
+    if (mWatched.contains(path))
+        return;
+
+    mWatched.insert(path);
+    QMetaObject::invokeMethod(&mWatcher, [this, path] {
+        mWatcher.addPath(path);
+    });
 }
 
 QString StatusCache::currentBranch() const
@@ -298,5 +478,6 @@ QString StatusCache::repoRootPath() const
 
 QString StatusCache::submoduleName() const
 {
-    return mSubmoduleName;
+    // Only named at the root of the submodule, not in the directories below it.
+    return mPrefix.isEmpty() ? mSubmoduleName : QString{};
 }
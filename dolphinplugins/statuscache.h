@@ -6,8 +6,13 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
 
-#include <QMap>
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
 #include <QString>
+#include <QStringList>
 
 #include <Dolphin/KVersionControlPlugin>
 #include <git2/types.h>
@@ -16,7 +21,25 @@ namespace Impl
 [[nodiscard]] QString removeSlashAtEnd(const QString &s);
 }
 
-class QFileInfo;
+/**
+ * The states Dolphin shows on the items of the directories it visits, for one repository
+ * at a time.
+ *
+ * A directory is looked at with a status limited to it by a pathspec, which also gives
+ * the states of everything below it: every directory on the way gets entries of its own,
+ * a subdirectory getting the state of what it holds, so going down into one of them needs
+ * no look at the repository at all. The repository stays open, and what was found is kept,
+ * for as long as the directories visited belong to it.
+ *
+ * What is kept is dropped when the watcher reports that the git directory changed, as it
+ * does whenever the index or HEAD is written, or that a directory visited did. A directory
+ * is also looked at again when it is retrieved and it, or anything right in it, was
+ * modified since it was looked at last. A file modified in place deeper below a directory
+ * visited goes unnoticed until one of those happens.
+ *
+ * With core.untrackedCache set, as git does then, untracked directories are not walked
+ * into: they are found as a whole, and so is everything in one when Dolphin goes inside.
+ */
 class StatusCache
 {
 public:
@@ -33,14 +56,45 @@ public:
     [[nodiscard]] QString submoduleName() const;
 
 private:
+    using Entries = QHash<QString, KVersionControlPlugin::ItemVersion>;
+
+    bool openRepository(const QString &path);
+    void closeRepository();
+    void takeChanges();
+    void invalidate(const QString &prefix);
+    void forget(const QString &prefix);
+    // When the scan covering @p prefix started, invalid when there is none.
+    [[nodiscard]] QDateTime scannedAt(const QString &prefix) const;
+    void scan(const QString &prefix);
+    // Whether nothing below @p prefix is in the index.
+    [[nodiscard]] bool isUntracked(const QString &prefix) const;
+    void watch(const QString &path);
+
     QString mRepoRootPath;
+    QString mGitPath;
     QString mPath;
+    // mPath relative to mRepoRootPath, ending in a slash unless it is the root itself.
+    QString mPrefix;
     QString mSubmoduleName;
 
-    QMap<QString, KVersionControlPlugin::ItemVersion> mStatuses;
+    // The entries of the directories with anything to show, by their path as in mPrefix.
+    QHash<QString, Entries> mDirectories;
+    // When each directory looked at was, each one covering everything below it.
+    QHash<QString, QDateTime> mScanned;
     bool mCurrentPathIsIgnored{false};
+    // Set when nothing in mPath is tracked, found without a scan with mUntrackedCache.
+    bool mCurrentPathIsUntracked{false};
+    bool mUntrackedCache{false};
+    int mScans{0};
 
     git_repository *mRepo{nullptr};
 
+    // The watcher lives in the thread the cache was made in, while Dolphin retrieves from a
+    // thread of its own; what it reports waits in mChanges for the next retrieval.
+    QFileSystemWatcher mWatcher;
+    QSet<QString> mWatched;
+    QMutex mChangesMutex;
+    QStringList mChanges;
+
     friend class OverlayTest;
 };
@@ -81,6 +81,13 @@ void CommitsWidget::init()
     connect(treeViewCommits, &QTreeView::customContextMenuRequested, this, &CommitsWidget::slotTreeViewCommitsCustomContextMenuRequested);
     connect(lineEditFilter, &QLineEdit::textChanged, this, &CommitsWidget::slotLineEditFilterTextChanged);
     connect(branchesView, &BranchesSelectionWidget::branchActivated, this, &CommitsWidget::setBranch);
+
+    // The history streams in after a branch is set, so the newest commit is only there to
+    // select once its page arrives.
+    connect(mHistoryModel, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &, int first) {
+        if (!first)
+            treeViewCommits->setCurrentIndex(mFilterModel->mapFromSource(mHistoryModel->index(0)));
+    });
 }
 
 void CommitsWidget::slotTreeViewCommitsItemActivated(const QModelIndex &index)
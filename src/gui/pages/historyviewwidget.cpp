@@ -32,6 +32,13 @@ HistoryViewWidget::HistoryViewWidget(RepositoryData *git, AppWindow *parent)
     connect(widgetCommit, &CommitDetails::hashClicked, this, &HistoryViewWidget::slotTextBrowserHashClicked);
     connect(widgetCommit, &CommitDetails::fileClicked, this, &HistoryViewWidget::slotTextBrowserFileClicked);
     connect(treeViewHistory, &TreeView::customContextMenuRequested, this, &HistoryViewWidget::slotTreeViewHistoryCustomContextMenuRequested);
+
+    // The history streams in after a branch is set, so the newest commit is only there to
+    // select once its page arrives.
+    connect(mHistoryModel, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &, int first) {
+        if (!first)
+            treeViewHistory->setCurrentIndex(mHistoryModel->index(0));
+    });
 }
 
 void HistoryViewWidget::setBranch(const Git::Branch &branch)
@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "KommitSettings.h"
 #include "kommitwidgetsglobaloptions.h"
+#include "options/statusoptions.h"
 #include "repository.h"
 
 #include <QCalendar>
@@ -108,6 +109,9 @@ void SettingsManager::applyToLib()
     opt->setColor(Git::ChangeStatus::Added, set->diffAddedColor());
     opt->setColor(Git::ChangeStatus::Modified, set->diffModifiedColor());
     opt->setColor(Git::ChangeStatus::Removed, set->diffRemovedColor());
+
+    Git::StatusOptions::setFsMonitorAllowed(set->runFsMonitorHook());
+    Git::StatusOptions::setUpdateIndexAllowed(set->updateIndexOnStatus());
 }
 
 #include "moc_settingsmanager.cpp"
@@ -0,0 +1,217 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "abstractcachetest.h"
+#include "caches/abstractcache.h"
+
+#include <QTest>
+
+#include <array>
+#include <tuple>
+
+QTEST_GUILESS_MAIN(AbstractCacheTest)
+
+namespace
+{
+
+struct Handle {
+    int id;
+};
+
+class Item
+{
+public:
+    Item() = default;
+    explicit Item(Handle *handle)
+        : mHandle{handle}
+    {
+    }
+
+    bool operator==(const Item &other) const
+    {
+        return mHandle == other.mHandle;
+    }
+
+    [[nodiscard]] Handle *handle() const
+    {
+        return mHandle;
+    }
+
+    [[nodiscard]] bool isNull() const
+    {
+        return !mHandle;
+    }
+
+private:
+    Handle *mHandle{nullptr};
+};
+
+class ItemsCache : public Git::Cache<Item, Handle>
+{
+public:
+    ItemsCache()
+        : Git::Cache<Item, Handle>{nullptr}
+    {
+    }
+
+    using Cache::removeFromList;
+
+    // Whether @p handle is in the cache, found without counting as a use of it.
+    bool contains(Handle *handle) const
+    {
+        const auto item = findCached([handle](const Item &item) {
+            return item.handle() == handle;
+        });
+        return !item.isNull();
+    }
+
+protected:
+    void clearChildData() override
+    {
+    }
+};
+
+template<size_t N>
+std::array<Handle, N> makeHandles()
+{
+    std::array<Handle, N> handles;
+    for (size_t i = 0; i < N; ++i)
+        handles[i].id = int(i);
+    return handles;
+}
+
+}
+
+void AbstractCacheTest::unlimitedByDefault()
+{
+    auto handles = makeHandles<1000>();
+    ItemsCache cache;
+
+    QCOMPARE(cache.capacity(), 0);
+    for (auto &handle : handles)
+        QCOMPARE(cache.findByPtr(&handle).handle(), &handle);
+
+    QCOMPARE(cache.size(), int(handles.size()));
+    QCOMPARE(cache.statistics().evictions, 0);
+}
+
+void AbstractCacheTest::evictsLeastRecentlyUsed()
+{
+    auto handles = makeHandles<11>();
+    ItemsCache cache;
+    cache.setCapacity(10);
+
+    for (int i = 0; i < 10; ++i)
+        std::ignore = cache.findByPtr(&handles[i]);
+    for (int i = 0; i < 5; ++i)
+        std::ignore = cache.findByPtr(&handles[i]);
+    QCOMPARE(cache.size(), 10);
+
+    // One past the capacity evicts the one used least recently.
+    std::ignore = cache.findByPtr(&handles[10]);
+    QCOMPARE(cache.size(), 10);
+    QCOMPARE(cache.statistics().evictions, 1);
+    QVERIFY(!cache.contains(&handles[5]));
+    for (int i : {0, 1, 2, 3, 4, 6, 7, 8, 9, 10})
+        QVERIFY(cache.contains(&handles[i]));
+
+    bool isNew;
+    std::ignore = cache.findByPtr(&handles[5], &isNew);
+    QVERIFY(isNew);
+    QVERIFY(!cache.contains(&handles[6]));
+
+    cache.setCapacity(2);
+    QCOMPARE(cache.size(), 2);
+    QVERIFY(cache.contains(&handles[10]));
+    QVERIFY(cache.contains(&handles[5]));
+}
+
+void AbstractCacheTest::pinnedEntriesStay()
+{
+    auto handles = makeHandles<20>();
+    ItemsCache cache;
+    cache.setCapacity(4);
+
+    std::ignore = cache.findByPtr(&handles[0]);
+    cache.pin(&handles[0]);
+    cache.pin(&handles[0]);
+
+    // Pinned entries do not count against the capacity.
+    for (int i = 1; i < 5; ++i)
+        std::ignore = cache.findByPtr(&handles[i]);
+    QCOMPARE(cache.size(), 5);
+    QCOMPARE(cache.statistics().evictions, 0);
+
+    for (int i = 5; i < 20; ++i)
+        std::ignore = cache.findByPtr(&handles[i]);
+    QVERIFY(cache.contains(&handles[0]));
+    QCOMPARE(cache.size(), 5);
+
+    cache.unpin(&handles[0]);
+    for (int i = 1; i < 20; ++i)
+        std::ignore = cache.findByPtr(&handles[i]);
+    QVERIFY(cache.contains(&handles[0]));
+
+    cache.unpin(&handles[0]);
+    for (int i = 1; i < 20; ++i)
+        std::ignore = cache.findByPtr(&handles[i]);
+    QVERIFY(!cache.contains(&handles[0]));
+    QCOMPARE(cache.size(), 4);
+}
+
+void AbstractCacheTest::removeAndReuseSlots()
+{
+    auto handles = makeHandles<12>();
+    ItemsCache cache;
+    cache.setCapacity(10);
+
+    for (int i = 0; i < 10; ++i)
+        std::ignore = cache.findByPtr(&handles[i]);
+
+    QVERIFY(cache.removeFromList(&handles[3]));
+    QVERIFY(cache.removeFromList(&handles[7]));
+    QVERIFY(!cache.removeFromList(&handles[7]));
+    QCOMPARE(cache.size(), 8);
+    QVERIFY(!cache.contains(&handles[3]));
+    QVERIFY(!cache.contains(&handles[7]));
+
+    // The freed slots are taken again, and the ones removed are not evicted a second time.
+    std::ignore = cache.findByPtr(&handles[10]);
+    std::ignore = cache.findByPtr(&handles[11]);
+    QCOMPARE(cache.size(), 10);
+    QCOMPARE(cache.statistics().evictions, 0);
+
+    bool isNew;
+    std::ignore = cache.findByPtr(&handles[3], &isNew);
+    QVERIFY(isNew);
+    QCOMPARE(cache.statistics().evictions, 1);
+    QVERIFY(!cache.contains(&handles[0]));
+    for (int i : {1, 2, 3, 4, 5, 6, 8, 9, 10, 11})
+        QVERIFY(cache.contains(&handles[i]));
+}
+
+void AbstractCacheTest::statistics()
+{
+    auto handles = makeHandles<3>();
+    ItemsCache cache;
+
+    std::ignore = cache.findByPtr(&handles[0]);
+    std::ignore = cache.findByPtr(&handles[1]);
+    std::ignore = cache.findByPtr(&handles[0]);
+    std::ignore = cache.findByPtr(&handles[0]);
+    QVERIFY(cache.insert(&handles[2], Item{&handles[2]}));
+    QVERIFY(!cache.insert(&handles[2], Item{&handles[2]}));
+
+    QCOMPARE(cache.statistics().hits, 2);
+    QCOMPARE(cache.statistics().misses, 2);
+    QCOMPARE(cache.statistics().evictions, 0);
+
+    cache.resetStatistics();
+    QCOMPARE(cache.statistics().hits, 0);
+    QCOMPARE(cache.statistics().misses, 0);
+}
+
+#include "moc_abstractcachetest.cpp"
@@ -0,0 +1,21 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class AbstractCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void unlimitedByDefault();
+    void evictsLeastRecentlyUsed();
+    void pinnedEntriesStay();
+    void removeAndReuseSlots();
+    void statistics();
+};
@@ -0,0 +1,167 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "blametest.h"
+#include "blame.h"
+#include "options/blameoptions.h"
+#include "repository.h"
+#include "testcommon.h"
+
+#include <QTest>
+
+#include <git2/blame.h>
+
+QTEST_GUILESS_MAIN(BlameTest)
+
+namespace
+{
+constexpr auto fileName{"code.txt"};
+
+QList<Git::Blame> blameParts(const QString &path)
+{
+    git_blame_options opts;
+    git_blame_options_init(&opts, GIT_BLAME_OPTIONS_VERSION);
+
+    QList<Git::Blame> parts;
+    const auto finished = Git::blameFile(path, QString::fromLatin1(fileName), opts, [&parts](const Git::Blame &part) {
+        parts << part;
+        return true;
+    });
+    return finished ? parts : QList<Git::Blame>{};
+}
+}
+
+BlameTest::BlameTest(QObject *parent)
+    : QObject{parent}
+    , mManager{new Git::Repository{this}}
+{
+}
+
+BlameTest::~BlameTest()
+{
+    delete mManager;
+}
+
+QString BlameTest::commitOf(int lineNumber) const
+{
+    const auto hunk = mManager->blame(QString::fromLatin1(fileName)).hunkByLineNumber(lineNumber);
+    if (hunk.isNull())
+        return QStringLiteral("none");
+    return hunk.finalCommit().isNull() ? QString{} : hunk.finalCommit().commitHash();
+}
+
+void BlameTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    QVERIFY(mManager->init(path));
+    QVERIFY(mManager->isValid());
+
+    TestCommon::initSignature(mManager);
+
+    for (auto i = 1; i <= 300; ++i)
+        mLines << QStringLiteral("line %1").arg(i);
+    QVERIFY(TestCommon::writeFile(mManager, fileName, mLines.join('\n') + '\n'));
+    mManager->addFile(fileName);
+    mFirstCommit = TestCommon::commitHash(mManager, "add code");
+
+    for (auto i = 200; i < 210; ++i)
+        mLines[i - 1] = QStringLiteral("changed line %1").arg(i);
+    QVERIFY(TestCommon::writeFile(mManager, fileName, mLines.join('\n') + '\n'));
+    mManager->addFile(fileName);
+    mSecondCommit = TestCommon::commitHash(mManager, "change code");
+
+    QVERIFY(!mFirstCommit.isEmpty());
+    QVERIFY(!mSecondCommit.isEmpty());
+}
+
+void BlameTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
+
+void BlameTest::parts()
+{
+    // The first 128 lines, then the rest.
+    const auto parts = blameParts(mManager->path());
+    QCOMPARE(parts.size(), 2);
+
+    Git::Blame blame{mManager, mLines};
+    QVERIFY(!blame.isNull());
+    QVERIFY(blame.hunkByLineNumber(1).isNull());
+
+    // Appended out of order, they still end up in line order.
+    blame.append(parts.at(1));
+    blame.append(parts.at(0));
+    QCOMPARE(blame.size(), 3);
+    for (auto i = 1; i < blame.size(); ++i)
+        QVERIFY(blame.at(i - 1).startLine() + blame.at(i - 1).linesCount() == blame.at(i).startLine());
+
+    QCOMPARE(blame.hunkByLineNumber(1).finalCommit().commitHash(), mFirstCommit);
+    QCOMPARE(blame.hunkByLineNumber(199).finalCommit().commitHash(), mFirstCommit);
+    QCOMPARE(blame.hunkByLineNumber(200).finalCommit().commitHash(), mSecondCommit);
+    QCOMPARE(blame.hunkByLineNumber(209).finalCommit().commitHash(), mSecondCommit);
+    QCOMPARE(blame.hunkByLineNumber(300).finalCommit().commitHash(), mFirstCommit);
+    QVERIFY(blame.hunkByLineNumber(301).isNull());
+    QVERIFY(blame.hunkByLineNumber(0).isNull());
+}
+
+void BlameTest::kept()
+{
+    const auto first = blameParts(mManager->path());
+    const auto second = blameParts(mManager->path());
+    QCOMPARE(first.size(), second.size());
+
+    // Handed back as they were, not blamed again.
+    for (auto i = 0; i < first.size(); ++i)
+        QCOMPARE(first.at(i).constData(), second.at(i).constData());
+}
+
+void BlameTest::edited()
+{
+    auto lines = mLines;
+    lines[4] = QStringLiteral("edited line 5");
+    lines.insert(100, QStringLiteral("new line"));
+    QVERIFY(TestCommon::writeFile(mManager, fileName, lines.join('\n') + '\n'));
+
+    QVERIFY(commitOf(5).isEmpty());
+    QVERIFY(commitOf(101).isEmpty());
+    QCOMPARE(commitOf(4), mFirstCommit);
+    QCOMPARE(commitOf(6), mFirstCommit);
+    // Moved down by the new line.
+    QCOMPARE(commitOf(200), mFirstCommit);
+    QCOMPARE(commitOf(201), mSecondCommit);
+    QCOMPARE(commitOf(301), mFirstCommit);
+
+    // Another edit is carried over from the same kept blame.
+    lines[4] = mLines.at(4);
+    QVERIFY(TestCommon::writeFile(mManager, fileName, lines.join('\n') + '\n'));
+    QCOMPARE(commitOf(5), mFirstCommit);
+    QVERIFY(commitOf(101).isEmpty());
+
+    QVERIFY(TestCommon::writeFile(mManager, fileName, mLines.join('\n') + '\n'));
+    QCOMPARE(commitOf(101), mFirstCommit);
+}
+
+void BlameTest::lineRange()
+{
+    Git::BlameOptions options;
+    options.setFirstLineNumber(195);
+    options.setLastLineNumber(204);
+
+    const auto blame = mManager->blame(QString::fromLatin1(fileName), &options);
+    QVERIFY(!blame.isNull());
+
+    size_t lines{0};
+    for (const auto &hunk : blame) {
+        QVERIFY(hunk.startLine() >= 195);
+        QVERIFY(hunk.startLine() + hunk.linesCount() <= 205);
+        lines += hunk.linesCount();
+    }
+    QCOMPARE(lines, size_t{10});
+    QCOMPARE(blame.hunkByLineNumber(195).finalCommit().commitHash(), mFirstCommit);
+    QCOMPARE(blame.hunkByLineNumber(204).finalCommit().commitHash(), mSecondCommit);
+    QVERIFY(blame.hunkByLineNumber(205).isNull());
+}
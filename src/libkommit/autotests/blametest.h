@@ -0,0 +1,40 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+
+namespace Git
+{
+class Repository;
+};
+
+class BlameTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BlameTest(QObject *parent = nullptr);
+    ~BlameTest() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void parts();
+    void kept();
+    void edited();
+    void lineRange();
+
+private:
+    [[nodiscard]] QString commitOf(int lineNumber) const;
+
+    Git::Repository *mManager;
+    QStringList mLines;
+    QString mFirstCommit;
+    QString mSecondCommit;
+};
@@ -0,0 +1,136 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "committest.h"
+#include "caches/commitscache.h"
+#include "entities/commit.h"
+#include "entities/index.h"
+#include "repository.h"
+#include "testcommon.h"
+
+#include <QTest>
+
+#include <git2/commit.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+QTEST_GUILESS_MAIN(CommitTest)
+
+namespace
+{
+constexpr int commitsCount{200};
+
+QString toString(const git_oid &oid)
+{
+    return QString::fromLatin1(git_oid_tostr_s(&oid));
+}
+}
+
+CommitTest::CommitTest(QObject *parent)
+    : QObject{parent}
+{
+}
+
+CommitTest::~CommitTest()
+{
+    delete mManager;
+}
+
+void CommitTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    mManager = new Git::Repository;
+
+    QVERIFY(mManager->init(path));
+    QVERIFY(mManager->isValid());
+
+    TestCommon::initSignature(mManager);
+
+    for (int i = 0; i < commitsCount; ++i) {
+        TestCommon::touch(mManager->path() + "/README.md");
+        auto index = mManager->index();
+        QVERIFY(index.addByPath("README.md"));
+        QVERIFY(index.writeTree());
+        QVERIFY(mManager->commit(QStringLiteral("commit %1").arg(i)));
+    }
+}
+
+void CommitTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
+
+void CommitTest::parentsAndChildren()
+{
+    const auto commits = mManager->commits()->allCommits();
+    QCOMPARE(commits.size(), commitsCount);
+
+    // Newest first: each commit is the only child of the one after it.
+    for (int i = 0; i < commits.size(); ++i) {
+        const auto &commit = commits.at(i);
+        QCOMPARE(commit.commitHash(), toString(*git_commit_id(commit.data())));
+
+        const auto parentOids = commit.parentOids();
+        const auto childOids = commit.childOids();
+        if (i + 1 < commits.size()) {
+            QCOMPARE(parentOids.size(), 1);
+            QVERIFY(git_oid_equal(&parentOids.first(), git_commit_id(commits.at(i + 1).data())));
+            QCOMPARE(commit.parents(), QStringList{commits.at(i + 1).commitHash()});
+        } else {
+            QVERIFY(parentOids.isEmpty());
+            QVERIFY(commit.parents().isEmpty());
+        }
+
+        if (i > 0) {
+            QCOMPARE(childOids.size(), 1);
+            QVERIFY(git_oid_equal(&childOids.first(), git_commit_id(commits.at(i - 1).data())));
+            QCOMPARE(commit.children(), QStringList{commits.at(i - 1).commitHash()});
+        } else {
+            QVERIFY(childOids.isEmpty());
+        }
+    }
+}
+
+void CommitTest::benchmarkMemoryPerCommit_data()
+{
+    QTest::addColumn<bool>("eager");
+    QTest::newRow("lazy") << false;
+    // What each commit used to keep from the start: its hash and the hashes of its parents
+    // and children, as strings.
+    QTest::newRow("eager") << true;
+}
+
+void CommitTest::benchmarkMemoryPerCommit()
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    QFETCH(bool, eager);
+
+    // A repository of its own, so none of the commits are in its cache yet.
+    Git::Repository repository;
+    QVERIFY(repository.open(mManager->path()));
+
+    QList<QStringList> hashes;
+    const auto before = mallinfo2().uordblks;
+    const auto commits = repository.commits()->allCommits();
+    if (eager) {
+        hashes.reserve(commits.size() * 2);
+        for (const auto &commit : commits) {
+            Q_UNUSED(commit.commitHash())
+            hashes << commit.parents() << commit.children();
+        }
+    }
+    const auto after = mallinfo2().uordblks;
+
+    QCOMPARE(commits.size(), commitsCount);
+    QTest::setBenchmarkResult(qreal(after - before) / commits.size(), QTest::BytesAllocated);
+#else
+    QSKIP("Needs glibc to count the bytes allocated");
+#endif
+}
+
+#include "moc_committest.cpp"
@@ -0,0 +1,33 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+namespace Git
+{
+class Repository;
+};
+
+class CommitTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CommitTest(QObject *parent = nullptr);
+    ~CommitTest() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void parentsAndChildren();
+    void benchmarkMemoryPerCommit_data();
+    void benchmarkMemoryPerCommit();
+
+private:
+    Git::Repository *mManager;
+};
@@ -0,0 +1,146 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "commitwalktest.h"
+#include "commitwalk.h"
+#include "repository.h"
+#include "testcommon.h"
+
+#include <QTest>
+
+#include <algorithm>
+
+QTEST_GUILESS_MAIN(CommitWalkTest)
+
+namespace
+{
+constexpr int commitsCount{7};
+}
+
+CommitWalkTest::CommitWalkTest(QObject *parent)
+    : QObject{parent}
+{
+}
+
+CommitWalkTest::~CommitWalkTest()
+{
+    delete mManager;
+}
+
+void CommitWalkTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    mManager = new Git::Repository;
+
+    QVERIFY(mManager->init(path));
+    QVERIFY(mManager->isValid());
+
+    TestCommon::initSignature(mManager);
+}
+
+void CommitWalkTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
+
+void CommitWalkTest::makeCommits()
+{
+    for (int i = 0; i < commitsCount; ++i) {
+        TestCommon::touch(mManager->path() + "/README.md");
+        mManager->addFile(QStringLiteral("README.md"));
+        const auto oid = TestCommon::commit(mManager, QStringLiteral("commit %1").arg(i));
+        QVERIFY(!git_oid_is_zero(&oid));
+    }
+
+    QCOMPARE(Git::walkCommits(mManager->path(), {}, 0).oids.size(), commitsCount);
+}
+
+void CommitWalkTest::pagedWalkMatchesWholeWalk()
+{
+    const auto whole = Git::walkCommits(mManager->path(), {}, 0).oids;
+
+    QList<git_oid> paged;
+    QList<int> pageSizes;
+    const auto completed = Git::walkCommits(mManager->path(), {}, 3, [&](const QList<git_oid> &page) {
+        paged << page;
+        pageSizes << page.size();
+        return true;
+    });
+
+    QVERIFY(completed);
+    QCOMPARE(pageSizes, (QList<int>{3, 3, 1}));
+    QCOMPARE(paged.size(), whole.size());
+    for (int i = 0; i < whole.size(); ++i)
+        QVERIFY(git_oid_equal(&paged.at(i), &whole.at(i)));
+}
+
+void CommitWalkTest::pagedWalkStopsWhenAsked()
+{
+    int pages{0};
+    const auto completed = Git::walkCommits(mManager->path(), {}, 2, [&pages](const QList<git_oid> &) {
+        ++pages;
+        return false;
+    });
+
+    QVERIFY(!completed);
+    QCOMPARE(pages, 1);
+}
+
+void CommitWalkTest::walkOnTopOfBase()
+{
+    const auto walk = [this](const Git::CommitWalkBase &base, QList<git_oid> *tips, int *pages) {
+        QList<git_oid> oids;
+        *pages = 0;
+        const auto completed = Git::walkCommits(
+            mManager->path(),
+            {},
+            100,
+            [&](const QList<git_oid> &page) {
+                oids << page;
+                ++*pages;
+                return true;
+            },
+            base,
+            tips);
+        return completed ? oids : QList<git_oid>{};
+    };
+    const auto same = [](const QList<git_oid> &oids1, const QList<git_oid> &oids2) {
+        return std::equal(oids1.cbegin(), oids1.cend(), oids2.cbegin(), oids2.cend(), [](const git_oid &oid1, const git_oid &oid2) {
+            return git_oid_equal(&oid1, &oid2);
+        });
+    };
+
+    int pages;
+    Git::CommitWalkBase base;
+    base.oids = walk({}, &base.tips, &pages);
+    QCOMPARE(base.tips.size(), 1);
+    QVERIFY(same(base.tips, Git::walkTips(mManager->path(), {})));
+    QVERIFY(same(base.oids, Git::walkCommits(mManager->path(), {}, 0).oids));
+
+    // Nothing moved: the base comes back as it is.
+    QList<git_oid> tips;
+    QVERIFY(same(walk(base, &tips, &pages), base.oids));
+    QVERIFY(same(tips, base.tips));
+
+    for (int i = 0; i < 2; ++i) {
+        TestCommon::touch(mManager->path() + "/README.md");
+        mManager->addFile(QStringLiteral("README.md"));
+        const auto oid = TestCommon::commit(mManager, QStringLiteral("on top %1").arg(i));
+        QVERIFY(!git_oid_is_zero(&oid));
+    }
+
+    // Two new commits on top: a page of those, then the base.
+    const auto whole = Git::walkCommits(mManager->path(), {}, 0).oids;
+    QVERIFY(same(walk(base, &tips, &pages), whole));
+    QCOMPARE(pages, 2);
+    QVERIFY(!same(tips, base.tips));
+
+    // A base tip that cannot be reached any more means a full walk.
+    Git::CommitWalkBase rewritten{{git_oid{{1}}}, base.oids};
+    QVERIFY(same(walk(rewritten, &tips, &pages), whole));
+}
+
+#include "moc_commitwalktest.cpp"
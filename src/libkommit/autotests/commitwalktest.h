@@ -0,0 +1,34 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+namespace Git
+{
+class Repository;
+};
+
+class CommitWalkTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CommitWalkTest(QObject *parent = nullptr);
+    ~CommitWalkTest() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void makeCommits();
+    void pagedWalkMatchesWholeWalk();
+    void pagedWalkStopsWhenAsked();
+    void walkOnTopOfBase();
+
+private:
+    Git::Repository *mManager;
+};
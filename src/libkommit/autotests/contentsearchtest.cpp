@@ -0,0 +1,177 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "contentsearchtest.h"
+#include "contentsearch.h"
+#include "repository.h"
+#include "testcommon.h"
+
+#include <QStringList>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(ContentSearchTest)
+
+namespace
+{
+struct Result {
+    QStringList matches;
+    Git::ContentSearch::Stats stats;
+};
+
+Result search(Git::ContentSearch &search, const QString &path, const QList<Git::ContentSearch::Place> &places)
+{
+    Result result;
+    search.run(path, places, [&result](const QList<Git::ContentSearch::Match> &matches, const Git::ContentSearch::Stats &stats) {
+        for (const auto &match : matches)
+            result.matches << QString::fromLatin1(git_oid_tostr_s(&match.commit)).left(7) + QLatin1Char(':') + match.path;
+        result.stats = stats;
+        return true;
+    });
+    result.matches.sort();
+    return result;
+}
+
+QStringList sorted(QStringList list)
+{
+    list.sort();
+    return list;
+}
+}
+
+ContentSearchTest::ContentSearchTest(QObject *parent)
+    : QObject{parent}
+    , mManager{new Git::Repository{this}}
+{
+}
+
+ContentSearchTest::~ContentSearchTest()
+{
+    delete mManager;
+}
+
+void ContentSearchTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    QVERIFY(mManager->init(path));
+    QVERIFY(mManager->isValid());
+
+    TestCommon::initSignature(mManager);
+
+    QVERIFY(TestCommon::writeFile(mManager, "a.txt", "hello world\n"));
+    QVERIFY(TestCommon::writeFile(mManager, "b.txt", "nothing here\n"));
+    mManager->addFile("a.txt");
+    mManager->addFile("b.txt");
+    mCommits << TestCommon::commit(mManager, "add a and b");
+
+    QVERIFY(TestCommon::makePath(mManager, "dir"));
+    QVERIFY(TestCommon::writeFile(mManager, "b.txt", "Hello again\n"));
+    QVERIFY(TestCommon::writeFile(mManager, "dir/c.txt", "say hello\n"));
+    QVERIFY(TestCommon::writeFile(mManager, "dir/d.txt", "hello world\n"));
+    mManager->addFile("b.txt");
+    mManager->addFile("dir/c.txt");
+    mManager->addFile("dir/d.txt");
+    mCommits << TestCommon::commit(mManager, "change b, add dir");
+
+    for (const auto &c : std::as_const(mCommits))
+        QVERIFY(!git_oid_is_zero(&c));
+}
+
+void ContentSearchTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
+
+void ContentSearchTest::contains_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<bool>("caseSensitive");
+    QTest::addColumn<bool>("regularExpression");
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<bool>("result");
+
+    QTest::newRow("literal") << "world" << true << false << QByteArray{"hello world"} << true;
+    QTest::newRow("literal at the end") << "ld" << true << false << QByteArray{"hello world"} << true;
+    QTest::newRow("literal missing") << "word" << true << false << QByteArray{"hello world"} << false;
+    QTest::newRow("literal past the end") << "world!" << true << false << QByteArray{"hello world"} << false;
+    QTest::newRow("case") << "World" << true << false << QByteArray{"hello world"} << false;
+    QTest::newRow("any case") << "WoRLD" << false << false << QByteArray{"hello world"} << true;
+    QTest::newRow("any case, first letter") << "h" << false << false << QByteArray{"xyz H"} << true;
+    QTest::newRow("any case, not a letter") << "1-a" << false << false << QByteArray{"x 1-A"} << true;
+    QTest::newRow("non ascii") << QStringLiteral("ÄPFEL") << false << false << QByteArray{"die äpfel"} << true;
+    QTest::newRow("regular expression") << "w[aeiou]rld" << true << true << QByteArray{"hello world"} << true;
+    QTest::newRow("regular expression, any case") << "^HELLO" << false << true << QByteArray{"hello world"} << true;
+    QTest::newRow("regular expression missing") << "^world" << true << true << QByteArray{"hello world"} << false;
+}
+
+void ContentSearchTest::contains()
+{
+    QFETCH(QString, text);
+    QFETCH(bool, caseSensitive);
+    QFETCH(bool, regularExpression);
+    QFETCH(QByteArray, data);
+    QFETCH(bool, result);
+
+    const Git::ContentSearch search{text, caseSensitive, regularExpression};
+    QVERIFY(search.isValid());
+    QCOMPARE(search.contains(data.constData(), data.size()), result);
+}
+
+void ContentSearchTest::search()
+{
+    QVERIFY(!Git::ContentSearch(QString{}, true, false).isValid());
+    QVERIFY(!Git::ContentSearch(QStringLiteral("("), true, true).isValid());
+
+    const auto first = QString::fromLatin1(git_oid_tostr_s(&mCommits.at(0))).left(7);
+    const auto second = QString::fromLatin1(git_oid_tostr_s(&mCommits.at(1))).left(7);
+
+    Git::ContentSearch caseSensitive{QStringLiteral("hello"), true, false};
+    auto result = ::search(caseSensitive, mManager->path(), {{QString{}, mCommits.at(1)}, {QString{}, mCommits.at(0)}});
+    QCOMPARE(result.matches, sorted({first + ":a.txt", second + ":a.txt", second + ":dir/c.txt", second + ":dir/d.txt"}));
+
+    QCOMPARE(result.stats.places, 2);
+    QCOMPARE(result.stats.matches, 4);
+    // a.txt and dir/d.txt are the same blob, as is a.txt in both commits.
+    QCOMPARE(result.stats.blobs, 4);
+    QCOMPARE(result.stats.reusedBlobs, 2);
+
+    Git::ContentSearch anyCase{QStringLiteral("hello"), false, false};
+    result = ::search(anyCase, mManager->path(), {{QStringLiteral("master"), mCommits.at(1)}});
+    QCOMPARE(result.matches, (QStringList{second + ":a.txt", second + ":b.txt", second + ":dir/c.txt", second + ":dir/d.txt"}));
+}
+
+void ContentSearchTest::pathFilter()
+{
+    const auto second = QString::fromLatin1(git_oid_tostr_s(&mCommits.at(1))).left(7);
+
+    Git::ContentSearch search{QStringLiteral("hello"), true, false, QStringLiteral("dir/")};
+    QVERIFY(search.acceptsPath(QStringLiteral("dir/c.txt")));
+    QVERIFY(!search.acceptsPath(QStringLiteral("a.txt")));
+
+    const auto result = ::search(search, mManager->path(), {{QString{}, mCommits.at(1)}});
+    QCOMPARE(result.matches, (QStringList{second + ":dir/c.txt", second + ":dir/d.txt"}));
+}
+
+void ContentSearchTest::stop()
+{
+    QList<Git::ContentSearch::Place> places;
+    for (auto i = 0; i < 1000; ++i)
+        places << Git::ContentSearch::Place{QString{}, mCommits.at(i % 2)};
+
+    Git::ContentSearch search{QStringLiteral("hello"), true, false};
+    auto calls{0};
+    const auto finished = search.run(mManager->path(), places, [&calls](const QList<Git::ContentSearch::Match> &, const Git::ContentSearch::Stats &) {
+        ++calls;
+        return false;
+    });
+    QVERIFY(!finished);
+    QCOMPARE(calls, 1);
+
+    Git::ContentSearch canceled{QStringLiteral("hello"), true, false};
+    canceled.cancel();
+    QVERIFY(!canceled.run(mManager->path(), places, [](const QList<Git::ContentSearch::Match> &, const Git::ContentSearch::Stats &) {
+        return true;
+    }));
+}
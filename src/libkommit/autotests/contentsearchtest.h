@@ -0,0 +1,41 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+
+#include <git2/oid.h>
+
+namespace Git
+{
+class Repository;
+};
+
+class ContentSearchTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ContentSearchTest(QObject *parent = nullptr);
+    ~ContentSearchTest() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void contains_data();
+    void contains();
+    void search();
+    void pathFilter();
+    void stop();
+
+private:
+
+    Git::Repository *mManager;
+    // Oldest first.
+    QList<git_oid> mCommits;
+};
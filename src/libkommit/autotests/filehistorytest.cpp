@@ -0,0 +1,147 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "filehistorytest.h"
+#include "entities/index.h"
+#include "filehistory.h"
+#include "repository.h"
+#include "testcommon.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTest>
+
+#include <git2/oid.h>
+
+QTEST_GUILESS_MAIN(FileHistoryTest)
+
+namespace
+{
+QString toString(const git_oid &oid)
+{
+    return QString::fromLatin1(git_oid_tostr_s(&oid));
+}
+}
+
+FileHistoryTest::FileHistoryTest(QObject *parent)
+    : QObject{parent}
+    , mManager{new Git::Repository{this}}
+{
+}
+
+FileHistoryTest::~FileHistoryTest()
+{
+    delete mManager;
+}
+
+QStringList FileHistoryTest::commitsOf(const QString &filePath, bool followRenames)
+{
+    QStringList hashes;
+    const auto revisions = Git::fileHistory(mManager->path(), filePath, followRenames);
+    for (const auto &revision : revisions)
+        hashes << toString(revision.commit);
+    return hashes;
+}
+
+void FileHistoryTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    QVERIFY(mManager->init(path));
+    QVERIFY(mManager->isValid());
+
+    TestCommon::initSignature(mManager);
+
+    TestCommon::touch(mManager, "a.txt");
+    mCommits << TestCommon::commitHash(mManager, "add a");
+
+    TestCommon::touch(mManager, "a.txt");
+    mCommits << TestCommon::commitHash(mManager, "change a");
+
+    TestCommon::touch(mManager, "b.txt");
+    mCommits << TestCommon::commitHash(mManager, "add b");
+
+    QVERIFY(QDir{mManager->path()}.mkpath("moved"));
+    QVERIFY(QFile::rename(mManager->path() + "/a.txt", mManager->path() + "/moved/a2.txt"));
+    auto index = mManager->index();
+    QVERIFY(index.removeByPath("a.txt"));
+    QVERIFY(index.addByPath("moved/a2.txt"));
+    QVERIFY(index.writeTree());
+    mCommits << TestCommon::commitHash(mManager, "move a");
+
+    TestCommon::touch(mManager, "moved/a2.txt");
+    mCommits << TestCommon::commitHash(mManager, "change moved a");
+
+    for (const auto &c : std::as_const(mCommits))
+        QVERIFY(!c.isEmpty());
+}
+
+void FileHistoryTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
+
+void FileHistoryTest::history()
+{
+    QCOMPARE(commitsOf("a.txt", false), (QStringList{mCommits.at(3), mCommits.at(1), mCommits.at(0)}));
+    QCOMPARE(commitsOf("b.txt", false), QStringList{mCommits.at(2)});
+    QCOMPARE(commitsOf("moved/a2.txt", false), (QStringList{mCommits.at(4), mCommits.at(3)}));
+    QVERIFY(commitsOf("nothing.txt", false).isEmpty());
+
+    // Deleted in the move.
+    const auto revisions = Git::fileHistory(mManager->path(), "a.txt");
+    QVERIFY(git_oid_is_zero(&revisions.first().blob));
+    QVERIFY(!git_oid_is_zero(&revisions.last().blob));
+}
+
+void FileHistoryTest::followRenames()
+{
+    const auto revisions = Git::fileHistory(mManager->path(), "moved/a2.txt", true);
+    QCOMPARE(revisions.size(), 4);
+
+    QCOMPARE(toString(revisions.at(2).commit), mCommits.at(1));
+    QCOMPARE(revisions.at(1).path, "moved/a2.txt");
+    QCOMPARE(revisions.at(2).path, "a.txt");
+    QCOMPARE(revisions.at(3).path, "a.txt");
+
+    // Moved as it was.
+    QVERIFY(git_oid_equal(&revisions.at(1).blob, &revisions.at(2).blob));
+
+    // Walked again, from what was kept.
+    QCOMPARE(commitsOf("moved/a2.txt", true), (QStringList{mCommits.at(4), mCommits.at(3), mCommits.at(1), mCommits.at(0)}));
+}
+
+void FileHistoryTest::paging()
+{
+    QList<int> pages;
+    auto finished = Git::walkFileHistory(mManager->path(), "moved/a2.txt", true, 3, [&pages](const QList<Git::FileRevision> &page) {
+        pages << page.size();
+        return true;
+    });
+    QVERIFY(finished);
+    QCOMPARE(pages, (QList<int>{3, 1}));
+
+    pages.clear();
+    finished = Git::walkFileHistory(mManager->path(), "a.txt", false, 1, [&pages](const QList<Git::FileRevision> &page) {
+        pages << page.size();
+        return false;
+    });
+    QVERIFY(!finished);
+    QCOMPARE(pages, QList<int>{1});
+}
+
+void FileHistoryTest::newCommits()
+{
+    // Walked before; the new walk goes as far as the HEAD of the old one and takes over.
+    QCOMPARE(commitsOf("moved/a2.txt", true).size(), 4);
+
+    TestCommon::touch(mManager, "b.txt");
+    const auto changeB = TestCommon::commitHash(mManager, "change b");
+    TestCommon::touch(mManager, "moved/a2.txt");
+    const auto changeA = TestCommon::commitHash(mManager, "change moved a again");
+
+    QCOMPARE(commitsOf("moved/a2.txt", true), (QStringList{changeA, mCommits.at(4), mCommits.at(3), mCommits.at(1), mCommits.at(0)}));
+    QCOMPARE(commitsOf("b.txt", false), (QStringList{changeB, mCommits.at(2)}));
+}
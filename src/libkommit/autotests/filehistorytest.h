@@ -0,0 +1,39 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+
+namespace Git
+{
+class Repository;
+};
+
+class FileHistoryTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileHistoryTest(QObject *parent = nullptr);
+    ~FileHistoryTest() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void history();
+    void followRenames();
+    void paging();
+    void newCommits();
+
+private:
+    [[nodiscard]] QStringList commitsOf(const QString &filePath, bool followRenames);
+
+    Git::Repository *mManager;
+    // Oldest first.
+    QStringList mCommits;
+};
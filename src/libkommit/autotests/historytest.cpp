@@ -0,0 +1,233 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "historytest.h"
+#include "entities/index.h"
+#include "filestatus.h"
+#include "gitglobal.h"
+#include "repository.h"
+#include "testcommon.h"
+
+#include <QFile>
+#include <QTest>
+
+#include <git2/commit.h>
+#include <git2/refs.h>
+#include <git2/repository.h>
+#include <git2/signature.h>
+
+QTEST_GUILESS_MAIN(HistoryTest)
+
+namespace
+{
+// Commits on top of the three the tests look at, for the benchmarks to walk through.
+constexpr int benchmarkCommits{100};
+}
+
+HistoryTest::HistoryTest(QObject *parent)
+    : QObject{parent}
+    , mManager{new Git::Repository{this}}
+{
+}
+
+HistoryTest::~HistoryTest()
+{
+    delete mManager;
+}
+
+void HistoryTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    QVERIFY(mManager->init(path));
+    QVERIFY(mManager->isValid());
+
+    TestCommon::initSignature(mManager);
+
+    TestCommon::touch(mManager, "a.txt");
+    TestCommon::touch(mManager, "b.txt");
+    TestCommon::writeFile(mManager, ".gitignore", "build/\n");
+    mManager->addFile(".gitignore");
+    mCommits << TestCommon::commitHash(mManager, "first");
+
+    TestCommon::touch(mManager, "a.txt");
+    auto index = mManager->index();
+    QVERIFY(index.removeByPath("b.txt"));
+    QVERIFY(index.writeTree());
+    QVERIFY(QFile::remove(mManager->path() + "/b.txt"));
+    TestCommon::touch(mManager, "dir/c.txt");
+    mCommits << TestCommon::commitHash(mManager, "second");
+
+    TestCommon::touch(mManager, "dir/c.txt");
+    mCommits << TestCommon::commitHash(mManager, "third");
+
+    for (const auto &c : std::as_const(mCommits))
+        QVERIFY(!c.isEmpty());
+
+    for (int i = 0; i < benchmarkCommits; ++i) {
+        TestCommon::touch(mManager, QStringLiteral("bench/%1.txt").arg(i % 10));
+        QVERIFY(!TestCommon::commitHash(mManager, QStringLiteral("bench %1").arg(i)).isEmpty());
+    }
+
+    TestCommon::touch(mManager->path() + "/build/out.o");
+}
+
+void HistoryTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
+
+void HistoryTest::changedFiles()
+{
+    auto files = mManager->changedFiles(mCommits.at(0));
+    QCOMPARE(files.size(), 3);
+    QCOMPARE(files.value("a.txt"), Git::ChangeStatus::Added);
+    QCOMPARE(files.value("b.txt"), Git::ChangeStatus::Added);
+
+    files = mManager->changedFiles(mCommits.at(1));
+    QCOMPARE(files.size(), 3);
+    QCOMPARE(files.value("a.txt"), Git::ChangeStatus::Modified);
+    QCOMPARE(files.value("b.txt"), Git::ChangeStatus::Removed);
+    QCOMPARE(files.value("dir/c.txt"), Git::ChangeStatus::Added);
+
+    QVERIFY(mManager->changedFiles(QStringLiteral("no-such-revision")).isEmpty());
+}
+
+void HistoryTest::fileLog()
+{
+    QCOMPARE(mManager->fileLog("a.txt"), (QStringList{mCommits.at(1), mCommits.at(0)}));
+    QCOMPARE(mManager->fileLog("b.txt"), (QStringList{mCommits.at(1), mCommits.at(0)}));
+    QCOMPARE(mManager->fileLog("dir/c.txt"), (QStringList{mCommits.at(2), mCommits.at(1)}));
+    QCOMPARE(mManager->fileLog("dir"), (QStringList{mCommits.at(2), mCommits.at(1)}));
+    QCOMPARE(mManager->fileLog("bench/0.txt").size(), benchmarkCommits / 10);
+    QVERIFY(mManager->fileLog("nothing.txt").isEmpty());
+}
+
+void HistoryTest::fileLogSimplification()
+{
+    Git::Repository repository;
+    QVERIFY(repository.init(TestCommon::getTempPath()));
+    TestCommon::initSignature(&repository);
+
+    TestCommon::touch(&repository, "a.txt");
+    const auto base = TestCommon::commit(&repository, "base");
+    TestCommon::touch(&repository, "a.txt");
+    const auto side = TestCommon::commit(&repository, "side");
+    QVERIFY(!git_oid_is_zero(&base));
+    QVERIFY(!git_oid_is_zero(&side));
+
+    // A merge of the side commit that keeps the base as it was, as a merge -s ours does.
+    git_commit *baseCommit{nullptr};
+    git_commit *sideCommit{nullptr};
+    git_tree *tree{nullptr};
+    git_signature *signature{nullptr};
+    git_reference *head{nullptr};
+    git_reference *moved{nullptr};
+    git_oid merge;
+    QVERIFY(!git_commit_lookup(&baseCommit, repository.repoPtr(), &base));
+    QVERIFY(!git_commit_lookup(&sideCommit, repository.repoPtr(), &side));
+    QVERIFY(!git_commit_tree(&tree, baseCommit));
+    QVERIFY(!git_signature_now(&signature, "Test", "test@example.com"));
+    QVERIFY(!git_commit_create_v(&merge, repository.repoPtr(), nullptr, signature, signature, nullptr, "merge", tree, 2, baseCommit, sideCommit));
+    QVERIFY(!git_repository_head(&head, repository.repoPtr()));
+    QVERIFY(!git_reference_set_target(&moved, head, &merge, "merge"));
+    git_reference_free(moved);
+    git_reference_free(head);
+    git_signature_free(signature);
+    git_tree_free(tree);
+    git_commit_free(sideCommit);
+    git_commit_free(baseCommit);
+
+    // The merge is TREESAME to the base, so the side commit is not gone into, as git log
+    // -- a.txt does not either.
+    QCOMPARE(repository.fileLog("a.txt"), QStringList{QString::fromLatin1(git_oid_tostr_s(&base))});
+
+    TestCommon::cleanPath(&repository);
+}
+
+void HistoryTest::diff()
+{
+    const auto patch = mManager->diff(mCommits.at(0), mCommits.at(1));
+    QVERIFY(patch.contains("diff --git a/a.txt b/a.txt"));
+    QVERIFY(patch.contains("deleted file mode"));
+    QVERIFY(patch.contains("+++ b/dir/c.txt"));
+
+    QVERIFY(mManager->diff(mCommits.at(1), mCommits.at(1)).isEmpty());
+}
+
+void HistoryTest::diffBranch()
+{
+    const auto files = mManager->diffBranch(mCommits.at(1));
+    QVERIFY(files.contains(Git::FileStatus{"dir/c.txt", Git::FileStatus::Modified}));
+    QVERIFY(files.contains(Git::FileStatus{"bench/0.txt", Git::FileStatus::Added}));
+    QVERIFY(!files.contains(Git::FileStatus{"a.txt", Git::FileStatus::Modified}));
+}
+
+void HistoryTest::saveFile()
+{
+    const auto target = TestCommon::getTempPath(false);
+    mManager->saveFile(mCommits.at(2), "dir/c.txt", target);
+    QCOMPARE(TestCommon::readFile(target), TestCommon::readFile(mManager->path() + "/dir/c.txt"));
+    QFile::remove(target);
+}
+
+void HistoryTest::ls()
+{
+    auto files = mManager->ls(mCommits.at(1));
+    files.sort();
+    QCOMPARE(files, (QStringList{".gitignore", "a.txt", "dir/c.txt"}));
+}
+
+void HistoryTest::ignoredFiles()
+{
+    QCOMPARE(mManager->ignoredFiles(), QStringList{"build/"});
+}
+
+void HistoryTest::benchmarkChangedFiles_data()
+{
+    QTest::addColumn<bool>("inProcess");
+    QTest::newRow("git process") << false;
+    QTest::newRow("libgit2") << true;
+}
+
+void HistoryTest::benchmarkChangedFiles()
+{
+    QFETCH(bool, inProcess);
+
+    const auto hash = mCommits.at(1);
+    if (inProcess) {
+        QBENCHMARK {
+            auto files = mManager->changedFiles(hash);
+            Q_UNUSED(files)
+        }
+    } else {
+        QBENCHMARK {
+            auto out = Git::runGit(mManager->path(), {QStringLiteral("show"), QStringLiteral("--name-status"), hash});
+            Q_UNUSED(out)
+        }
+    }
+}
+
+void HistoryTest::benchmarkFileLog_data()
+{
+    benchmarkChangedFiles_data();
+}
+
+void HistoryTest::benchmarkFileLog()
+{
+    QFETCH(bool, inProcess);
+
+    if (inProcess) {
+        QBENCHMARK {
+            auto hashes = mManager->fileLog("a.txt");
+            Q_UNUSED(hashes)
+        }
+    } else {
+        QBENCHMARK {
+            auto out = Git::runGit(mManager->path(), {QStringLiteral("log"), QStringLiteral("--format=format:%H"), QStringLiteral("--"), QStringLiteral("a.txt")});
+            Q_UNUSED(out)
+        }
+    }
+}
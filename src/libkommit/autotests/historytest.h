@@ -0,0 +1,46 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+
+namespace Git
+{
+class Repository;
+};
+
+class HistoryTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HistoryTest(QObject *parent = nullptr);
+    ~HistoryTest() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void changedFiles();
+    void fileLog();
+    void fileLogSimplification();
+    void diff();
+    void diffBranch();
+    void saveFile();
+    void ls();
+    void ignoredFiles();
+
+    void benchmarkChangedFiles_data();
+    void benchmarkChangedFiles();
+    void benchmarkFileLog_data();
+    void benchmarkFileLog();
+
+private:
+    Git::Repository *mManager;
+    // Oldest first.
+    QStringList mCommits;
+};
@@ -14,6 +14,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <QUuid>
 #include <repository.h>
 
+#include <git2/refs.h>
+
 namespace TestCommon
 {
 
@@ -77,6 +79,22 @@ QString touch(Git::Repository *manager, const QString &fileName)
     return content;
 }
 
+git_oid commit(Git::Repository *manager, const QString &message)
+{
+    git_oid oid{};
+    if (manager->commit(message))
+        git_reference_name_to_id(&oid, manager->repoPtr(), "HEAD");
+    return oid;
+}
+
+QString commitHash(Git::Repository *manager, const QString &message)
+{
+    const auto oid = commit(manager, message);
+    if (git_oid_is_zero(&oid))
+        return {};
+    return QString::fromLatin1(git_oid_tostr_s(&oid));
+}
+
 void initSignature(Git::Repository *manager)
 {
     manager->setConfig("user.name", "kommit test user", Git::Repository::ConfigLocal);
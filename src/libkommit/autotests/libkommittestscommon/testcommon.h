@@ -8,6 +8,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "libkommitTestsCommon_global.h"
 #include <QString>
 
+#include <git2/oid.h>
+
 namespace Git
 {
 class Repository;
@@ -26,4 +28,9 @@ LIBKOMMITTESTSCOMMON_EXPORT bool cleanPath(Git::Repository *manager);
 LIBKOMMITTESTSCOMMON_EXPORT QString touch(Git::Repository *manager, const QString &fileName);
 LIBKOMMITTESTSCOMMON_EXPORT bool makePath(Git::Repository *manager, const QString &path);
 LIBKOMMITTESTSCOMMON_EXPORT bool extractSampleRepo(const QString &path);
+
+// Commits what is staged and returns the new HEAD, zero if that failed.
+LIBKOMMITTESTSCOMMON_EXPORT git_oid commit(Git::Repository *manager, const QString &message);
+// As commit(), in hex; empty if that failed.
+LIBKOMMITTESTSCOMMON_EXPORT QString commitHash(Git::Repository *manager, const QString &message);
 }
@@ -0,0 +1,204 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "statustest.h"
+#include "fsmonitor.h"
+#include "options/statusoptions.h"
+#include "repository.h"
+#include "testcommon.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(StatusTest)
+
+StatusTest::StatusTest(QObject *parent)
+    : QObject{parent}
+    , mManager{new Git::Repository{this}}
+{
+}
+
+StatusTest::~StatusTest()
+{
+    delete mManager;
+}
+
+void StatusTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    auto init = mManager->init(path);
+    QVERIFY(init);
+    QVERIFY(mManager->isValid());
+
+    TestCommon::initSignature(mManager);
+
+    TestCommon::touch(mManager, "a.txt");
+    TestCommon::touch(mManager, "b.txt");
+    QVERIFY(mManager->commit("initial"));
+
+    // A stand-in for a file system monitor: answers with a fixed token and whatever paths
+    // the test has reported, outside the working tree so it does not show up in it.
+    auto hookDir = TestCommon::getTempPath();
+    mHookPath = hookDir + QStringLiteral("/fsmonitor");
+    QFile hook{mHookPath};
+    QVERIFY(hook.open(QIODevice::WriteOnly));
+    hook.write("#!/bin/sh\nprintf 'token\\0'\ncat \"$(dirname \"$0\")/changes\"\n");
+    hook.close();
+    hook.setPermissions(hook.permissions() | QFileDevice::ExeOwner);
+    reportChanges({});
+}
+
+void StatusTest::cleanupTestCase()
+{
+    QDir{QFileInfo{mHookPath}.absolutePath()}.removeRecursively();
+    TestCommon::cleanPath(mManager);
+}
+
+void StatusTest::reportChanges(const QStringList &paths)
+{
+    QFile f{QFileInfo{mHookPath}.absolutePath() + QStringLiteral("/changes")};
+    QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    for (const auto &path : paths) {
+        f.write(path.toUtf8());
+        f.write("", 1);
+    }
+}
+
+void StatusTest::optionsFromConfig()
+{
+    auto options = Git::StatusOptions::fromConfig(mManager->repoPtr());
+    QCOMPARE(options.untrackedFiles, Git::StatusOptions::UntrackedFiles::All);
+    QVERIFY(!options.updateIndex);
+    QVERIFY(options.fsMonitorHook.isEmpty());
+
+    // Nothing is run or written unless the application allows it.
+    mManager->setConfig("core.untrackedCache", "true");
+    mManager->setConfig("core.fsmonitor", mHookPath);
+    options = Git::StatusOptions::fromConfig(mManager->repoPtr());
+    QCOMPARE(options.untrackedFiles, Git::StatusOptions::UntrackedFiles::Normal);
+    QVERIFY(!options.updateIndex);
+    QVERIFY(options.fsMonitorHook.isEmpty());
+
+    Git::StatusOptions::setFsMonitorAllowed(true);
+    Git::StatusOptions::setUpdateIndexAllowed(true);
+    mManager->unsetConfig("core.fsmonitor");
+    options = Git::StatusOptions::fromConfig(mManager->repoPtr());
+    QCOMPARE(options.untrackedFiles, Git::StatusOptions::UntrackedFiles::Normal);
+    QVERIFY(options.updateIndex);
+
+    // git's own daemon is not something to run.
+    mManager->setConfig("core.fsmonitor", "true");
+    options = Git::StatusOptions::fromConfig(mManager->repoPtr());
+    QVERIFY(options.fsMonitorHook.isEmpty());
+
+    mManager->setConfig("core.fsmonitor", mHookPath);
+    mManager->setConfig("status.showUntrackedFiles", "all");
+    options = Git::StatusOptions::fromConfig(mManager->repoPtr());
+    QCOMPARE(options.fsMonitorHook, mHookPath);
+    QCOMPARE(options.untrackedFiles, Git::StatusOptions::UntrackedFiles::All);
+
+    Git::StatusOptions::setFsMonitorAllowed(false);
+    Git::StatusOptions::setUpdateIndexAllowed(false);
+    mManager->unsetConfig("core.untrackedCache");
+    mManager->unsetConfig("core.fsmonitor");
+    mManager->unsetConfig("status.showUntrackedFiles");
+}
+
+void StatusTest::untrackedDirectories()
+{
+    TestCommon::touch(mManager->path() + "/new/dir/c.txt");
+
+    Git::StatusOptions options;
+    auto changedFiles = mManager->changedFiles(options);
+    QCOMPARE(changedFiles.value("new/dir/c.txt"), Git::ChangeStatus::Added);
+
+    options.untrackedFiles = Git::StatusOptions::UntrackedFiles::Normal;
+    changedFiles = mManager->changedFiles(options);
+    QVERIFY(!changedFiles.contains("new/dir/c.txt"));
+    QCOMPARE(changedFiles.value("new/"), Git::ChangeStatus::Added);
+
+    options.untrackedFiles = Git::StatusOptions::UntrackedFiles::No;
+    changedFiles = mManager->changedFiles(options);
+    QVERIFY(!changedFiles.contains("new/"));
+
+    QDir{mManager->path() + "/new"}.removeRecursively();
+}
+
+void StatusTest::fsMonitor()
+{
+    Git::StatusOptions options;
+    options.untrackedFiles = Git::StatusOptions::UntrackedFiles::Normal;
+    options.fsMonitorHook = mHookPath;
+
+    // The first look is a full one.
+    reportChanges({});
+    auto changedFiles = mManager->changedFiles(options);
+    QVERIFY(changedFiles.isEmpty());
+
+    // Only what the monitor reports is looked at again.
+    TestCommon::touch(mManager->path() + "/a.txt");
+    changedFiles = mManager->changedFiles(options);
+    QVERIFY(!changedFiles.contains("a.txt"));
+
+    reportChanges({"a.txt"});
+    changedFiles = mManager->changedFiles(options);
+    QCOMPARE(changedFiles.value("a.txt"), Git::ChangeStatus::Modified);
+
+    TestCommon::touch(mManager->path() + "/new/dir/c.txt");
+    reportChanges({"new/dir/c.txt"});
+    changedFiles = mManager->changedFiles(options);
+    QCOMPARE(changedFiles.value("new/"), Git::ChangeStatus::Added);
+    QCOMPARE(changedFiles.value("a.txt"), Git::ChangeStatus::Modified);
+
+    QVERIFY(mManager->revertFile("a.txt"));
+    reportChanges({"a.txt"});
+    changedFiles = mManager->changedFiles(options);
+    QVERIFY(!changedFiles.contains("a.txt"));
+    QVERIFY(changedFiles.contains("new/"));
+
+    // Staging moves the index, which asks for a full look whatever the monitor says.
+    TestCommon::touch(mManager->path() + "/b.txt");
+    mManager->addFile("b.txt");
+    reportChanges({});
+    changedFiles = mManager->changedFiles(options);
+    QCOMPARE(changedFiles.value("b.txt"), Git::ChangeStatus::Modified);
+
+    reportChanges({"/"});
+    QDir{mManager->path() + "/new"}.removeRecursively();
+    changedFiles = mManager->changedFiles(options);
+    QVERIFY(!changedFiles.contains("new/"));
+}
+
+void StatusTest::fsMonitorTimeout()
+{
+    auto hookDir = TestCommon::getTempPath();
+    QFile hook{hookDir + QStringLiteral("/fsmonitor")};
+    QVERIFY(hook.open(QIODevice::WriteOnly));
+    hook.write("#!/bin/sh\nsleep 30\n");
+    hook.close();
+    hook.setPermissions(hook.permissions() | QFileDevice::ExeOwner);
+
+    Git::FsMonitor monitor{hook.fileName(), mManager->path()};
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(monitor.query().everything);
+    QVERIFY(timer.elapsed() < 10000);
+
+    QDir{hookDir}.removeRecursively();
+}
+
+void StatusTest::changedFilesInBackground()
+{
+    TestCommon::touch(mManager->path() + "/c.txt");
+
+    auto changedFiles = mManager->changedFilesInBackground().result();
+    QCOMPARE(changedFiles.value("c.txt"), Git::ChangeStatus::Added);
+    QCOMPARE(changedFiles, mManager->changedFiles());
+
+    QFile::remove(mManager->path() + "/c.txt");
+}
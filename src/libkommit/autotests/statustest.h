@@ -0,0 +1,39 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+
+namespace Git
+{
+class Repository;
+};
+
+class StatusTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StatusTest(QObject *parent = nullptr);
+    ~StatusTest() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void optionsFromConfig();
+    void untrackedDirectories();
+    void fsMonitor();
+    void fsMonitorTimeout();
+    void changedFilesInBackground();
+
+private:
+    void reportChanges(const QStringList &paths);
+
+    Git::Repository *mManager;
+    QString mHookPath;
+};
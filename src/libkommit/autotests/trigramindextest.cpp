@@ -0,0 +1,320 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "trigramindextest.h"
+#include "commitwalk.h"
+#include "contentsearch.h"
+#include "repository.h"
+#include "testcommon.h"
+#include "trigramindex.h"
+
+#include <QDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(TrigramIndexTest)
+
+namespace
+{
+// The synthetic history: each commit rewrites a few of the files with words of its own.
+constexpr int syntheticCommits{80};
+constexpr int syntheticFiles{24};
+constexpr int linesPerFile{120};
+// The commit that adds the text the tests look for.
+constexpr int needleCommit{30};
+const QString needle{QStringLiteral("Needle_In_Haystack")};
+
+QString fileName(int file)
+{
+    return QStringLiteral("src/f%1.txt").arg(file);
+}
+
+QStringList matchesOf(Git::ContentSearch &search, const QString &path, const QList<git_oid> &commits, Git::ContentSearch::Stats *stats)
+{
+    QList<Git::ContentSearch::Place> places;
+    for (const auto &commit : commits)
+        places << Git::ContentSearch::Place{QString{}, commit};
+
+    QStringList result;
+    search.run(path, places, [&result, stats](const QList<Git::ContentSearch::Match> &matches, const Git::ContentSearch::Stats &s) {
+        for (const auto &match : matches)
+            result << QString::fromLatin1(git_oid_tostr_s(&match.commit)) + QLatin1Char(':') + match.path;
+        *stats = s;
+        return true;
+    });
+    result.sort();
+    return result;
+}
+
+QList<git_oid> allCommits(const QString &path)
+{
+    return Git::walkCommits(path, QString{}, 0).oids;
+}
+}
+
+TrigramIndexTest::TrigramIndexTest(QObject *parent)
+    : QObject{parent}
+    , mManager{new Git::Repository{this}}
+{
+}
+
+TrigramIndexTest::~TrigramIndexTest()
+{
+    delete mManager;
+}
+
+void TrigramIndexTest::writeCommit(int number)
+{
+    // A fixed sequence of pseudo random words, so every run builds the same history.
+    auto seed = static_cast<quint32>(number * 7919 + 17);
+    const auto next = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % 5000;
+    };
+
+    for (auto f = 0; f < 3; ++f) {
+        const auto file = (number * 5 + f * 7) % syntheticFiles;
+        QStringList lines;
+        for (auto l = 0; l < linesPerFile; ++l)
+            lines << QStringLiteral("word%1 value%2 item%3").arg(next()).arg(next()).arg(next());
+        if (number == needleCommit && !f)
+            lines << needle;
+        QVERIFY(TestCommon::writeFile(mManager, fileName(file), lines.join(QLatin1Char('\n')) + QLatin1Char('\n')));
+        mManager->addFile(fileName(file));
+    }
+
+    const auto oid = TestCommon::commit(mManager, QStringLiteral("commit %1").arg(number));
+    QVERIFY(!git_oid_is_zero(&oid));
+    mCommits << oid;
+}
+
+void TrigramIndexTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    QVERIFY(mManager->init(path));
+    QVERIFY(mManager->isValid());
+    TestCommon::initSignature(mManager);
+    QVERIFY(TestCommon::makePath(mManager, "src"));
+
+    for (auto i = 0; i < syntheticCommits; ++i)
+        writeCommit(i);
+
+    mIndexPath = TestCommon::getTempPath();
+}
+
+void TrigramIndexTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+    QDir{mIndexPath}.removeRecursively();
+}
+
+void TrigramIndexTest::build()
+{
+    QVERIFY(!Git::TrigramIndex::exists(mIndexPath));
+
+    Git::TrigramIndex index{mIndexPath};
+    QVERIFY(!index.load());
+
+    Git::TrigramIndex::UpdateStats stats;
+    QVERIFY(index.update(mManager->path(), Git::TrigramIndex::defaultMemoryBudget, nullptr, &stats));
+    QVERIFY(Git::TrigramIndex::exists(mIndexPath));
+
+    QCOMPARE(stats.commits, qint64{syntheticCommits});
+    // Three new files in each commit.
+    QCOMPARE(stats.blobs, qint64{3 * syntheticCommits});
+    QCOMPARE(stats.segments, 1);
+    QCOMPARE(index.blobCount(), qsizetype(stats.blobs));
+
+    Git::TrigramIndex loaded{mIndexPath};
+    QVERIFY(loaded.load());
+    QCOMPARE(loaded.blobCount(), qsizetype(stats.blobs));
+
+    // Nothing new.
+    QVERIFY(loaded.update(mManager->path(), Git::TrigramIndex::defaultMemoryBudget, nullptr, &stats));
+    QCOMPARE(stats.commits, qint64{0});
+    QCOMPARE(loaded.segmentCount(), 1);
+}
+
+void TrigramIndexTest::candidates()
+{
+    Git::TrigramIndex index{mIndexPath};
+    QVERIFY(index.load());
+
+    QSet<git_oid> candidates;
+    QVERIFY(!index.candidates(QStringLiteral("ab"), true, &candidates));
+    QVERIFY(!index.candidates(QStringLiteral("äöü"), false, &candidates));
+
+    QVERIFY(index.candidates(needle, true, &candidates));
+    QCOMPARE(candidates.size(), qsizetype{1});
+    const auto blob = *candidates.cbegin();
+    QVERIFY(index.covers(blob));
+
+    const auto origin = index.origin(blob);
+    QVERIFY(git_oid_equal(&origin.commit, &mCommits.at(needleCommit)));
+    QCOMPARE(origin.path, fileName((needleCommit * 5) % syntheticFiles));
+
+    // Letters in any case.
+    QVERIFY(index.candidates(needle.toLower(), false, &candidates));
+    QCOMPARE(candidates.size(), qsizetype{1});
+
+    QVERIFY(index.candidates(QStringLiteral("no such text anywhere"), true, &candidates));
+    QVERIFY(candidates.isEmpty());
+
+    // Every blob has these.
+    QVERIFY(index.candidates(QStringLiteral("value"), true, &candidates));
+    QCOMPARE(candidates.size(), index.blobCount());
+
+    git_oid zero{};
+    QVERIFY(!index.covers(zero));
+    QVERIFY(git_oid_is_zero(&index.origin(zero).commit));
+}
+
+void TrigramIndexTest::incremental()
+{
+    writeCommit(syntheticCommits);
+    writeCommit(syntheticCommits + 1);
+
+    Git::TrigramIndex index{mIndexPath};
+    QVERIFY(index.load());
+    const auto before = index.blobCount();
+
+    Git::TrigramIndex::UpdateStats stats;
+    QVERIFY(index.update(mManager->path(), Git::TrigramIndex::defaultMemoryBudget, nullptr, &stats));
+    QCOMPARE(stats.commits, qint64{2});
+    QCOMPARE(stats.blobs, qint64{6});
+    QCOMPARE(index.blobCount(), before + 6);
+    QCOMPARE(index.segmentCount(), 2);
+
+    // A canceled update writes nothing and leaves the index as it was.
+    writeCommit(syntheticCommits + 2);
+    const std::atomic<bool> canceled{true};
+    QVERIFY(!index.update(mManager->path(), Git::TrigramIndex::defaultMemoryBudget, &canceled, &stats));
+    QCOMPARE(index.blobCount(), before + 6);
+    QVERIFY(index.update(mManager->path(), Git::TrigramIndex::defaultMemoryBudget, nullptr, &stats));
+    QCOMPARE(stats.commits, qint64{1});
+}
+
+void TrigramIndexTest::boundedMemory()
+{
+    const auto path = TestCommon::getTempPath();
+    Git::TrigramIndex small{path};
+    Git::TrigramIndex::UpdateStats stats;
+    QVERIFY(small.update(mManager->path(), 64 * 1024, nullptr, &stats));
+    QVERIFY(stats.segments > 1);
+    QCOMPARE(small.segmentCount(), stats.segments);
+
+    Git::TrigramIndex index{mIndexPath};
+    QVERIFY(index.load());
+    QCOMPARE(small.blobCount(), index.blobCount());
+
+    QSet<git_oid> expected;
+    QSet<git_oid> actual;
+    QVERIFY(index.candidates(QStringLiteral("word12 value"), true, &expected));
+    QVERIFY(small.candidates(QStringLiteral("word12 value"), true, &actual));
+    QVERIFY(!expected.isEmpty());
+    QCOMPARE(actual, expected);
+
+    QDir{path}.removeRecursively();
+}
+
+void TrigramIndexTest::search()
+{
+    const auto commits = allCommits(mManager->path());
+
+    Git::ContentSearch::Stats scanStats;
+    Git::ContentSearch scan{needle.toLower(), false, false};
+    const auto expected = matchesOf(scan, mManager->path(), commits, &scanStats);
+    QVERIFY(!expected.isEmpty());
+    QCOMPARE(scanStats.ruledOutBlobs, qint64{0});
+
+    auto index = std::make_shared<Git::TrigramIndex>(mIndexPath);
+    QVERIFY(index->load());
+
+    Git::ContentSearch::Stats indexStats;
+    Git::ContentSearch indexed{needle.toLower(), false, false};
+    indexed.setIndex(index);
+    QCOMPARE(matchesOf(indexed, mManager->path(), commits, &indexStats), expected);
+
+    // Only the one blob that has it is read.
+    QCOMPARE(indexStats.blobs, qint64{1});
+    QCOMPARE(indexStats.ruledOutBlobs, scanStats.blobs - 1);
+
+    // Not narrowed down, and still right.
+    Git::ContentSearch expression{QStringLiteral("needle_.n_haystack"), false, true};
+    expression.setIndex(index);
+    QCOMPARE(matchesOf(expression, mManager->path(), commits, &indexStats), expected);
+    QCOMPARE(indexStats.ruledOutBlobs, qint64{0});
+}
+
+void TrigramIndexTest::compaction()
+{
+    Git::TrigramIndex index{mIndexPath};
+    QVERIFY(index.load());
+
+    // A segment for each update, however little it finds.
+    for (auto i = 0; i < Git::TrigramIndex::maxSegments; ++i) {
+        writeCommit(syntheticCommits + 3 + i);
+        QVERIFY(index.update(mManager->path()));
+        QVERIFY(index.segmentCount() <= Git::TrigramIndex::maxSegments);
+    }
+
+    const auto segmentFiles = QDir{mIndexPath}.entryList({QStringLiteral("*.seg")}, QDir::Files);
+    QCOMPARE(segmentFiles.size(), qsizetype(index.segmentCount()));
+
+    const auto path = TestCommon::getTempPath();
+    Git::TrigramIndex fresh{path};
+    QVERIFY(fresh.update(mManager->path()));
+    QCOMPARE(index.blobCount(), fresh.blobCount());
+
+    QSet<git_oid> expected;
+    QSet<git_oid> actual;
+    QVERIFY(fresh.candidates(QStringLiteral("word12 value"), true, &expected));
+    QVERIFY(index.candidates(QStringLiteral("word12 value"), true, &actual));
+    QCOMPARE(actual, expected);
+    QVERIFY(index.candidates(needle, true, &actual));
+    QCOMPARE(actual.size(), qsizetype{1});
+
+    Git::TrigramIndex loaded{mIndexPath};
+    QVERIFY(loaded.load());
+    QCOMPARE(loaded.segmentCount(), index.segmentCount());
+
+    QDir{path}.removeRecursively();
+}
+
+void TrigramIndexTest::benchmarkBuild()
+{
+    const auto path = TestCommon::getTempPath();
+    QBENCHMARK {
+        QDir{path}.removeRecursively();
+        Git::TrigramIndex index{path};
+        QVERIFY(index.update(mManager->path()));
+    }
+    QDir{path}.removeRecursively();
+}
+
+void TrigramIndexTest::benchmarkSearch_data()
+{
+    QTest::addColumn<bool>("useIndex");
+    QTest::newRow("scan") << false;
+    QTest::newRow("index") << true;
+}
+
+void TrigramIndexTest::benchmarkSearch()
+{
+    QFETCH(bool, useIndex);
+
+    const auto commits = allCommits(mManager->path());
+    auto index = std::make_shared<Git::TrigramIndex>(mIndexPath);
+    QVERIFY(index->load());
+
+    QBENCHMARK {
+        Git::ContentSearch search{needle, true, false};
+        if (useIndex)
+            search.setIndex(index);
+        Git::ContentSearch::Stats stats;
+        const auto matches = matchesOf(search, mManager->path(), commits, &stats);
+        QVERIFY(!matches.isEmpty());
+    }
+}
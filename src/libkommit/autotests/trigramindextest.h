@@ -0,0 +1,48 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include <git2/oid.h>
+
+namespace Git
+{
+class Repository;
+};
+
+class TrigramIndexTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TrigramIndexTest(QObject *parent = nullptr);
+    ~TrigramIndexTest() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void build();
+    void candidates();
+    void incremental();
+    void boundedMemory();
+    void search();
+    void compaction();
+    void benchmarkBuild();
+    void benchmarkSearch_data();
+    void benchmarkSearch();
+
+private:
+    void writeCommit(int number);
+
+    Git::Repository *mManager;
+    QString mIndexPath;
+    // Oldest first.
+    QList<git_oid> mCommits;
+};
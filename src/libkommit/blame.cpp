@@ -8,6 +8,13 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "blamehunk.h"
 
+#include <algorithm>
+
+#include <QCache>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+
 namespace Git
 {
 
@@ -19,7 +26,12 @@ public:
 
     QList<BlameHunk> hunks;
     QStringList content;
+    // The handle a part was blamed on; git_blame_free() lets go of objects of it, so it is
+    // destroyed after the blame.
+    std::shared_ptr<git_repository> owner;
     git_blame *blame{nullptr};
+    // The parts appended, which own the hunks.
+    QList<Blame> parts;
     Repository *git{nullptr};
 };
 BlamePrivate::BlamePrivate(git_blame *blame)
@@ -32,6 +44,195 @@ BlamePrivate::~BlamePrivate()
     git_blame_free(blame);
 }
 
+namespace
+{
+
+// Files whose blame is kept.
+constexpr int cachedBlames{32};
+
+// The lines of the first part blameFile() hands out.
+constexpr int firstPartLines{128};
+
+struct CachedBlame {
+    git_oid head;
+    git_oid blob;
+    // The committed file blamed in parts, as handed out.
+    QList<Blame> parts;
+    // The committed file blamed at once, which git_blame_buffer() starts from.
+    Blame reference;
+};
+
+QMutex cacheMutex;
+QCache<QString, CachedBlame> cache{cachedBlames};
+
+// The handle every blame of one repository is made on, and so the one the kept blames of it
+// hold. A handle is not to be used on two threads at once: blaming holds its mutex.
+struct SharedRepository {
+    git_repository *repo{nullptr};
+    QMutex mutex;
+
+    ~SharedRepository()
+    {
+        git_repository_free(repo);
+    }
+};
+
+QMutex repositoriesMutex;
+// Weak, so a handle goes with the last blame made on it.
+QHash<QString, std::weak_ptr<SharedRepository>> repositories;
+
+std::shared_ptr<SharedRepository> sharedRepository(const QString &path)
+{
+    QMutexLocker locker{&repositoriesMutex};
+    if (auto shared = repositories.value(path).lock())
+        return shared;
+
+    git_repository *repo{nullptr};
+    if (git_repository_open_ext(&repo, path.toUtf8().constData(), 0, nullptr))
+        return {};
+
+    auto shared = std::make_shared<SharedRepository>();
+    shared->repo = repo;
+    repositories.removeIf([](const auto &it) {
+        return it.value().expired();
+    });
+    repositories.insert(path, shared);
+    return shared;
+}
+
+// By the path the repository is opened with, as the handles are.
+QString cacheKey(const QString &path, const QString &filePath, const git_blame_options &options)
+{
+    const auto oid = [](const git_oid &id) {
+        return QString::fromLatin1(QByteArray::fromRawData(reinterpret_cast<const char *>(id.id), GIT_OID_SHA1_SIZE).toHex());
+    };
+    return path + QLatin1Char('\n') + filePath + QLatin1Char('\n')
+        + QStringLiteral("%1 %2 %3 %4 ").arg(options.flags).arg(options.min_match_characters).arg(options.min_line).arg(options.max_line)
+        + oid(options.oldest_commit);
+}
+
+// The lines of @p blob, counted the way git_blame_file() does.
+int lineCount(git_repository *repo, const git_oid &blob)
+{
+    git_blob *object{nullptr};
+    if (git_blob_lookup(&object, repo, &blob))
+        return 0;
+
+    const auto data = static_cast<const char *>(git_blob_rawcontent(object));
+    const auto size = static_cast<qsizetype>(git_blob_rawsize(object));
+    auto count = static_cast<int>(std::count(data, data + size, '\n'));
+    if (size && data[size - 1] != '\n')
+        ++count;
+
+    git_blob_free(object);
+    return count;
+}
+
+}
+
+bool blameFile(const QString &path, const QString &filePath, const git_blame_options &options, const BlamePartHandler &handler)
+{
+    const auto shared = sharedRepository(path);
+    if (!shared)
+        return false;
+    QMutexLocker repositoryLocker{&shared->mutex};
+    const auto repo = shared->repo;
+    // Keeps the handle, and the kept blames of the repository with it, for as long as a blame
+    // made on it is.
+    const std::shared_ptr<git_repository> owner{shared, repo};
+
+    const auto file = filePath.toUtf8();
+    const auto workingTree = git_oid_is_zero(&options.newest_commit);
+
+    git_oid head = options.newest_commit;
+    if (workingTree && git_reference_name_to_id(&head, repo, "HEAD"))
+        return false;
+
+    git_oid blob{};
+    {
+        git_commit *commit{nullptr};
+        git_tree *tree{nullptr};
+        git_tree_entry *entry{nullptr};
+        if (!git_commit_lookup(&commit, repo, &head) && !git_commit_tree(&tree, commit) && !git_tree_entry_bypath(&entry, tree, file.constData()))
+            git_oid_cpy(&blob, git_tree_entry_id(entry));
+        git_tree_entry_free(entry);
+        git_tree_free(tree);
+        git_commit_free(commit);
+    }
+    if (git_oid_is_zero(&blob))
+        return false;
+
+    QByteArray buffer;
+    auto edited{false};
+    if (workingTree && git_repository_workdir(repo)) {
+        QFile workingFile{QString::fromUtf8(git_repository_workdir(repo)) + filePath};
+        if (workingFile.open(QIODevice::ReadOnly)) {
+            buffer = workingFile.readAll();
+            git_oid id;
+            edited = !git_odb_hash(&id, buffer.constData(), buffer.size(), GIT_OBJECT_BLOB) && !git_oid_equal(&id, &blob);
+        }
+    }
+
+    const auto key = cacheKey(path, filePath, options);
+    CachedBlame cached{head, blob, {}, {}};
+    {
+        QMutexLocker locker{&cacheMutex};
+        if (auto found = cache.object(key); found && git_oid_equal(&found->head, &head) && git_oid_equal(&found->blob, &blob))
+            cached = *found;
+    }
+
+    if (!edited) {
+        if (!cached.parts.isEmpty()) {
+            for (const auto &part : std::as_const(cached.parts))
+                if (!handler(part))
+                    return false;
+            return true;
+        }
+        if (!cached.reference.isNull())
+            return handler(cached.reference);
+
+        auto opts = options;
+        auto first = options.min_line ? static_cast<int>(options.min_line) : 1;
+        const auto count = lineCount(repo, blob);
+        const auto last = options.max_line ? qMin(static_cast<int>(options.max_line), count) : count;
+        for (auto size = firstPartLines; first <= last; size *= 4) {
+            opts.min_line = first;
+            opts.max_line = qMin(last, first + size - 1);
+
+            git_blame *blame{nullptr};
+            if (git_blame_file(&blame, repo, file.constData(), &opts))
+                return false;
+
+            const Blame part{owner, blame};
+            cached.parts << part;
+            if (!handler(part))
+                return false;
+            first = static_cast<int>(opts.max_line) + 1;
+        }
+
+        QMutexLocker locker{&cacheMutex};
+        cache.insert(key, new CachedBlame{cached});
+        return true;
+    }
+
+    if (cached.reference.isNull()) {
+        auto opts = options;
+        git_blame *blame{nullptr};
+        if (git_blame_file(&blame, repo, file.constData(), &opts))
+            return false;
+        cached.reference = Blame{owner, blame};
+    }
+
+    git_blame *blame{nullptr};
+    if (git_blame_buffer(&blame, cached.reference.d->blame, buffer.constData(), buffer.size()))
+        return false;
+    {
+        QMutexLocker locker{&cacheMutex};
+        cache.insert(key, new CachedBlame{cached});
+    }
+    return handler(Blame{owner, blame});
+}
+
 Blame::Blame()
     : d{new BlamePrivate{nullptr}}
 {
@@ -53,6 +254,40 @@ Blame::Blame(Repository *gitManager, const QStringList &content, git_blame *blam
     }
 }
 
+Blame::Blame(Repository *gitManager, const QStringList &content)
+    : d{new BlamePrivate{nullptr}}
+{
+    d->git = gitManager;
+    d->content = content;
+}
+
+Blame::Blame(std::shared_ptr<git_repository> owner, git_blame *blame)
+    : d{new BlamePrivate{blame}}
+{
+    d->owner = std::move(owner);
+}
+
+void Blame::append(const Blame &part)
+{
+    if (!part.d->blame)
+        return;
+
+    d->parts << part;
+    const auto count = git_blame_get_hunk_count(part.d->blame);
+    d->hunks.reserve(d->hunks.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        BlameHunk hunk{d->git, git_blame_get_hunk_byindex(part.d->blame, i)};
+        if (d->hunks.isEmpty() || d->hunks.constLast().startLine() < hunk.startLine()) {
+            d->hunks << hunk;
+            continue;
+        }
+        const auto at = std::upper_bound(d->hunks.cbegin(), d->hunks.cend(), hunk.startLine(), [](size_t line, const BlameHunk &other) {
+            return line < other.startLine();
+        });
+        d->hunks.insert(at, hunk);
+    }
+}
+
 Blame &Blame::operator=(const Blame &other)
 {
     if (this != &other)
@@ -63,7 +298,7 @@ Blame &Blame::operator=(const Blame &other)
 
 bool Blame::operator==(const Blame &other) const
 {
-    return d->blame == other.d->blame;
+    return d == other.d;
 }
 
 bool Blame::operator!=(const Blame &other) const
@@ -73,7 +308,7 @@ bool Blame::operator!=(const Blame &other) const
 
 bool Blame::isNull() const
 {
-    return !d->blame;
+    return !d->blame && !d->git;
 }
 
 git_blame *Blame::data() const
@@ -113,16 +348,19 @@ const BlameHunk &Blame::at(int index) const
 
 BlameHunk Blame::hunkByLineNumber(int lineNumber) const
 {
-    auto hunk = git_blame_get_hunk_byline(d->blame, lineNumber);
-
-    auto it = std::find_if(d->hunks.begin(), d->hunks.end(), [&hunk](const BlameHunk &row) {
-        return row.constData() == hunk;
+    // The hunks are in line order and do not overlap: the one is the last to start at or
+    // before the line, if it reaches it.
+    auto it = std::upper_bound(d->hunks.cbegin(), d->hunks.cend(), lineNumber, [](int line, const BlameHunk &hunk) {
+        return line < static_cast<int>(hunk.startLine());
     });
 
-    if (it != d->hunks.end())
-        return *it;
+    if (it != d->hunks.cbegin()) {
+        --it;
+        if (lineNumber < static_cast<int>(it->startLine() + it->linesCount()))
+            return *it;
+    }
 
-    return BlameHunk{d->git, hunk};
+    return BlameHunk{d->git, nullptr};
 }
 
 QList<BlameHunk>::const_iterator Blame::begin() const
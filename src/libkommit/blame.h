@@ -11,6 +11,9 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <QList>
 #include <QSharedPointer>
 
+#include <functional>
+#include <memory>
+
 #include <Kommit/BlameHunk>
 
 #include "libkommit_export.h"
@@ -19,18 +22,50 @@ namespace Git
 {
 
 class Repository;
+class Blame;
 class BlamePrivate;
+
+/// Receives one part of a blame. Returning false stops the blame there.
+using BlamePartHandler = std::function<bool(const Blame &part)>;
+
+/**
+ * Blames @p filePath of the repository at @p path, handing the result to @p handler in
+ * parts, in line order, as each is done: the first lines of the file first, then ranges
+ * four times larger than the one before, so what a view shows first is not kept waiting
+ * for the rest. It returns true when the whole file was blamed and false when it could not
+ * be or the handler stopped it. The parts are appended to a Blame of a Repository with
+ * Blame::append(), which looks their commits up.
+ *
+ * Without a newest commit in @p options, the file is the one in the working tree, and when
+ * it differs from the one at HEAD, the blame of the committed file is carried over to it with
+ * git_blame_buffer(), in one part, its changed lines having no commit.
+ *
+ * This is safe to call on a worker thread: the blames of a repository are made one at a
+ * time, on one handle of its own that is kept as long as a blame made on it is, so
+ * @p handler should not wait on another blame of the same repository. Blames are kept, by
+ * repository, path, options, HEAD and the id of the committed file: blaming an unchanged
+ * file again hands the parts back without blaming, and an edited one only has its edits to
+ * carry the kept blame over.
+ */
+LIBKOMMIT_EXPORT bool blameFile(const QString &path, const QString &filePath, const git_blame_options &options, const BlamePartHandler &handler);
+
 class LIBKOMMIT_EXPORT Blame
 {
 public:
     Blame();
     Blame(Repository *gitManager, const QStringList &content, git_blame *blame);
+    /// A blame of @p content with nothing blamed yet, for appending parts to.
+    Blame(Repository *gitManager, const QStringList &content);
     Blame(const Blame &other) = default;
     Blame &operator=(const Blame &other);
     bool operator==(const Blame &other) const;
     bool operator!=(const Blame &other) const;
     [[nodiscard]] bool isNull() const;
 
+    /// Adds the hunks of @p part, made by blameFile(), keeping them in line order.
+    void append(const Blame &part);
+
+    /// The git_blame, or null for a blame made of parts.
     [[nodiscard]] git_blame *data() const;
     [[nodiscard]] const git_blame *constData() const;
 
@@ -47,7 +82,11 @@ public:
     [[nodiscard]] qsizetype size() const;
 
 private:
+    Blame(std::shared_ptr<git_repository> owner, git_blame *blame);
+
     QSharedPointer<BlamePrivate> d;
+
+    friend bool blameFile(const QString &path, const QString &filePath, const git_blame_options &options, const BlamePartHandler &handler);
 };
 
 }
@@ -8,6 +8,12 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <repository.h>
 
+#include <git2/commit.h>
+#include <git2/refs.h>
+#include <git2/remote.h>
+#include <git2/submodule.h>
+#include <git2/tag.h>
+
 namespace Git
 {
 namespace Impl
@@ -19,4 +25,72 @@ git_repository *getRepo(Repository *manager)
 }
 
 }
+
+git_oid CacheKey<git_commit>::of(git_commit *ptr)
+{
+    return *git_commit_id(ptr);
+}
+
+void CacheKey<git_commit>::release(git_commit *ptr)
+{
+    git_commit_free(ptr);
+}
+
+git_oid CacheKey<git_tag>::of(git_tag *ptr)
+{
+    return *git_tag_id(ptr);
+}
+
+void CacheKey<git_tag>::release(git_tag *ptr)
+{
+    git_tag_free(ptr);
+}
+
+QString CacheKey<git_reference>::of(git_reference *ptr)
+{
+    return QString::fromUtf8(git_reference_name(ptr));
+}
+
+bool CacheKey<git_reference>::isCurrent(git_reference *cached, git_reference *ptr)
+{
+    if (git_reference_type(cached) != git_reference_type(ptr))
+        return false;
+    if (git_reference_type(ptr) == GIT_REFERENCE_SYMBOLIC)
+        return !qstrcmp(git_reference_symbolic_target(cached), git_reference_symbolic_target(ptr));
+    return git_oid_equal(git_reference_target(cached), git_reference_target(ptr));
+}
+
+void CacheKey<git_reference>::release(git_reference *ptr)
+{
+    git_reference_free(ptr);
+}
+
+QString CacheKey<git_remote>::of(git_remote *ptr)
+{
+    // An anonymous remote has no name, only the url it was made for.
+    if (auto name = git_remote_name(ptr))
+        return QString::fromUtf8(name);
+    return QString::fromUtf8(git_remote_url(ptr));
+}
+
+bool CacheKey<git_remote>::isCurrent(git_remote *cached, git_remote *ptr)
+{
+    return !qstrcmp(git_remote_url(cached), git_remote_url(ptr)) && !qstrcmp(git_remote_pushurl(cached), git_remote_pushurl(ptr));
+}
+
+void CacheKey<git_remote>::release(git_remote *ptr)
+{
+    git_remote_free(ptr);
+}
+
+QString CacheKey<git_submodule>::of(git_submodule *ptr)
+{
+    return QString::fromUtf8(git_submodule_name(ptr));
+}
+
+void CacheKey<git_submodule>::release(git_submodule *ptr)
+{
+    git_submodule_free(ptr);
+}
+
 }
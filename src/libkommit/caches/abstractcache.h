@@ -13,8 +13,13 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <git2/types.h>
 
+#include <Kommit/Oid>
+
 #include "libkommit_export.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace Git
 {
 
@@ -25,31 +30,198 @@ namespace Impl
 git_repository *getRepo(Repository *manager);
 }
 
+/// How a cache has been doing since it was created or its statistics were last reset.
+struct CacheStatistics {
+    qint64 hits{0};
+    qint64 misses{0};
+    qint64 evictions{0};
+};
+
+/**
+ * What a cache keys the objects of @p PtrType by, whether an object it holds is still what
+ * a pointer just read from the repository for the same key says, and how it lets go of
+ * such a pointer when it is.
+ *
+ * libgit2 hands out a new pointer, or a new reference to a shared one, on every lookup, so
+ * keying by the pointer keeps one entry per lookup. The specialisations below key by what
+ * names the object in the repository instead: its oid, or its name for references, remotes
+ * and submodules. Anything else is keyed by the pointer.
+ */
+template<class PtrType>
+struct CacheKey {
+    using Type = PtrType *;
+
+    static Type of(PtrType *ptr)
+    {
+        return ptr;
+    }
+
+    static bool isCurrent(PtrType *cached, PtrType *ptr)
+    {
+        Q_UNUSED(cached)
+        Q_UNUSED(ptr)
+        return true;
+    }
+
+    static void release(PtrType *ptr)
+    {
+        Q_UNUSED(ptr)
+    }
+};
+
+template<>
+struct LIBKOMMIT_EXPORT CacheKey<git_commit> {
+    using Type = git_oid;
+    static Type of(git_commit *ptr);
+    static bool isCurrent(git_commit *cached, git_commit *ptr)
+    {
+        Q_UNUSED(cached)
+        Q_UNUSED(ptr)
+        return true;
+    }
+    static void release(git_commit *ptr);
+};
+
+template<>
+struct LIBKOMMIT_EXPORT CacheKey<git_tag> {
+    using Type = git_oid;
+    static Type of(git_tag *ptr);
+    static bool isCurrent(git_tag *cached, git_tag *ptr)
+    {
+        Q_UNUSED(cached)
+        Q_UNUSED(ptr)
+        return true;
+    }
+    static void release(git_tag *ptr);
+};
+
+template<>
+struct LIBKOMMIT_EXPORT CacheKey<git_reference> {
+    using Type = QString;
+    static Type of(git_reference *ptr);
+    static bool isCurrent(git_reference *cached, git_reference *ptr);
+    static void release(git_reference *ptr);
+};
+
+template<>
+struct LIBKOMMIT_EXPORT CacheKey<git_remote> {
+    using Type = QString;
+    static Type of(git_remote *ptr);
+    static bool isCurrent(git_remote *cached, git_remote *ptr);
+    static void release(git_remote *ptr);
+};
+
+template<>
+struct LIBKOMMIT_EXPORT CacheKey<git_submodule> {
+    using Type = QString;
+    static Type of(git_submodule *ptr);
+    static bool isCurrent(git_submodule *cached, git_submodule *ptr)
+    {
+        Q_UNUSED(cached)
+        Q_UNUSED(ptr)
+        return true;
+    }
+    static void release(git_submodule *ptr);
+};
+
+/**
+ * Holds one object for every key it has been asked for. The objects live in a slot array
+ * that freed slots are taken from again, so adding and removing one is a hash lookup and
+ * no more; the slots that hold an object which is not pinned are also linked up in the
+ * order they were last used in, for eviction.
+ */
 template<class ObjectType, class PtrType>
 class Cache
 {
 public:
     using DataType = ObjectType;
     using ListType = QList<ObjectType>;
+    using KeyType = typename CacheKey<PtrType>::Type;
 
     explicit Cache(Repository *git);
     virtual ~Cache();
 
+    /**
+     * The object for @p ptr, made when the cache does not have one for its key yet, or has
+     * one that is out of date, such as a branch that has since moved. This takes over the
+     * caller's reference to @p ptr: the new object keeps it, or it is released when the
+     * cache already had an object for the key.
+     */
     virtual DataType findByPtr(PtrType *ptr, bool *isNew = nullptr);
 
     bool insert(PtrType *ptr, const ObjectType &obj);
 
     int size() const;
-    const DataType &at(int index) const;
     void clear();
 
+    /**
+     * How many entries that are not pinned the cache keeps, or 0, the default, for no
+     * limit. Past it, the ones used least recently are dropped. That only drops the
+     * cache's own reference: whoever else holds the object keeps it, but looking it up
+     * again makes a new one.
+     */
+    [[nodiscard]] int capacity() const;
+    void setCapacity(int capacity);
+
+    /**
+     * Keeps the entry of @p ptr from being evicted until unpin() has been called as many
+     * times, for objects a model holds on to and expects to be given again when they are
+     * looked up.
+     */
+    void pin(PtrType *ptr);
+    void unpin(PtrType *ptr);
+
+    [[nodiscard]] const CacheStatistics &statistics() const;
+    void resetStatistics();
+
 protected:
     virtual void clearChildData() = 0;
+    /// Makes the object for @p ptr, which the cache does not hold yet.
+    virtual DataType create(PtrType *ptr);
     bool removeFromList(PtrType *ptr);
 
+    /// The object cached for @p key, counted as a use of it, or nullptr.
+    const DataType *lookUp(const KeyType &key);
+
+    /// Calls @p func with every object in the cache, in no particular order.
+    template<class Func>
+    void forEachCached(Func func) const;
+
+    /// One of the objects in the cache that @p predicate accepts, or a null object.
+    template<class Predicate>
+    DataType findCached(Predicate predicate) const;
+
     Repository *manager;
-    ListType mList;
-    QHash<PtrType *, DataType> mHash;
+
+private:
+    struct Slot {
+        DataType object;
+        PtrType *ptr{nullptr};
+        KeyType key{};
+        int pins{0};
+        bool used{false};
+        // The neighbours in the recency list while the slot holds an object that is not
+        // pinned; the next free slot while it is free.
+        int previous{-1};
+        int next{-1};
+    };
+
+    void store(const KeyType &key, PtrType *ptr, const ObjectType &obj);
+    void touch(int slot);
+    void freeSlot(int slot);
+    void link(int slot);
+    void unlink(int slot);
+    void evictIfNeeded();
+
+    std::vector<Slot> mSlots;
+    QHash<KeyType, int> mSlotByKey;
+    int mFreeSlot{-1};
+    // The ends of the recency list, least recently used first.
+    int mLeastRecent{-1};
+    int mMostRecent{-1};
+    int mCapacity{0};
+    int mPinnedCount{0};
+    CacheStatistics mStatistics;
 };
 
 template<class ObjectType, class PtrType>
@@ -83,6 +255,14 @@ Q_OUTOFLINE_TEMPLATE OidCache<ObjectType, PtrType>::OidCache(Repository *git, Gi
 template<class ObjectType, class PtrType>
 Q_OUTOFLINE_TEMPLATE ObjectType OidCache<ObjectType, PtrType>::findByOid(const git_oid *oid, bool *isNew)
 {
+    // Look in the cache before asking libgit2, which hands out one more reference to the
+    // object on every lookup.
+    if (auto object = Cache<ObjectType, PtrType>::lookUp(*oid)) {
+        if (isNew)
+            *isNew = false;
+        return *object;
+    }
+
     PtrType *ptr;
     auto r = gitLookupFunc(&ptr, Impl::getRepo(Cache<ObjectType, PtrType>::manager), oid);
     if (!r)
@@ -107,15 +287,33 @@ Q_OUTOFLINE_TEMPLATE Cache<ObjectType, PtrType>::~Cache()
 template<class ObjectType, class PtrType>
 Q_OUTOFLINE_TEMPLATE ObjectType Cache<ObjectType, PtrType>::findByPtr(PtrType *ptr, bool *isNew)
 {
-    if (mHash.contains(ptr)) {
+    const auto key = CacheKey<PtrType>::of(ptr);
+
+    const auto i = mSlotByKey.constFind(key);
+    if (i != mSlotByKey.cend()) {
+        auto &slot = mSlots[*i];
+        touch(*i);
+
+        if (CacheKey<PtrType>::isCurrent(slot.ptr, ptr)) {
+            ++mStatistics.hits;
+            CacheKey<PtrType>::release(ptr);
+            if (isNew)
+                *isNew = false;
+            return slot.object;
+        }
+
+        // Whoever holds the old object keeps it; the cache moves on to the new one.
+        ++mStatistics.misses;
+        slot.object = create(ptr);
+        slot.ptr = ptr;
         if (isNew)
-            *isNew = false;
-        return mHash.value(ptr);
+            *isNew = true;
+        return slot.object;
     }
 
-    ObjectType entity{ptr};
-    mList << entity;
-    mHash.insert(ptr, entity);
+    ++mStatistics.misses;
+    auto entity = create(ptr);
+    store(key, ptr, entity);
 
     if (isNew)
         *isNew = true;
@@ -125,43 +323,220 @@ Q_OUTOFLINE_TEMPLATE ObjectType Cache<ObjectType, PtrType>::findByPtr(PtrType *p
 template<class ObjectType, class PtrType>
 Q_OUTOFLINE_TEMPLATE bool Cache<ObjectType, PtrType>::insert(PtrType *ptr, const ObjectType &obj)
 {
-    if (mHash.contains(ptr))
+    const auto key = CacheKey<PtrType>::of(ptr);
+    if (mSlotByKey.contains(key))
         return false;
 
-    mHash.insert(ptr, obj);
-    mList << obj;
-
+    store(key, ptr, obj);
     return true;
 }
 
 template<class ObjectType, class PtrType>
-Q_OUTOFLINE_TEMPLATE int Cache<ObjectType, PtrType>::size() const
+Q_OUTOFLINE_TEMPLATE ObjectType Cache<ObjectType, PtrType>::create(PtrType *ptr)
+{
+    return ObjectType{ptr};
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE const ObjectType *Cache<ObjectType, PtrType>::lookUp(const KeyType &key)
+{
+    const auto i = mSlotByKey.constFind(key);
+    if (i == mSlotByKey.cend())
+        return nullptr;
+
+    ++mStatistics.hits;
+    touch(*i);
+    return &mSlots[*i].object;
+}
+
+template<class ObjectType, class PtrType>
+template<class Func>
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::forEachCached(Func func) const
+{
+    for (const auto &slot : mSlots)
+        if (slot.used)
+            func(slot.object);
+}
+
+template<class ObjectType, class PtrType>
+template<class Predicate>
+Q_OUTOFLINE_TEMPLATE ObjectType Cache<ObjectType, PtrType>::findCached(Predicate predicate) const
+{
+    for (const auto &slot : mSlots)
+        if (slot.used && predicate(slot.object))
+            return slot.object;
+    return ObjectType{};
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::store(const KeyType &key, PtrType *ptr, const ObjectType &obj)
 {
-    return mList.size();
+    int index;
+    if (mFreeSlot != -1) {
+        index = mFreeSlot;
+        mFreeSlot = mSlots[index].next;
+    } else {
+        index = int(mSlots.size());
+        mSlots.emplace_back();
+    }
+
+    auto &slot = mSlots[index];
+    slot.object = obj;
+    slot.ptr = ptr;
+    slot.key = key;
+    slot.pins = 0;
+    slot.used = true;
+    link(index);
+    mSlotByKey.insert(key, index);
+
+    evictIfNeeded();
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::touch(int index)
+{
+    if (!mSlots[index].pins) {
+        unlink(index);
+        link(index);
+    }
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::freeSlot(int index)
+{
+    auto &slot = mSlots[index];
+    if (slot.pins)
+        --mPinnedCount;
+    else
+        unlink(index);
+
+    mSlotByKey.remove(slot.key);
+    slot.object = ObjectType{};
+    slot.ptr = nullptr;
+    slot.key = KeyType{};
+    slot.used = false;
+    slot.previous = -1;
+    slot.next = mFreeSlot;
+    mFreeSlot = index;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::link(int index)
+{
+    auto &slot = mSlots[index];
+    slot.previous = mMostRecent;
+    slot.next = -1;
+    if (mMostRecent != -1)
+        mSlots[mMostRecent].next = index;
+    else
+        mLeastRecent = index;
+    mMostRecent = index;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::unlink(int index)
+{
+    auto &slot = mSlots[index];
+    if (slot.previous != -1)
+        mSlots[slot.previous].next = slot.next;
+    else
+        mLeastRecent = slot.next;
+    if (slot.next != -1)
+        mSlots[slot.next].previous = slot.previous;
+    else
+        mMostRecent = slot.previous;
+    slot.previous = slot.next = -1;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::evictIfNeeded()
+{
+    if (!mCapacity)
+        return;
+
+    while (mSlotByKey.size() - mPinnedCount > mCapacity) {
+        freeSlot(mLeastRecent);
+        ++mStatistics.evictions;
+    }
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE int Cache<ObjectType, PtrType>::capacity() const
+{
+    return mCapacity;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::setCapacity(int capacity)
+{
+    mCapacity = std::max(capacity, 0);
+    evictIfNeeded();
 }
 
 template<class ObjectType, class PtrType>
-Q_OUTOFLINE_TEMPLATE const ObjectType &Cache<ObjectType, PtrType>::at(int index) const
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::pin(PtrType *ptr)
+{
+    const auto i = mSlotByKey.constFind(CacheKey<PtrType>::of(ptr));
+    if (i == mSlotByKey.cend())
+        return;
+
+    if (!mSlots[*i].pins++) {
+        unlink(*i);
+        ++mPinnedCount;
+    }
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::unpin(PtrType *ptr)
+{
+    const auto i = mSlotByKey.constFind(CacheKey<PtrType>::of(ptr));
+    if (i == mSlotByKey.cend() || !mSlots[*i].pins)
+        return;
+
+    // Evicting is left to the next insertion, so a model letting go of all its rows just
+    // before it looks them up again does not drop them in between.
+    if (!--mSlots[*i].pins) {
+        --mPinnedCount;
+        link(*i);
+    }
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE const CacheStatistics &Cache<ObjectType, PtrType>::statistics() const
+{
+    return mStatistics;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::resetStatistics()
+{
+    mStatistics = {};
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE int Cache<ObjectType, PtrType>::size() const
 {
-    return std::move(mList.at(index));
+    return mSlotByKey.size();
 }
 
 template<class ObjectType, class PtrType>
 Q_OUTOFLINE_TEMPLATE void Cache<ObjectType, PtrType>::clear()
 {
-    mList.clear();
-    mHash.clear();
+    mSlots.clear();
+    mSlotByKey.clear();
+    mFreeSlot = mLeastRecent = mMostRecent = -1;
+    mPinnedCount = 0;
     clearChildData();
 }
 
 template<class ObjectType, class PtrType>
 Q_OUTOFLINE_TEMPLATE bool Cache<ObjectType, PtrType>::removeFromList(PtrType *ptr)
 {
-    if (!mHash.contains(ptr))
+    const auto i = mSlotByKey.constFind(CacheKey<PtrType>::of(ptr));
+    if (i == mSlotByKey.cend())
         return false;
 
-    mList.removeOne(mHash.value(ptr));
-    mHash.remove(ptr);
+    freeSlot(*i);
     return true;
 }
 };
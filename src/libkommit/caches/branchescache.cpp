@@ -23,13 +23,8 @@ public:
     Q_DECLARE_PUBLIC(BranchesCache)
 
     Repository *manager;
-    BranchesCache::ListType list;
-    QMap<QString, BranchesCache::DataType> dataByName;
-    QHash<git_reference *, BranchesCache::DataType> dataByRef;
 
     BranchesCachePrivate(BranchesCache *parent, Repository *manager);
-    void add(BranchesCache::DataType newItem);
-    bool remove(BranchesCache::DataType branch);
 };
 
 BranchesCache::BranchesCache(Repository *manager)
@@ -47,17 +42,11 @@ BranchesCache::DataType BranchesCache::findByName(const QString &key)
 {
     Q_D(BranchesCache);
 
-    if (d->dataByName.contains(key))
-        return d->dataByName.value(key);
-
     git_reference *ref;
     BEGIN
     STEP git_branch_lookup(&ref, d->manager->repoPtr(), key.toLocal8Bit().constData(), GIT_BRANCH_ALL);
-    if (IS_OK) {
-        Branch b{ref};
-        d->add(b);
-        return b;
-    }
+    if (IS_OK)
+        return findByPtr(ref);
     return Branch{};
 }
 
@@ -90,8 +79,6 @@ bool BranchesCache::create(const QString &name)
 
 bool BranchesCache::remove(DataType branch)
 {
-    Q_D(BranchesCache);
-
     BEGIN
     STEP git_branch_delete(branch.refPtr());
 
@@ -100,11 +87,8 @@ bool BranchesCache::remove(DataType branch)
         return false;
     }
 
-    // The branch is gone from the repository whether or not this held a copy of it: the ones
-    // read from it are kept by reference, the ones made here by name, and a branch removed
-    // through neither of those was still removed.
+    // The branch is gone from the repository whether or not this held a copy of it.
     removeFromList(branch.refPtr());
-    d->remove(branch);
 
     Q_EMIT removed(branch);
 
@@ -192,11 +176,6 @@ QString BranchesCache::currentName()
 
 void BranchesCache::clearChildData()
 {
-    Q_D(BranchesCache);
-    d->dataByName.clear();
-    d->dataByRef.clear();
-    d->list.clear();
-
     Q_EMIT reseted();
 }
 
@@ -206,27 +185,6 @@ BranchesCachePrivate::BranchesCachePrivate(BranchesCache *parent, Repository *ma
 {
 }
 
-void BranchesCachePrivate::add(BranchesCache::DataType newItem)
-{
-    if (dataByName.contains(newItem.name()))
-        return;
-
-    list.append(newItem);
-    dataByName.insert(newItem.name(), newItem);
-    dataByRef.insert(newItem.refPtr(), newItem);
-}
-
-bool BranchesCachePrivate::remove(BranchesCache::DataType branch)
-{
-    if (!list.contains(branch))
-        return false;
-
-    list.removeOne(branch);
-    dataByName.remove(branch.name());
-    dataByRef.remove(branch.refPtr());
-    return true;
-}
-
 }
 
 #include "moc_branchescache.cpp"
@@ -17,9 +17,17 @@ SPDX-License-Identifier: GPL-3.0-or-later
 namespace Git
 {
 
+namespace
+{
+// Commits that are looked up and let go again, by the dialogs and views around the history.
+// The ones a model holds on to are pinned and do not count against it.
+constexpr int defaultCapacity{50000};
+}
+
 CommitsCache::CommitsCache(Repository *parent)
     : Git::OidCache<Commit, git_commit>{parent, git_commit_lookup}
 {
+    setCapacity(defaultCapacity);
 }
 
 Commit CommitsCache::find(const QString &hash)
@@ -84,17 +92,34 @@ QList<Commit> CommitsCache::commitsFromOids(const QList<git_oid> &oids)
     QList<Commit> list;
     list.reserve(oids.size());
 
-    for (const auto &oid : oids) {
-        auto en = findByOid(&oid);
-        en.clearChildren();
-        list << en;
-    }
+    for (const auto &oid : oids)
+        list << findByOid(&oid);
 
     linkCommits(list);
 
     return list;
 }
 
+Commit CommitsCache::linkedCommit(const git_oid &oid, const QList<git_oid> &children)
+{
+    auto commit = findByOid(&oid);
+    if (commit.isNull())
+        return commit;
+
+    commit.clearChildren();
+    for (const auto &child : children)
+        commit.addChild(child);
+    commit.setReferences(manager->references()->findForCommit(commit));
+    return commit;
+}
+
+void CommitsCache::clearChildren()
+{
+    forEachCached([](Commit commit) {
+        commit.clearChildren();
+    });
+}
+
 void CommitsCache::linkCommits(QList<Commit> &list)
 {
     for (auto &commit : list) {
@@ -111,7 +136,7 @@ void CommitsCache::linkCommits(QList<Commit> &list)
         for (unsigned int i = 0; i < parentCount; ++i) {
             auto parent = findByOid(git_commit_parent_id(commitPtr, i));
             if (!parent.isNull())
-                parent.addChild(commit.commitHash());
+                parent.addChild(*git_commit_id(commitPtr));
         }
         commit.setReferences(manager->references()->findForCommit(commit));
     }
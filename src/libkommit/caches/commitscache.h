@@ -39,9 +39,23 @@ public:
      * The entities and the cache holding them belong to one thread, so this is the half of
      * reading a history that cannot be moved away from the thread that owns the repository.
      * walkCommits() produces the object ids it takes.
+     *
+     * Child links are added to, never cleared, so the pages of one walk resolved one after
+     * the other link up with each other: a commit's children come before it in the walk,
+     * often on an earlier page. Call clearChildren() before resolving a new walk.
      */
     [[nodiscard]] QList<Commit> commitsFromOids(const QList<git_oid> &oids);
 
+    /**
+     * The commit entity for @p oid, its children set to @p children and the references
+     * pointing at it filled in: commitsFromOids() for a single commit, for a model that only
+     * looks the commits of a walk up once they are shown.
+     */
+    [[nodiscard]] Commit linkedCommit(const git_oid &oid, const QList<git_oid> &children);
+
+    /// Forgets the child links of every commit loaded so far.
+    void clearChildren();
+
 protected:
     void clearChildData() override;
 
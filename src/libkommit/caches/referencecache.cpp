@@ -47,60 +47,44 @@ ReferenceCache::DataType ReferenceCache::findByName(const QString &name)
 
 ReferenceCache::DataType ReferenceCache::findForNote(const Note &note)
 {
-    if (!mList.size())
+    if (!size())
         fill();
-    auto i = std::find_if(mList.begin(), mList.end(), [&note](DataType c) {
+    return findCached([&note](const DataType &c) {
         return c.isNote() && c.toNote() == note;
     });
-
-    if (i != mList.end())
-        return *i;
-    return Reference{};
 }
 
 ReferenceCache::DataType ReferenceCache::findForBranch(const Branch &branch)
 {
-    if (!mList.size())
+    if (!size())
         fill();
-    auto i = std::find_if(mList.begin(), mList.end(), [&branch](DataType c) {
+    return findCached([&branch](const DataType &c) {
         return c.isBranch() && c.toBranch() == branch;
     });
-
-    if (i != mList.end())
-        return *i;
-    return Reference{};
 }
 
 ReferenceCache::DataType ReferenceCache::findForTag(const Tag &tag)
 {
-    if (!mList.size())
+    if (!size())
         fill();
-    auto i = std::find_if(mList.begin(), mList.end(), [&tag](DataType c) {
+    return findCached([&tag](const DataType &c) {
         return c.isTag() && c.toTag() == tag;
     });
-
-    if (i != mList.end())
-        return *i;
-    return Reference{};
 }
 
 ReferenceCache::DataType ReferenceCache::findForRemote(const Remote &remote)
 {
-    if (!mList.size())
+    if (!size())
         fill();
-    auto i = std::find_if(mList.begin(), mList.end(), [&remote](DataType c) {
+    return findCached([&remote](const DataType &c) {
         return c.isRemote() && c.toRemote() == remote;
     });
-
-    if (i != mList.end())
-        return *i;
-    return Reference{};
 }
 
 ReferenceCache::ListType ReferenceCache::findForCommit(const Commit &commit)
 {
     Q_D(ReferenceCache);
-    if (!mList.size())
+    if (!size())
         fill();
 
     return d->dataByCommit.values(commit);
@@ -125,7 +109,6 @@ void ReferenceCache::forEach(std::function<void(DataType)> callback) const
 void ReferenceCache::clearChildData()
 {
     Q_D(ReferenceCache);
-    d->list.clear();
     d->dataByCommit.clear();
 }
 
@@ -154,7 +137,6 @@ void ReferenceCachePrivate::fill()
 
     while (!git_reference_next(&reference, iterator)) {
         auto ref = q->findByPtr(reference);
-        list << ref;
         auto hash = ref.target().toString();
         auto commit = q->manager->commits()->find(hash);
         if (Q_LIKELY(!commit.isNull())) // TODO: check if is this possible?
@@ -57,7 +57,6 @@ class ReferenceCachePrivate
 public:
     explicit ReferenceCachePrivate(ReferenceCache *parent);
 
-    QList<Reference> list;
     QMultiMap<Commit, Reference> dataByCommit;
     void fill();
 };
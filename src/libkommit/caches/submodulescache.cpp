@@ -95,21 +95,9 @@ Submodule SubmodulesCache::findByName(const QString &name)
     return findByPtr(submodule);
 }
 
-SubmodulesCache::DataType SubmodulesCache::findByPtr(git_submodule *ptr, bool *isNew)
+SubmodulesCache::DataType SubmodulesCache::create(git_submodule *ptr)
 {
-    if (mHash.contains(ptr)) {
-        if (isNew)
-            *isNew = false;
-        return mHash.value(ptr);
-    }
-
-    Submodule entity{ptr, manager->repoPtr()};
-    mList << entity;
-    mHash.insert(ptr, entity);
-
-    if (isNew)
-        *isNew = true;
-    return entity;
+    return Submodule{ptr, manager->repoPtr()};
 }
 
 void SubmodulesCache::clearChildData()
@@ -27,10 +27,10 @@ public:
 
     [[nodiscard]] QList<Submodule> allSubmodules();
     [[nodiscard]] Submodule findByName(const QString &name);
-    [[nodiscard]] DataType findByPtr(git_submodule *ptr, bool *isNew = nullptr) override;
 
 protected:
     void clearChildData() override;
+    DataType create(git_submodule *ptr) override;
 
 Q_SIGNALS:
     void added(DataType submodule);
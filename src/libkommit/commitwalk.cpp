@@ -7,44 +7,137 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "commitwalk.h"
 
 #include <git2/branch.h>
+#include <git2/graph.h>
 #include <git2/refs.h>
 #include <git2/repository.h>
 #include <git2/revwalk.h>
 
+#include <algorithm>
+
 namespace Git
 {
 
-CommitWalk walkCommits(const QString &path, const QString &branchRefName, int maxCount)
+namespace
 {
-    CommitWalk result;
 
-    if (path.isEmpty())
-        return result;
+bool oidLessThan(const git_oid &oid1, const git_oid &oid2)
+{
+    return git_oid_cmp(&oid1, &oid2) < 0;
+}
 
-    git_repository *repo{nullptr};
-    if (git_repository_open_ext(&repo, path.toUtf8().constData(), 0, nullptr))
-        return result;
+bool oidEqual(const git_oid &oid1, const git_oid &oid2)
+{
+    return git_oid_equal(&oid1, &oid2);
+}
 
-    git_revwalk *walker{nullptr};
-    if (git_revwalk_new(&walker, repo)) {
-        git_repository_free(repo);
-        return result;
-    }
+/// The commits @p branchRefName, or every branch when it is empty, points at.
+QList<git_oid> readTips(git_repository *repo, const QString &branchRefName)
+{
+    QList<git_oid> tips;
+    git_oid oid;
 
     if (branchRefName.isEmpty()) {
-        git_revwalk_sorting(walker, GIT_SORT_TOPOLOGICAL | GIT_SORT_TIME);
-
         git_branch_iterator *iterator{nullptr};
         if (!git_branch_iterator_new(&iterator, repo, GIT_BRANCH_ALL)) {
             git_reference *ref{nullptr};
             git_branch_t type;
-            while (!git_branch_next(&ref, &type, iterator))
-                git_revwalk_push_ref(walker, git_reference_name(ref));
+            while (!git_branch_next(&ref, &type, iterator)) {
+                if (!git_reference_name_to_id(&oid, repo, git_reference_name(ref)))
+                    tips << oid;
+                git_reference_free(ref);
+            }
             git_branch_iterator_free(iterator);
         }
-    } else {
+    } else if (!git_reference_name_to_id(&oid, repo, branchRefName.toUtf8().constData())) {
+        tips << oid;
+    }
+
+    std::sort(tips.begin(), tips.end(), oidLessThan);
+    tips.erase(std::unique(tips.begin(), tips.end(), oidEqual), tips.end());
+    return tips;
+}
+
+/// A walker from @p tips, sorted the way a walk over @p branchRefName is, or null.
+git_revwalk *newWalker(git_repository *repo, const QString &branchRefName, const QList<git_oid> &tips)
+{
+    git_revwalk *walker{nullptr};
+    if (git_revwalk_new(&walker, repo))
+        return nullptr;
+
+    if (branchRefName.isEmpty())
+        git_revwalk_sorting(walker, GIT_SORT_TOPOLOGICAL | GIT_SORT_TIME);
+    else
         git_revwalk_sorting(walker, GIT_SORT_TOPOLOGICAL);
-        git_revwalk_push_ref(walker, branchRefName.toUtf8().constData());
+
+    for (const auto &tip : tips)
+        git_revwalk_push(walker, &tip);
+
+    return walker;
+}
+
+/// Hands what @p walker produces to @p handler, page by page.
+bool walkPages(git_revwalk *walker, int pageSize, const CommitWalkPageHandler &handler)
+{
+    QList<git_oid> page;
+    page.reserve(pageSize);
+
+    git_oid oid;
+    while (!git_revwalk_next(&oid, walker)) {
+        page << oid;
+
+        if (page.size() == pageSize) {
+            if (!handler(page))
+                return false;
+            page.clear();
+        }
+    }
+
+    if (!page.isEmpty())
+        handler(page);
+    return true;
+}
+
+/// Hands @p oids to @p handler, page by page, as if they were walked.
+bool handOver(const QList<git_oid> &oids, int pageSize, const CommitWalkPageHandler &handler)
+{
+    for (qsizetype first = 0; first < oids.size(); first += pageSize)
+        if (!handler(oids.mid(first, pageSize)))
+            return false;
+    return true;
+}
+
+/// Whether every commit of @p base can be reached from @p tips.
+bool reachable(git_repository *repo, const QList<git_oid> &base, const QList<git_oid> &tips)
+{
+    if (tips.isEmpty())
+        return false;
+
+    for (const auto &tip : base) {
+        if (std::binary_search(tips.cbegin(), tips.cend(), tip, oidLessThan))
+            continue;
+        if (git_graph_reachable_from_any(repo, &tip, tips.constData(), tips.size()) != 1)
+            return false;
+    }
+    return true;
+}
+
+}
+
+CommitWalk walkCommits(const QString &path, const QString &branchRefName, int maxCount)
+{
+    CommitWalk result;
+
+    if (path.isEmpty())
+        return result;
+
+    git_repository *repo{nullptr};
+    if (git_repository_open_ext(&repo, path.toUtf8().constData(), 0, nullptr))
+        return result;
+
+    auto walker = newWalker(repo, branchRefName, readTips(repo, branchRefName));
+    if (!walker) {
+        git_repository_free(repo);
+        return result;
     }
 
     git_oid oid;
@@ -65,4 +158,88 @@ CommitWalk walkCommits(const QString &path, const QString &branchRefName, int ma
     return result;
 }
 
+bool walkCommits(const QString &path, const QString &branchRefName, int pageSize, const CommitWalkPageHandler &handler)
+{
+    if (path.isEmpty() || pageSize <= 0 || !handler)
+        return false;
+
+    git_repository *repo{nullptr};
+    if (git_repository_open_ext(&repo, path.toUtf8().constData(), 0, nullptr))
+        return false;
+
+    auto walker = newWalker(repo, branchRefName, readTips(repo, branchRefName));
+    if (!walker) {
+        git_repository_free(repo);
+        return false;
+    }
+
+    const auto completed = walkPages(walker, pageSize, handler);
+
+    git_revwalk_free(walker);
+    git_repository_free(repo);
+
+    return completed;
+}
+
+QList<git_oid> walkTips(const QString &path, const QString &branchRefName)
+{
+    if (path.isEmpty())
+        return {};
+
+    git_repository *repo{nullptr};
+    if (git_repository_open_ext(&repo, path.toUtf8().constData(), 0, nullptr))
+        return {};
+
+    auto tips = readTips(repo, branchRefName);
+    git_repository_free(repo);
+    return tips;
+}
+
+bool walkCommits(const QString &path,
+                 const QString &branchRefName,
+                 int pageSize,
+                 const CommitWalkPageHandler &handler,
+                 const CommitWalkBase &base,
+                 QList<git_oid> *tips)
+{
+    if (path.isEmpty() || pageSize <= 0 || !handler)
+        return false;
+
+    git_repository *repo{nullptr};
+    if (git_repository_open_ext(&repo, path.toUtf8().constData(), 0, nullptr))
+        return false;
+
+    const auto currentTips = readTips(repo, branchRefName);
+    if (tips)
+        *tips = currentTips;
+
+    if (!base.oids.isEmpty() && std::equal(currentTips.cbegin(), currentTips.cend(), base.tips.cbegin(), base.tips.cend(), oidEqual)) {
+        git_repository_free(repo);
+        return handOver(base.oids, pageSize, handler);
+    }
+
+    const auto onTopOfBase = !base.oids.isEmpty() && reachable(repo, base.tips, currentTips);
+
+    auto walker = newWalker(repo, branchRefName, currentTips);
+    if (!walker) {
+        git_repository_free(repo);
+        return false;
+    }
+
+    // Hiding the old tips hides everything they reach, which is all of the base.
+    if (onTopOfBase)
+        for (const auto &tip : base.tips)
+            git_revwalk_hide(walker, &tip);
+
+    auto completed = walkPages(walker, pageSize, handler);
+
+    git_revwalk_free(walker);
+    git_repository_free(repo);
+
+    if (completed && onTopOfBase)
+        completed = handOver(base.oids, pageSize, handler);
+
+    return completed;
+}
+
 }
@@ -11,6 +11,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <QList>
 #include <QString>
 
+#include <functional>
+
 #include <git2/oid.h>
 
 namespace Git
@@ -34,4 +36,52 @@ struct LIBKOMMIT_EXPORT CommitWalk {
  */
 [[nodiscard]] LIBKOMMIT_EXPORT CommitWalk walkCommits(const QString &path, const QString &branchRefName, int maxCount);
 
+/// Receives one page of a paged walk. Returning false stops the walk there.
+using CommitWalkPageHandler = std::function<bool(const QList<git_oid> &page)>;
+
+/**
+ * The same walk as above, over the whole history, handed to @p handler in pages of at most
+ * @p pageSize object ids as the walk produces them, newest first. It returns true when the
+ * walk ran to the end and false when it could not start or the handler stopped it.
+ *
+ * The handler runs on the calling thread. Paging does not make the walk itself any cheaper,
+ * but it lets the caller show the first commits while the rest are still being read, and
+ * give up on a walk nobody wants any more without waiting for it to finish.
+ */
+LIBKOMMIT_EXPORT bool walkCommits(const QString &path, const QString &branchRefName, int pageSize, const CommitWalkPageHandler &handler);
+
+/// A walk done before, for the next one to build on.
+struct LIBKOMMIT_EXPORT CommitWalkBase {
+    /// The commits it started from, as walkTips() gave them.
+    QList<git_oid> tips;
+    /// Every commit it produced, in its order.
+    QList<git_oid> oids;
+};
+
+/**
+ * The commits a walk over @p branchRefName, or over every branch when it is empty, starts
+ * from, sorted and without duplicates. Two walks with the same tips produce the same
+ * history.
+ */
+[[nodiscard]] LIBKOMMIT_EXPORT QList<git_oid> walkTips(const QString &path, const QString &branchRefName);
+
+/**
+ * The paged walk, for a history that was walked before as @p base. When the tips have not
+ * moved, @p base is handed back as it is, without walking anything. When every tip of
+ * @p base can still be reached, only the commits that are new since are walked, and handed
+ * over first, followed by @p base: that is a valid order for a history graph, though a
+ * commit with an old date on a new branch is not sorted in among the old ones by time as a
+ * full walk would do. Otherwise a branch was deleted, reset or rewritten, and the whole
+ * history is walked again.
+ *
+ * @p tips receives the tips this walk starts from before the first page is handed over,
+ * to be the tips of the base of the next walk.
+ */
+LIBKOMMIT_EXPORT bool walkCommits(const QString &path,
+                                  const QString &branchRefName,
+                                  int pageSize,
+                                  const CommitWalkPageHandler &handler,
+                                  const CommitWalkBase &base,
+                                  QList<git_oid> *tips);
+
 }
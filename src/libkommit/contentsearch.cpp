@@ -0,0 +1,376 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "contentsearch.h"
+
+#include "entities/oid.h"
+#include "trigramindex.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QtConcurrentMap>
+
+#include <cstring>
+
+#include <git2/blob.h>
+#include <git2/commit.h>
+#include <git2/repository.h>
+#include <git2/tree.h>
+
+namespace Git
+{
+
+namespace
+{
+
+// The blobs one scanning task takes; a task opens a repository handle of its own.
+constexpr int blobsPerTask{256};
+
+// How often, in milliseconds, and past how many matches, found matches are handed over.
+constexpr qint64 flushInterval{100};
+constexpr int flushMatches{256};
+
+constexpr char fold(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr char otherCase(char c)
+{
+    if (c >= 'a' && c <= 'z')
+        return static_cast<char>(c - 'a' + 'A');
+    return fold(c);
+}
+
+// The first of @p a or @p b in [from, end), or null.
+const char *findByte(const char *from, const char *end, char a, char b)
+{
+    const auto first = static_cast<const char *>(std::memchr(from, a, end - from));
+    if (a == b)
+        return first;
+    const auto second = static_cast<const char *>(std::memchr(from, b, (first ? first : end) - from));
+    return second ? second : first;
+}
+
+// A tree as met at a path; the same tree at another path has other paths matching the filter.
+QByteArray treeKey(const git_oid *id, const QByteArray &prefix)
+{
+    return QByteArray{reinterpret_cast<const char *>(id->id), GIT_OID_SHA1_SIZE} + prefix;
+}
+
+struct Task {
+    QList<git_oid> blobs;
+    QList<git_oid> found;
+    qint64 bytes{0};
+};
+
+class Search
+{
+public:
+    Search(const ContentSearch &search, const QString &path, git_repository *repo, const std::atomic<bool> &canceled)
+        : mSearch{search}
+        , mPath{path}
+        , mRepo{repo}
+        , mCanceled{canceled}
+    {
+    }
+
+    // Only the blobs @p index covers and @p candidates has are to be scanned.
+    void setCandidates(const TrigramIndex *index, QSet<git_oid> candidates)
+    {
+        mIndex = index;
+        mCandidates = std::move(candidates);
+    }
+
+    // Adds the blobs under @p tree not scanned yet to @p blobs.
+    void collect(const git_tree *tree, const QByteArray &prefix, QList<git_oid> &blobs)
+    {
+        const auto key = treeKey(git_tree_id(tree), prefix);
+        if (mWalked.contains(key))
+            return;
+        mWalked.insert(key);
+        ++stats.trees;
+
+        const auto count = git_tree_entrycount(tree);
+        for (size_t i = 0; i < count; ++i) {
+            const auto entry = git_tree_entry_byindex(tree, i);
+            const auto path = prefix + git_tree_entry_name(entry);
+
+            switch (git_tree_entry_type(entry)) {
+            case GIT_OBJECT_BLOB: {
+                const auto id = *git_tree_entry_id(entry);
+                if (mScanned.contains(id)) {
+                    ++stats.reusedBlobs;
+                } else if (mSearch.acceptsPath(QString::fromUtf8(path))) {
+                    mScanned.insert(id, false);
+                    if (mIndex && !mCandidates.contains(id) && mIndex->covers(id))
+                        ++stats.ruledOutBlobs;
+                    else
+                        blobs << id;
+                }
+                break;
+            }
+            case GIT_OBJECT_TREE: {
+                git_tree *subtree{nullptr};
+                if (!git_tree_lookup(&subtree, mRepo, git_tree_entry_id(entry))) {
+                    collect(subtree, path + '/', blobs);
+                    git_tree_free(subtree);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+
+    void scan(const QList<git_oid> &blobs)
+    {
+        QList<Task> tasks;
+        for (qsizetype i = 0; i < blobs.size(); i += blobsPerTask)
+            tasks << Task{blobs.mid(i, blobsPerTask), {}, 0};
+
+        if (tasks.size() == 1) {
+            scan(mRepo, tasks.first());
+        } else if (tasks.size() > 1) {
+            QtConcurrent::blockingMap(tasks, [this](Task &task) {
+                git_repository *repo{nullptr};
+                if (git_repository_open_ext(&repo, mPath.toUtf8().constData(), 0, nullptr))
+                    return;
+                scan(repo, task);
+                git_repository_free(repo);
+            });
+        }
+
+        for (const auto &task : std::as_const(tasks)) {
+            for (const auto &id : task.found)
+                mScanned[id] = true;
+            stats.blobs += task.blobs.size();
+            stats.bytes += task.bytes;
+        }
+    }
+
+    // The paths under @p tree of the blobs that matched.
+    QList<QByteArray> matchingPaths(const git_tree *tree, const QByteArray &prefix)
+    {
+        const auto key = treeKey(git_tree_id(tree), prefix);
+        if (const auto it = mMatchingPaths.constFind(key); it != mMatchingPaths.cend())
+            return *it;
+
+        QList<QByteArray> paths;
+        const auto count = git_tree_entrycount(tree);
+        for (size_t i = 0; i < count; ++i) {
+            const auto entry = git_tree_entry_byindex(tree, i);
+            const auto type = git_tree_entry_type(entry);
+            if (type == GIT_OBJECT_BLOB && mScanned.value(*git_tree_entry_id(entry))) {
+                paths << prefix + git_tree_entry_name(entry);
+            } else if (type == GIT_OBJECT_TREE) {
+                git_tree *subtree{nullptr};
+                if (!git_tree_lookup(&subtree, mRepo, git_tree_entry_id(entry))) {
+                    paths << matchingPaths(subtree, prefix + git_tree_entry_name(entry) + '/');
+                    git_tree_free(subtree);
+                }
+            }
+        }
+
+        mMatchingPaths.insert(key, paths);
+        return paths;
+    }
+
+    ContentSearch::Stats stats;
+
+private:
+    void scan(git_repository *repo, Task &task) const
+    {
+        for (const auto &id : std::as_const(task.blobs)) {
+            if (mCanceled)
+                return;
+
+            git_blob *blob{nullptr};
+            if (git_blob_lookup(&blob, repo, &id))
+                continue;
+
+            const auto size = static_cast<qsizetype>(git_blob_rawsize(blob));
+            task.bytes += size;
+            if (mSearch.contains(static_cast<const char *>(git_blob_rawcontent(blob)), size))
+                task.found << id;
+            git_blob_free(blob);
+        }
+    }
+
+    const ContentSearch &mSearch;
+    const QString mPath;
+    git_repository *const mRepo;
+    const std::atomic<bool> &mCanceled;
+
+    const TrigramIndex *mIndex{nullptr};
+    QSet<git_oid> mCandidates;
+    // Every blob met whose path passed the filter, and whether it matched.
+    QHash<git_oid, bool> mScanned;
+    QSet<QByteArray> mWalked;
+    QHash<QByteArray, QList<QByteArray>> mMatchingPaths;
+};
+
+}
+
+ContentSearch::ContentSearch(const QString &text, bool caseSensitive, bool regularExpression, const QString &pathFilter)
+    : mDecodedText{text}
+    , mPathFilter{pathFilter}
+    , mCaseSensitive{caseSensitive}
+    , mUseRegularExpression{regularExpression}
+    , mAsciiText{true}
+{
+    for (const auto &c : text)
+        if (c.unicode() > 127)
+            mAsciiText = false;
+
+    mText = text.toUtf8();
+    if (!mCaseSensitive)
+        for (auto &c : mText)
+            c = fold(c);
+
+    if (mUseRegularExpression) {
+        mRegularExpression.setPattern(text);
+        if (!mCaseSensitive)
+            mRegularExpression.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+        mRegularExpression.optimize();
+    }
+}
+
+bool ContentSearch::isValid() const
+{
+    if (mUseRegularExpression)
+        return !mDecodedText.isEmpty() && mRegularExpression.isValid();
+    return !mText.isEmpty();
+}
+
+bool ContentSearch::contains(const char *data, qsizetype size) const
+{
+    if (mUseRegularExpression)
+        return mRegularExpression.match(QString::fromUtf8(data, size)).hasMatch();
+    if (!mCaseSensitive && !mAsciiText)
+        return QString::fromUtf8(data, size).contains(mDecodedText, Qt::CaseInsensitive);
+    return findLiteral(data, size);
+}
+
+bool ContentSearch::findLiteral(const char *data, qsizetype size) const
+{
+    const auto length = mText.size();
+    if (!length)
+        return true;
+    if (size < length)
+        return false;
+
+    const auto text = mText.constData();
+    const auto first = mCaseSensitive ? text[0] : fold(text[0]);
+    const auto firstOtherCase = mCaseSensitive ? first : otherCase(first);
+    // Where the text can start at the latest, plus one.
+    const auto end = data + size - length + 1;
+
+    for (auto p = findByte(data, end, first, firstOtherCase); p; p = findByte(p + 1, end, first, firstOtherCase)) {
+        if (mCaseSensitive) {
+            if (!std::memcmp(p + 1, text + 1, length - 1))
+                return true;
+            continue;
+        }
+
+        qsizetype i{1};
+        while (i < length && fold(p[i]) == text[i])
+            ++i;
+        if (i == length)
+            return true;
+    }
+    return false;
+}
+
+bool ContentSearch::acceptsPath(const QString &path) const
+{
+    return mPathFilter.isEmpty() || path.contains(mPathFilter);
+}
+
+void ContentSearch::setIndex(std::shared_ptr<const TrigramIndex> index)
+{
+    mIndex = std::move(index);
+}
+
+bool ContentSearch::run(const QString &path, const QList<Place> &places, const ResultHandler &handler)
+{
+    git_repository *repo{nullptr};
+    if (git_repository_open_ext(&repo, path.toUtf8().constData(), 0, nullptr))
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 lastFlush{0};
+
+    Search search{*this, path, repo, mCanceled};
+    if (mIndex && !mUseRegularExpression) {
+        QSet<git_oid> candidates;
+        if (mIndex->candidates(mDecodedText, mCaseSensitive, &candidates))
+            search.setCandidates(mIndex.get(), std::move(candidates));
+    }
+    QList<Match> matches;
+    const auto flush = [&]() {
+        search.stats.elapsed = timer.elapsed();
+        lastFlush = search.stats.elapsed;
+        if (!handler(matches, search.stats))
+            mCanceled = true;
+        matches.clear();
+    };
+
+    for (const auto &place : places) {
+        if (mCanceled)
+            break;
+
+        git_commit *commit{nullptr};
+        git_tree *tree{nullptr};
+        if (!git_commit_lookup(&commit, repo, &place.commit) && !git_commit_tree(&tree, commit)) {
+            QList<git_oid> blobs;
+            search.collect(tree, {}, blobs);
+            search.scan(blobs);
+
+            // A canceled scan leaves blobs unscanned, which would count as not matching.
+            if (!mCanceled) {
+                const auto paths = search.matchingPaths(tree, {});
+                for (const auto &p : paths) {
+                    auto file = QString::fromUtf8(p);
+                    if (acceptsPath(file)) {
+                        matches << Match{file, place.branch, place.commit};
+                        ++search.stats.matches;
+                    }
+                }
+            }
+        }
+        git_tree_free(tree);
+        git_commit_free(commit);
+
+        if (mCanceled)
+            break;
+        ++search.stats.places;
+
+        if (matches.size() >= flushMatches || timer.elapsed() - lastFlush >= flushInterval)
+            flush();
+    }
+
+    if (!mCanceled)
+        flush();
+
+    git_repository_free(repo);
+    return search.stats.places == places.size();
+}
+
+void ContentSearch::cancel()
+{
+    mCanceled = true;
+}
+
+bool ContentSearch::isCanceled() const
+{
+    return mCanceled;
+}
+
+}
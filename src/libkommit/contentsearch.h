@@ -0,0 +1,115 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommit_export.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include <git2/oid.h>
+
+namespace Git
+{
+
+class TrigramIndex;
+
+/**
+ * Looks for a text in the files of a set of commits.
+ *
+ * Commits share most of their trees and files: a tree or a blob met before, by its id, is
+ * not read again. The trees of each commit are walked for the blobs not scanned yet, those
+ * are scanned on the global thread pool, and the paths of the matching blobs are then put
+ * together from the trees, a subtree seen before giving its matches at once.
+ *
+ * A literal text is looked for in the raw bytes, with memchr() finding where its first byte
+ * is; a regular expression, or a text with letters past ASCII to match in any case, is
+ * matched against the decoded file.
+ *
+ * With a TrigramIndex, a literal text is first looked up in it, and the blobs it covers that
+ * cannot contain the text are ruled out without being read.
+ */
+class LIBKOMMIT_EXPORT ContentSearch
+{
+public:
+    struct Place {
+        // Empty when searching commits.
+        QString branch;
+        git_oid commit;
+    };
+
+    struct Match {
+        QString path;
+        QString branch;
+        git_oid commit;
+    };
+
+    struct Stats {
+        int places{0};
+        qint64 trees{0};
+        // Blobs scanned, each once.
+        qint64 blobs{0};
+        // Blobs met again, in another commit or path, and not scanned.
+        qint64 reusedBlobs{0};
+        // Blobs the index ruled out, and not scanned.
+        qint64 ruledOutBlobs{0};
+        qint64 bytes{0};
+        qint64 matches{0};
+        // In milliseconds.
+        qint64 elapsed{0};
+    };
+
+    /// Receives the matches found since the previous call. Returning false stops the search.
+    using ResultHandler = std::function<bool(const QList<Match> &matches, const Stats &stats)>;
+
+    /// Searches for @p text in the files whose path contains @p pathFilter, all files when empty.
+    ContentSearch(const QString &text, bool caseSensitive, bool regularExpression, const QString &pathFilter = {});
+
+    /// False for an empty text or a regular expression that does not compile.
+    [[nodiscard]] bool isValid() const;
+
+    [[nodiscard]] bool contains(const char *data, qsizetype size) const;
+    [[nodiscard]] bool acceptsPath(const QString &path) const;
+
+    /// Narrows the blobs to scan down with @p index, which run() only reads.
+    void setIndex(std::shared_ptr<const TrigramIndex> index);
+
+    /**
+     * Searches @p places, in order, in the repository at @p path, handing the matches found
+     * and the stats so far over every tenth of a second or so, and once at the end. Returns
+     * true when every place was searched.
+     *
+     * Safe to call on a worker thread: the repository is opened by the search itself.
+     */
+    bool run(const QString &path, const QList<Place> &places, const ResultHandler &handler);
+
+    /// Stops a search running on another thread, as soon as the blobs being scanned are done,
+    /// or the next one before it starts.
+    void cancel();
+    [[nodiscard]] bool isCanceled() const;
+
+private:
+    [[nodiscard]] LIBKOMMIT_NO_EXPORT bool findLiteral(const char *data, qsizetype size) const;
+
+    QByteArray mText;
+    QString mDecodedText;
+    QString mPathFilter;
+    QRegularExpression mRegularExpression;
+    std::shared_ptr<const TrigramIndex> mIndex;
+    bool mCaseSensitive;
+    bool mUseRegularExpression;
+    bool mAsciiText;
+    std::atomic<bool> mCanceled{false};
+};
+
+}
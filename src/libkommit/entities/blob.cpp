@@ -85,6 +85,7 @@ Blob::Blob(git_repository *repo, const QString &relativePath)
 }
 
 Blob::Blob(Repository *git, const Oid &oid)
+    : d{new BlobPrivate{this}}
 {
     git_blob_lookup(&d->blob, git->repoPtr(), oid.constData());
 }
@@ -151,6 +152,15 @@ QByteArray Blob::content() const
     return QByteArray{static_cast<const char *>(git_blob_rawcontent(blob)), static_cast<qsizetype>(git_blob_rawsize(blob))};
 }
 
+QByteArrayView Blob::rawContent() const
+{
+    auto blob = d->blob;
+    if (!blob)
+        return {};
+
+    return QByteArrayView{static_cast<const char *>(git_blob_rawcontent(blob)), static_cast<qsizetype>(git_blob_rawsize(blob))};
+}
+
 bool Blob::isValid() const
 {
     return d->blob;
@@ -11,6 +11,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <git2/index.h>
 #include <git2/types.h>
 
+#include <QByteArrayView>
 #include <QSharedPointer>
 #include <QString>
 
@@ -39,6 +40,8 @@ public:
     [[nodiscard]] QString saveAsTemp() const;
     QString stringContent() const;
     QByteArray content() const;
+    /// The content in place, without copying it; valid as long as this blob or a copy of it.
+    [[nodiscard]] QByteArrayView rawContent() const;
 
     [[nodiscard]] bool isValid() const;
     [[nodiscard]] bool isBinary() const;
@@ -190,7 +190,9 @@ Commit Branch::commit()
 Reference Branch::reference() const
 {
     auto manager = Repository::owner(git_reference_owner(d->branch));
-    return manager->references()->findByPtr(d->branch);
+    // Look it up by name: the cache takes over the pointer it is handed, and this one stays
+    // with the branch.
+    return manager->references()->findByName(d->refName);
 }
 
 QString Branch::treeTitle() const
@@ -13,6 +13,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <QTimeZone>
 
+#include <mutex>
+
 #include "tree.h"
 #include "types.h"
 #include <git2/commit.h>
@@ -33,17 +35,31 @@ public:
     ~CommitPrivate();
 
     git_commit *const commit;
+    // Only made when asked for: most commits of a long history are never shown. Commits are
+    // shared with worker threads, so it is made once, whichever thread asks first.
     QString hash;
+    std::once_flag hashOnce;
     Signature author;
     Signature committer;
     QList<Reference> references;
     Branch branch;
     Note note;
     Commit::CommitType type;
-    QStringList parentHashes;
-    QStringList children;
+    QList<git_oid> children;
 };
 
+namespace
+{
+QStringList toStrings(const QList<git_oid> &oids)
+{
+    QStringList list;
+    list.reserve(oids.size());
+    for (const auto &oid : oids)
+        list << QString::fromLatin1(git_oid_tostr_s(&oid));
+    return list;
+}
+}
+
 Commit::Commit()
     : d{new CommitPrivate{this, nullptr}}
 {
@@ -92,7 +108,12 @@ const Branch &Commit::branch() const
     return d->branch;
 }
 
-const QStringList &Commit::children() const
+QStringList Commit::children() const
+{
+    return toStrings(d->children);
+}
+
+const QList<git_oid> &Commit::childOids() const
 {
     return d->children;
 }
@@ -187,12 +208,29 @@ QString Commit::summary() const
 
 const QString &Commit::commitHash() const
 {
+    std::call_once(d->hashOnce, [this] {
+        if (d->commit)
+            d->hash = QString::fromLatin1(git_oid_tostr_s(git_commit_id(d->commit)));
+    });
     return d->hash;
 }
 
-const QStringList &Commit::parents() const
+QStringList Commit::parents() const
+{
+    return toStrings(parentOids());
+}
+
+QList<git_oid> Commit::parentOids() const
 {
-    return d->parentHashes;
+    QList<git_oid> list;
+    if (!d->commit)
+        return list;
+
+    const auto parentCount = git_commit_parentcount(d->commit);
+    list.reserve(parentCount);
+    for (unsigned int i = 0; i < parentCount; ++i)
+        list << *git_commit_parent_id(d->commit, i);
+    return list;
 }
 
 bool Commit::createNote(const QString &message)
@@ -224,7 +262,7 @@ CommitSignatureInfo Commit::signatureInfo() const
     auto repo = Repository::owner(git_commit_owner(d->commit));
     if (!repo)
         return {};
-    return repo->verifyCommitSignature(d->hash);
+    return repo->verifyCommitSignature(commitHash());
 }
 
 void Commit::clearChildren()
@@ -237,25 +275,15 @@ void Commit::setReferences(const QList<Reference> refs)
     d->references = refs;
 }
 
-void Commit::addChild(const QString &childHash)
+void Commit::addChild(const git_oid &childOid)
 {
-    d->children << childHash;
+    d->children << childOid;
 }
 
 CommitPrivate::CommitPrivate(Commit *parent, git_commit *commit)
     : q_ptr{parent}
     , commit{commit}
 {
-    if (commit) {
-        auto id = git_commit_id(commit);
-        hash = git_oid_tostr_s(id);
-
-        auto parentCount = git_commit_parentcount(commit);
-        for (unsigned int i = 0; i < parentCount; ++i) {
-            auto pid = git_commit_parent_id(commit, i);
-            parentHashes << convertToString(pid, 20);
-        }
-    }
 }
 
 CommitPrivate::~CommitPrivate()
@@ -58,9 +58,11 @@ public:
     [[nodiscard]] QString body() const;
     [[nodiscard]] QString summary() const;
     [[nodiscard]] const QString &commitHash() const;
-    [[nodiscard]] const QStringList &parents() const;
+    [[nodiscard]] QStringList parents() const;
+    [[nodiscard]] QList<git_oid> parentOids() const;
     [[nodiscard]] const Branch &branch() const;
-    [[nodiscard]] const QStringList &children() const;
+    [[nodiscard]] QStringList children() const;
+    [[nodiscard]] const QList<git_oid> &childOids() const;
     [[nodiscard]] const QString &commitShortHash() const;
     [[nodiscard]] QDateTime commitTime() const;
 
@@ -82,7 +84,7 @@ private:
 
     void clearChildren();
     void setReferences(const QList<Reference> refs);
-    void addChild(const QString &childHash);
+    void addChild(const git_oid &childOid);
 
     friend class LogList;
     friend class Manager;
@@ -165,6 +165,15 @@ bool Index::addAll()
 
 bool Index::addByPath(const QString &path)
 {
+    // A directory listed as a whole by the status, when untracked directories are not walked.
+    if (path.endsWith(QLatin1Char('/'))) {
+        StrArray pathspec{path.startsWith(QLatin1Char('/')) ? path.mid(1) : path};
+        if (git_index_add_all(d->index, *pathspec, GIT_INDEX_ADD_DEFAULT, nullptr, nullptr))
+            return false;
+        d->writeNeeded = true;
+        return true;
+    }
+
     BEGIN;
     if (path.startsWith(QLatin1Char('/')))
         STEP git_index_add_bypath(d->index, toConstChars(path.mid(1)));
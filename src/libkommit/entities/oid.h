@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <git2/oid.h>
 
+#include <QHashFunctions>
 #include <QString>
 
 #include "libkommit_export.h"
@@ -42,3 +43,19 @@ private:
 bool operator==(const Git::Oid &oid, const QString &hash);
 bool operator!=(const Git::Oid &oid, const QString &hash);
 
+// Comparison and hashing for the raw libgit2 struct, so code that handles many object ids
+// can key a QHash or QSet on them directly instead of on their 40 character hex form.
+inline bool operator==(const git_oid &oid1, const git_oid &oid2) noexcept
+{
+    return git_oid_equal(&oid1, &oid2);
+}
+
+inline bool operator!=(const git_oid &oid1, const git_oid &oid2) noexcept
+{
+    return !git_oid_equal(&oid1, &oid2);
+}
+
+inline size_t qHash(const git_oid &oid, size_t seed = 0) noexcept
+{
+    return qHashBits(oid.id, sizeof(oid.id), seed);
+}
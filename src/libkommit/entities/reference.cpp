@@ -156,8 +156,9 @@ Branch Reference::toBranch() const
 
     auto manager = Repository::owner(git_reference_owner(d->reference));
 
-    // memory leak warning: both branch and this will free the d->reference!
-    return manager->branches()->findByPtr(d->reference);
+    // Look it up by name: the cache takes over the pointer it is handed, and this one stays
+    // with the reference.
+    return manager->branches()->findByName(QString::fromUtf8(git_reference_shorthand(d->reference)));
 }
 
 Tag Reference::toTag() const
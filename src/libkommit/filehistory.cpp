@@ -0,0 +1,211 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "filehistory.h"
+
+#include <QCache>
+#include <QMutex>
+
+#include <git2/commit.h>
+#include <git2/diff.h>
+#include <git2/refs.h>
+#include <git2/repository.h>
+#include <git2/tree.h>
+
+namespace Git
+{
+
+namespace
+{
+
+// Files whose history is kept once walked.
+constexpr int cachedHistories{64};
+
+struct CachedHistory {
+    git_oid head;
+    QList<FileRevision> revisions;
+};
+
+QMutex cacheMutex;
+QCache<QString, CachedHistory> cache{cachedHistories};
+
+// What @p path is in @p tree, zero when it is not there.
+git_oid entryId(const git_tree *tree, const QByteArray &path)
+{
+    git_oid id{};
+    git_tree_entry *entry{nullptr};
+    if (tree && !git_tree_entry_bypath(&entry, tree, path.constData())) {
+        git_oid_cpy(&id, git_tree_entry_id(entry));
+        git_tree_entry_free(entry);
+    }
+    return id;
+}
+
+// Where @p path came from when the change from @p oldTree to @p newTree renamed it; empty
+// when it did not.
+QByteArray renamedFrom(git_repository *repo, git_tree *oldTree, git_tree *newTree, const QByteArray &path)
+{
+    git_diff *diff{nullptr};
+    if (git_diff_tree_to_tree(&diff, repo, oldTree, newTree, nullptr))
+        return {};
+
+    QByteArray from;
+    git_diff_find_options opts = GIT_DIFF_FIND_OPTIONS_INIT;
+    opts.flags = GIT_DIFF_FIND_RENAMES;
+    if (!git_diff_find_similar(diff, &opts)) {
+        const auto count = git_diff_num_deltas(diff);
+        for (size_t i = 0; i < count; ++i) {
+            const auto delta = git_diff_get_delta(diff, i);
+            if (delta->status == GIT_DELTA_RENAMED && path == delta->new_file.path) {
+                from = delta->old_file.path;
+                break;
+            }
+        }
+    }
+
+    git_diff_free(diff);
+    return from;
+}
+
+class Walk
+{
+public:
+    Walk(int pageSize, const FileHistoryPageHandler &handler)
+        : mPageSize{qMax(1, pageSize)}
+        , mHandler{handler}
+    {
+    }
+
+    bool add(const FileRevision &revision)
+    {
+        revisions << revision;
+        mPage << revision;
+        return mPage.size() < mPageSize || flush();
+    }
+
+    bool flush()
+    {
+        if (mPage.isEmpty())
+            return true;
+
+        const auto keepGoing = mHandler(mPage);
+        mPage.clear();
+        return keepGoing;
+    }
+
+    QList<FileRevision> revisions;
+
+private:
+    const int mPageSize;
+    const FileHistoryPageHandler &mHandler;
+    QList<FileRevision> mPage;
+};
+
+}
+
+bool walkFileHistory(const QString &path, const QString &filePath, bool followRenames, int pageSize, const FileHistoryPageHandler &handler)
+{
+    git_repository *repo{nullptr};
+    if (git_repository_open_ext(&repo, path.toUtf8().constData(), 0, nullptr))
+        return false;
+
+    git_oid head;
+    if (git_reference_name_to_id(&head, repo, "HEAD")) {
+        git_repository_free(repo);
+        return false;
+    }
+
+    const auto key = QString::fromUtf8(git_repository_path(repo)) + QLatin1Char('\n') + filePath + (followRenames ? QStringLiteral("\n+") : QString{});
+    // A zero HEAD, when there is nothing cached, is no commit to stop at.
+    CachedHistory cached{};
+    {
+        QMutexLocker locker{&cacheMutex};
+        if (auto found = cache.object(key))
+            cached = *found;
+    }
+
+    Walk walk{pageSize, handler};
+    auto currentPath = filePath.toUtf8();
+    auto completed{false};
+    auto stopped{false};
+
+    git_commit *commit{nullptr};
+    git_tree *tree{nullptr};
+    git_oid blob{};
+    if (!git_commit_lookup(&commit, repo, &head) && !git_commit_tree(&tree, commit))
+        blob = entryId(tree, currentPath);
+
+    while (commit && !stopped) {
+        const auto commitId = *git_commit_id(commit);
+
+        // Below the HEAD of a walk done before, with the same path, all is known.
+        if (git_oid_equal(&commitId, &cached.head) && currentPath == filePath.toUtf8()) {
+            for (const auto &revision : std::as_const(cached.revisions))
+                if (!walk.add(revision)) {
+                    stopped = true;
+                    break;
+                }
+            completed = !stopped;
+            break;
+        }
+
+        git_commit *parent{nullptr};
+        git_tree *parentTree{nullptr};
+        git_oid parentBlob{};
+        const auto hasParent = git_commit_parentcount(commit) && !git_commit_parent(&parent, commit, 0) && !git_commit_tree(&parentTree, parent);
+        if (hasParent)
+            parentBlob = entryId(parentTree, currentPath);
+
+        if (!git_oid_equal(&blob, &parentBlob)) {
+            stopped = !walk.add({commitId, blob, QString::fromUtf8(currentPath)});
+
+            if (followRenames && hasParent && git_oid_is_zero(&parentBlob) && !git_oid_is_zero(&blob)) {
+                const auto from = renamedFrom(repo, parentTree, tree, currentPath);
+                if (!from.isEmpty()) {
+                    currentPath = from;
+                    parentBlob = entryId(parentTree, currentPath);
+                }
+            }
+        }
+
+        git_tree_free(tree);
+        git_commit_free(commit);
+        commit = hasParent ? parent : nullptr;
+        tree = hasParent ? parentTree : nullptr;
+        blob = parentBlob;
+        if (!hasParent) {
+            git_tree_free(parentTree);
+            git_commit_free(parent);
+            completed = !stopped;
+        }
+    }
+
+    git_tree_free(tree);
+    git_commit_free(commit);
+    git_repository_free(repo);
+
+    if (!stopped)
+        stopped = !walk.flush();
+
+    if (completed) {
+        QMutexLocker locker{&cacheMutex};
+        cache.insert(key, new CachedHistory{head, walk.revisions});
+    }
+
+    return completed && !stopped;
+}
+
+QList<FileRevision> fileHistory(const QString &path, const QString &filePath, bool followRenames)
+{
+    QList<FileRevision> revisions;
+    walkFileHistory(path, filePath, followRenames, 1024, [&revisions](const QList<FileRevision> &page) {
+        revisions << page;
+        return true;
+    });
+    return revisions;
+}
+
+}
@@ -0,0 +1,53 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommit_export.h"
+
+#include <QList>
+#include <QString>
+
+#include <functional>
+
+#include <git2/oid.h>
+
+namespace Git
+{
+
+/// One commit that changed a file, and what the file was in it.
+struct LIBKOMMIT_EXPORT FileRevision {
+    git_oid commit;
+    /// Zero when the commit deleted the file.
+    git_oid blob;
+    /// Where the file was in the commit; past a rename, not the path asked for.
+    QString path;
+};
+
+/// Receives one page of a file history. Returning false stops the walk there.
+using FileHistoryPageHandler = std::function<bool(const QList<FileRevision> &page)>;
+
+/**
+ * The commits that changed @p filePath, newest first, handed to @p handler in pages of at
+ * most @p pageSize as they are found. It returns true when the walk ran to the end and false
+ * when it could not start or the handler stopped it.
+ *
+ * The walk goes down the first parents from HEAD, so the changes made on a branch merged in
+ * show up as the merge. A commit is passed over when the file has the same tree entry id as
+ * in its parent, which needs no content to be read. With @p followRenames, a commit that adds
+ * the file is checked for having renamed it, and the walk goes on with the old path.
+ *
+ * Like walkCommits(), this opens a repository handle of its own and is safe to call on a
+ * worker thread. Finished walks are kept, by repository, path and HEAD: a file walked before
+ * is handed back without walking, and once HEAD has moved on, the walk stops at the HEAD it
+ * was walked from and takes the rest over.
+ */
+LIBKOMMIT_EXPORT bool walkFileHistory(const QString &path, const QString &filePath, bool followRenames, int pageSize, const FileHistoryPageHandler &handler);
+
+/// The whole history of @p filePath at once; see above.
+[[nodiscard]] LIBKOMMIT_EXPORT QList<FileRevision> fileHistory(const QString &path, const QString &filePath, bool followRenames = false);
+
+}
@@ -0,0 +1,88 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "fsmonitor.h"
+#include "libkommit_debug.h"
+
+#include <QProcess>
+
+namespace Git
+{
+
+FsMonitor::FsMonitor(const QString &hook, const QString &workingDirectory)
+    : mHook{hook}
+    , mWorkingDirectory{workingDirectory}
+{
+}
+
+const QString &FsMonitor::hook() const
+{
+    return mHook;
+}
+
+FsMonitor::Changes FsMonitor::query()
+{
+    Changes changes;
+
+    // Run through the shell, as git does, so the hook can be a command line.
+    QProcess p;
+    p.setProgram(QStringLiteral("sh"));
+    p.setArguments({QStringLiteral("-c"),
+                    mHook + QStringLiteral(" \"$@\""),
+                    mHook,
+                    QStringLiteral("2"),
+                    QString::fromUtf8(mToken)});
+    p.setWorkingDirectory(mWorkingDirectory);
+    p.setStandardInputFile(QProcess::nullDevice());
+    p.start();
+
+    if (!p.waitForFinished(timeout)) {
+        qCWarning(KOMMITLIB_LOG) << "fsmonitor hook timed out:" << mHook;
+        p.kill();
+        p.waitForFinished();
+        mToken.clear();
+        return changes;
+    }
+
+    if (p.exitStatus() != QProcess::NormalExit || p.exitCode()) {
+        qCWarning(KOMMITLIB_LOG) << "fsmonitor hook failed:" << mHook << p.readAllStandardError();
+        mToken.clear();
+        return changes;
+    }
+
+    const auto out = p.readAllStandardOutput();
+    const auto tokenEnd = out.indexOf('\0');
+    if (tokenEnd <= 0) {
+        mToken.clear();
+        return changes;
+    }
+
+    const auto firstQuery = mToken.isEmpty();
+    mToken = out.left(tokenEnd);
+    if (firstQuery)
+        return changes;
+
+    changes.everything = false;
+    for (const auto &path : out.mid(tokenEnd + 1).split('\0')) {
+        if (path.isEmpty())
+            continue;
+        if (path == "/") {
+            changes.everything = true;
+            changes.paths.clear();
+            break;
+        }
+        changes.paths << QString::fromUtf8(path);
+    }
+
+    return changes;
+}
+
+void FsMonitor::reset()
+{
+    mToken.clear();
+}
+
+}
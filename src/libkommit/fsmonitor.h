@@ -0,0 +1,57 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommit_private_export.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+namespace Git
+{
+
+/**
+ * Asks a core.fsmonitor hook what has changed in a working tree, the way git does with
+ * version 2 of the hook protocol: the hook is given the token it returned the previous time,
+ * and answers with a new token followed by the paths changed since the old one.
+ *
+ * libgit2 has no fsmonitor support of its own; Repository::changedFiles() uses the answer to
+ * limit its status to the paths that can have changed. A hook that does not answer within
+ * timeout is killed and taken to report everything, so a stuck one costs no more than a
+ * full status.
+ */
+class LIBKOMMIT_TESTS_EXPORT FsMonitor
+{
+public:
+    struct Changes {
+        // Set when the hook could not tell, on the first query, or when it failed.
+        bool everything{true};
+        // Relative to the root of the working tree; directories end in '/'.
+        QStringList paths;
+    };
+
+    // Milliseconds.
+    static constexpr int timeout{1000};
+
+    FsMonitor(const QString &hook, const QString &workingDirectory);
+
+    [[nodiscard]] const QString &hook() const;
+
+    /// What has changed since the previous query.
+    [[nodiscard]] Changes query();
+
+    /// Forgets the token, so the next query reports everything.
+    void reset();
+
+private:
+    QString mHook;
+    QString mWorkingDirectory;
+    QByteArray mToken;
+};
+
+}
@@ -108,13 +108,13 @@ void BlameOptions::apply(git_blame_options *opts)
     if (d->firstLineNumber != -1)
         opts->min_line = d->firstLineNumber;
     if (d->lastLineNumber != -1)
-        opts->max_line = d->firstLineNumber;
+        opts->max_line = d->lastLineNumber;
 
     if (!d->firstCommit.isNull()) {
         opts->oldest_commit = *d->firstCommit->oid().data();
     }
     if (!d->lastCommit.isNull()) {
-        opts->oldest_commit = *d->lastCommit->oid().data();
+        opts->newest_commit = *d->lastCommit->oid().data();
     }
     opts->flags = d->flags;
 }
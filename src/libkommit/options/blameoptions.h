@@ -39,15 +39,18 @@ public:
     Q_DECLARE_FLAGS(BlameFlags, BlameFlag)
     // Q_FLAG(BlameFlags)
 
+    /// The oldest commit to look at; lines older than it are put on it.
     [[nodiscard]] QSharedPointer<Commit> firstCommit() const;
     void setFirstCommit(QSharedPointer<Commit> firstCommit);
 
+    /// The commit to blame the file of, instead of the working tree.
     [[nodiscard]] QSharedPointer<Commit> lastCommit() const;
     void setLastCommit(QSharedPointer<Commit> lastCommit);
 
     [[nodiscard]] int minMatchCharacters() const;
     void setMinMatchCharacters(int minMatchCharacters);
 
+    /// The lines to blame, 1-based and inclusive; the whole file when not set.
     [[nodiscard]] int firstLineNumber() const;
     void setFirstLineNumber(int firstLineNumber);
 
@@ -0,0 +1,128 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "statusoptions.h"
+
+#include <git2/config.h>
+#include <git2/repository.h>
+
+#include <atomic>
+
+namespace Git
+{
+
+namespace
+{
+
+// The hook is a command taken from the repository, and updating the index writes to it just
+// from looking; both are up to the user.
+std::atomic<bool> fsMonitorIsAllowed{false};
+std::atomic<bool> updateIndexIsAllowed{false};
+
+QString configString(git_config *config, const char *name)
+{
+    git_config_entry *entry{nullptr};
+    if (git_config_get_entry(&entry, config, name))
+        return {};
+
+    const auto value = QString::fromUtf8(entry->value);
+    git_config_entry_free(entry);
+    return value;
+}
+
+}
+
+StatusOptions StatusOptions::fromConfig(git_repository *repo)
+{
+    StatusOptions options;
+
+    git_config *config{nullptr};
+    if (!repo || git_repository_config_snapshot(&config, repo))
+        return options;
+
+    int untrackedCache{0};
+    if (!git_config_get_bool(&untrackedCache, config, "core.untrackedCache") && untrackedCache) {
+        options.untrackedFiles = UntrackedFiles::Normal;
+        options.updateIndex = updateIndexIsAllowed;
+    }
+
+    // A boolean asks for git's own daemon, which only git itself can talk to.
+    const auto fsMonitor = configString(config, "core.fsmonitor");
+    int isBool{0};
+    if (!fsMonitor.isEmpty() && git_config_parse_bool(&isBool, fsMonitor.toUtf8().constData())) {
+        if (fsMonitorIsAllowed)
+            options.fsMonitorHook = fsMonitor;
+        options.untrackedFiles = UntrackedFiles::Normal;
+        options.updateIndex = updateIndexIsAllowed;
+    }
+
+    const auto showUntrackedFiles = configString(config, "status.showUntrackedFiles");
+    if (showUntrackedFiles == QStringLiteral("no"))
+        options.untrackedFiles = UntrackedFiles::No;
+    else if (showUntrackedFiles == QStringLiteral("normal"))
+        options.untrackedFiles = UntrackedFiles::Normal;
+    else if (showUntrackedFiles == QStringLiteral("all"))
+        options.untrackedFiles = UntrackedFiles::All;
+
+    git_config_free(config);
+    return options;
+}
+
+bool StatusOptions::fsMonitorAllowed()
+{
+    return fsMonitorIsAllowed;
+}
+
+void StatusOptions::setFsMonitorAllowed(bool allowed)
+{
+    fsMonitorIsAllowed = allowed;
+}
+
+bool StatusOptions::updateIndexAllowed()
+{
+    return updateIndexIsAllowed;
+}
+
+void StatusOptions::setUpdateIndexAllowed(bool allowed)
+{
+    updateIndexIsAllowed = allowed;
+}
+
+bool StatusOptions::operator==(const StatusOptions &other) const
+{
+    return untrackedFiles == other.untrackedFiles && excludeSubmodules == other.excludeSubmodules && updateIndex == other.updateIndex
+        && fsMonitorHook == other.fsMonitorHook;
+}
+
+bool StatusOptions::operator!=(const StatusOptions &other) const
+{
+    return !(*this == other);
+}
+
+void StatusOptions::applyToStatusOptions(git_status_options *opts) const
+{
+    opts->show = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
+    // As GIT_STATUS_OPT_DEFAULTS, less what depends on the untracked files wanted.
+    opts->flags = GIT_STATUS_OPT_INCLUDE_IGNORED;
+
+    switch (untrackedFiles) {
+    case UntrackedFiles::No:
+        break;
+    case UntrackedFiles::Normal:
+        opts->flags |= GIT_STATUS_OPT_INCLUDE_UNTRACKED;
+        break;
+    case UntrackedFiles::All:
+        opts->flags |= GIT_STATUS_OPT_INCLUDE_UNTRACKED | GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS;
+        break;
+    }
+
+    if (excludeSubmodules)
+        opts->flags |= GIT_STATUS_OPT_EXCLUDE_SUBMODULES;
+    if (updateIndex)
+        opts->flags |= GIT_STATUS_OPT_UPDATE_INDEX;
+}
+
+}
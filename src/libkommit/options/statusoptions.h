@@ -0,0 +1,69 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommit_export.h"
+
+#include <QString>
+
+#include <git2/status.h>
+
+namespace Git
+{
+
+/**
+ * How Repository::changedFiles() looks at the working tree.
+ *
+ * The defaults list every untracked file and touch nothing. fromConfig() gives the fast mode
+ * a repository opts in to through its configuration, as it does for git itself, as far as
+ * the application allows it; see setFsMonitorAllowed() and setUpdateIndexAllowed().
+ */
+class LIBKOMMIT_EXPORT StatusOptions
+{
+public:
+    enum class UntrackedFiles {
+        // None listed.
+        No,
+        // An untracked directory is listed as a whole, as "dir/", and not walked into.
+        Normal,
+        // Every untracked file is listed.
+        All,
+    };
+
+    UntrackedFiles untrackedFiles{UntrackedFiles::All};
+    bool excludeSubmodules{true};
+    // Writes the stat data found back to the index, so the next look compares stat data
+    // instead of reading the files whose stat data was out of date.
+    bool updateIndex{false};
+    // A core.fsmonitor hook to ask what changed since the previous look, run from the root of
+    // the working tree; see FsMonitor.
+    QString fsMonitorHook;
+
+    /**
+     * The options for @p repo: once core.untrackedCache or core.fsmonitor is set, untracked
+     * directories are listed as a whole, the index is updated if that is allowed, and
+     * core.fsmonitor, when it names a hook rather than git's own daemon and running it is
+     * allowed, is asked what changed. An explicit status.showUntrackedFiles is honoured
+     * either way.
+     */
+    [[nodiscard]] static StatusOptions fromConfig(git_repository *repo);
+
+    /// Whether fromConfig() may run the hook a repository names; off unless turned on.
+    [[nodiscard]] static bool fsMonitorAllowed();
+    static void setFsMonitorAllowed(bool allowed);
+
+    /// Whether fromConfig() may write the index back; off unless turned on.
+    [[nodiscard]] static bool updateIndexAllowed();
+    static void setUpdateIndexAllowed(bool allowed);
+
+    [[nodiscard]] bool operator==(const StatusOptions &other) const;
+    [[nodiscard]] bool operator!=(const StatusOptions &other) const;
+
+    void applyToStatusOptions(git_status_options *opts) const;
+};
+
+}
@@ -133,7 +133,10 @@ int git_helper_remote_ready_cb(git_remote *remote, int direction, void *payload)
     if (Q_UNLIKELY(!bridge))
         return GIT_EUSER;
 
-    auto remoteObject = bridge->manager->remotes()->findByPtr(remote);
+    // The remote belongs to the operation under way, so the cache is not handed the pointer
+    // to take over; an anonymous remote has no name to look it up by.
+    const auto remoteName = git_remote_name(remote);
+    auto remoteObject = remoteName ? bridge->manager->remotes()->findByName(QString::fromUtf8(remoteName)) : Remote{};
     auto dir = static_cast<Remote::Direction>(direction);
     QString newUrl;
 
@@ -21,24 +21,36 @@
 #include "entities/file.h"
 #include "entities/index.h"
 #include "entities/note.h"
+#include "entities/oid.h"
+#include "entities/strarray.h"
 #include "entities/submodule.h"
 #include "entities/tree.h"
 #include "entities/treediff.h"
 #include "filestatus.h"
+#include "fsmonitor.h"
 #include "gitglobal_p.h"
 #include "observers/cloneobserver.h"
 #include "observers/fetchobserver.h"
 #include "observers/pushobserver.h"
 #include "options/blameoptions.h"
+#include "options/statusoptions.h"
 #include "signatureverifier.h"
 
 #include "libkommit_debug.h"
 #include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSet>
+#include <QtConcurrentRun>
 #include <QProcess>
 
+#include <memory>
+#include <queue>
+
 #include <git2/branch.h>
 #include <git2/diff.h>
 #include <git2/errors.h>
+#include <git2/index.h>
 #include <git2/refs.h>
 #include <git2/repository.h>
 #include <git2/stash.h>
@@ -79,6 +91,29 @@ public:
     StashesCache *stashesCache;
     ReferenceCache *referenceCache;
 
+    // What changedFiles() last found with an fsmonitor hook, and what it was found with.
+    // Shared with changedFilesInBackground(), which may still be running as the repository
+    // changes or goes away.
+    struct MonitoredStatus {
+        QMutex mutex;
+        std::unique_ptr<FsMonitor> monitor;
+        StatusOptions options;
+        QMap<QString, ChangeStatus> files;
+        QByteArray stamp;
+
+        [[nodiscard]] QMap<QString, ChangeStatus> changedFiles(git_repository *repo, const QString &workingDirectory, const StatusOptions &options);
+    };
+    std::shared_ptr<MonitoredStatus> monitoredStatus{std::make_shared<MonitoredStatus>()};
+
+    // These take the repository to look at, as changedFilesInBackground() opens its own.
+    [[nodiscard]] static QMap<QString, ChangeStatus> status(git_repository *repo, const StatusOptions &options, const QStringList &paths = {});
+    [[nodiscard]] static QMap<QString, ChangeStatus> changedFiles(git_repository *repo,
+                                                                  const QString &workingDirectory,
+                                                                  const std::shared_ptr<MonitoredStatus> &monitoredStatus,
+                                                                  const StatusOptions &options);
+    [[nodiscard]] static QByteArray statusStamp(git_repository *repo);
+    [[nodiscard]] static QString untrackedRoot(git_repository *repo, const QString &path);
+
     void changeRepo(git_repository *repo);
     void resetCaches();
 
@@ -89,6 +124,100 @@ public:
 };
 QHash<git_repository *, Repository *> RepositoryPrivate::managerMap;
 
+namespace
+{
+
+FileStatus::Status toFileStatus(git_delta_t status)
+{
+    switch (status) {
+    case GIT_DELTA_UNMODIFIED:
+        return FileStatus::Unmodified;
+    case GIT_DELTA_ADDED:
+        return FileStatus::Added;
+    case GIT_DELTA_DELETED:
+        return FileStatus::Removed;
+    case GIT_DELTA_MODIFIED:
+        return FileStatus::Modified;
+    case GIT_DELTA_RENAMED:
+        return FileStatus::Renamed;
+    case GIT_DELTA_COPIED:
+        return FileStatus::Copied;
+    case GIT_DELTA_IGNORED:
+        return FileStatus::Ignored;
+    case GIT_DELTA_UNTRACKED:
+        return FileStatus::Untracked;
+    case GIT_DELTA_TYPECHANGE:
+    case GIT_DELTA_UNREADABLE:
+    case GIT_DELTA_CONFLICTED:
+        return FileStatus::Unknown;
+    }
+    return FileStatus::Unknown;
+}
+
+// The tree @p revision names, through a commit or tag if need be; nullptr if there is none.
+git_tree *lookupTree(git_repository *repo, const QString &revision)
+{
+    git_object *object{nullptr};
+    git_object *tree{nullptr};
+
+    BEGIN
+    STEP git_revparse_single(&object, repo, revision.toUtf8().constData());
+    STEP git_object_peel(&tree, object, GIT_OBJECT_TREE);
+    PRINT_ERROR;
+
+    git_object_free(object);
+    return reinterpret_cast<git_tree *>(tree);
+}
+
+// The id of what @p path is in @p tree; false when it is not there.
+bool entryId(const git_tree *tree, const QByteArray &path, git_oid *id)
+{
+    git_tree_entry *entry{nullptr};
+    if (git_tree_entry_bypath(&entry, tree, path.constData()))
+        return false;
+
+    git_oid_cpy(id, git_tree_entry_id(entry));
+    git_tree_entry_free(entry);
+    return true;
+}
+
+// The first parent of @p commit that has @p path as the commit has it, the same entry or none
+// at all, that is TREESAME to it as git log -- path says; -1 when there is none. @p exists
+// tells whether the commit has the path.
+int treeSameParent(git_commit *commit, const QByteArray &path, bool *exists)
+{
+    *exists = false;
+    git_tree *tree{nullptr};
+    if (git_commit_tree(&tree, commit))
+        return -1;
+
+    git_oid id;
+    *exists = entryId(tree, path, &id);
+    git_tree_free(tree);
+
+    const auto parentCount = git_commit_parentcount(commit);
+    for (unsigned int i = 0; i < parentCount; ++i) {
+        git_commit *parent{nullptr};
+        git_tree *parentTree{nullptr};
+        auto same{false};
+
+        if (!git_commit_parent(&parent, commit, i) && !git_commit_tree(&parentTree, parent)) {
+            git_oid parentId;
+            const auto parentExists = entryId(parentTree, path, &parentId);
+            same = *exists == parentExists && (!*exists || git_oid_equal(&id, &parentId));
+        }
+
+        git_tree_free(parentTree);
+        git_commit_free(parent);
+
+        if (same)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+}
+
 const QString &Repository::path() const
 {
     Q_D(const Repository);
@@ -165,33 +294,79 @@ bool Repository::checkout()
 
 QMap<QString, ChangeStatus> Repository::changedFiles(const QString &hash) const
 {
-    QMap<QString, ChangeStatus> statuses;
-    auto buffer = QString(runGit({QStringLiteral("show"), QStringLiteral("--name-status"), hash})).split(QLatin1Char('\n'));
+    Q_D(const Repository);
 
-    for (auto &line : buffer) {
-        if (!line.trimmed().size())
-            continue;
+    git_object *object{nullptr};
+    git_commit *commit{nullptr};
+    git_commit *parent{nullptr};
+    git_tree *tree{nullptr};
+    git_tree *parentTree{nullptr};
+    git_diff *diff{nullptr};
 
-        const auto parts = line.split(QLatin1Char('\t'));
-        if (parts.size() != 2)
-            continue;
+    BEGIN
+    STEP git_revparse_single(&object, d->repo, hash.toUtf8().constData());
+    STEP git_object_peel(reinterpret_cast<git_object **>(&commit), object, GIT_OBJECT_COMMIT);
+    STEP git_commit_tree(&tree, commit);
+    // A merge is compared with its first parent, and a root commit with nothing.
+    if (IS_OK && git_commit_parentcount(commit)) {
+        STEP git_commit_parent(&parent, commit, 0);
+        STEP git_commit_tree(&parentTree, parent);
+    }
+    STEP git_diff_tree_to_tree(&diff, d->repo, parentTree, tree, nullptr);
+    PRINT_ERROR;
 
-        const auto partFirst{parts.first()};
-        if (partFirst == QLatin1Char('A'))
-            statuses.insert(parts.at(1), ChangeStatus::Added);
-        else if (partFirst == QLatin1Char('M'))
-            statuses.insert(parts.at(1), ChangeStatus::Modified);
-        else if (partFirst == QLatin1Char('D'))
-            statuses.insert(parts.at(1), ChangeStatus::Removed);
-        else
-            qCDebug(KOMMITLIB_LOG) << "Unknown file status" << partFirst;
+    QMap<QString, ChangeStatus> statuses;
+    const auto count = IS_OK ? git_diff_num_deltas(diff) : 0;
+    for (size_t i = 0; i < count; ++i) {
+        const auto delta = git_diff_get_delta(diff, i);
+        switch (delta->status) {
+        case GIT_DELTA_ADDED:
+            statuses.insert(QString::fromUtf8(delta->new_file.path), ChangeStatus::Added);
+            break;
+        case GIT_DELTA_MODIFIED:
+        case GIT_DELTA_TYPECHANGE:
+            statuses.insert(QString::fromUtf8(delta->new_file.path), ChangeStatus::Modified);
+            break;
+        case GIT_DELTA_DELETED:
+            statuses.insert(QString::fromUtf8(delta->old_file.path), ChangeStatus::Removed);
+            break;
+        default:
+            qCDebug(KOMMITLIB_LOG) << "Unknown file status" << delta->status;
+            break;
+        }
     }
+
+    git_diff_free(diff);
+    git_tree_free(parentTree);
+    git_tree_free(tree);
+    git_commit_free(parent);
+    git_commit_free(commit);
+    git_object_free(object);
     return statuses;
 }
 
 QStringList Repository::ignoredFiles() const
 {
-    return readAllNonEmptyOutput({QStringLiteral("check-ignore"), QStringLiteral("*")});
+    Q_D(const Repository);
+
+    auto cb = [](const char *path, unsigned int status_flags, void *payload) -> int {
+        if (status_flags & GIT_STATUS_IGNORED)
+            reinterpret_cast<QStringList *>(payload)->append(QString::fromUtf8(path));
+        return 0;
+    };
+
+    // An ignored directory comes as a whole, "dir/".
+    git_status_options opts;
+    git_status_options_init(&opts, GIT_STATUS_OPTIONS_VERSION);
+    opts.show = GIT_STATUS_SHOW_WORKDIR_ONLY;
+    opts.flags = GIT_STATUS_OPT_INCLUDE_IGNORED | GIT_STATUS_OPT_EXCLUDE_SUBMODULES;
+
+    QStringList files;
+    BEGIN
+    STEP git_status_foreach_ext(d->repo, &opts, cb, &files);
+    PRINT_ERROR;
+
+    return files;
 }
 
 // TODO: remove this
@@ -298,30 +473,129 @@ QPair<int, int> Repository::uniqueCommitsOnBranches(const QString &branch1, cons
 
 QStringList Repository::fileLog(const QString &fileName) const
 {
-    return readAllNonEmptyOutput({QStringLiteral("log"), QStringLiteral("--format=format:%H"), QStringLiteral("--"), fileName});
+    Q_D(const Repository);
+
+    git_oid head;
+    BEGIN
+    STEP git_reference_name_to_id(&head, d->repo, "HEAD");
+    if (IS_ERROR) {
+        PRINT_ERROR;
+        return {};
+    }
+
+    // As git log -- path walks: newest commit time first, ties in the order the commits were
+    // reached, and through a commit TREESAME to a parent only to the first such parent, so
+    // a side branch that merged nothing new for the path is not gone into.
+    struct Pending {
+        git_time_t time;
+        quint64 order;
+        git_oid oid;
+    };
+    const auto older = [](const Pending &a, const Pending &b) {
+        return a.time != b.time ? a.time < b.time : a.order > b.order;
+    };
+    std::priority_queue<Pending, std::vector<Pending>, decltype(older)> pending{older};
+    QSet<git_oid> reached;
+    quint64 order{0};
+
+    const auto reach = [&](const git_oid &oid) {
+        if (reached.contains(oid))
+            return;
+        reached.insert(oid);
+
+        git_commit *commit{nullptr};
+        if (git_commit_lookup(&commit, d->repo, &oid))
+            return;
+        pending.push(Pending{git_commit_time(commit), order++, oid});
+        git_commit_free(commit);
+    };
+
+    QStringList hashes;
+    const auto path = fileName.toUtf8();
+    reach(head);
+    while (!pending.empty()) {
+        const auto oid = pending.top().oid;
+        pending.pop();
+
+        git_commit *commit{nullptr};
+        if (git_commit_lookup(&commit, d->repo, &oid))
+            continue;
+
+        bool exists;
+        const auto sameParent = treeSameParent(commit, path, &exists);
+        if (sameParent >= 0) {
+            reach(*git_commit_parent_id(commit, static_cast<unsigned int>(sameParent)));
+        } else {
+            // A root commit shows only where it adds the path.
+            const auto parentCount = git_commit_parentcount(commit);
+            if (parentCount || exists)
+                hashes << QString::fromLatin1(git_oid_tostr_s(&oid));
+            for (unsigned int i = 0; i < parentCount; ++i)
+                reach(*git_commit_parent_id(commit, i));
+        }
+
+        git_commit_free(commit);
+    }
+
+    return hashes;
 }
 
 QString Repository::diff(const QString &from, const QString &to) const
 {
-    return runGit({QStringLiteral("diff"), from, to});
+    Q_D(const Repository);
+
+    auto fromTree = lookupTree(d->repo, from);
+    auto toTree = to.isEmpty() ? nullptr : lookupTree(d->repo, to);
+    git_diff *diff{nullptr};
+    git_buf buf = GIT_BUF_INIT;
+
+    if (!fromTree || (!to.isEmpty() && !toTree)) {
+        git_tree_free(toTree);
+        git_tree_free(fromTree);
+        return {};
+    }
+
+    BEGIN
+
+    if (to.isEmpty())
+        STEP git_diff_tree_to_workdir_with_index(&diff, d->repo, fromTree, nullptr);
+    else
+        STEP git_diff_tree_to_tree(&diff, d->repo, fromTree, toTree, nullptr);
+    STEP git_diff_to_buf(&buf, diff, GIT_DIFF_FORMAT_PATCH);
+    PRINT_ERROR;
+
+    const auto patch = IS_OK ? QString::fromUtf8(buf.ptr, static_cast<qsizetype>(buf.size)) : QString{};
+
+    git_buf_dispose(&buf);
+    git_diff_free(diff);
+    git_tree_free(toTree);
+    git_tree_free(fromTree);
+    return patch;
 }
 
 QList<FileStatus> Repository::diffBranch(const QString &from) const
 {
-    const QStringList buffer = QString(runGit({QStringLiteral("diff"), from, QStringLiteral("--name-status")})).split(QLatin1Char('\n'));
-    QList<FileStatus> files;
-    for (const auto &item : buffer) {
-        if (!item.trimmed().size())
-            continue;
-        const auto parts = item.split(QStringLiteral("\t"));
-        if (parts.size() != 2)
-            continue;
+    Q_D(const Repository);
 
-        FileStatus fs;
-        fs.setStatus(parts.at(0));
-        fs.setName(parts.at(1));
-        files.append(fs);
+    auto tree = lookupTree(d->repo, from);
+    if (!tree)
+        return {};
+
+    git_diff *diff{nullptr};
+
+    BEGIN
+    STEP git_diff_tree_to_workdir_with_index(&diff, d->repo, tree, nullptr);
+    PRINT_ERROR;
+
+    QList<FileStatus> files;
+    const auto count = IS_OK ? git_diff_num_deltas(diff) : 0;
+    for (size_t i = 0; i < count; ++i) {
+        const auto delta = git_diff_get_delta(diff, i);
+        files << FileStatus{QString::fromUtf8(delta->new_file.path), toFileStatus(delta->status)};
     }
+
+    git_diff_free(diff);
+    git_tree_free(tree);
     return files;
 }
 
@@ -371,42 +645,7 @@ QList<FileStatus> Repository::diffBranches(const QString &from, const QString &t
         auto delta = git_diff_get_delta(diff, i);
         FileStatus fs;
         fs.mName = delta->new_file.path;
-
-        switch (delta->status) {
-        case GIT_DELTA_UNMODIFIED:
-            fs.mStatus = FileStatus::Unmodified;
-            break;
-        case GIT_DELTA_ADDED:
-            fs.mStatus = FileStatus::Added;
-            break;
-        case GIT_DELTA_DELETED:
-            fs.mStatus = FileStatus::Removed;
-            break;
-        case GIT_DELTA_MODIFIED:
-            fs.mStatus = FileStatus::Modified;
-            break;
-        case GIT_DELTA_RENAMED:
-            fs.mStatus = FileStatus::Renamed;
-            break;
-        case GIT_DELTA_COPIED:
-            fs.mStatus = FileStatus::Copied;
-            break;
-        case GIT_DELTA_IGNORED:
-            fs.mStatus = FileStatus::Ignored;
-            break;
-        case GIT_DELTA_UNTRACKED:
-            fs.mStatus = FileStatus::Untracked;
-            break;
-        case GIT_DELTA_TYPECHANGE:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        case GIT_DELTA_UNREADABLE:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        case GIT_DELTA_CONFLICTED:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        }
+        fs.mStatus = toFileStatus(delta->status);
         files2 << fs;
     }
 
@@ -439,42 +678,7 @@ QList<FileStatus> Repository::diff(AbstractReference *from, AbstractReference *t
         auto delta = git_diff_get_delta(diff, i);
         FileStatus fs;
         fs.mName = delta->new_file.path;
-
-        switch (delta->status) {
-        case GIT_DELTA_UNMODIFIED:
-            fs.mStatus = FileStatus::Unmodified;
-            break;
-        case GIT_DELTA_ADDED:
-            fs.mStatus = FileStatus::Added;
-            break;
-        case GIT_DELTA_DELETED:
-            fs.mStatus = FileStatus::Removed;
-            break;
-        case GIT_DELTA_MODIFIED:
-            fs.mStatus = FileStatus::Modified;
-            break;
-        case GIT_DELTA_RENAMED:
-            fs.mStatus = FileStatus::Renamed;
-            break;
-        case GIT_DELTA_COPIED:
-            fs.mStatus = FileStatus::Copied;
-            break;
-        case GIT_DELTA_IGNORED:
-            fs.mStatus = FileStatus::Ignored;
-            break;
-        case GIT_DELTA_UNTRACKED:
-            fs.mStatus = FileStatus::Untracked;
-            break;
-        case GIT_DELTA_TYPECHANGE:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        case GIT_DELTA_UNREADABLE:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        case GIT_DELTA_CONFLICTED:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        }
+        fs.mStatus = toFileStatus(delta->status);
         files2 << fs;
     }
 
@@ -711,21 +915,6 @@ void Repository::forEachConfig(std::function<void(QString, QString)> calback)
     git_config_free(cfg);
 }
 
-QStringList Repository::readAllNonEmptyOutput(const QStringList &cmd) const
-{
-    QStringList list;
-    const auto out = runGit(cmd).split(QLatin1Char('\n'));
-
-    for (const auto &line : out) {
-        const auto b = line.trimmed();
-        if (b.isEmpty())
-            continue;
-
-        list.append(b.trimmed());
-    }
-    return list;
-}
-
 Repository::Repository(QObject *parent)
     : QObject{parent}
     , d_ptr{new RepositoryPrivate{this}}
@@ -885,36 +1074,23 @@ QStringList Repository::ls(const QString &place) const
 {
     Q_D(const Repository);
 
-    struct wrapper {
-        QStringList files;
-    };
-
     auto cb = [](const char *root, const git_tree_entry *entry, void *payload) -> int {
-        auto w = reinterpret_cast<wrapper *>(payload);
-        qDebug() << QString{root} << QString{git_tree_entry_name(entry)};
-        w->files << QString{root} + QString{git_tree_entry_name(entry)};
+        if (git_tree_entry_type(entry) != GIT_OBJECT_TREE)
+            reinterpret_cast<QStringList *>(payload)->append(QString::fromUtf8(root) + QString::fromUtf8(git_tree_entry_name(entry)));
         return 0;
     };
-    git_tree *tree;
-    git_object *placeObject{nullptr};
-    git_commit *commit{nullptr};
 
+    auto tree = lookupTree(d->repo, place);
+    if (!tree)
+        return {};
+
+    QStringList files;
     BEGIN
-    STEP git_revparse_single(&placeObject, d->repo, place.toLatin1().constData());
-    STEP git_commit_lookup(&commit, d->repo, git_object_id(placeObject));
-    STEP git_commit_tree(&tree, commit);
+    STEP git_tree_walk(tree, GIT_TREEWALK_PRE, cb, &files);
+    PRINT_ERROR;
 
-    wrapper w;
-    STEP git_tree_walk(tree, GIT_TREEWALK_PRE, cb, &w);
-
-    auto buffer = readAllNonEmptyOutput({QStringLiteral("ls-tree"), QStringLiteral("--name-only"), QStringLiteral("-r"), place});
-    QMutableListIterator<QString> it(buffer);
-    while (it.hasNext()) {
-        auto s = it.next();
-        if (s.startsWith(QLatin1String("\"")) && s.endsWith(QLatin1String("\"")))
-            it.setValue(s.mid(1, s.length() - 2));
-    }
-    return buffer;
+    git_tree_free(tree);
+    return files;
 }
 
 QString Repository::fileContent(const QString &place, const QString &fileName) const
@@ -955,19 +1131,31 @@ QString Repository::fileContent(const QString &place, const QString &fileName) c
 
 void Repository::saveFile(const QString &place, const QString &fileName, const QString &localFile) const
 {
-    auto buffer = runGit({QStringLiteral("show"), place + QLatin1Char(':') + fileName});
+    Q_D(const Repository);
+
+    git_object *object{nullptr};
+    git_object *blob{nullptr};
+
+    BEGIN
+    STEP git_revparse_single(&object, d->repo, (place + QLatin1Char(':') + fileName).toUtf8().constData());
+    STEP git_object_peel(&blob, object, GIT_OBJECT_BLOB);
+    PRINT_ERROR;
+
     QFile f{localFile};
-    if (!f.open(QIODevice::WriteOnly))
-        return;
-    f.write(buffer.toUtf8());
-    f.close();
+    if (IS_OK && f.open(QIODevice::WriteOnly)) {
+        const auto b = reinterpret_cast<git_blob *>(blob);
+        f.write(static_cast<const char *>(git_blob_rawcontent(b)), static_cast<qint64>(git_blob_rawsize(b)));
+        f.close();
+    }
+
+    git_object_free(blob);
+    git_object_free(object);
 }
 
 Blame Repository::blame(const QString &filePath, BlameOptions *options)
 {
     Q_D(Repository);
 
-    git_blame *blame;
     git_blame_options opts;
 
     QFile file{d->path + QStringLiteral("/") + filePath};
@@ -977,17 +1165,18 @@ Blame Repository::blame(const QString &filePath, BlameOptions *options)
     auto content = QString{file.readAll()};
     file.close();
 
-    SequenceRunner r;
-    r.run(git_blame_options_init, &opts, GIT_BLAME_OPTIONS_VERSION);
+    if (git_blame_options_init(&opts, GIT_BLAME_OPTIONS_VERSION))
+        return Blame{};
     if (options)
         options->apply(&opts);
 
-    r.run(git_blame_file, &blame, d->repo, filePath.toUtf8().data(), &opts);
+    Blame blame{this, content.split('\n')};
+    const auto ok = blameFile(d->path, filePath, opts, [&blame](const Blame &part) {
+        blame.append(part);
+        return true;
+    });
 
-    if (r.isError())
-        return Blame{};
-
-    return Blame{this, content.split('\n'), blame};
+    return ok ? blame : Blame{};
 }
 
 bool Repository::revertFile(const QString &filePath) const
@@ -1014,48 +1203,87 @@ bool Repository::revertFile(const QString &filePath) const
 QMap<QString, ChangeStatus> Repository::changedFiles() const
 {
     Q_D(const Repository);
+    return changedFiles(StatusOptions::fromConfig(d->repo));
+}
 
-    struct wrapper {
-        QMap<QString, ChangeStatus> files;
-    };
-    auto cb = [](const char *path, unsigned int status_flags, void *payload) -> int {
-        auto w = reinterpret_cast<wrapper *>(payload);
+QMap<QString, ChangeStatus> Repository::changedFiles(const StatusOptions &options) const
+{
+    Q_D(const Repository);
+    return RepositoryPrivate::changedFiles(d->repo, d->path, d->monitoredStatus, options);
+}
 
-        auto status = ChangeStatus::Unknown;
-        if (status_flags & GIT_STATUS_WT_NEW || status_flags & GIT_STATUS_INDEX_NEW)
-            status = ChangeStatus::Added;
-        else if ((status_flags & GIT_STATUS_WT_MODIFIED) || (status_flags & GIT_STATUS_INDEX_MODIFIED))
-            status = ChangeStatus::Modified;
-        else if ((status_flags & GIT_STATUS_WT_DELETED) || (status_flags & GIT_STATUS_INDEX_DELETED))
-            status = ChangeStatus::Removed;
-        else if ((status_flags & GIT_STATUS_WT_RENAMED) || (status_flags & GIT_STATUS_INDEX_RENAMED))
-            status = ChangeStatus::Renamed;
-        else if (status_flags & GIT_STATUS_IGNORED)
-            status = ChangeStatus::Ignored;
-        else
-            status = ChangeStatus::Unknown;
-        //        if (status_flags & GIT_STATUS_INDEX_TYPECHANGE) status = ChangeStatus::ty ;
+QFuture<QMap<QString, ChangeStatus>> Repository::changedFilesInBackground() const
+{
+    Q_D(const Repository);
 
-        w->files.insert(QString{path}, status);
-        return 0;
-    };
+    return QtConcurrent::run([path = d->path, monitoredStatus = d->monitoredStatus] {
+        // libgit2 handles are not to be shared between threads.
+        git_repository *repo{nullptr};
+        if (git_repository_open_ext(&repo, path.toUtf8().constData(), 0, nullptr))
+            return QMap<QString, ChangeStatus>{};
 
-    wrapper w;
-    git_status_options opts;
-    git_status_options_init(&opts, GIT_STATUS_OPTIONS_VERSION);
-    opts.show = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
-    opts.flags = GIT_STATUS_OPT_DEFAULTS | GIT_STATUS_OPT_EXCLUDE_SUBMODULES
-        /*GIT_STATUS_OPT_INCLUDE_UNTRACKED | GIT_STATUS_OPT_INCLUDE_IGNORED |
-   GIT_STATUS_OPT_INCLUDE_UNMODIFIED | GIT_STATUS_OPT_EXCLUDE_SUBMODULES | GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS | GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH
-   | GIT_STATUS_OPT_RECURSE_IGNORED_DIRS | GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX | GIT_STATUS_OPT_RENAMES_INDEX_TO_WORKDIR |
-   GIT_STATUS_OPT_SORT_CASE_SENSITIVELY | GIT_STATUS_OPT_SORT_CASE_INSENSITIVELY | GIT_STATUS_OPT_RENAMES_FROM_REWRITES | GIT_STATUS_OPT_NO_REFRESH |
-   GIT_STATUS_OPT_UPDATE_INDEX | GIT_STATUS_OPT_INCLUDE_UNREADABLE | GIT_STATUS_OPT_INCLUDE_UNREADABLE_AS_UNTRACKED*/
-        ;
+        auto files = RepositoryPrivate::changedFiles(repo, path, monitoredStatus, StatusOptions::fromConfig(repo));
+        git_repository_free(repo);
+        return files;
+    });
+}
+
+QMap<QString, ChangeStatus> RepositoryPrivate::changedFiles(git_repository *repo,
+                                                            const QString &workingDirectory,
+                                                            const std::shared_ptr<MonitoredStatus> &monitoredStatus,
+                                                            const StatusOptions &options)
+{
+    if (options.fsMonitorHook.isEmpty())
+        return status(repo, options);
+    return monitoredStatus->changedFiles(repo, workingDirectory, options);
+}
+
+QMap<QString, ChangeStatus>
+RepositoryPrivate::MonitoredStatus::changedFiles(git_repository *repo, const QString &workingDirectory, const StatusOptions &options)
+{
+    QMutexLocker locker{&mutex};
+
+    if (!monitor || monitor->hook() != options.fsMonitorHook)
+        monitor.reset(new FsMonitor{options.fsMonitorHook, workingDirectory});
 
-    git_status_foreach_ext(d->repo, &opts, cb, &w);
+    auto changes = monitor->query();
 
-    //    git_status_foreach(_repo, cb, &w);
-    return w.files;
+    // Staging, committing or switching branches changes what the files are compared with,
+    // which the hook knows nothing about.
+    if (changes.everything || this->options != options || stamp != statusStamp(repo)) {
+        this->options = options;
+        files = status(repo, options);
+        stamp = statusStamp(repo);
+        return files;
+    }
+
+    if (changes.paths.isEmpty())
+        return files;
+
+    QStringList paths;
+    for (auto path : std::as_const(changes.paths)) {
+        if (path.endsWith(QLatin1Char('/')))
+            path.chop(1);
+
+        // A file inside a directory listed as a whole changes the directory, as does a new
+        // file in a new one.
+        if (options.untrackedFiles == StatusOptions::UntrackedFiles::Normal)
+            path = untrackedRoot(repo, path);
+
+        if (path.isEmpty() || paths.contains(path))
+            continue;
+        paths << path;
+
+        const auto prefix = path + QLatin1Char('/');
+        files.remove(path);
+        auto it = files.lowerBound(prefix);
+        while (it != files.end() && it.key().startsWith(prefix))
+            it = files.erase(it);
+    }
+
+    files.insert(status(repo, options, paths));
+    stamp = statusStamp(repo);
+    return files;
 }
 
 bool Repository::commit(const QString &message)
@@ -1415,6 +1643,85 @@ RepositoryPrivate::~RepositoryPrivate()
         git_repository_free(repo);
 }
 
+QMap<QString, ChangeStatus> RepositoryPrivate::status(git_repository *repo, const StatusOptions &options, const QStringList &paths)
+{
+    auto cb = [](const char *path, unsigned int status_flags, void *payload) -> int {
+        auto files = reinterpret_cast<QMap<QString, ChangeStatus> *>(payload);
+
+        auto status = ChangeStatus::Unknown;
+        if (status_flags & GIT_STATUS_WT_NEW || status_flags & GIT_STATUS_INDEX_NEW)
+            status = ChangeStatus::Added;
+        else if ((status_flags & GIT_STATUS_WT_MODIFIED) || (status_flags & GIT_STATUS_INDEX_MODIFIED))
+            status = ChangeStatus::Modified;
+        else if ((status_flags & GIT_STATUS_WT_DELETED) || (status_flags & GIT_STATUS_INDEX_DELETED))
+            status = ChangeStatus::Removed;
+        else if ((status_flags & GIT_STATUS_WT_RENAMED) || (status_flags & GIT_STATUS_INDEX_RENAMED))
+            status = ChangeStatus::Renamed;
+        else if (status_flags & GIT_STATUS_IGNORED)
+            status = ChangeStatus::Ignored;
+        else
+            status = ChangeStatus::Unknown;
+        //        if (status_flags & GIT_STATUS_INDEX_TYPECHANGE) status = ChangeStatus::ty ;
+
+        files->insert(QString{path}, status);
+        return 0;
+    };
+
+    StrArray pathspec{paths};
+
+    git_status_options opts;
+    git_status_options_init(&opts, GIT_STATUS_OPTIONS_VERSION);
+    options.applyToStatusOptions(&opts);
+    if (!paths.isEmpty()) {
+        opts.pathspec = **pathspec;
+        opts.flags |= GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+    }
+
+    QMap<QString, ChangeStatus> files;
+    if (git_status_foreach_ext(repo, &opts, cb, &files) && (opts.flags & GIT_STATUS_OPT_UPDATE_INDEX)) {
+        // Most likely GIT_ELOCKED, someone else holding index.lock; look without writing the
+        // index back rather than come back empty.
+        files.clear();
+        opts.flags &= ~GIT_STATUS_OPT_UPDATE_INDEX;
+        git_status_foreach_ext(repo, &opts, cb, &files);
+    }
+    return files;
+}
+
+QByteArray RepositoryPrivate::statusStamp(git_repository *repo)
+{
+    QByteArray stamp;
+
+    const QFileInfo index{QString::fromUtf8(git_repository_path(repo)) + QStringLiteral("index")};
+    if (index.exists())
+        stamp = QByteArray::number(index.lastModified().toMSecsSinceEpoch()) + ' ' + QByteArray::number(index.size());
+
+    git_oid head;
+    if (!git_reference_name_to_id(&head, repo, "HEAD"))
+        stamp += ' ' + QByteArray{reinterpret_cast<const char *>(head.id), GIT_OID_SHA1_SIZE};
+
+    return stamp;
+}
+
+QString RepositoryPrivate::untrackedRoot(git_repository *repo, const QString &path)
+{
+    git_index *index{nullptr};
+    if (git_repository_index(&index, repo))
+        return path;
+
+    auto root = path;
+    for (auto slash = root.lastIndexOf(QLatin1Char('/')); slash > 0; slash = root.lastIndexOf(QLatin1Char('/'))) {
+        const auto parent = root.left(slash);
+        size_t pos;
+        if (git_index_find_prefix(&pos, index, (parent + QLatin1Char('/')).toUtf8().constData()) != GIT_ENOTFOUND)
+            break;
+        root = parent;
+    }
+
+    git_index_free(index);
+    return root;
+}
+
 void RepositoryPrivate::changeRepo(git_repository *repo)
 {
     Q_Q(Repository);
@@ -1432,6 +1739,9 @@ void RepositoryPrivate::changeRepo(git_repository *repo)
 
     isValid = repo;
 
+    // A look still running for the old repository keeps the old state to itself.
+    monitoredStatus = std::make_shared<MonitoredStatus>();
+
     resetCaches();
 }
 
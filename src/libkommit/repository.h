@@ -10,6 +10,7 @@
 
 #include <git2.h>
 
+#include <QFuture>
 #include <QObject>
 #include <QScopedPointer>
 #include <QSharedPointer>
@@ -49,6 +50,7 @@ class File;
 class TreeDiff;
 struct BlameDataRow;
 class BlameOptions;
+class StatusOptions;
 class Blame;
 class BlameData;
 
@@ -120,9 +122,21 @@ public:
     void saveFile(const QString &place, const QString &fileName, const QString &localFile) const;
     bool revertFile(const QString &filePath) const;
     bool removeFile(const QString &file, bool cached) const;
+    /// The hashes of the commits from HEAD that change @p fileName, as git log -- fileName lists them.
     [[nodiscard]] QStringList fileLog(const QString &fileName) const;
     Blame blame(const QString &filePath, BlameOptions *options = nullptr);
+    /// The changed files of the working tree, looked at as the configuration asks for; see
+    /// StatusOptions::fromConfig().
     [[nodiscard]] QMap<QString, ChangeStatus> changedFiles() const;
+    /**
+     * The changed files of the working tree, looked at as @p options asks for. With an
+     * fsmonitor hook, the result is kept between calls and only the paths the hook reports as
+     * changed are looked at again, unless the index or HEAD has moved in the meantime.
+     */
+    [[nodiscard]] QMap<QString, ChangeStatus> changedFiles(const StatusOptions &options) const;
+    /// As changedFiles(), on a worker thread with a repository handle of its own, so an
+    /// fsmonitor hook or a large working tree does not hold up the caller.
+    [[nodiscard]] QFuture<QMap<QString, ChangeStatus>> changedFilesInBackground() const;
     [[nodiscard]] QMap<QString, ChangeStatus> changedFiles(const QString &hash) const;
     [[nodiscard]] QStringList ignoredFiles() const;
 
@@ -133,6 +147,7 @@ public:
     bool isIgnored(const QString &path);
 
     // diffs
+    /// The patch between two revisions, or between @p from and the working tree when @p to is empty.
     [[nodiscard]] QString diff(const QString &from, const QString &to) const;
     [[nodiscard]] QList<FileStatus> diffBranch(const QString &from) const;
     [[nodiscard]] QList<FileStatus> diffBranches(const QString &from, const QString &to) const;
@@ -176,7 +191,6 @@ Q_SIGNALS:
 private:
     QScopedPointer<RepositoryPrivate> d_ptr;
     Q_DECLARE_PRIVATE(Repository)
-    LIBKOMMIT_NO_EXPORT QStringList readAllNonEmptyOutput(const QStringList &cmd) const;
 };
 
 } // namespace Git
@@ -0,0 +1,729 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "trigramindex.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <QUuid>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include <git2/blob.h>
+#include <git2/commit.h>
+#include <git2/diff.h>
+#include <git2/refs.h>
+#include <git2/repository.h>
+#include <git2/revwalk.h>
+
+namespace Git
+{
+
+namespace
+{
+
+constexpr quint32 manifestMagic{0x4b544749}; // KTGI
+constexpr quint32 manifestVersion{1};
+constexpr char segmentMagic[4]{'K', 'T', 'G', 'S'};
+constexpr quint32 segmentVersion{1};
+
+// Blobs larger than this are listed without trigrams; a file that big is rarely source and
+// would have most trigrams there are anyway.
+constexpr qint64 maxIndexedSize{1024 * 1024};
+
+// What a blob in a segment costs in memory while being gathered, besides its path and its
+// postings.
+constexpr qint64 blobOverhead{96};
+
+const QString manifestName{QStringLiteral("manifest")};
+
+enum BlobFlag : quint32 {
+    // Listed without trigrams, for being binary or too large.
+    NotIndexed = 1,
+};
+
+// A segment file is this header, the blobs sorted by id, the trigrams in ascending order, the
+// postings of each trigram one after the other, and the paths.
+struct SegmentHeader {
+    char magic[4];
+    quint32 version;
+    quint32 blobCount;
+    quint32 trigramCount;
+    quint32 postingCount;
+    quint32 pathBytes;
+};
+
+struct BlobEntry {
+    git_oid blob;
+    git_oid commit;
+    quint32 pathOffset;
+    quint32 pathLength;
+    quint32 flags;
+};
+
+struct TrigramEntry {
+    quint32 trigram;
+    quint32 offset;
+    quint32 count;
+};
+
+static_assert(sizeof(SegmentHeader) == 24);
+static_assert(sizeof(BlobEntry) == 52);
+static_assert(sizeof(TrigramEntry) == 12);
+
+constexpr uchar fold(uchar c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<uchar>(c - 'A' + 'a') : c;
+}
+
+// The trigrams of @p data, sorted and each once.
+void trigramsOf(const char *data, qsizetype size, std::vector<quint32> &trigrams)
+{
+    trigrams.clear();
+    if (size < 3)
+        return;
+
+    trigrams.reserve(size - 2);
+    auto trigram = quint32{fold(data[0])} << 8 | fold(data[1]);
+    for (qsizetype i = 2; i < size; ++i) {
+        trigram = (trigram << 8 | fold(data[i])) & 0xffffff;
+        trigrams.push_back(trigram);
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+bool oidLess(const git_oid &a, const git_oid &b)
+{
+    return git_oid_cmp(&a, &b) < 0;
+}
+
+// What an update has gathered and not written yet.
+struct Batch {
+    struct Blob {
+        git_oid blob;
+        git_oid commit;
+        QByteArray path;
+        quint32 flags;
+    };
+
+    QList<Blob> blobs;
+    QHash<git_oid, quint32> ordinals;
+    // The blobs, by their place in blobs, that have each trigram, in ascending order.
+    QHash<quint32, std::vector<quint32>> postings;
+    qint64 memory{0};
+
+    void add(const git_oid &blob, const git_oid &commit, const QByteArray &path, quint32 flags, const std::vector<quint32> &trigrams)
+    {
+        const auto ordinal = static_cast<quint32>(blobs.size());
+        blobs << Blob{blob, commit, path, flags};
+        ordinals.insert(blob, ordinal);
+        memory += blobOverhead + path.size();
+
+        for (const auto trigram : trigrams) {
+            auto &list = postings[trigram];
+            if (list.empty())
+                memory += blobOverhead;
+            list.push_back(ordinal);
+            memory += sizeof(quint32);
+        }
+    }
+
+    void clear()
+    {
+        blobs.clear();
+        ordinals.clear();
+        postings.clear();
+        memory = 0;
+    }
+
+    bool write(const QString &fileName) const
+    {
+        // The blobs go sorted by id, so they can be looked up in place.
+        QList<quint32> order(blobs.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [this](quint32 a, quint32 b) {
+            return oidLess(blobs.at(a).blob, blobs.at(b).blob);
+        });
+        QList<quint32> renumbered(blobs.size());
+        for (qsizetype i = 0; i < order.size(); ++i)
+            renumbered[order.at(i)] = static_cast<quint32>(i);
+
+        QList<quint32> keys = postings.keys();
+        std::sort(keys.begin(), keys.end());
+
+        QByteArray paths;
+        QList<BlobEntry> blobEntries;
+        blobEntries.reserve(blobs.size());
+        for (const auto ordinal : std::as_const(order)) {
+            const auto &blob = blobs.at(ordinal);
+            blobEntries << BlobEntry{blob.blob, blob.commit, static_cast<quint32>(paths.size()), static_cast<quint32>(blob.path.size()), blob.flags};
+            paths += blob.path;
+        }
+
+        QList<TrigramEntry> trigramEntries;
+        trigramEntries.reserve(keys.size());
+        std::vector<quint32> allPostings;
+        for (const auto key : std::as_const(keys)) {
+            const auto &list = *postings.constFind(key);
+            const auto offset = allPostings.size();
+            for (const auto ordinal : list)
+                allPostings.push_back(renumbered.at(ordinal));
+            std::sort(allPostings.begin() + offset, allPostings.end());
+            trigramEntries << TrigramEntry{key, static_cast<quint32>(offset), static_cast<quint32>(list.size())};
+        }
+
+        SegmentHeader header{};
+        std::memcpy(header.magic, segmentMagic, sizeof(segmentMagic));
+        header.version = segmentVersion;
+        header.blobCount = static_cast<quint32>(blobEntries.size());
+        header.trigramCount = static_cast<quint32>(trigramEntries.size());
+        header.postingCount = static_cast<quint32>(allPostings.size());
+        header.pathBytes = static_cast<quint32>(paths.size());
+
+        QSaveFile file{fileName};
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(blobEntries.constData()), blobEntries.size() * sizeof(BlobEntry));
+        file.write(reinterpret_cast<const char *>(trigramEntries.constData()), trigramEntries.size() * sizeof(TrigramEntry));
+        file.write(reinterpret_cast<const char *>(allPostings.data()), allPostings.size() * sizeof(quint32));
+        file.write(paths);
+        return file.commit();
+    }
+};
+
+// The commits the references point to, sorted and each once.
+QList<git_oid> referenceTips(git_repository *repo)
+{
+    QList<git_oid> tips;
+    git_reference_iterator *iterator{nullptr};
+    if (git_reference_iterator_new(&iterator, repo))
+        return tips;
+
+    git_reference *reference{nullptr};
+    while (!git_reference_next(&reference, iterator)) {
+        git_object *commit{nullptr};
+        if (!git_reference_peel(&commit, reference, GIT_OBJECT_COMMIT)) {
+            tips << *git_object_id(commit);
+            git_object_free(commit);
+        }
+        git_reference_free(reference);
+    }
+    git_reference_iterator_free(iterator);
+
+    std::sort(tips.begin(), tips.end(), oidLess);
+    tips.erase(std::unique(tips.begin(), tips.end()), tips.end());
+    return tips;
+}
+
+// Set once the application is going away, for a background update not to hold it up.
+std::atomic<bool> shuttingDown{false};
+
+}
+
+class TrigramIndex::Segment
+{
+public:
+    ~Segment()
+    {
+        if (mData)
+            mFile.unmap(const_cast<uchar *>(mData));
+    }
+
+    bool open(const QString &fileName)
+    {
+        mFile.setFileName(fileName);
+        if (!mFile.open(QIODevice::ReadOnly))
+            return false;
+
+        const auto size = mFile.size();
+        if (size < qint64(sizeof(SegmentHeader)))
+            return false;
+        mData = mFile.map(0, size);
+        // The map outlives the file being closed, and a descriptor kept open for each segment
+        // adds up.
+        mFile.close();
+        if (!mData)
+            return false;
+
+        mHeader = reinterpret_cast<const SegmentHeader *>(mData);
+        if (std::memcmp(mHeader->magic, segmentMagic, sizeof(segmentMagic)) || mHeader->version != segmentVersion)
+            return false;
+
+        const auto expected = qint64(sizeof(SegmentHeader)) + qint64(mHeader->blobCount) * sizeof(BlobEntry) + qint64(mHeader->trigramCount) * sizeof(TrigramEntry)
+            + qint64(mHeader->postingCount) * sizeof(quint32) + mHeader->pathBytes;
+        if (size != expected)
+            return false;
+
+        mBlobs = reinterpret_cast<const BlobEntry *>(mData + sizeof(SegmentHeader));
+        mTrigrams = reinterpret_cast<const TrigramEntry *>(mBlobs + mHeader->blobCount);
+        mPostings = reinterpret_cast<const quint32 *>(mTrigrams + mHeader->trigramCount);
+        mPaths = reinterpret_cast<const char *>(mPostings + mHeader->postingCount);
+        return true;
+    }
+
+    [[nodiscard]] QString fileName() const
+    {
+        return mFile.fileName();
+    }
+
+    [[nodiscard]] quint32 blobCount() const
+    {
+        return mHeader->blobCount;
+    }
+
+    [[nodiscard]] const BlobEntry *find(const git_oid &blob) const
+    {
+        const auto end = mBlobs + mHeader->blobCount;
+        const auto it = std::lower_bound(mBlobs, end, blob, [](const BlobEntry &entry, const git_oid &id) {
+            return oidLess(entry.blob, id);
+        });
+        return it != end && git_oid_equal(&it->blob, &blob) ? it : nullptr;
+    }
+
+    [[nodiscard]] const BlobEntry &blob(quint32 ordinal) const
+    {
+        return mBlobs[ordinal];
+    }
+
+    // What gathering it into a Batch again would take, counted as Batch::add() does.
+    [[nodiscard]] qint64 memory() const
+    {
+        return (blobOverhead * mHeader->blobCount) + mHeader->pathBytes + (blobOverhead * mHeader->trigramCount)
+            + qint64(sizeof(quint32)) * mHeader->postingCount;
+    }
+
+    // Adds every blob of the segment to @p batch, with its trigrams.
+    void addTo(Batch &batch) const
+    {
+        const auto base = static_cast<quint32>(batch.blobs.size());
+        for (quint32 i = 0; i < mHeader->blobCount; ++i) {
+            const auto &entry = mBlobs[i];
+            batch.blobs << Batch::Blob{entry.blob, entry.commit, QByteArray{mPaths + entry.pathOffset, entry.pathLength}, entry.flags};
+            batch.ordinals.insert(entry.blob, base + i);
+        }
+        for (quint32 i = 0; i < mHeader->trigramCount; ++i) {
+            const auto &entry = mTrigrams[i];
+            auto &list = batch.postings[entry.trigram];
+            for (auto it = mPostings + entry.offset; it != mPostings + entry.offset + entry.count; ++it)
+                list.push_back(base + *it);
+        }
+        batch.memory += memory();
+    }
+
+    // The blobs that have @p trigram, in ascending order.
+    [[nodiscard]] std::pair<const quint32 *, const quint32 *> postings(quint32 trigram) const
+    {
+        const auto end = mTrigrams + mHeader->trigramCount;
+        const auto it = std::lower_bound(mTrigrams, end, trigram, [](const TrigramEntry &entry, quint32 value) {
+            return entry.trigram < value;
+        });
+        if (it == end || it->trigram != trigram)
+            return {nullptr, nullptr};
+        return {mPostings + it->offset, mPostings + it->offset + it->count};
+    }
+
+    [[nodiscard]] QString path(const BlobEntry &entry) const
+    {
+        return QString::fromUtf8(mPaths + entry.pathOffset, entry.pathLength);
+    }
+
+private:
+    QFile mFile;
+    const uchar *mData{nullptr};
+    const SegmentHeader *mHeader{nullptr};
+    const BlobEntry *mBlobs{nullptr};
+    const TrigramEntry *mTrigrams{nullptr};
+    const quint32 *mPostings{nullptr};
+    const char *mPaths{nullptr};
+};
+
+TrigramIndex::TrigramIndex(const QString &directory)
+    : mDirectory{directory}
+{
+}
+
+TrigramIndex::~TrigramIndex() = default;
+
+QString TrigramIndex::defaultDirectory(const QString &repositoryPath)
+{
+    const auto key = QCryptographicHash::hash(QDir{repositoryPath}.canonicalPath().toUtf8(), QCryptographicHash::Sha1);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/trigramindex/") + QString::fromLatin1(key.toHex());
+}
+
+bool TrigramIndex::exists(const QString &directory)
+{
+    return QFile::exists(directory + QLatin1Char('/') + manifestName);
+}
+
+bool TrigramIndex::readManifest(QList<git_oid> *tips, QStringList *segments) const
+{
+    QFile file{mDirectory + QLatin1Char('/') + manifestName};
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream{&file};
+    quint32 magic{0};
+    quint32 version{0};
+    QList<QByteArray> rawTips;
+    stream >> magic >> version;
+    if (magic != manifestMagic || version != manifestVersion)
+        return false;
+    stream >> rawTips >> *segments;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    for (const auto &raw : std::as_const(rawTips)) {
+        if (raw.size() != GIT_OID_SHA1_SIZE)
+            return false;
+        git_oid oid;
+        git_oid_fromraw(&oid, reinterpret_cast<const unsigned char *>(raw.constData()));
+        *tips << oid;
+    }
+    return true;
+}
+
+bool TrigramIndex::writeManifest(const QList<git_oid> &tips) const
+{
+    QList<QByteArray> rawTips;
+    for (const auto &tip : tips)
+        rawTips << QByteArray{reinterpret_cast<const char *>(tip.id), GIT_OID_SHA1_SIZE};
+
+    QStringList segments;
+    for (const auto &segment : mSegments)
+        segments << QFileInfo{segment->fileName()}.fileName();
+
+    QSaveFile file{mDirectory + QLatin1Char('/') + manifestName};
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream stream{&file};
+    stream << manifestMagic << manifestVersion << rawTips << segments;
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+bool TrigramIndex::load()
+{
+    mSegments.clear();
+
+    QList<git_oid> tips;
+    QStringList segments;
+    if (!readManifest(&tips, &segments))
+        return false;
+
+    for (const auto &name : std::as_const(segments)) {
+        auto segment = std::make_unique<Segment>();
+        if (!segment->open(mDirectory + QLatin1Char('/') + name)) {
+            mSegments.clear();
+            return false;
+        }
+        mSegments.push_back(std::move(segment));
+    }
+    return true;
+}
+
+qsizetype TrigramIndex::blobCount() const
+{
+    qsizetype count{0};
+    for (const auto &segment : mSegments)
+        count += segment->blobCount();
+    return count;
+}
+
+int TrigramIndex::segmentCount() const
+{
+    return static_cast<int>(mSegments.size());
+}
+
+bool TrigramIndex::isKnown(const git_oid &blob) const
+{
+    return std::any_of(mSegments.cbegin(), mSegments.cend(), [&blob](const std::unique_ptr<Segment> &segment) {
+        return segment->find(blob) != nullptr;
+    });
+}
+
+bool TrigramIndex::covers(const git_oid &blob) const
+{
+    for (const auto &segment : mSegments)
+        if (const auto entry = segment->find(blob))
+            return !(entry->flags & NotIndexed);
+    return false;
+}
+
+bool TrigramIndex::candidates(const QString &text, bool caseSensitive, QSet<git_oid> *result) const
+{
+    result->clear();
+
+    const auto bytes = text.toUtf8();
+    std::vector<quint32> trigrams;
+    for (qsizetype i = 2; i < bytes.size(); ++i) {
+        const auto a = static_cast<uchar>(bytes.at(i - 2));
+        const auto b = static_cast<uchar>(bytes.at(i - 1));
+        const auto c = static_cast<uchar>(bytes.at(i));
+        // The index folds ASCII letters only; other bytes of a text matched in any case can be
+        // in a blob in another case, so they give no trigram to rely on.
+        if (!caseSensitive && (a > 127 || b > 127 || c > 127))
+            continue;
+        trigrams.push_back(quint32{fold(a)} << 16 | quint32{fold(b)} << 8 | fold(c));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    if (trigrams.empty())
+        return false;
+
+    for (const auto &segment : mSegments) {
+        std::vector<std::pair<const quint32 *, const quint32 *>> lists;
+        lists.reserve(trigrams.size());
+        for (const auto trigram : trigrams)
+            lists.push_back(segment->postings(trigram));
+
+        // The shortest list first, as the intersection is never longer than it.
+        std::sort(lists.begin(), lists.end(), [](const auto &a, const auto &b) {
+            return a.second - a.first < b.second - b.first;
+        });
+        if (lists.front().first == lists.front().second)
+            continue;
+
+        std::vector<quint32> current(lists.front().first, lists.front().second);
+        std::vector<quint32> next;
+        for (size_t i = 1; i < lists.size() && !current.empty(); ++i) {
+            next.clear();
+            std::set_intersection(current.cbegin(), current.cend(), lists.at(i).first, lists.at(i).second, std::back_inserter(next));
+            current.swap(next);
+        }
+
+        for (const auto ordinal : current)
+            result->insert(segment->blob(ordinal).blob);
+    }
+    return true;
+}
+
+TrigramIndex::Origin TrigramIndex::origin(const git_oid &blob) const
+{
+    for (const auto &segment : mSegments)
+        if (const auto entry = segment->find(blob))
+            return {entry->commit, segment->path(*entry)};
+    return {git_oid{}, QString{}};
+}
+
+bool TrigramIndex::update(const QString &repositoryPath, qint64 memoryBudget, const std::atomic<bool> *canceled, UpdateStats *stats)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!QDir{}.mkpath(mDirectory))
+        return false;
+    QLockFile lock{mDirectory + QStringLiteral("/lock")};
+    if (!lock.tryLock(0))
+        return false;
+
+    git_repository *repo{nullptr};
+    if (git_repository_open_ext(&repo, repositoryPath.toUtf8().constData(), 0, nullptr))
+        return false;
+
+    // What is on disk now, another update having possibly run since load().
+    QList<git_oid> indexedTips;
+    load();
+    {
+        QStringList segments;
+        readManifest(&indexedTips, &segments);
+    }
+
+    const auto tips = referenceTips(repo);
+    UpdateStats local;
+    auto &s = stats ? *stats : local;
+    s = UpdateStats{};
+
+    git_revwalk *walk{nullptr};
+    if (git_revwalk_new(&walk, repo)) {
+        git_repository_free(repo);
+        return false;
+    }
+    // Parents first, so a blob is put on the commit that added it.
+    git_revwalk_sorting(walk, GIT_SORT_TOPOLOGICAL | GIT_SORT_REVERSE);
+    for (const auto &tip : tips)
+        git_revwalk_push(walk, &tip);
+    for (const auto &tip : std::as_const(indexedTips))
+        git_revwalk_hide(walk, &tip);
+
+    Batch batch;
+    std::vector<quint32> trigrams;
+    auto ok{true};
+
+    const auto flush = [&]() {
+        if (batch.blobs.isEmpty())
+            return true;
+        const auto fileName = mDirectory + QLatin1Char('/') + QUuid::createUuid().toString(QUuid::Id128) + QStringLiteral(".seg");
+        auto segment = std::make_unique<Segment>();
+        if (!batch.write(fileName) || !segment->open(fileName))
+            return false;
+        mSegments.push_back(std::move(segment));
+        batch.clear();
+        ++s.segments;
+        // Usable right away, though the commits indexed are only recorded at the end.
+        return writeManifest(indexedTips);
+    };
+
+    git_oid commitId;
+    while (ok && !git_revwalk_next(&commitId, walk)) {
+        if ((canceled && *canceled) || shuttingDown) {
+            ok = false;
+            break;
+        }
+
+        git_commit *commit{nullptr};
+        git_commit *parent{nullptr};
+        git_tree *tree{nullptr};
+        git_tree *parentTree{nullptr};
+        git_diff *diff{nullptr};
+        if (!git_commit_lookup(&commit, repo, &commitId) && !git_commit_tree(&tree, commit)) {
+            if (git_commit_parentcount(commit) && !git_commit_parent(&parent, commit, 0))
+                git_commit_tree(&parentTree, parent);
+
+            if (!git_diff_tree_to_tree(&diff, repo, parentTree, tree, nullptr)) {
+                const auto count = git_diff_num_deltas(diff);
+                for (size_t i = 0; i < count; ++i) {
+                    const auto delta = git_diff_get_delta(diff, i);
+                    const auto &id = delta->new_file.id;
+                    if (git_oid_is_zero(&id) || (delta->new_file.mode != GIT_FILEMODE_BLOB && delta->new_file.mode != GIT_FILEMODE_BLOB_EXECUTABLE))
+                        continue;
+                    if (batch.ordinals.contains(id) || isKnown(id))
+                        continue;
+
+                    git_blob *blob{nullptr};
+                    if (git_blob_lookup(&blob, repo, &id))
+                        continue;
+
+                    const auto size = static_cast<qsizetype>(git_blob_rawsize(blob));
+                    quint32 flags{0};
+                    if (size > maxIndexedSize || git_blob_is_binary(blob)) {
+                        flags = NotIndexed;
+                        trigrams.clear();
+                    } else {
+                        trigramsOf(static_cast<const char *>(git_blob_rawcontent(blob)), size, trigrams);
+                        s.bytes += size;
+                    }
+                    git_blob_free(blob);
+
+                    batch.add(id, commitId, delta->new_file.path, flags, trigrams);
+                    ++s.blobs;
+
+                    if (batch.memory >= memoryBudget && !flush()) {
+                        ok = false;
+                        break;
+                    }
+                }
+                git_diff_free(diff);
+            }
+            ++s.commits;
+        }
+        git_tree_free(parentTree);
+        git_tree_free(tree);
+        git_commit_free(parent);
+        git_commit_free(commit);
+    }
+
+    git_revwalk_free(walk);
+    git_repository_free(repo);
+
+    if (!flush())
+        ok = false;
+    if (ok)
+        ok = writeManifest(tips);
+    if (ok)
+        ok = compact(memoryBudget, tips);
+
+    s.elapsed = timer.elapsed();
+    return ok;
+}
+
+bool TrigramIndex::compact(qint64 memoryBudget, const QList<git_oid> &tips)
+{
+    if (mSegments.size() <= size_t{maxSegments})
+        return true;
+
+    while (mSegments.size() > size_t{maxSegments}) {
+        // The smallest, as many as fit in the budget together.
+        std::vector<size_t> order(mSegments.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return mSegments.at(a)->memory() < mSegments.at(b)->memory();
+        });
+        qint64 memory{0};
+        size_t count{0};
+        while (count < order.size() && memory + mSegments.at(order.at(count))->memory() <= memoryBudget)
+            memory += mSegments.at(order.at(count++))->memory();
+        if (count < 2)
+            break;
+        order.resize(count);
+        std::sort(order.begin(), order.end());
+
+        Batch batch;
+        for (const auto i : order)
+            mSegments.at(i)->addTo(batch);
+
+        const auto fileName = mDirectory + QLatin1Char('/') + QUuid::createUuid().toString(QUuid::Id128) + QStringLiteral(".seg");
+        auto merged = std::make_unique<Segment>();
+        if (!batch.write(fileName) || !merged->open(fileName)) {
+            QFile::remove(fileName);
+            return false;
+        }
+
+        for (auto it = order.crbegin(); it != order.crend(); ++it)
+            mSegments.erase(mSegments.begin() + static_cast<std::ptrdiff_t>(*it));
+        mSegments.push_back(std::move(merged));
+    }
+    if (!writeManifest(tips))
+        return false;
+
+    // The segments not listed any more, and any a previous compaction could not remove while
+    // another index had them mapped.
+    QSet<QString> listed;
+    for (const auto &segment : mSegments)
+        listed << QFileInfo{segment->fileName()}.fileName();
+    const auto names = QDir{mDirectory}.entryList({QStringLiteral("*.seg")}, QDir::Files);
+    for (const auto &name : names)
+        if (!listed.contains(name))
+            QFile::remove(mDirectory + QLatin1Char('/') + name);
+    return true;
+}
+
+QFuture<bool> TrigramIndex::updateInBackground(const QString &repositoryPath)
+{
+    static QThreadPool pool;
+    static const auto init = [] {
+        // One at a time, and at low priority: the index only ever saves time later.
+        pool.setMaxThreadCount(1);
+        pool.setThreadPriority(QThread::LowestPriority);
+        qAddPostRoutine([] {
+            shuttingDown = true;
+        });
+        return true;
+    }();
+    Q_UNUSED(init)
+
+    return QtConcurrent::run(&pool, [repositoryPath] {
+        TrigramIndex index{defaultDirectory(repositoryPath)};
+        return index.update(repositoryPath);
+    });
+}
+
+}
@@ -0,0 +1,126 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommit_export.h"
+
+#include <QFuture>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <Kommit/Oid>
+
+namespace Git
+{
+
+/**
+ * A trigram index of the contents of every blob in the history of a repository, kept on
+ * disk, for ContentSearch to rule out the blobs that cannot contain a text without reading
+ * them.
+ *
+ * For each blob it holds the runs of three bytes found in it, ASCII letters folded to lower
+ * case, and where the blob first showed up: a commit and a path. A text can only be in a blob
+ * that has every trigram of the text, so intersecting their postings gives the blobs that
+ * can contain it, which a search still has to read to be sure.
+ *
+ * The index is a set of segment files that are never changed once written, read through
+ * memory maps, and a manifest listing them with the references indexed up to. update() only
+ * walks the commits that are new since, and only reads the blobs they add, writing a segment
+ * whenever what it has gathered reaches a memory budget. Once there are more than
+ * maxSegments, as each update writes one however little it found, the smallest are merged
+ * into one as far as the memory budget allows. Blobs that look binary, or are large, are
+ * listed without trigrams, and always have to be read.
+ *
+ * The files are meant to be read back by the same build on the same machine.
+ */
+class LIBKOMMIT_EXPORT TrigramIndex
+{
+public:
+    struct Origin {
+        git_oid commit;
+        QString path;
+    };
+
+    struct UpdateStats {
+        qint64 commits{0};
+        // Blobs added to the index, with or without trigrams.
+        qint64 blobs{0};
+        qint64 bytes{0};
+        int segments{0};
+        // In milliseconds.
+        qint64 elapsed{0};
+    };
+
+    static constexpr qint64 defaultMemoryBudget{64 * 1024 * 1024};
+    static constexpr int maxSegments{16};
+
+    /// The index kept in @p directory; nothing is read before load().
+    explicit TrigramIndex(const QString &directory);
+    ~TrigramIndex();
+
+    TrigramIndex(const TrigramIndex &) = delete;
+    TrigramIndex &operator=(const TrigramIndex &) = delete;
+
+    /// Where the index of the repository at @p repositoryPath is kept, in the cache directory.
+    [[nodiscard]] static QString defaultDirectory(const QString &repositoryPath);
+
+    /// Whether an index was ever written to @p directory.
+    [[nodiscard]] static bool exists(const QString &directory);
+
+    /// Maps the segments the manifest lists. Returns false when there is no index.
+    bool load();
+
+    [[nodiscard]] qsizetype blobCount() const;
+    [[nodiscard]] int segmentCount() const;
+
+    /**
+     * Indexes the blobs added by the commits that any reference of the repository at
+     * @p repositoryPath reaches and that are not indexed yet, and loads the index again.
+     * Returns false when it could not start, another update of the same index is running, in
+     * this process or another, or it was canceled through @p canceled; what a canceled update
+     * wrote is kept for the next one to go on from.
+     *
+     * Only one segment's worth of trigrams, about @p memoryBudget bytes, is kept in memory.
+     * Like walkCommits(), this opens a repository handle of its own.
+     */
+    bool update(const QString &repositoryPath, qint64 memoryBudget = defaultMemoryBudget, const std::atomic<bool> *canceled = nullptr, UpdateStats *stats = nullptr);
+
+    /// Runs update() on the default index of the repository at @p repositoryPath, on a thread
+    /// of its own, one repository after the other.
+    static QFuture<bool> updateInBackground(const QString &repositoryPath);
+
+    /// Whether @p blob is indexed with its trigrams, so candidates() tells whether it can match.
+    [[nodiscard]] bool covers(const git_oid &blob) const;
+
+    /**
+     * Puts in @p result the indexed blobs that have every trigram of @p text. Returns false,
+     * leaving it empty, when there is no trigram to look up: the text is shorter than three
+     * bytes or, matched in any case, has no three ASCII characters in a row.
+     */
+    bool candidates(const QString &text, bool caseSensitive, QSet<git_oid> *result) const;
+
+    /// Where @p blob first showed up; a zero commit when it is not indexed.
+    [[nodiscard]] Origin origin(const git_oid &blob) const;
+
+private:
+    class Segment;
+
+    LIBKOMMIT_NO_EXPORT bool readManifest(QList<git_oid> *tips, QStringList *segments) const;
+    LIBKOMMIT_NO_EXPORT bool writeManifest(const QList<git_oid> &tips) const;
+    [[nodiscard]] LIBKOMMIT_NO_EXPORT bool isKnown(const git_oid &blob) const;
+    LIBKOMMIT_NO_EXPORT bool compact(qint64 memoryBudget, const QList<git_oid> &tips);
+
+    QString mDirectory;
+    std::vector<std::unique_ptr<Segment>> mSegments;
+};
+
+}
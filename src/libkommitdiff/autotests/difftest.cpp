@@ -10,9 +10,82 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <KommitDiff/Diff>
 
+#include <kernels.h>
 #include <lcs.h>
 #include <solution.h>
 
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+
+Q_DECLARE_METATYPE(Diff::DiffAlgorithm)
+
+namespace
+{
+
+// A text of @p count lines that repeat now and then, like code does.
+QStringList generatedLines(int count, quint32 seed)
+{
+    QRandomGenerator random{seed};
+    QStringList lines;
+    lines.reserve(count);
+    for (int i = 0; i < count; ++i)
+        lines << QStringLiteral("line %1").arg(random.bounded(count / 4 + 1));
+    return lines;
+}
+
+// @p lines with @p count lines changed, removed or added here and there.
+QStringList edited(QStringList lines, int count, quint32 seed)
+{
+    QRandomGenerator random{seed};
+    for (int i = 0; i < count; ++i) {
+        auto at = random.bounded(int(lines.size()));
+        switch (random.bounded(3)) {
+        case 0:
+            lines[at] = QStringLiteral("changed %1").arg(i);
+            break;
+        case 1:
+            lines.removeAt(at);
+            break;
+        default:
+            lines.insert(at, QStringLiteral("added %1").arg(i));
+            break;
+        }
+    }
+    return lines;
+}
+
+int commonLength(const QList<Diff::LcsResult> &runs)
+{
+    int length{0};
+    for (const auto &run : runs)
+        length += run.leftEnd - run.leftStart + 1;
+    return length;
+}
+
+// Whether @p hunks cover both texts from start to end, in order, with the unchanged ones
+// really unchanged; @p unchanged is set to how many lines they have in common.
+bool coversBoth(const QList<Diff::DiffHunk> &hunks, const QStringList &left, const QStringList &right, int *unchanged)
+{
+    int leftIndex{0};
+    int rightIndex{0};
+    *unchanged = 0;
+    for (const auto &hunk : hunks) {
+        if (hunk.left.begin != leftIndex || hunk.right.begin != rightIndex)
+            return false;
+        if (hunk.type == Diff::SegmentType::SameOnBoth) {
+            if (hunk.left.size != hunk.right.size || left.mid(leftIndex, hunk.left.size) != right.mid(rightIndex, hunk.right.size))
+                return false;
+            *unchanged += hunk.left.size;
+        }
+        leftIndex += hunk.left.size;
+        rightIndex += hunk.right.size;
+    }
+    return leftIndex == left.size() && rightIndex == right.size();
+}
+
+}
+
 void DiffTest::solutionTest()
 {
     /*
@@ -190,14 +263,14 @@ void DiffTest::merge()
     // QCOMPARE(basePart, (QStringList{"a"}));
     // QCOMPARE(result.part(result.segments[0], Diff::MergeSide::Local), (QStringList{"z", "a"}));
 
-    auto segment0 = result.segments[0];
+    const auto &segment0 = result.segments[0];
 
-    QCOMPARE(segment0->baseStart, 0);
-    QCOMPARE(segment0->baseSize, 1);
-    QCOMPARE(segment0->localStart, 0);
-    QCOMPARE(segment0->localSize, 2);
-    QCOMPARE(segment0->remoteStart, 0);
-    QCOMPARE(segment0->remoteSize, 0);
+    QCOMPARE(segment0.baseStart, 0);
+    QCOMPARE(segment0.baseSize, 1);
+    QCOMPARE(segment0.localStart, 0);
+    QCOMPARE(segment0.localSize, 2);
+    QCOMPARE(segment0.remoteStart, 0);
+    QCOMPARE(segment0.remoteSize, 0);
 
     QCOMPARE(result.part(result.segments[1], Diff::MergeSide::Base), (QStringList{"b"}));
     QCOMPARE(result.part(result.segments[1], Diff::MergeSide::Local), (QStringList{"b"}));
@@ -273,6 +346,397 @@ void DiffTest::removedTest()
     // QCOMPARE(r->newText, c);
 }
 
+void DiffTest::myersIsMinimal()
+{
+    // On inputs small enough for the dynamic programming table, Myers' algorithm has to find
+    // a common subsequence just as long.
+    QRandomGenerator random{42};
+    auto equals = [](const QString &s1, const QString &s2) {
+        return s1 == s2;
+    };
+
+    for (int round = 0; round < 500; ++round) {
+        QStringList left;
+        QStringList right;
+        const auto alphabet = random.bounded(1, 8);
+        for (auto i = random.bounded(40); i > 0; --i)
+            left << QString{QChar(u'a' + random.bounded(alphabet))};
+        for (auto i = random.bounded(40); i > 0; --i)
+            right << QString{QChar(u'a' + random.bounded(alphabet))};
+
+        const auto expected = commonLength(Diff::longestCommonSubsequence(left, right, equals));
+        QCOMPARE(commonLength(Diff::commonSubsequence(left, right, Diff::DiffOptions<QString>{})), expected);
+    }
+}
+
+void DiffTest::bitParallelIsMinimal()
+{
+    QRandomGenerator random{43};
+    auto equals = [](int a, int b) {
+        return a == b;
+    };
+
+    // Sizes on both sides of a word boundary, so carries between words are exercised.
+    for (int round = 0; round < 500; ++round) {
+        QList<int> left;
+        QList<int> right;
+        const auto alphabet = random.bounded(1, 8);
+        for (auto i = random.bounded(150); i > 0; --i)
+            left << random.bounded(alphabet);
+        for (auto i = random.bounded(150); i > 0; --i)
+            right << random.bounded(alphabet);
+
+        const auto runs = Diff::Impl::bitParallel(left.constData(), int(left.size()), right.constData(), int(right.size()));
+        for (const auto &run : runs)
+            QCOMPARE(left.mid(run.leftStart, run.leftEnd - run.leftStart + 1), right.mid(run.rightStart, run.rightEnd - run.rightStart + 1));
+        QCOMPARE(commonLength(runs), commonLength(Diff::longestCommonSubsequence(left, right, equals)));
+    }
+}
+
+void DiffTest::matchKernels()
+{
+    // Every length around the vector widths, with the first difference at every place.
+    for (int size = 0; size < 40; ++size) {
+        for (int at = 0; at <= size; ++at) {
+            std::vector<int> left(size);
+            std::vector<int> right(size);
+            for (int i = 0; i < size; ++i)
+                left[i] = right[i] = i;
+            if (at < size)
+                right[at] = -1;
+
+            QCOMPARE(Diff::Impl::matchForward(left.data(), right.data(), size), at);
+            QCOMPARE(Diff::Impl::matchBackward(left.data() + size, right.data() + size, size), at < size ? size - at - 1 : size);
+        }
+    }
+}
+
+void DiffTest::largeInput_data()
+{
+    QTest::addColumn<Diff::DiffAlgorithm>("algorithm");
+
+    QTest::newRow("myers") << Diff::DiffAlgorithm::Myers;
+    QTest::newRow("patience") << Diff::DiffAlgorithm::Patience;
+    QTest::newRow("histogram") << Diff::DiffAlgorithm::Histogram;
+}
+
+void DiffTest::largeInput()
+{
+    QFETCH(Diff::DiffAlgorithm, algorithm);
+
+    // Far past what a table of (left + 1) × (right + 1) ints could hold.
+    const auto left = generatedLines(50000, 1);
+    const auto right = edited(left, 500, 2);
+
+    Diff::DiffOptions<QString> opts;
+    opts.algorithm = algorithm;
+    auto hunks = Diff::diff2(left, right, opts);
+
+    int unchanged;
+    QVERIFY(coversBoth(hunks, left, right, &unchanged));
+    // Each edit touches a line on at most one side.
+    QVERIFY(unchanged >= left.size() - 500);
+}
+
+void DiffTest::largeUnrelatedInput()
+{
+    QStringList left;
+    QStringList right;
+    for (int i = 0; i < 50000; ++i) {
+        left << QStringLiteral("left %1").arg(i);
+        right << QStringLiteral("right %1").arg(i);
+    }
+
+    auto hunks = Diff::diff2(left, right);
+
+    QCOMPARE(hunks.size(), 1);
+    QCOMPARE(hunks.first().type, Diff::SegmentType::DifferentOnBoth);
+    QCOMPARE(hunks.first().left.size, 50000);
+    QCOMPARE(hunks.first().right.size, 50000);
+}
+
+void DiffTest::everyOtherLineChanged_data()
+{
+    QTest::addColumn<Diff::DiffAlgorithm>("algorithm");
+
+    QTest::newRow("patience") << Diff::DiffAlgorithm::Patience;
+    QTest::newRow("histogram") << Diff::DiffAlgorithm::Histogram;
+}
+
+void DiffTest::everyOtherLineChanged()
+{
+    QFETCH(Diff::DiffAlgorithm, algorithm);
+
+    // Split into as many pieces as there are lines, one after the other, which is as deep
+    // as the comparison goes.
+    constexpr int count{200000};
+    QStringList left;
+    QStringList right;
+    for (int i = 0; i < count; ++i) {
+        left << QStringLiteral("line %1").arg(i);
+        right << (i % 2 ? QStringLiteral("changed %1").arg(i) : left.last());
+    }
+
+    Diff::DiffOptions<QString> opts;
+    opts.algorithm = algorithm;
+    auto hunks = Diff::diff2(left, right, opts);
+
+    int unchanged;
+    QVERIFY(coversBoth(hunks, left, right, &unchanged));
+    QCOMPARE(unchanged, count / 2);
+}
+
+void DiffTest::cancel()
+{
+    const auto left = generatedLines(20000, 9);
+    const auto right = edited(left, 2000, 10);
+
+    Diff::DiffControl control;
+    Diff::DiffOptions<QString> opts;
+    opts.control = &control;
+
+    auto hunks = Diff::diff2(left, right, opts);
+    int unchanged;
+    QVERIFY(coversBoth(hunks, left, right, &unchanged));
+    QVERIFY(control.progress.load() > 0);
+
+    // Canceled, it gives up before looking for anything, and the hunks still cover both
+    // texts, with what it did not get to as changed.
+    control.canceled = true;
+    hunks = Diff::diff2(left, right, opts);
+    int canceledUnchanged;
+    QVERIFY(coversBoth(hunks, left, right, &canceledUnchanged));
+    QVERIFY(canceledUnchanged < unchanged);
+}
+
+void DiffTest::ignoreCaseAndWhiteSpaces()
+{
+    const QStringList left{QStringLiteral("int main()"),
+                           QStringLiteral("{"),
+                           QStringLiteral("    Return 0;"),
+                           QStringLiteral("}"),
+                           QStringLiteral("// Ünïcode")};
+    const QStringList right{QStringLiteral("int main()"),
+                            QStringLiteral("{"),
+                            QStringLiteral("\treturn 0;  "),
+                            QStringLiteral("}"),
+                            QStringLiteral("// üNÏCODE")};
+
+    auto hunks = Diff::diff2(left, right, Diff::DiffOptions<QString>{true, true});
+    QCOMPARE(hunks.size(), 1);
+    QCOMPARE(hunks.first().type, Diff::SegmentType::SameOnBoth);
+
+    // Either option on its own keeps apart the lines that differ in the other way.
+    auto unchangedLines = [&left, &right](bool ignoreCase, bool ignoreWhiteSpaces) {
+        int unchanged{0};
+        const auto hunks = Diff::diff2(left, right, Diff::DiffOptions<QString>{ignoreCase, ignoreWhiteSpaces});
+        for (const auto &hunk : hunks)
+            if (hunk.type == Diff::SegmentType::SameOnBoth)
+                unchanged += hunk.left.size;
+        return unchanged;
+    };
+    QCOMPARE(unchangedLines(true, false), 4);
+    QCOMPARE(unchangedLines(false, true), 3);
+    QCOMPARE(unchangedLines(false, false), 3);
+}
+
+void DiffTest::textViews()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write("int main()\r\n{\r\n    return 0;\r\n}\r\n// Ünïcode");
+    file.close();
+
+    const auto fromFile = Diff::TextView::readFile(file.fileName());
+    QVERIFY(fromFile.isUtf8());
+    QCOMPARE(fromFile.lineEnding, Diff::LineEnding::CrLf);
+    QCOMPARE(fromFile.lineCount(), 5);
+    QCOMPARE(fromFile.line(2), QStringLiteral("    return 0;"));
+    QCOMPARE(fromFile.line(4), QStringLiteral("// Ünïcode"));
+
+    // The view keeps its own copy, so rewriting the file under it changes nothing.
+    QVERIFY(file.open());
+    QVERIFY(file.resize(0));
+    file.close();
+    QCOMPARE(fromFile.line(4), QStringLiteral("// Ünïcode"));
+
+    const QByteArray edited{"int main()\n{\n\treturn 1;\n}\n// üNÏCODE"};
+    const auto borrowed = Diff::TextView::borrow(edited, nullptr);
+    QCOMPARE(borrowed.lineEnding, Diff::LineEnding::Lf);
+    QCOMPARE(borrowed.lineRange(1, 2), (QStringList{QStringLiteral("{"), QStringLiteral("\treturn 1;")}));
+
+    Diff::DiffOptions<QString> opts;
+    opts.ignoreCase = true;
+    auto hunks = Diff::diff2(fromFile, borrowed, opts);
+    QCOMPARE(hunks.size(), 3);
+    QCOMPARE(hunks.at(1).type, Diff::SegmentType::DifferentOnBoth);
+    QCOMPARE(hunks.at(1).left.begin, 2);
+    QCOMPARE(hunks.at(1).left.size, 1);
+
+    const auto stats = Diff::diffStats(fromFile, borrowed, opts);
+    QCOMPARE(stats.added, 1);
+    QCOMPARE(stats.removed, 1);
+
+    // A view of a QString against one of bytes.
+    const Diff::TextView text{QStringLiteral("int main()\n{\n    return 0;\n}\n// Ünïcode")};
+    hunks = Diff::diff2(text, fromFile);
+    QCOMPARE(hunks.size(), 1);
+    QCOMPARE(hunks.first().type, Diff::SegmentType::SameOnBoth);
+
+    // Each keeps its own lines, whatever ends them, so the hunks line up with both views.
+    const Diff::TextView mixed{QByteArray{"a\nb\rc\nd"}};
+    QCOMPARE(mixed.lineCount(), 3);
+    hunks = Diff::diff2(text, mixed);
+    qsizetype leftLines{0};
+    qsizetype rightLines{0};
+    for (const auto &hunk : std::as_const(hunks)) {
+        leftLines += hunk.left.size;
+        rightLines += hunk.right.size;
+    }
+    QCOMPARE(leftLines, text.lineCount());
+    QCOMPARE(rightLines, mixed.lineCount());
+
+    // White space past ASCII is trimmed the same in UTF-8 as decoded.
+    opts.ignoreCase = false;
+    opts.ignoreWhiteSpaces = true;
+    const Diff::TextView spaced{QStringLiteral("\u00a0x\u3000\ny")};
+    const Diff::TextView bare{QByteArray{"x\ny"}};
+    const Diff::TextView spacedBytes{QStringLiteral("\u00a0x\u3000\ny").toUtf8()};
+    QCOMPARE(Diff::diff2(spaced, bare, opts).size(), 1);
+    QCOMPARE(Diff::diff2(spacedBytes, bare, opts).size(), 1);
+    QCOMPARE(Diff::diff2(spacedBytes, bare, opts).first().type, Diff::SegmentType::SameOnBoth);
+}
+
+void DiffTest::dirs()
+{
+    QTemporaryDir left;
+    QTemporaryDir right;
+    QVERIFY(left.isValid() && right.isValid());
+
+    auto write = [](const QTemporaryDir &dir, const QString &name, const QByteArray &content) {
+        QDir{dir.path()}.mkpath(QFileInfo{name}.path());
+        QFile file{dir.filePath(name)};
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(content);
+    };
+    write(left, QStringLiteral("same.txt"), "same");
+    write(right, QStringLiteral("same.txt"), "same");
+    write(left, QStringLiteral("sub/edited.txt"), "before");
+    write(right, QStringLiteral("sub/edited.txt"), "after!");
+    write(left, QStringLiteral("removed.txt"), "gone");
+    write(right, QStringLiteral("sub/added.txt"), "new");
+
+    const auto map = Diff::diffDirs(left.path(), right.path());
+    QCOMPARE(map.size(), 4);
+    QCOMPARE(map.value(QStringLiteral("same.txt")), Diff::DiffType::Unchanged);
+    QCOMPARE(map.value(QStringLiteral("sub/edited.txt")), Diff::DiffType::Modified);
+    QCOMPARE(map.value(QStringLiteral("removed.txt")), Diff::DiffType::Removed);
+    QCOMPARE(map.value(QStringLiteral("sub/added.txt")), Diff::DiffType::Added);
+
+    auto future = Diff::diffDirsAsync(left.path(), right.path());
+    future.waitForFinished();
+    QCOMPARE(future.resultCount(), 4);
+    QCOMPARE(future.progressValue(), 4);
+}
+
+void DiffTest::mergeLargeInput()
+{
+    const auto base = generatedLines(20000, 3);
+    const auto local = edited(base, 100, 4);
+    const auto remote = edited(base, 100, 5);
+
+    auto result = Diff::diff3(base, local, remote);
+
+    // Every line of both sides ends up in exactly one segment.
+    int localLines{0};
+    int remoteLines{0};
+    for (const auto &segment : std::as_const(result.segments)) {
+        localLines += segment.localSize;
+        remoteLines += segment.remoteSize;
+    }
+    QCOMPARE(localLines, int(local.size()));
+    QCOMPARE(remoteLines, int(remote.size()));
+}
+
+void DiffTest::benchmarkEngines_data()
+{
+    QTest::addColumn<QString>("engine");
+    QTest::addColumn<int>("size");
+
+    // The table the dynamic programming engine fills grows with the square of the input, so
+    // it is only measured on what it can still handle.
+    for (const auto size : {2000, 50000}) {
+        const QStringList engines = size > 2000 ? QStringList{"myers", "patience", "histogram"} : QStringList{"dp", "myers", "patience", "histogram"};
+        for (const auto &engine : engines)
+            QTest::addRow("%s-%d", qPrintable(engine), size) << engine << size;
+    }
+}
+
+void DiffTest::benchmarkEngines()
+{
+    QFETCH(QString, engine);
+    QFETCH(int, size);
+
+    const auto left = generatedLines(size, 6);
+    const auto right = edited(left, size / 100, 7);
+
+    if (engine == QStringLiteral("dp")) {
+        auto equals = [](const QString &s1, const QString &s2) {
+            return s1 == s2;
+        };
+        QBENCHMARK {
+            auto runs = Diff::longestCommonSubsequence(left, right, equals);
+            Q_UNUSED(runs)
+        }
+        return;
+    }
+
+    Diff::DiffOptions<QString> opts;
+    if (engine == QStringLiteral("patience"))
+        opts.algorithm = Diff::DiffAlgorithm::Patience;
+    else if (engine == QStringLiteral("histogram"))
+        opts.algorithm = Diff::DiffAlgorithm::Histogram;
+
+    QBENCHMARK {
+        auto runs = Diff::commonSubsequence(left, right, opts);
+        Q_UNUSED(runs)
+    }
+}
+
+void DiffTest::benchmarkOneHunkEdit()
+{
+    // The usual case: a few lines changed in the middle of a large file.
+    const auto left = generatedLines(200000, 8);
+    auto right = left;
+    for (int i = 0; i < 5; ++i)
+        right[100000 + i] = QStringLiteral("changed %1").arg(i);
+
+    Diff::DiffOptions<QString> opts;
+    opts.ignoreWhiteSpaces = true;
+
+    QBENCHMARK {
+        auto hunks = Diff::diff2(left, right, opts);
+        QCOMPARE(hunks.size(), 3);
+    }
+}
+
+void DiffTest::benchmarkMerge()
+{
+    // A vendored lock file, changed on both sides.
+    QString base;
+    for (int i = 0; i < 30000; ++i)
+        base += QStringLiteral("    \"package-%1\": \"^%2.%3.0\",\n").arg(i).arg(i % 7).arg(i % 13);
+    auto local = base;
+    local.replace(QStringLiteral("\"^3.4.0\""), QStringLiteral("\"^3.5.0\""));
+    auto remote = base;
+    remote.replace(QStringLiteral("\"^1.9.0\""), QStringLiteral("\"^2.0.0\""));
+
+    QBENCHMARK {
+        auto result = Diff::diff3String(base, local, remote);
+        QVERIFY(result.segments.size() > 1);
+    }
+}
+
 QTEST_MAIN(DiffTest)
 
 #include "moc_difftest.cpp"
@@ -22,4 +22,22 @@ class DiffTest : public QObject
 
 private Q_SLOTS:
     void removeFromLocal();
+
+    void myersIsMinimal();
+    void bitParallelIsMinimal();
+    void matchKernels();
+    void largeInput_data();
+    void largeInput();
+    void largeUnrelatedInput();
+    void everyOtherLineChanged_data();
+    void everyOtherLineChanged();
+    void cancel();
+    void ignoreCaseAndWhiteSpaces();
+    void textViews();
+    void dirs();
+    void mergeLargeInput();
+    void benchmarkEngines_data();
+    void benchmarkEngines();
+    void benchmarkOneHunkEdit();
+    void benchmarkMerge();
 };
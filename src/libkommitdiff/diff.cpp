@@ -6,64 +6,76 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "diff.h"
 
+#include <QDateTime>
 #include <QDir>
+#include <QDirIterator>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
 
 namespace Diff
 {
 
-bool isFilesSame(const QString &file1, const QString &file2)
+namespace
 {
-    QFileInfo fi1{file1};
-    QFileInfo fi2{file2};
 
-    if (fi1.size() != fi2.size() /* || fi1.lastModified() != fi2.lastModified()*/)
-        return false;
+struct ListedFile {
+    QString file;
+    qint64 size;
+    qint64 modified;
+};
+
+// Every file under @p dir, which ends with a slash, by its path relative to @p dir, sorted.
+QList<ListedFile> listFiles(const QString &dir)
+{
+    QList<ListedFile> files;
+    QDirIterator it{dir, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks};
+    while (it.hasNext()) {
+        it.next();
+        const auto info = it.fileInfo();
+        files.append({info.filePath().mid(dir.size()), info.size(), info.lastModified().toMSecsSinceEpoch()});
+    }
+
+    std::sort(files.begin(), files.end(), [](const ListedFile &l, const ListedFile &r) {
+        return l.file < r.file;
+    });
+    return files;
+}
+
+bool isFilesSame(const QString &file1, const QString &file2)
+{
+    // Read straight into buffers large enough that a file of a build tree is a read or two,
+    // one pair per thread of the pool.
+    constexpr qint64 chunkSize{1 << 18};
+    thread_local std::unique_ptr<char[]> buffer1{new char[chunkSize]};
+    thread_local std::unique_ptr<char[]> buffer2{new char[chunkSize]};
 
     QFile f1{file1};
     QFile f2{file2};
-
-    if (!f1.open(QIODevice::ReadOnly) || !f2.open(QIODevice::ReadOnly))
+    if (!f1.open(QIODevice::ReadOnly | QIODevice::Unbuffered) || !f2.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
         return false;
 
-    while (!f1.atEnd() && !f2.atEnd()) {
-        auto buffer1 = f1.read(100);
-        auto buffer2 = f2.read(100);
-        if (buffer1 != buffer2) {
-            f1.close();
-            f2.close();
+    while (true) {
+        const auto read1 = f1.read(buffer1.get(), chunkSize);
+        const auto read2 = f2.read(buffer2.get(), chunkSize);
+        if (read1 != read2 || read1 < 0)
+            return false;
+        if (!read1)
+            return true;
+        if (std::memcmp(buffer1.get(), buffer2.get(), read1))
             return false;
-        }
     }
-
-    f1.close();
-    f2.close();
-
-    return true;
 }
-void browseDir(QStringList &filesList, const QString &dirPath, const QString &basePath)
-{
-    QDir d(basePath + QLatin1Char('/') + dirPath);
-    const auto files = d.entryList(QDir::NoDotAndDotDot | QDir::Files);
-    for (const auto &f : files) {
-        if (dirPath.isEmpty())
-            filesList.append(dirPath + f);
-        else
-            filesList.append(dirPath + QLatin1Char('/') + f);
-    }
 
-    const auto dirs = d.entryList(QDir::NoDotAndDotDot | QDir::Dirs);
-    for (const auto &dir : dirs) {
-        if (dirPath.isEmpty())
-            browseDir(filesList, dirPath + dir, basePath);
-        else
-            browseDir(filesList, dirPath + QLatin1Char('/') + dir, basePath);
-    }
 }
-QMap<QString, DiffType> diffDirs(const QString &dir1, const QString &dir2)
+
+void diffDirs(QPromise<DirDiffEntry> &promise, const QString &dir1, const QString &dir2, const DirDiffOptions &options)
 {
     auto d1 = dir1;
     auto d2 = dir2;
-    QMap<QString, DiffType> map;
 
     if (!d1.endsWith(QLatin1Char('/')))
         d1.append(QLatin1Char('/'));
@@ -71,22 +83,74 @@ QMap<QString, DiffType> diffDirs(const QString &dir1, const QString &dir2)
     if (!d2.endsWith(QLatin1Char('/')))
         d2.append(QLatin1Char('/'));
 
-    QStringList files1, files2;
-    browseDir(files1, {}, d1);
-    browseDir(files2, {}, d2);
-
-    for (const auto &file : std::as_const(files1)) {
-        if (!files2.contains(file)) {
-            map.insert(file, DiffType::Removed);
+    auto listing2 = QtConcurrent::run(listFiles, d2);
+    const auto files1 = listFiles(d1);
+    const auto files2 = listing2.result();
+
+    if (promise.isCanceled())
+        return;
+
+    std::atomic<int> done{0};
+    auto report = [&promise, &done](const QString &file, DiffType type) {
+        promise.addResult(DirDiffEntry{file, type});
+        promise.setProgressValue(++done);
+    };
+
+    // Both listings are sorted, so walking them side by side pairs up the files.
+    QStringList toRead;
+    qsizetype i{0};
+    qsizetype j{0};
+    int total{0};
+    QList<DirDiffEntry> known;
+    while (i < files1.size() || j < files2.size()) {
+        ++total;
+        if (j == files2.size() || (i < files1.size() && files1.at(i).file < files2.at(j).file)) {
+            known.append({files1.at(i++).file, DiffType::Removed});
+        } else if (i == files1.size() || files2.at(j).file < files1.at(i).file) {
+            known.append({files2.at(j++).file, DiffType::Added});
         } else {
-            map.insert(file, isFilesSame(d1 + file, d2 + file) ? DiffType::Unchanged : DiffType::Modified);
-            files2.removeOne(file);
+            const auto &file1 = files1.at(i++);
+            const auto &file2 = files2.at(j++);
+            if (file1.size != file2.size)
+                known.append({file1.file, DiffType::Modified});
+            else if (options.trustModificationTime && file1.modified == file2.modified)
+                known.append({file1.file, DiffType::Unchanged});
+            else
+                toRead.append(file1.file);
         }
     }
 
-    for (const auto &file : std::as_const(files2))
-        map.insert(file, DiffType::Added);
+    promise.setProgressRange(0, total);
+    for (const auto &entry : std::as_const(known))
+        report(entry.file, entry.type);
+
+    QtConcurrent::blockingMap(toRead, [&](const QString &file) {
+        if (promise.isCanceled())
+            return;
+        report(file, isFilesSame(d1 + file, d2 + file) ? DiffType::Unchanged : DiffType::Modified);
+    });
+}
+
+QFuture<DirDiffEntry> diffDirsAsync(const QString &dir1, const QString &dir2, const DirDiffOptions &options)
+{
+    return QtConcurrent::run(
+        [dir1, dir2, options](QPromise<DirDiffEntry> &promise) {
+            diffDirs(promise, dir1, dir2, options);
+        });
+}
 
+QMap<QString, DiffType> diffDirs(const QString &dir1, const QString &dir2)
+{
+    QPromise<DirDiffEntry> promise;
+    auto future = promise.future();
+    promise.start();
+    diffDirs(promise, dir1, dir2);
+    promise.finish();
+
+    QMap<QString, DiffType> map;
+    const auto results = future.results();
+    for (const auto &entry : results)
+        map.insert(entry.file, entry.type);
     return map;
 }
 
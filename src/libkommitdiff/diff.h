@@ -11,11 +11,39 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "libkommitdiff_export.h"
 
+#include <QFuture>
 #include <QMap>
+#include <QPromise>
 
 namespace Diff
 {
 
+/// A file found under either of two directories compared, and how the two differ on it.
+struct LIBKOMMITDIFF_EXPORT DirDiffEntry {
+    QString file;
+    DiffType type;
+};
+
+struct DirDiffOptions {
+    /// Takes files with the same size and modification time as the same without reading
+    /// them, as for two copies of a tree made with the times kept.
+    bool trustModificationTime{false};
+};
+
+/**
+ * Compares the files under @p dir1 and @p dir2, reporting each one to @p promise as soon as
+ * it is known how it differs, in no particular order.
+ *
+ * The two listings are sorted and joined in one pass. Files only on one side, or of a
+ * different size, are reported right away; the rest are read and compared on the global
+ * thread pool. Progress goes from 0 to the number of files, and canceling the promise
+ * stops the comparison.
+ */
+void LIBKOMMITDIFF_EXPORT diffDirs(QPromise<DirDiffEntry> &promise, const QString &dir1, const QString &dir2, const DirDiffOptions &options = {});
+
+/// Same as above, run on the global thread pool.
+[[nodiscard]] QFuture<DirDiffEntry> LIBKOMMITDIFF_EXPORT diffDirsAsync(const QString &dir1, const QString &dir2, const DirDiffOptions &options = {});
+
 QMap<QString, DiffType> LIBKOMMITDIFF_EXPORT diffDirs(const QString &dir1, const QString &dir2);
 
 }
@@ -24,11 +24,9 @@ Diff2TextResult diff(const QString &oldText, const QString &newText, const DiffO
 class Diff2TextResultPrivate
 {
 public:
-    ~Diff2TextResultPrivate();
-
     Text left;
     Text right;
-    QList<DiffHunk *> hunks;
+    QList<DiffHunk> hunks;
 };
 
 const Text &Diff2TextResult::left() const
@@ -41,7 +39,7 @@ const Text &Diff2TextResult::right() const
     return d->right;
 }
 
-const QList<DiffHunk *> &Diff2TextResult::hunks() const
+const QList<DiffHunk> &Diff2TextResult::hunks() const
 {
     return d->hunks;
 }
@@ -51,7 +49,7 @@ Diff2TextResult::Diff2TextResult()
 {
 }
 
-Diff2TextResult::Diff2TextResult(Text left, Text right, QList<DiffHunk *> hunks)
+Diff2TextResult::Diff2TextResult(Text left, Text right, QList<DiffHunk> hunks)
     : d{new Diff2TextResultPrivate}
 {
     d->left = std::move(left);
@@ -72,19 +70,86 @@ Diff2TextResult &Diff2TextResult::operator=(const Diff2TextResult &other)
     return *this;
 }
 
-QList<DiffHunk *> diff2(const Text &oldText, const Text &newText, const DiffOptions<QString> &opts)
+QList<DiffHunk> diff2(const Text &oldText, const Text &newText, const DiffOptions<QString> &opts)
 {
     return Impl::diff(oldText.lines, newText.lines, opts);
 }
 
-QList<DiffHunk *> diff2(const QStringList &oldText, const QStringList &newText, const DiffOptions<QString> &opts)
+QList<DiffHunk> diff2(const QStringList &oldText, const QStringList &newText, const DiffOptions<QString> &opts)
 {
     return Impl::diff(oldText, newText, opts);
 }
 
-Diff2TextResultPrivate::~Diff2TextResultPrivate()
+namespace
+{
+
+// Calls @p compare with the lines of both views as the same kind, and options to match.
+template<typename Compare>
+auto compareLines(const TextView &oldText, const TextView &newText, const DiffOptions<QString> &opts, Compare compare)
+{
+    // A view built from a QString is compared as UTF-16; one with no lines goes either way.
+    const auto utf16 = (oldText.lineCount() && !oldText.isUtf8()) || (newText.lineCount() && !newText.isUtf8());
+    if (!utf16) {
+        DiffOptions<QUtf8StringView> utf8Opts;
+        utf8Opts.ignoreCase = opts.ignoreCase;
+        utf8Opts.ignoreWhiteSpaces = opts.ignoreWhiteSpaces;
+        utf8Opts.algorithm = opts.algorithm;
+        utf8Opts.control = opts.control;
+        return compare(oldText.utf8Lines, newText.utf8Lines, utf8Opts);
+    }
+
+    DiffOptions<QStringView> utf16Opts;
+    utf16Opts.ignoreCase = opts.ignoreCase;
+    utf16Opts.ignoreWhiteSpaces = opts.ignoreWhiteSpaces;
+    utf16Opts.algorithm = opts.algorithm;
+    utf16Opts.control = opts.control;
+    if (!oldText.isUtf8() && !newText.isUtf8())
+        return compare(oldText.lines, newText.lines, utf16Opts);
+
+    // One of each: the UTF-8 one is decoded a line at a time, so both are the same kind and
+    // it keeps its lines as they are, whatever ends them.
+    const auto decode = [](const TextView &text, QStringList &decoded) {
+        if (!text.isUtf8())
+            return text.lines;
+        decoded = text.lineRange(0, text.lineCount());
+        QList<QStringView> lines;
+        lines.reserve(decoded.size());
+        for (const auto &line : std::as_const(decoded))
+            lines << QStringView{line};
+        return lines;
+    };
+    QStringList oldDecoded;
+    QStringList newDecoded;
+    return compare(decode(oldText, oldDecoded), decode(newText, newDecoded), utf16Opts);
+}
+
+}
+
+QList<DiffHunk> diff2(const TextView &oldText, const TextView &newText, const DiffOptions<QString> &opts)
+{
+    return compareLines(oldText, newText, opts, [](const auto &left, const auto &right, const auto &lineOpts) {
+        return Impl::diff(left, right, lineOpts);
+    });
+}
+
+DiffStats diffStats(const TextView &oldText, const TextView &newText, const DiffOptions<QString> &opts)
+{
+    return compareLines(oldText, newText, opts, [](const auto &left, const auto &right, const auto &lineOpts) {
+        int common{0};
+        if (!left.isEmpty() && !right.isEmpty()) {
+            const auto lcs = commonSubsequence(left, right, lineOpts);
+            for (const auto &p : lcs)
+                common += p.leftEnd - p.leftStart + 1;
+        }
+        return DiffStats{static_cast<int>(right.size()) - common, static_cast<int>(left.size()) - common};
+    });
+}
+
+Diff2TextViewResult::Diff2TextViewResult(TextView left, TextView right, QList<DiffHunk> hunks)
+    : left{std::move(left)}
+    , right{std::move(right)}
+    , hunks{std::move(hunks)}
 {
-    qDeleteAll(hunks);
 }
 
 Diff2TextResult diff2(const QString &oldText, const QString &newText, const DiffOptions<QString> &opts)
@@ -21,62 +21,52 @@ namespace Diff
 namespace Impl
 {
 template<typename T>
-QList<DiffHunk *> diff(const QList<T> &oldText, const QList<T> &newText, const DiffOptions<T> &opts = {})
+QList<DiffHunk> diff(const QList<T> &oldText, const QList<T> &newText, const DiffOptions<T> &opts = {})
 {
+    auto hunk = [](SegmentType type, Range left, Range right) {
+        DiffHunk h;
+        h.type = type;
+        h.left = left;
+        h.right = right;
+        return h;
+    };
+
     // These shortcuts have to set begin as well as size: Range() starts life at -1, so a
     // caller that reads the range back gets one line of nonsense in front of the text.
-    if (oldText == newText) {
-        auto segment = new DiffHunk;
-        segment->type = SegmentType::SameOnBoth;
-        segment->left = Range{0, static_cast<int>(oldText.size())};
-        segment->right = Range{0, static_cast<int>(newText.size())};
-        return {segment};
-    } else if (newText.isEmpty()) {
-        auto segment = new DiffHunk;
-        segment->type = SegmentType::OnlyOnLeft;
-        segment->left = Range{0, static_cast<int>(oldText.size())};
-        segment->right = Range{0, 0};
-        return {segment};
-    } else if (oldText.isEmpty()) {
-        auto segment = new DiffHunk;
-        segment->type = SegmentType::OnlyOnRight;
-        segment->left = Range{0, 0};
-        segment->right = Range{0, static_cast<int>(newText.size())};
-        return {segment};
-    }
-
-    std::function<bool(const T &, const T &)> equals = [&opts](const T &s1, const T &s2) -> bool {
-        return opts.equals(s1, s2);
-    };
+    if (oldText == newText)
+        return {hunk(SegmentType::SameOnBoth, Range{0, static_cast<int>(oldText.size())}, Range{0, static_cast<int>(newText.size())})};
+    if (newText.isEmpty())
+        return {hunk(SegmentType::OnlyOnLeft, Range{0, static_cast<int>(oldText.size())}, Range{0, 0})};
+    if (oldText.isEmpty())
+        return {hunk(SegmentType::OnlyOnRight, Range{0, 0}, Range{0, static_cast<int>(newText.size())})};
 
-    QList<LcsResult> lcs = longestCommonSubsequence<T>(oldText, newText, equals);
+    QList<LcsResult> lcs = commonSubsequence(oldText, newText, opts);
 
-    QList<DiffHunk *> ret;
+    // Hunks and runs in common alternate, so there are at most two per run, and one more.
+    QList<DiffHunk> ret;
+    ret.reserve(2 * lcs.size() + 1);
 
     int leftIndex{0};
     int rightIndex{0};
-    auto add = [&ret, &oldText, &newText](int leftStart, int leftEnd, int rightStart, int rightEnd, bool same) {
+    auto add = [&ret](int leftStart, int leftEnd, int rightStart, int rightEnd, bool same) {
         Q_ASSERT(leftStart <= leftEnd);
         Q_ASSERT(rightStart <= rightEnd);
-        auto s = new DiffHunk;
-        s->left.begin = leftStart;
-        s->left.size = leftEnd - leftStart;
-        s->right.begin = rightStart;
-        s->right.size = rightEnd - rightStart;
-
-        // s->oldText = oldText.mid(leftStart, leftEnd - leftStart);
-        // s->newText = newText.mid(rightStart, rightEnd - rightStart);
+        auto &s = ret.emplace_back();
+        s.left.begin = leftStart;
+        s.left.size = leftEnd - leftStart;
+        s.right.begin = rightStart;
+        s.right.size = rightEnd - rightStart;
+
         if (same) {
-            s->type = SegmentType::SameOnBoth;
+            s.type = SegmentType::SameOnBoth;
         } else {
             if (leftStart == leftEnd)
-                s->type = SegmentType::OnlyOnRight;
+                s.type = SegmentType::OnlyOnRight;
             else if (rightStart == rightEnd)
-                s->type = SegmentType::OnlyOnLeft;
+                s.type = SegmentType::OnlyOnLeft;
             else
-                s->type = SegmentType::DifferentOnBoth;
+                s.type = SegmentType::DifferentOnBoth;
         }
-        ret << s;
         // qDebug().noquote().nospace() << "Segment: " << s->oldLineStart << "->" << s->oldLineEnd << "    <>    " << s->newLineStart << "->" << s->newLineEnd;
     };
 
@@ -108,10 +98,10 @@ class Diff2TextResultPrivate;
 struct LIBKOMMITDIFF_EXPORT Diff2TextResult {
     const Text &left() const;
     const Text &right() const;
-    const QList<DiffHunk *> &hunks() const;
+    const QList<DiffHunk> &hunks() const;
 
     Diff2TextResult();
-    Diff2TextResult(Text left, Text right, QList<DiffHunk *> hunks);
+    Diff2TextResult(Text left, Text right, QList<DiffHunk> hunks);
 
     Diff2TextResult(const Diff2TextResult &other);
     Diff2TextResult &operator=(const Diff2TextResult &other);
@@ -120,14 +110,36 @@ private:
     QSharedPointer<Diff2TextResultPrivate> d;
 };
 
+/**
+ * The hunks between two views, together with the views they index into, so whoever shows
+ * them can hold on to all three at once. Whatever refers to a hunk does so by its index.
+ */
 struct LIBKOMMITDIFF_EXPORT Diff2TextViewResult {
     const TextView left;
     const TextView right;
-    const QList<DiffSegment *> segments;
-    Diff2TextViewResult(Text left, Text right, QList<DiffSegment *> segments);
-    ~Diff2TextViewResult();
+    const QList<DiffHunk> hunks;
+    Diff2TextViewResult(TextView left, TextView right, QList<DiffHunk> hunks);
+
+    Q_DISABLE_COPY(Diff2TextViewResult)
+};
+
+/// How many lines a diff adds and removes; a line changed in place counts as both.
+struct DiffStats {
+    int added{0};
+    int removed{0};
 };
 
 [[nodiscard]] Diff2TextResult LIBKOMMITDIFF_EXPORT diff2(const QString &oldText, const QString &newText, const DiffOptions<QString> &opts = {});
-[[nodiscard]] QList<DiffHunk *> LIBKOMMITDIFF_EXPORT diff2(const QStringList &oldText, const QStringList &newText, const DiffOptions<QString> &opts = {});
+[[nodiscard]] QList<DiffHunk> LIBKOMMITDIFF_EXPORT diff2(const QStringList &oldText, const QStringList &newText, const DiffOptions<QString> &opts = {});
+
+/**
+ * Compares the lines of two views in place, as UTF-8 when both are, without decoding them.
+ */
+[[nodiscard]] QList<DiffHunk> LIBKOMMITDIFF_EXPORT diff2(const TextView &oldText, const TextView &newText, const DiffOptions<QString> &opts = {});
+
+/**
+ * Counts the lines diff2() would show as added and removed, from the lines the two views
+ * have in common, without building any hunks.
+ */
+[[nodiscard]] DiffStats LIBKOMMITDIFF_EXPORT diffStats(const TextView &oldText, const TextView &newText, const DiffOptions<QString> &opts = {});
 }
@@ -19,12 +19,11 @@ int LIBKOMMITDIFF_EXPORT getRight(int baseLeft, const QList<LcsResult>::iterator
 template<typename T>
 MergeResult<T> diff3(const QList<T> &base, const QList<T> &local, const QList<T> &remote, const DiffOptions<T> &opts = {})
 {
-    std::function<bool(const T &, const T &)> equals = [&opts](const T &s1, const T &s2) -> bool {
-        return opts.equals(s1, s2);
-    };
-    using namespace std::placeholders;
-    QList<LcsResult> withLocal = longestCommonSubsequence(base, local, equals);
-    QList<LcsResult> withRemote = longestCommonSubsequence(base, remote, equals);
+    // The base is compared with both sides, so all three share their ids.
+    Impl::Classifier<T> classifier{opts};
+    const auto baseIds = classifier.ids(base);
+    QList<LcsResult> withLocal = Impl::commonSubsequence(baseIds, classifier.ids(local), opts.algorithm, opts.control);
+    QList<LcsResult> withRemote = Impl::commonSubsequence(baseIds, classifier.ids(remote), opts.algorithm, opts.control);
 
     QList<LcsResult>::iterator itLocal = withLocal.begin();
     QList<LcsResult>::iterator itRemote = withRemote.begin();
@@ -33,7 +32,7 @@ MergeResult<T> diff3(const QList<T> &base, const QList<T> &local, const QList<T>
     auto indexRemote{0};
     int indexBase{};
 
-    QList<MergeSegment2 *> result;
+    QList<MergeSegment2> result;
 
     while (itLocal != withLocal.end() && itRemote != withRemote.end()) {
         if (itLocal->leftStart == itRemote->leftStart) {
@@ -51,53 +50,53 @@ MergeResult<T> diff3(const QList<T> &base, const QList<T> &local, const QList<T>
         auto commonStart = std::max(itLocal->leftStart, itRemote->leftStart);
         auto commonEnd = std::min(itLocal->leftEnd, itRemote->leftEnd);
 
-        auto seg = new MergeSegment2; // TODO: check memory leak
-        seg->baseStart = commonStart;
-        seg->baseSize = seg->localSize = seg->remoteSize = commonEnd - commonStart + 1;
-        seg->localStart = indexLocal;
-        seg->remoteStart = indexRemote;
-        seg->type = MergeSegment2::Type::Unchanged;
+        MergeSegment2 seg;
+        seg.baseStart = commonStart;
+        seg.baseSize = seg.localSize = seg.remoteSize = commonEnd - commonStart + 1;
+        seg.localStart = indexLocal;
+        seg.remoteStart = indexRemote;
+        seg.type = MergeSegment2::Type::Unchanged;
 
         if (commonStart > indexBase || itRemote->rightStart > indexRemote || itLocal->rightStart > indexLocal) {
-            auto segChanged = new MergeSegment2;
-            segChanged->baseStart = indexBase;
-            segChanged->baseSize = commonStart - indexBase;
+            MergeSegment2 segChanged;
+            segChanged.baseStart = indexBase;
+            segChanged.baseSize = commonStart - indexBase;
 
             auto localEnd = getRight(commonStart - 1, itLocal);
             auto remoteEnd = getRight(commonStart - 1, itRemote);
 
-            segChanged->localStart = indexLocal;
-            segChanged->localSize = localEnd - segChanged->localStart + 1;
+            segChanged.localStart = indexLocal;
+            segChanged.localSize = localEnd - segChanged.localStart + 1;
 
-            segChanged->remoteStart = indexRemote;
-            segChanged->remoteSize = remoteEnd - segChanged->remoteStart + 1;
+            segChanged.remoteStart = indexRemote;
+            segChanged.remoteSize = remoteEnd - segChanged.remoteStart + 1;
 
-            if (segChanged->remoteSize && segChanged->localSize)
-                segChanged->type = MergeSegment2::Type::ChangedOnBoth;
-            else if (segChanged->localSize)
-                segChanged->type = MergeSegment2::Type::OnlyOnLocal;
-            else if (segChanged->remoteSize)
-                segChanged->type = MergeSegment2::Type::OnlyOnRemote;
+            if (segChanged.remoteSize && segChanged.localSize)
+                segChanged.type = MergeSegment2::Type::ChangedOnBoth;
+            else if (segChanged.localSize)
+                segChanged.type = MergeSegment2::Type::OnlyOnLocal;
+            else if (segChanged.remoteSize)
+                segChanged.type = MergeSegment2::Type::OnlyOnRemote;
             else
-                segChanged->type = MergeSegment2::Type::Unchanged;
+                segChanged.type = MergeSegment2::Type::Unchanged;
 
-            if (Q_UNLIKELY(segChanged->type != MergeSegment2::Type::Unchanged))
+            if (Q_UNLIKELY(segChanged.type != MergeSegment2::Type::Unchanged))
                 result << segChanged;
             else
                 qDebug() << "Invalid segment detected";
 
-            indexLocal += segChanged->localSize;
-            indexRemote += segChanged->remoteSize;
+            indexLocal += segChanged.localSize;
+            indexRemote += segChanged.remoteSize;
         }
 
-        seg->localStart = getRight(commonStart, itLocal);
-        seg->remoteStart = getRight(commonStart, itRemote);
-        seg->type = MergeSegment2::Type::Unchanged;
+        seg.localStart = getRight(commonStart, itLocal);
+        seg.remoteStart = getRight(commonStart, itRemote);
+        seg.type = MergeSegment2::Type::Unchanged;
 
         result << seg;
 
-        indexLocal = seg->localStart + seg->localSize;
-        indexRemote = seg->remoteStart + seg->remoteSize;
+        indexLocal = seg.localStart + seg.localSize;
+        indexRemote = seg.remoteStart + seg.remoteSize;
         indexBase = commonEnd + 1;
 
         if (itLocal->leftEnd < indexBase)
@@ -108,17 +107,17 @@ MergeResult<T> diff3(const QList<T> &base, const QList<T> &local, const QList<T>
     }
 
     if (itLocal != withLocal.end() || itRemote != withRemote.end()) {
-        auto segChanged = new MergeSegment2;
-        segChanged->baseStart = indexBase;
-        segChanged->baseSize = base.size() - indexBase;
+        MergeSegment2 segChanged;
+        segChanged.baseStart = indexBase;
+        segChanged.baseSize = base.size() - indexBase;
 
-        segChanged->localStart = indexLocal + 1;
-        segChanged->localSize = local.size() - indexLocal;
+        segChanged.localStart = indexLocal + 1;
+        segChanged.localSize = local.size() - indexLocal;
 
-        segChanged->remoteStart = indexRemote + 1;
-        segChanged->remoteSize = remote.size() - indexRemote;
+        segChanged.remoteStart = indexRemote + 1;
+        segChanged.remoteSize = remote.size() - indexRemote;
 
-        segChanged->type = MergeSegment2::Type::ChangedOnBoth;
+        segChanged.type = MergeSegment2::Type::ChangedOnBoth;
 
         result << segChanged;
     }
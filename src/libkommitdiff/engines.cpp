@@ -0,0 +1,368 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "engines.h"
+#include "kernels.h"
+#include "myers.h"
+
+#include <QHash>
+
+#include <algorithm>
+
+namespace Diff
+{
+
+namespace Impl
+{
+
+namespace
+{
+
+class Engine
+{
+public:
+    Engine(const std::vector<int> &left, const std::vector<int> &right, QList<LcsResult> *result, DiffControl *control)
+        : mLeft{left.data()}
+        , mRight{right.data()}
+        , mMyers{left.data(), int(left.size()), right.data(), int(right.size()), control}
+        , mResult{result}
+    {
+    }
+
+    void patience(int off1, int lim1, int off2, int lim2);
+    void histogram(int off1, int lim1, int off2, int lim2);
+
+private:
+    struct Anchor {
+        int left;
+        int right;
+        int length;
+    };
+
+    // Puts in @p anchors the runs, in order, a pair of ranges with nothing in common at
+    // either end is split at; none for Myers to compare the pair.
+    using FindAnchors = void (Engine::*)(int off1, int lim1, int off2, int lim2, std::vector<Anchor> &anchors) const;
+
+    // A pair of ranges still to compare or, when length is set, a run matched already,
+    // which goes to the result once everything before it has.
+    struct Work {
+        int off1;
+        int lim1;
+        int off2;
+        int lim2;
+        int length{-1};
+    };
+
+    void run(int off1, int lim1, int off2, int lim2, FindAnchors findAnchors);
+    void patienceAnchors(int off1, int lim1, int off2, int lim2, std::vector<Anchor> &anchors) const;
+    void histogramAnchors(int off1, int lim1, int off2, int lim2, std::vector<Anchor> &anchors) const;
+
+    // Matches the head the ranges share and takes it off them, then the tail, which is
+    // returned to be added once the rest has been.
+    int trim(int &off1, int &lim1, int &off2, int &lim2);
+
+    const int *mLeft;
+    const int *mRight;
+    Myers mMyers;
+    QList<LcsResult> *mResult;
+};
+
+int Engine::trim(int &off1, int &lim1, int &off2, int &lim2)
+{
+    const auto head = matchForward(mLeft + off1, mRight + off2, std::min(lim1 - off1, lim2 - off2));
+    appendMatch(mResult, off1, off2, head);
+    off1 += head;
+    off2 += head;
+
+    const auto tail = matchBackward(mLeft + lim1, mRight + lim2, std::min(lim1 - off1, lim2 - off2));
+    lim1 -= tail;
+    lim2 -= tail;
+    return tail;
+}
+
+void Engine::patience(int off1, int lim1, int off2, int lim2)
+{
+    run(off1, lim1, off2, lim2, &Engine::patienceAnchors);
+}
+
+void Engine::histogram(int off1, int lim1, int off2, int lim2)
+{
+    run(off1, lim1, off2, lim2, &Engine::histogramAnchors);
+}
+
+void Engine::run(int off1, int lim1, int off2, int lim2, FindAnchors findAnchors)
+{
+    // The pieces between the anchors are kept on a stack of their own rather than recursed
+    // into: a file where every other line changed would otherwise take a call per line, and
+    // the tables of each. The anchors are found, and their tables let go of, before any of
+    // the pieces is looked at, and the pieces go on in reverse so they come off in order.
+    std::vector<Work> stack{{off1, lim1, off2, lim2}};
+    std::vector<Anchor> anchors;
+
+    while (!stack.empty()) {
+        auto work = stack.back();
+        stack.pop_back();
+
+        if (work.length != -1) {
+            appendMatch(mResult, work.off1, work.off2, work.length);
+            continue;
+        }
+        if (mMyers.interrupted(work.off1))
+            return;
+
+        const auto tail = trim(work.off1, work.lim1, work.off2, work.lim2);
+        if (tail)
+            stack.push_back({work.lim1, work.lim1, work.lim2, work.lim2, tail});
+
+        if (work.off1 >= work.lim1 || work.off2 >= work.lim2)
+            continue;
+
+        anchors.clear();
+        (this->*findAnchors)(work.off1, work.lim1, work.off2, work.lim2, anchors);
+        if (anchors.empty()) {
+            mMyers.compare(work.off1, work.lim1, work.off2, work.lim2, mResult);
+            continue;
+        }
+
+        auto lim1Before = work.lim1;
+        auto lim2Before = work.lim2;
+        for (auto anchor = anchors.crbegin(); anchor != anchors.crend(); ++anchor) {
+            stack.push_back({anchor->left + anchor->length, lim1Before, anchor->right + anchor->length, lim2Before});
+            stack.push_back({anchor->left, anchor->left, anchor->right, anchor->right, anchor->length});
+            lim1Before = anchor->left;
+            lim2Before = anchor->right;
+        }
+        stack.push_back({work.off1, lim1Before, work.off2, lim2Before});
+    }
+}
+
+void Engine::patienceAnchors(int off1, int lim1, int off2, int lim2, std::vector<Anchor> &anchors) const
+{
+    struct Occurrence {
+        int leftCount{0};
+        int rightCount{0};
+        int left{-1};
+        int right{-1};
+    };
+
+    QHash<int, Occurrence> occurrences;
+    occurrences.reserve(lim1 - off1);
+    for (auto i = off1; i < lim1; ++i) {
+        auto &occurrence = occurrences[mLeft[i]];
+        ++occurrence.leftCount;
+        occurrence.left = i;
+    }
+    for (auto j = off2; j < lim2; ++j) {
+        auto occurrence = occurrences.find(mRight[j]);
+        if (occurrence != occurrences.end()) {
+            ++occurrence->rightCount;
+            occurrence->right = j;
+        }
+    }
+
+    // The lines unique on both sides, in left order, and of those the longest run that is
+    // in order on the right as well, by patience sorting.
+    std::vector<std::pair<int, int>> unique;
+    for (auto i = off1; i < lim1; ++i) {
+        const auto &occurrence = occurrences[mLeft[i]];
+        if (occurrence.leftCount == 1 && occurrence.rightCount == 1)
+            unique.emplace_back(i, occurrence.right);
+    }
+
+    std::vector<int> pileTops;
+    std::vector<int> previous(unique.size(), -1);
+    std::vector<int> tops;
+    for (int k = 0; k < int(unique.size()); ++k) {
+        auto pile = std::lower_bound(pileTops.begin(), pileTops.end(), unique[k].second) - pileTops.begin();
+        if (pile == int(pileTops.size())) {
+            pileTops.push_back(unique[k].second);
+            tops.push_back(k);
+        } else {
+            pileTops[pile] = unique[k].second;
+            tops[pile] = k;
+        }
+        if (pile)
+            previous[k] = tops[pile - 1];
+    }
+
+    if (tops.empty())
+        return;
+
+    for (auto k = tops.back(); k != -1; k = previous[k])
+        anchors.push_back({unique[k].first, unique[k].second, 1});
+    std::reverse(anchors.begin(), anchors.end());
+}
+
+void Engine::histogramAnchors(int off1, int lim1, int off2, int lim2, std::vector<Anchor> &anchors) const
+{
+    constexpr int maxChainLength{64};
+
+    struct Record {
+        int first{-1};
+        int count{0};
+    };
+
+    // Where each line occurs on the left, as a chain through next from the first one.
+    QHash<int, Record> records;
+    records.reserve(lim1 - off1);
+    std::vector<int> next(lim1 - off1);
+    for (auto i = lim1 - 1; i >= off1; --i) {
+        auto &record = records[mLeft[i]];
+        next[i - off1] = record.first;
+        record.first = i;
+        ++record.count;
+    }
+    std::vector<int> counts(lim1 - off1);
+    for (auto i = off1; i < lim1; ++i)
+        counts[i - off1] = records.value(mLeft[i]).count;
+
+    int best1{-1}, bestEnd1{-1}, best2{-1};
+    auto bestCount = maxChainLength + 1;
+
+    for (auto j = off2; j < lim2;) {
+        auto nextJ = j + 1;
+        const auto record = records.constFind(mRight[j]);
+        if (record == records.cend() || record->count > bestCount) {
+            j = nextJ;
+            continue;
+        }
+
+        for (auto i = record->first; i != -1; i = next[i - off1]) {
+            auto as = i;
+            auto bs = j;
+            auto ae = i + 1;
+            auto be = j + 1;
+            auto count = counts[i - off1];
+
+            while (as > off1 && bs > off2 && mLeft[as - 1] == mRight[bs - 1]) {
+                --as;
+                --bs;
+                count = std::min(count, counts[as - off1]);
+            }
+            while (ae < lim1 && be < lim2 && mLeft[ae] == mRight[be]) {
+                count = std::min(count, counts[ae - off1]);
+                ++ae;
+                ++be;
+            }
+
+            nextJ = std::max(nextJ, be);
+            if (bestEnd1 - best1 < ae - as || count < bestCount) {
+                best1 = as;
+                bestEnd1 = ae;
+                best2 = bs;
+                bestCount = count;
+            }
+        }
+        j = nextJ;
+    }
+
+    if (best1 != -1)
+        anchors.push_back({best1, best2, bestEnd1 - best1});
+}
+
+}
+
+QList<LcsResult> commonSubsequence(const std::vector<int> &left, const std::vector<int> &right, DiffAlgorithm algorithm, DiffControl *control)
+{
+    switch (algorithm) {
+    case DiffAlgorithm::Patience:
+        return patience(left, right, control);
+    case DiffAlgorithm::Histogram:
+        return histogram(left, right, control);
+    case DiffAlgorithm::Myers:
+        break;
+    }
+    return myers(left, right, control);
+}
+
+QList<LcsResult> myers(const std::vector<int> &left, const std::vector<int> &right, DiffControl *control)
+{
+    QList<LcsResult> result;
+    Myers{left.data(), int(left.size()), right.data(), int(right.size()), control}.compare(0, int(left.size()), 0, int(right.size()), &result);
+    return result;
+}
+
+QList<LcsResult> bitParallel(const int *left, int leftSize, const int *right, int rightSize)
+{
+    using Word = quint64;
+    const auto words = (rightSize + 63) / 64;
+
+    // Where each id occurs on the right: positions sorted by id, then by position.
+    std::vector<int> positions(rightSize);
+    for (int j = 0; j < rightSize; ++j)
+        positions[j] = j;
+    std::stable_sort(positions.begin(), positions.end(), [right](int a, int b) {
+        return right[a] < right[b];
+    });
+
+    // Row i holds, for every column j, a zero bit where row i of the dynamic programming
+    // table grows by one from column j to j + 1. Row 0 is all ones.
+    std::vector<Word> rows(size_t(leftSize + 1) * words, ~Word{0});
+    std::vector<Word> matches(words);
+
+    for (int i = 0; i < leftSize; ++i) {
+        const auto first = std::lower_bound(positions.begin(), positions.end(), left[i], [right](int position, int id) {
+            return right[position] < id;
+        });
+        const auto last = std::upper_bound(first, positions.end(), left[i], [right](int id, int position) {
+            return id < right[position];
+        });
+        for (auto p = first; p != last; ++p)
+            matches[*p / 64] |= Word{1} << (*p % 64);
+
+        const auto *previous = rows.data() + size_t(i) * words;
+        auto *row = rows.data() + size_t(i + 1) * words;
+        Word carry{0};
+        for (int w = 0; w < words; ++w) {
+            const auto v = previous[w];
+            const auto u = v & matches[w];
+            const auto sum = v + u + carry;
+            carry = sum < v || (carry && sum == v);
+            row[w] = sum | (v - u);
+        }
+
+        for (auto p = first; p != last; ++p)
+            matches[*p / 64] = 0;
+    }
+
+    // Back from the end: a match is always part of some longest subsequence, otherwise
+    // the bit tells whether the value comes from the left or from above.
+    QList<LcsResult> result;
+    auto i = leftSize;
+    auto j = rightSize;
+    while (i > 0 && j > 0) {
+        if (left[i - 1] == right[j - 1]) {
+            auto count = matchBackward(left + i, right + j, std::min(i, j));
+            i -= count;
+            j -= count;
+            result.append({i, i + count - 1, j, j + count - 1});
+        } else if (rows[size_t(i) * words + (j - 1) / 64] >> ((j - 1) % 64) & 1) {
+            --j;
+        } else {
+            --i;
+        }
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+QList<LcsResult> patience(const std::vector<int> &left, const std::vector<int> &right, DiffControl *control)
+{
+    QList<LcsResult> result;
+    Engine{left, right, &result, control}.patience(0, int(left.size()), 0, int(right.size()));
+    return result;
+}
+
+QList<LcsResult> histogram(const std::vector<int> &left, const std::vector<int> &right, DiffControl *control)
+{
+    QList<LcsResult> result;
+    Engine{left, right, &result, control}.histogram(0, int(left.size()), 0, int(right.size()));
+    return result;
+}
+
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "lcsresult.h"
+#include "libkommitdiff_export.h"
+#include "types.h"
+
+#include <vector>
+
+namespace Diff
+{
+
+namespace Impl
+{
+
+/**
+ * The runs two sequences of ids have in common, in order, found with @p algorithm.
+ *
+ * With a @p control, the progress is reported to it as the runs are found, and the search
+ * stops early, returning whatever it has so far, once it is canceled.
+ */
+[[nodiscard]] LIBKOMMITDIFF_EXPORT QList<LcsResult>
+commonSubsequence(const std::vector<int> &left, const std::vector<int> &right, DiffAlgorithm algorithm, DiffControl *control = nullptr);
+
+/**
+ * Myers' algorithm, see Myers, over sequences of ids, equal for elements that compare
+ * equal, so that comparing two lines is comparing two ints.
+ */
+[[nodiscard]] LIBKOMMITDIFF_EXPORT QList<LcsResult> myers(const std::vector<int> &left, const std::vector<int> &right, DiffControl *control = nullptr);
+
+/**
+ * The longest common subsequence of two sequences of ids, found exactly by the
+ * bit-parallel algorithm of Allison and Dix, as improved by Hyyrö: a row of the dynamic
+ * programming table is worked out 64 columns at a time with word additions. This takes
+ * time proportional to the product of the sizes over 64, whatever is in the sequences, and
+ * keeps every row for walking back through them, so it is for ranges of moderate size.
+ */
+[[nodiscard]] LIBKOMMITDIFF_EXPORT QList<LcsResult> bitParallel(const int *left, int leftSize, const int *right, int rightSize);
+
+/**
+ * Patience diff: the lines that occur exactly once on each side are matched up first, as
+ * many of them as keep their order, and the gaps between them are diffed the same way.
+ * Where a gap has no such lines, Myers' algorithm takes over.
+ */
+[[nodiscard]] LIBKOMMITDIFF_EXPORT QList<LcsResult> patience(const std::vector<int> &left, const std::vector<int> &right, DiffControl *control = nullptr);
+
+/**
+ * Histogram diff, as in git and JGit: a refinement of patience diff that anchors on the
+ * longest run of common lines among those that occur least often on the left, rather than
+ * only on unique lines, which makes for hunks that follow the structure of the code the
+ * way a reader expects. Ranges where every line occurs more than 64 times fall back to
+ * Myers' algorithm.
+ */
+[[nodiscard]] LIBKOMMITDIFF_EXPORT QList<LcsResult> histogram(const std::vector<int> &left, const std::vector<int> &right, DiffControl *control = nullptr);
+
+}
+
+}
@@ -0,0 +1,150 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "kernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KOMMITDIFF_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace Diff
+{
+
+namespace Impl
+{
+
+namespace
+{
+
+using Kernel = int (*)(const int *, const int *, int);
+
+int forwardScalar(const int *left, const int *right, int count)
+{
+    int n{0};
+    while (n < count && left[n] == right[n])
+        ++n;
+    return n;
+}
+
+int backwardScalar(const int *leftEnd, const int *rightEnd, int count)
+{
+    int n{0};
+    while (n < count && leftEnd[-n - 1] == rightEnd[-n - 1])
+        ++n;
+    return n;
+}
+
+#ifdef KOMMITDIFF_X86_KERNELS
+
+// SSE2 is part of x86-64, so only AVX2 has to be asked for.
+
+int forwardSse2(const int *left, const int *right, int count)
+{
+    int n{0};
+    for (; n + 4 <= count; n += 4) {
+        auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(left + n));
+        auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(right + n));
+        auto same = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)));
+        if (same != 0xffff)
+            return n + __builtin_ctz(~same) / 4;
+    }
+    return n + forwardScalar(left + n, right + n, count - n);
+}
+
+int backwardSse2(const int *leftEnd, const int *rightEnd, int count)
+{
+    int n{0};
+    for (; n + 4 <= count; n += 4) {
+        auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(leftEnd - n - 4));
+        auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rightEnd - n - 4));
+        auto same = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)));
+        if (same != 0xffff)
+            return n + __builtin_clz(~same << 16) / 4;
+    }
+    return n + backwardScalar(leftEnd - n, rightEnd - n, count - n);
+}
+
+__attribute__((target("avx2"))) int forwardAvx2(const int *left, const int *right, int count)
+{
+    int n{0};
+    for (; n + 8 <= count; n += 8) {
+        auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(left + n));
+        auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + n));
+        auto same = unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b)));
+        if (same != 0xffffffff)
+            return n + __builtin_ctz(~same) / 4;
+    }
+    return n + forwardSse2(left + n, right + n, count - n);
+}
+
+__attribute__((target("avx2"))) int backwardAvx2(const int *leftEnd, const int *rightEnd, int count)
+{
+    int n{0};
+    for (; n + 8 <= count; n += 8) {
+        auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(leftEnd - n - 8));
+        auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rightEnd - n - 8));
+        auto same = unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b)));
+        if (same != 0xffffffff)
+            return n + __builtin_clz(~same) / 4;
+    }
+    return n + backwardSse2(leftEnd - n, rightEnd - n, count - n);
+}
+
+bool hasAvx2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+Kernel forwardKernel()
+{
+    return hasAvx2() ? forwardAvx2 : forwardSse2;
+}
+
+Kernel backwardKernel()
+{
+    return hasAvx2() ? backwardAvx2 : backwardSse2;
+}
+
+#else
+
+Kernel forwardKernel()
+{
+    return forwardScalar;
+}
+
+Kernel backwardKernel()
+{
+    return backwardScalar;
+}
+
+#endif
+
+}
+
+int matchForward(const int *left, const int *right, int count)
+{
+    // Most snakes stop at the first line, where setting up the vectors would not pay.
+    if (count <= 0 || *left != *right)
+        return 0;
+
+    static const auto kernel = forwardKernel();
+    return kernel(left, right, count);
+}
+
+int matchBackward(const int *leftEnd, const int *rightEnd, int count)
+{
+    if (count <= 0 || leftEnd[-1] != rightEnd[-1])
+        return 0;
+
+    static const auto kernel = backwardKernel();
+    return kernel(leftEnd, rightEnd, count);
+}
+
+}
+
+}
@@ -0,0 +1,31 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommitdiff_export.h"
+
+namespace Diff
+{
+
+namespace Impl
+{
+
+/**
+ * How many ids @p left and @p right have in common from their start, looking at no more
+ * than @p count of them.
+ *
+ * These compare eight or four ids at a time where the processor can, picked when first
+ * called, since runs of unchanged lines are what a diff of two versions mostly has.
+ */
+[[nodiscard]] LIBKOMMITDIFF_EXPORT int matchForward(const int *left, const int *right, int count);
+
+/// Same as matchForward(), going back from just before @p leftEnd and @p rightEnd.
+[[nodiscard]] LIBKOMMITDIFF_EXPORT int matchBackward(const int *leftEnd, const int *rightEnd, int count);
+
+}
+
+}
@@ -7,10 +7,14 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 
 #include "array.h"
+#include "engines.h"
+#include "lcsresult.h"
 #include "libkommitdiff_export.h"
 #include "solution.h"
 
 #include <QBitArray>
+#include <QHash>
+#include <QVarLengthArray>
 
 namespace Diff
 {
@@ -37,19 +41,17 @@ struct LcsOptions<QString> {
     }
 };
 
-struct LcsResult {
-    int leftStart;
-    int leftEnd;
-    int rightStart;
-    int rightEnd;
-};
-
 int LIBKOMMITDIFF_EXPORT maxIn(int first, int second, int third);
 int LIBKOMMITDIFF_EXPORT maxIn(int first, int second);
 int LIBKOMMITDIFF_EXPORT maxIn(const QList<int> &list);
 
-template<typename T>
-[[nodiscard]] QList<LcsResult> longestCommonSubsequence(const QList<T> &left, const QList<T> &right, const std::function<bool(const T &, const T &)> &equals)
+/**
+ * The longest common subsequence by filling the whole dynamic programming table, which
+ * takes time and memory proportional to the product of the sizes. @p equals is any
+ * callable taking two elements, inlined into the loop.
+ */
+template<typename T, typename Equal>
+[[nodiscard]] QList<LcsResult> longestCommonSubsequence(const QList<T> &left, const QList<T> &right, Equal equals)
 {
     Array2<int> l(left.size() + 1, right.size() + 1);
 
@@ -102,6 +104,98 @@ template<typename T>
     return result;
 }
 
+namespace Impl
+{
+
+/**
+ * Gives elements ids, the same for elements @p opts considers equal, so the algorithms
+ * compare ints rather than lines. Each element is hashed once and compared only with the
+ * elements that hash the same; ids stay the same across calls to ids(), so that the three
+ * texts of a merge can be compared with each other.
+ */
+template<typename T>
+class Classifier
+{
+public:
+    explicit Classifier(const DiffOptions<T> &opts)
+        : mOpts{opts}
+    {
+    }
+
+    /// The ids of the @p size elements from @p elements on, which have to outlive this.
+    [[nodiscard]] std::vector<int> ids(const T *elements, qsizetype size)
+    {
+        mClasses.reserve(mClasses.size() + size);
+        std::vector<int> result(size);
+        for (qsizetype i = 0; i < size; ++i)
+            result[i] = idOf(elements[i]);
+        return result;
+    }
+
+    [[nodiscard]] std::vector<int> ids(const QList<T> &elements)
+    {
+        return ids(elements.constData(), elements.size());
+    }
+
+private:
+    int idOf(const T &element)
+    {
+        auto &bucket = mClasses[mOpts.hash(element)];
+        for (const auto &[other, id] : std::as_const(bucket))
+            if (mOpts.equals(*other, element))
+                return id;
+        bucket.append({&element, mCount});
+        return mCount++;
+    }
+
+    const DiffOptions<T> &mOpts;
+    // Elements with the same hash, each with the id it was given.
+    QHash<size_t, QVarLengthArray<std::pair<const T *, int>, 1>> mClasses;
+    int mCount{0};
+};
+
+}
+
+/**
+ * The runs @p left and @p right have in common, in order, found with the algorithm
+ * @p opts asks for.
+ *
+ * The head and tail the two share are matched first and left out; an edit to a large file
+ * usually leaves little else. The lines in between are turned into ids, see
+ * Impl::Classifier, and the algorithm runs on those, taking time about proportional to
+ * their number times the number of lines that differ, and memory proportional to their
+ * number.
+ */
+template<typename T>
+[[nodiscard]] QList<LcsResult> commonSubsequence(const QList<T> &left, const QList<T> &right, const DiffOptions<T> &opts)
+{
+    const auto common = std::min(left.size(), right.size());
+    qsizetype head{0};
+    while (head < common && opts.equals(left.at(head), right.at(head)))
+        ++head;
+    qsizetype tail{0};
+    while (tail < common - head && opts.equals(left.at(left.size() - tail - 1), right.at(right.size() - tail - 1)))
+        ++tail;
+
+    QList<LcsResult> result;
+    Impl::appendMatch(&result, 0, 0, int(head));
+
+    const auto leftSize = left.size() - head - tail;
+    const auto rightSize = right.size() - head - tail;
+    if (leftSize && rightSize) {
+        Impl::Classifier<T> classifier{opts};
+        const auto leftIds = classifier.ids(left.constData() + head, leftSize);
+        const auto rightIds = classifier.ids(right.constData() + head, rightSize);
+
+        const auto middle = Impl::commonSubsequence(leftIds, rightIds, opts.algorithm, opts.control);
+        for (const auto &run : middle)
+            Impl::appendMatch(&result, run.leftStart + int(head), run.rightStart + int(head), run.leftEnd - run.leftStart + 1);
+    }
+
+    Impl::appendMatch(&result, int(left.size() - tail), int(right.size() - tail), int(tail));
+    return result;
+}
+
 Q_DECL_DEPRECATED
 [[nodiscard]] Solution longestCommonSubsequence(const QStringList &source, const QStringList &target);
 
@@ -0,0 +1,44 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QList>
+
+namespace Diff
+{
+
+/// A run two sequences have in common, ends included.
+struct LcsResult {
+    int leftStart;
+    int leftEnd;
+    int rightStart;
+    int rightEnd;
+};
+
+namespace Impl
+{
+
+/// Adds @p count elements in common from @p left and @p right on, extending the last run.
+inline void appendMatch(QList<LcsResult> *result, int left, int right, int count)
+{
+    if (count <= 0)
+        return;
+
+    if (!result->isEmpty()) {
+        auto &last = result->last();
+        if (last.leftEnd + 1 == left && last.rightEnd + 1 == right) {
+            last.leftEnd += count;
+            last.rightEnd += count;
+            return;
+        }
+    }
+    result->append({left, left + count - 1, right, right + count - 1});
+}
+
+}
+
+}
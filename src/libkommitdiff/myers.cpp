@@ -0,0 +1,200 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "myers.h"
+#include "engines.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace Diff
+{
+
+namespace Impl
+{
+
+namespace
+{
+// How large a range, in rows times 64-bit words, is still solved exactly once the search
+// gets too expensive: 8 MiB of rows, about eight thousand lines on each side.
+constexpr qint64 maxBitParallelWords{1 << 20};
+}
+
+Myers::Myers(const int *left, int leftSize, const int *right, int rightSize, DiffControl *control)
+    : mLeft{left}
+    , mRight{right}
+    , mForward(leftSize + rightSize + 3)
+    , mBackward(leftSize + rightSize + 3)
+    , mOffset{rightSize + 1}
+    , mLeftSize{leftSize}
+    , mControl{control}
+{
+    // The cost past which a search gives up on being minimal, as git's xdiff picks it.
+    auto size = leftSize + rightSize + 3;
+    mMaxCost = 1;
+    while (size >>= 2)
+        mMaxCost <<= 1;
+    mMaxCost = std::max(mMaxCost, 256);
+}
+
+void Myers::compare(int leftBegin, int leftEnd, int rightBegin, int rightEnd, QList<LcsResult> *result)
+{
+    mResult = result;
+    compareRange(leftBegin, leftEnd, rightBegin, rightEnd, false);
+    mResult = nullptr;
+}
+
+bool Myers::interrupted(int leftDone) const
+{
+    if (!mControl)
+        return false;
+    if (mLeftSize)
+        mControl->progress.store(int(qint64(leftDone) * 1000 / mLeftSize), std::memory_order_relaxed);
+    return mControl->isCanceled();
+}
+
+void Myers::compareRange(int off1, int lim1, int off2, int lim2, bool minimal)
+{
+    // The head and tail the two ranges share are part of any shortest edit script.
+    const auto head = matchForward(mLeft + off1, mRight + off2, std::min(lim1 - off1, lim2 - off2));
+    appendMatch(mResult, off1, off2, head);
+    off1 += head;
+    off2 += head;
+
+    const auto tail = matchBackward(mLeft + lim1, mRight + lim2, std::min(lim1 - off1, lim2 - off2));
+    lim1 -= tail;
+    lim2 -= tail;
+
+    if (interrupted(off1))
+        return;
+
+    if (off1 < lim1 && off2 < lim2) {
+        const auto s = split(off1, lim1, off2, lim2, minimal);
+        if (s.exact) {
+            const auto runs = bitParallel(mLeft + off1, lim1 - off1, mRight + off2, lim2 - off2);
+            for (const auto &run : runs)
+                appendMatch(mResult, run.leftStart + off1, run.rightStart + off2, run.leftEnd - run.leftStart + 1);
+        } else {
+            compareRange(off1, s.left, off2, s.right, s.minimalBefore);
+            compareRange(s.left, lim1, s.right, lim2, s.minimalAfter);
+        }
+    }
+
+    appendMatch(mResult, lim1, lim2, tail);
+}
+
+Myers::Split Myers::split(int off1, int lim1, int off2, int lim2, bool minimal)
+{
+    const auto dmin = off1 - lim2;
+    const auto dmax = lim1 - off2;
+    const auto fmid = off1 - off2;
+    const auto bmid = lim1 - lim2;
+    const bool odd = (fmid - bmid) & 1;
+    auto fmin = fmid;
+    auto fmax = fmid;
+    auto bmin = bmid;
+    auto bmax = bmid;
+
+    forward(fmid) = off1;
+    backward(bmid) = lim1;
+
+    for (int cost = 1;; ++cost) {
+        // One more step forward on every diagonal in reach, following the snake after it.
+        if (fmin > dmin)
+            forward(--fmin - 1) = -1;
+        else
+            ++fmin;
+        if (fmax < dmax)
+            forward(++fmax + 1) = -1;
+        else
+            --fmax;
+
+        for (auto d = fmax; d >= fmin; d -= 2) {
+            auto i1 = forward(d - 1) >= forward(d + 1) ? forward(d - 1) + 1 : forward(d + 1);
+            auto i2 = i1 - d;
+            const auto snake = matchForward(mLeft + i1, mRight + i2, std::min(lim1 - i1, lim2 - i2));
+            i1 += snake;
+            i2 += snake;
+            forward(d) = i1;
+
+            if (odd && bmin <= d && d <= bmax && backward(d) <= i1)
+                return {i1, i2, true, true, false};
+        }
+
+        // And one step back.
+        if (bmin > dmin)
+            backward(--bmin - 1) = INT_MAX;
+        else
+            ++bmin;
+        if (bmax < dmax)
+            backward(++bmax + 1) = INT_MAX;
+        else
+            --bmax;
+
+        for (auto d = bmax; d >= bmin; d -= 2) {
+            auto i1 = backward(d - 1) < backward(d + 1) ? backward(d - 1) : backward(d + 1) - 1;
+            auto i2 = i1 - d;
+            const auto snake = matchBackward(mLeft + i1, mRight + i2, std::min(i1 - off1, i2 - off2));
+            i1 -= snake;
+            i2 -= snake;
+            backward(d) = i1;
+
+            if (!odd && fmin <= d && d <= fmax && i1 <= forward(d))
+                return {i1, i2, true, true, false};
+        }
+
+        // A search that does not meet can go on for long; a canceled one stops with any
+        // split, the halves of which are given up on by compareRange().
+        if (mControl && mControl->isCanceled())
+            return {off1, off2, true, true, false};
+
+        if (minimal || cost < mMaxCost)
+            continue;
+
+        if (qint64(lim1 - off1) * ((lim2 - off2 + 63) / 64) <= maxBitParallelWords)
+            return {0, 0, false, false, true};
+
+        // Too expensive: split where the search that got furthest has got to.
+        auto forwardBest = -1;
+        auto forwardBest1 = -1;
+        for (auto d = fmax; d >= fmin; d -= 2) {
+            auto i1 = std::min(forward(d), lim1);
+            auto i2 = i1 - d;
+            if (lim2 < i2) {
+                i1 = lim2 + d;
+                i2 = lim2;
+            }
+            if (forwardBest < i1 + i2) {
+                forwardBest = i1 + i2;
+                forwardBest1 = i1;
+            }
+        }
+
+        auto backwardBest = INT_MAX;
+        auto backwardBest1 = INT_MAX;
+        for (auto d = bmax; d >= bmin; d -= 2) {
+            auto i1 = std::max(off1, backward(d));
+            auto i2 = i1 - d;
+            if (i2 < off2) {
+                i1 = off2 + d;
+                i2 = off2;
+            }
+            if (i1 + i2 < backwardBest) {
+                backwardBest = i1 + i2;
+                backwardBest1 = i1;
+            }
+        }
+
+        if ((lim1 + lim2) - backwardBest < forwardBest - (off1 + off2))
+            return {forwardBest1, forwardBest - forwardBest1, true, false, false};
+        return {backwardBest1, backwardBest - backwardBest1, false, true, false};
+    }
+}
+
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "lcsresult.h"
+#include "types.h"
+
+#include <QList>
+
+#include <vector>
+
+namespace Diff
+{
+
+namespace Impl
+{
+
+/**
+ * Myers' O(ND) difference algorithm in linear space: the shortest edit script between two
+ * sequences is found by meeting a forward and a backward search in the middle and
+ * recursing on both halves, so memory stays proportional to the input, not to its square.
+ *
+ * The sequences are given as ids, equal for elements that compare equal.
+ *
+ * A pair of sequences with nothing much in common can take up to N² steps to prove it. As
+ * in git, once a search has gone past a cost of about the square root of the input without
+ * meeting, it either solves the range exactly with bitParallel(), when the range is small
+ * enough for that, or splits it at the furthest either side has got and moves on, which
+ * gives a correct but not always minimal result for such inputs.
+ */
+class Myers
+{
+public:
+    Myers(const int *left, int leftSize, const int *right, int rightSize, DiffControl *control = nullptr);
+
+    /// Appends the runs the two ranges have in common to @p result, in order.
+    void compare(int leftBegin, int leftEnd, int rightBegin, int rightEnd, QList<LcsResult> *result);
+
+    /// Reports to the control that the left side is done up to @p leftDone, and returns
+    /// whether the comparison has been canceled.
+    [[nodiscard]] bool interrupted(int leftDone) const;
+
+private:
+    struct Split {
+        int left;
+        int right;
+        bool minimalBefore;
+        bool minimalAfter;
+        // Set instead when the range is to be solved by bitParallel().
+        bool exact;
+    };
+
+    void compareRange(int off1, int lim1, int off2, int lim2, bool minimal);
+    Split split(int off1, int lim1, int off2, int lim2, bool minimal);
+
+    int &forward(int diagonal)
+    {
+        return mForward[diagonal + mOffset];
+    }
+
+    int &backward(int diagonal)
+    {
+        return mBackward[diagonal + mOffset];
+    }
+
+    const int *mLeft;
+    const int *mRight;
+    // The furthest point reached on each diagonal, i - j, by the forward and the backward
+    // search; sized for the whole input, so every range compared fits in them.
+    std::vector<int> mForward;
+    std::vector<int> mBackward;
+    int mOffset;
+    int mMaxCost;
+    int mLeftSize;
+    DiffControl *mControl;
+    QList<LcsResult> *mResult{nullptr};
+};
+
+}
+
+}
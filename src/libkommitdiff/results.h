@@ -74,17 +74,17 @@ struct MergeResult {
     QList<T> local;
     QList<T> remote;
 
-    QList<MergeSegment2 *> segments;
+    QList<MergeSegment2> segments;
 
-    QList<T> part(MergeSegment2 *segment, MergeSide side)
+    QList<T> part(const MergeSegment2 &segment, MergeSide side) const
     {
         switch (side) {
         case MergeSide::Base:
-            return base.mid(segment->baseStart, segment->baseSize);
+            return base.mid(segment.baseStart, segment.baseSize);
         case MergeSide::Local:
-            return local.mid(segment->localStart, segment->localSize);
+            return local.mid(segment.localStart, segment.localSize);
         case MergeSide::Remote:
-            return remote.mid(segment->remoteStart, segment->remoteSize);
+            return remote.mid(segment.remoteStart, segment.remoteSize);
         }
         return {};
     }
@@ -96,17 +96,17 @@ struct MergeResult<Text> {
     Text local;
     Text remote;
 
-    QList<MergeSegment2 *> segments;
+    QList<MergeSegment2> segments;
 
-    QList<QString> part(MergeSegment2 *segment, MergeSide side)
+    QList<QString> part(const MergeSegment2 &segment, MergeSide side) const
     {
         switch (side) {
         case MergeSide::Base:
-            return base.lines.mid(segment->baseStart, segment->baseSize);
+            return base.lines.mid(segment.baseStart, segment.baseSize);
         case MergeSide::Local:
-            return local.lines.mid(segment->localStart, segment->localSize);
+            return local.lines.mid(segment.localStart, segment.localSize);
         case MergeSide::Remote:
-            return remote.lines.mid(segment->remoteStart, segment->remoteSize);
+            return remote.lines.mid(segment.remoteStart, segment.remoteSize);
         }
         return {};
     }
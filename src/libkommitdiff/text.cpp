@@ -7,6 +7,9 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "text.h"
 
 #include <QDebug>
+#include <QFile>
+
+#include <cstring>
 
 namespace Diff
 {
@@ -79,30 +82,116 @@ Text readLines(const QString &text)
     return t;
 }
 
-TextView::TextView(const QString &text)
+TextView::TextView()
     : lineEnding{LineEnding::None}
 {
-    if (text.isEmpty())
+}
+
+TextView::TextView(const QByteArray &content)
+    : lineEnding{LineEnding::None}
+    , mBytes{content}
+{
+    splitUtf8(mBytes);
+}
+
+TextView TextView::readFile(const QString &path)
+{
+    QFile file{path};
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    return TextView{file.readAll()};
+}
+
+TextView TextView::borrow(QByteArrayView content, std::shared_ptr<const void> owner)
+{
+    TextView view;
+    view.mOwner = std::move(owner);
+    view.splitUtf8(content);
+    return view;
+}
+
+void TextView::splitUtf8(QByteArrayView content)
+{
+    if (content.isEmpty())
+        return;
+
+    const auto data = content.data();
+    const auto size = content.size();
+    const auto lf = static_cast<const char *>(std::memchr(data, '\n', size));
+    const auto cr = static_cast<const char *>(std::memchr(data, '\r', lf ? lf - data : size));
+
+    char separator{'\n'};
+    if (cr && cr + 1 == lf) {
+        lineEnding = LineEnding::CrLf;
+    } else if (cr) {
+        lineEnding = LineEnding::Cr;
+        separator = '\r';
+    } else if (lf) {
+        lineEnding = LineEnding::Lf;
+    }
+
+    qsizetype begin{0};
+    while (true) {
+        auto end = static_cast<const char *>(std::memchr(data + begin, separator, size - begin));
+        auto length = (end ? end - data : size) - begin;
+        if (lineEnding == LineEnding::CrLf && end && length && data[begin + length - 1] == '\r')
+            --length;
+        utf8Lines.append(QUtf8StringView{data + begin, length});
+        if (!end)
+            break;
+        begin = end - data + 1;
+    }
+}
+
+bool TextView::isUtf8() const
+{
+    return !utf8Lines.isEmpty();
+}
+
+qsizetype TextView::lineCount() const
+{
+    return isUtf8() ? utf8Lines.size() : lines.size();
+}
+
+QString TextView::line(qsizetype index) const
+{
+    return isUtf8() ? utf8Lines.at(index).toString() : lines.at(index).toString();
+}
+
+QStringList TextView::lineRange(qsizetype index, qsizetype count) const
+{
+    QStringList result;
+    result.reserve(count);
+    for (auto i = index; i < index + count; ++i)
+        result.append(line(i));
+    return result;
+}
+
+TextView::TextView(const QString &text)
+    : content{text}
+    , lineEnding{LineEnding::None}
+{
+    if (content.isEmpty())
         return;
 
     QString separator;
-    LineEnding le = Impl::detectLineEnding(text, &separator);
+    lineEnding = Impl::detectLineEnding(content, &separator);
 
-    if (le == LineEnding::None) {
-        qWarning() << "Unable to detect line ending";
+    // Without a line ending, the text is a single line.
+    if (lineEnding == LineEnding::None) {
+        lines << QStringView{content};
         return;
     }
 
-    int i{0};
-    content = text;
-    lineEnding = le;
+    qsizetype i{0};
     while (i != -1) {
-        auto n = text.indexOf(separator, i);
+        auto n = content.indexOf(separator, i);
         if (n == -1) {
-            lines << QStringView{text}.mid(i);
+            lines << QStringView{content}.mid(i);
             break;
         }
-        lines << QStringView{text}.mid(i, n - i);
+        lines << QStringView{content}.mid(i, n - i);
         i = n + separator.size();
     }
 }
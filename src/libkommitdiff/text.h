@@ -11,6 +11,10 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <QList>
 #include <QString>
+#include <QStringList>
+#include <QUtf8StringView>
+
+#include <memory>
 
 namespace Diff
 {
@@ -21,11 +25,52 @@ struct LIBKOMMITDIFF_EXPORT Text {
     LineEnding lineEnding;
 };
 
+/**
+ * A text split into lines without copying them: the lines point into the content.
+ *
+ * Built from a QString, the lines are in lines. Built from bytes, whether an array, a file
+ * read from disk or the content of a blob, they are UTF-8 in utf8Lines, and nothing is
+ * decoded until line() or lineRange() asks for it, so a large file takes little more
+ * memory than its size. Copies share the content.
+ */
 struct LIBKOMMITDIFF_EXPORT TextView {
+    TextView();
     explicit TextView(const QString &content);
+    /// The UTF-8 text @p content, shared rather than copied.
+    explicit TextView(const QByteArray &content);
+
+    /**
+     * The file at @p path, read into memory; an empty text when it cannot be read. Files on
+     * disk are read rather than mapped, as anything can truncate them while the view lives,
+     * and reading a mapping past the end of a file crashes.
+     */
+    [[nodiscard]] static TextView readFile(const QString &path);
+
+    /**
+     * The UTF-8 text @p content, owned by someone else, such as a git_blob. @p owner is kept
+     * by the view and its copies, so the content has to live as long as it does, unchanged.
+     */
+    [[nodiscard]] static TextView borrow(QByteArrayView content, std::shared_ptr<const void> owner);
+
+    /// Whether the lines are in utf8Lines rather than in lines.
+    [[nodiscard]] bool isUtf8() const;
+    [[nodiscard]] qsizetype lineCount() const;
+    /// Line @p index, decoded if the text is UTF-8.
+    [[nodiscard]] QString line(qsizetype index) const;
+    /// @p count lines from @p index on, decoded if the text is UTF-8.
+    [[nodiscard]] QStringList lineRange(qsizetype index, qsizetype count) const;
+
     QString content;
     QList<QStringView> lines;
+    QList<QUtf8StringView> utf8Lines;
     LineEnding lineEnding;
+
+private:
+    void splitUtf8(QByteArrayView content);
+
+    // What utf8Lines point into, for as long as the view or a copy of it needs it.
+    QByteArray mBytes;
+    std::shared_ptr<const void> mOwner;
 };
 
 [[nodiscard]] Text readLines(const QString &text);
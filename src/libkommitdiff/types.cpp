@@ -0,0 +1,153 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "types.h"
+
+#include <QChar>
+
+namespace Diff
+{
+
+namespace Impl
+{
+
+namespace
+{
+
+void combine(size_t &hash, char32_t value)
+{
+    hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+}
+
+// The code point at @p i, moving @p i past it. A byte that does not start a well formed
+// sequence stands for itself, out of the range of code points so it matches only itself.
+char32_t nextCodePoint(QByteArrayView text, qsizetype &i)
+{
+    const auto lead = uchar(text.at(i++));
+    if (lead < 0x80)
+        return lead;
+
+    int length = lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : lead >= 0xc0 ? 1 : 0;
+    char32_t value = lead & (0x3f >> length);
+    if (!length || lead > 0xf4 || i + length > text.size())
+        return 0x110000 + lead;
+
+    for (int k = 0; k < length; ++k) {
+        const auto next = uchar(text.at(i + k));
+        if ((next & 0xc0) != 0x80)
+            return 0x110000 + lead;
+        value = value << 6 | (next & 0x3f);
+    }
+    i += length;
+    return value;
+}
+
+// @p text without the white space at either end, by the rule QStringView::trimmed() has:
+// QChar::isSpace() of each code point, so a line trims the same in UTF-8 as decoded.
+QByteArrayView trimmedUtf8(QByteArrayView text)
+{
+    qsizetype begin{-1};
+    qsizetype end{0};
+    for (qsizetype i = 0; i < text.size();) {
+        const auto at = i;
+        const auto ch = nextCodePoint(text, i);
+        if (ch <= 0x10ffff && QChar::isSpace(ch))
+            continue;
+        if (begin == -1)
+            begin = at;
+        end = i;
+    }
+    return begin == -1 ? QByteArrayView{} : text.sliced(begin, end - begin);
+}
+
+}
+
+bool sameLine(QStringView s1, QStringView s2, bool ignoreCase, bool ignoreWhiteSpaces)
+{
+    if (ignoreWhiteSpaces) {
+        s1 = s1.trimmed();
+        s2 = s2.trimmed();
+    }
+    return s1.compare(s2, ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive) == 0;
+}
+
+bool sameLine(QByteArrayView s1, QByteArrayView s2, bool ignoreCase, bool ignoreWhiteSpaces)
+{
+    if (ignoreWhiteSpaces) {
+        s1 = s1.trimmed();
+        s2 = s2.trimmed();
+    }
+    return s1.compare(s2, ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive) == 0;
+}
+
+size_t lineHash(QStringView line, bool ignoreCase, bool ignoreWhiteSpaces)
+{
+    if (ignoreWhiteSpaces)
+        line = line.trimmed();
+    if (!ignoreCase)
+        return qHash(line);
+
+    // Folded a code point at a time, the way QStringView::compare() folds when ignoring case.
+    size_t hash = line.size();
+    for (qsizetype i = 0; i < line.size(); ++i) {
+        char32_t ch = line.at(i).unicode();
+        if (QChar::isHighSurrogate(ch) && i + 1 < line.size() && line.at(i + 1).isLowSurrogate())
+            ch = QChar::surrogateToUcs4(char16_t(ch), line.at(++i).unicode());
+        combine(hash, QChar::toCaseFolded(ch));
+    }
+    return hash;
+}
+
+size_t lineHash(QByteArrayView line, bool ignoreCase, bool ignoreWhiteSpaces)
+{
+    if (ignoreWhiteSpaces)
+        line = line.trimmed();
+    if (!ignoreCase)
+        return qHash(line);
+
+    // QByteArrayView::compare() takes the bytes as Latin-1 when ignoring case.
+    size_t hash = line.size();
+    for (const auto ch : line)
+        combine(hash, QChar::toLower(char32_t(uchar(ch))));
+    return hash;
+}
+
+bool sameUtf8Line(QUtf8StringView s1, QUtf8StringView s2, bool ignoreCase, bool ignoreWhiteSpaces)
+{
+    QByteArrayView bytes1{s1.data(), s1.size()};
+    QByteArrayView bytes2{s2.data(), s2.size()};
+    if (ignoreWhiteSpaces) {
+        bytes1 = trimmedUtf8(bytes1);
+        bytes2 = trimmedUtf8(bytes2);
+    }
+    if (!ignoreCase)
+        return bytes1 == bytes2;
+
+    qsizetype i{0};
+    qsizetype j{0};
+    while (i < bytes1.size() && j < bytes2.size())
+        if (QChar::toCaseFolded(nextCodePoint(bytes1, i)) != QChar::toCaseFolded(nextCodePoint(bytes2, j)))
+            return false;
+    return i == bytes1.size() && j == bytes2.size();
+}
+
+size_t utf8LineHash(QUtf8StringView line, bool ignoreCase, bool ignoreWhiteSpaces)
+{
+    QByteArrayView bytes{line.data(), line.size()};
+    if (ignoreWhiteSpaces)
+        bytes = trimmedUtf8(bytes);
+    if (!ignoreCase)
+        return qHash(bytes);
+
+    size_t hash{0};
+    for (qsizetype i = 0; i < bytes.size();)
+        combine(hash, QChar::toCaseFolded(nextCodePoint(bytes, i)));
+    return hash;
+}
+
+}
+
+}
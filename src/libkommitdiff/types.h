@@ -8,9 +8,14 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "libkommitdiff_export.h"
 #include <QByteArray>
+#include <QByteArrayView>
 #include <QFile>
+#include <QHashFunctions>
 #include <QString>
 #include <QStringView>
+#include <QUtf8StringView>
+
+#include <atomic>
 #include <cstddef>
 
 namespace Diff
@@ -48,6 +53,37 @@ enum class SegmentType {
     DifferentOnBoth,
 };
 
+/**
+ * How the lines two texts have in common are found. All of them give a shortest, or near
+ * shortest, diff; they differ in which one they pick when there are several.
+ */
+enum class DiffAlgorithm {
+    /// Myers' algorithm, the default of git and GNU diff.
+    Myers,
+    /// Anchors on lines that occur once on each side, so moved or repeated boilerplate,
+    /// such as lone braces, does not pull hunks out of place.
+    Patience,
+    /// Patience diff extended to lines that are rare rather than unique; git's --histogram.
+    Histogram,
+};
+
+namespace Impl
+{
+/// Whether @p s1 and @p s2 are the same line, ignoring case and leading and trailing white
+/// space when asked to; compares in place, without copying either of them.
+[[nodiscard]] LIBKOMMITDIFF_EXPORT bool sameLine(QStringView s1, QStringView s2, bool ignoreCase, bool ignoreWhiteSpaces);
+[[nodiscard]] LIBKOMMITDIFF_EXPORT bool sameLine(QByteArrayView s1, QByteArrayView s2, bool ignoreCase, bool ignoreWhiteSpaces);
+
+/// A hash of @p line that is the same for lines sameLine() takes as the same.
+[[nodiscard]] LIBKOMMITDIFF_EXPORT size_t lineHash(QStringView line, bool ignoreCase, bool ignoreWhiteSpaces);
+[[nodiscard]] LIBKOMMITDIFF_EXPORT size_t lineHash(QByteArrayView line, bool ignoreCase, bool ignoreWhiteSpaces);
+
+/// Same as sameLine() for lines in UTF-8, ignoring case the way QStringView does rather
+/// than byte by byte.
+[[nodiscard]] LIBKOMMITDIFF_EXPORT bool sameUtf8Line(QUtf8StringView s1, QUtf8StringView s2, bool ignoreCase, bool ignoreWhiteSpaces);
+[[nodiscard]] LIBKOMMITDIFF_EXPORT size_t utf8LineHash(QUtf8StringView line, bool ignoreCase, bool ignoreWhiteSpaces);
+}
+
 enum MergeDiffType {
     Unchanged,
     LocalAdd,
@@ -55,25 +91,55 @@ enum MergeDiffType {
     BothChanged
 };
 
+/**
+ * Shared between a diff running on another thread and the one waiting for it. Setting
+ * canceled has the diff give up at the next point it checks, with a result in which the
+ * lines it did not get to show as changed; progress goes from 0 to 1000 as the lines in
+ * common are found, once per pair of texts compared.
+ */
+struct DiffControl {
+    std::atomic<bool> canceled{false};
+    std::atomic<int> progress{0};
+
+    [[nodiscard]] bool isCanceled() const
+    {
+        return canceled.load(std::memory_order_relaxed);
+    }
+};
+
 template<typename T>
 struct DiffOptions {
+    DiffAlgorithm algorithm{DiffAlgorithm::Myers};
+    /// Not owned; when set, the diff reports to it and can be canceled through it.
+    DiffControl *control{nullptr};
+
     bool equals(const T &n1, const T &n2) const
     {
         return n1 == n2;
     }
+
+    /// A hash that agrees with equals(): elements that compare equal hash the same.
+    size_t hash(const T &n) const
+    {
+        return qHash(n);
+    }
 };
 
 template<>
 struct DiffOptions<QString> {
     bool ignoreCase{false};
     bool ignoreWhiteSpaces{false};
+    DiffAlgorithm algorithm{DiffAlgorithm::Myers};
+    DiffControl *control{nullptr};
 
     bool equals(const QString &s1, const QString &s2) const
     {
-        if (ignoreWhiteSpaces)
-            return QString::compare(s1.trimmed(), s2.trimmed(), ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive) == 0;
+        return Impl::sameLine(s1, s2, ignoreCase, ignoreWhiteSpaces);
+    }
 
-        return QString::compare(s1, s2, ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive) == 0;
+    size_t hash(const QString &n) const
+    {
+        return Impl::lineHash(n, ignoreCase, ignoreWhiteSpaces);
     }
 };
 
@@ -81,13 +147,17 @@ template<>
 struct DiffOptions<QByteArray> {
     bool ignoreCase{false};
     bool ignoreWhiteSpaces{false};
+    DiffAlgorithm algorithm{DiffAlgorithm::Myers};
+    DiffControl *control{nullptr};
 
     bool equals(const QByteArray &s1, const QByteArray &s2) const
     {
-        if (ignoreWhiteSpaces)
-            return s1.trimmed().compare(s2.trimmed(), ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive) == 0;
+        return Impl::sameLine(QByteArrayView{s1}, QByteArrayView{s2}, ignoreCase, ignoreWhiteSpaces);
+    }
 
-        return s1.compare(s2, ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive) == 0;
+    size_t hash(const QByteArray &n) const
+    {
+        return Impl::lineHash(QByteArrayView{n}, ignoreCase, ignoreWhiteSpaces);
     }
 };
 
@@ -95,13 +165,35 @@ template<>
 struct DiffOptions<QStringView> {
     bool ignoreCase{false};
     bool ignoreWhiteSpaces{false};
+    DiffAlgorithm algorithm{DiffAlgorithm::Myers};
+    DiffControl *control{nullptr};
 
     bool equals(const QStringView &s1, const QStringView &s2) const
     {
-        if (ignoreWhiteSpaces)
-            return s1.trimmed().compare(s2.trimmed(), ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive) == 0;
+        return Impl::sameLine(s1, s2, ignoreCase, ignoreWhiteSpaces);
+    }
+
+    size_t hash(const QStringView &n) const
+    {
+        return Impl::lineHash(n, ignoreCase, ignoreWhiteSpaces);
+    }
+};
+
+template<>
+struct DiffOptions<QUtf8StringView> {
+    bool ignoreCase{false};
+    bool ignoreWhiteSpaces{false};
+    DiffAlgorithm algorithm{DiffAlgorithm::Myers};
+    DiffControl *control{nullptr};
+
+    bool equals(const QUtf8StringView &s1, const QUtf8StringView &s2) const
+    {
+        return Impl::sameUtf8Line(s1, s2, ignoreCase, ignoreWhiteSpaces);
+    }
 
-        return s1.compare(s2, ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive) == 0;
+    size_t hash(const QUtf8StringView &n) const
+    {
+        return Impl::utf8LineHash(n, ignoreCase, ignoreWhiteSpaces);
     }
 };
 
@@ -110,13 +202,12 @@ struct DiffOptions<QFile> {
     bool ignoreCase{false};
     bool ignoreWhiteSpaces{false};
     bool checkTime;
+    DiffAlgorithm algorithm{DiffAlgorithm::Myers};
+    DiffControl *control{nullptr};
 
     bool equals(const QString &s1, const QString &s2) const
     {
-        if (ignoreWhiteSpaces)
-            return QString::compare(s1.trimmed(), s2.trimmed(), ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive) == 0;
-
-        return QString::compare(s1, s2, ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive) == 0;
+        return Impl::sameLine(s1, s2, ignoreCase, ignoreWhiteSpaces);
     }
 };
 }
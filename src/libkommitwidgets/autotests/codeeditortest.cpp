@@ -0,0 +1,78 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "codeeditortest.h"
+#include "widgets/codeeditor.h"
+
+#include <QTest>
+
+QTEST_MAIN(CodeEditorTest)
+
+namespace
+{
+
+void moveToBlock(CodeEditor &editor, int blockNumber)
+{
+    editor.setTextCursor(QTextCursor{editor.document()->findBlockByNumber(blockNumber)});
+}
+
+}
+
+void CodeEditorTest::lineNumbersOfFilledBlocks()
+{
+    // Three lines, two lines padded up to four, and one line; eight blocks in all.
+    const QStringList lines{QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c"), QStringLiteral("d"), QStringLiteral("e"), QStringLiteral("f")};
+    const QList<CodeEditor::BlockData> dataList{CodeEditor::BlockData{0, 3, 3, CodeEditor::Unchanged, 0},
+                                                CodeEditor::BlockData{3, 2, 4, CodeEditor::Removed, 1},
+                                                CodeEditor::BlockData{5, 1, 1, CodeEditor::Unchanged, 2}};
+
+    CodeEditor editor;
+    editor.setContent(lines, dataList, true);
+    QCOMPARE(editor.blockCount(), 8);
+
+    moveToBlock(editor, 1);
+    QCOMPARE(editor.currentHunk(), 0);
+    QCOMPARE(editor.currentLineNumber(), 2);
+
+    moveToBlock(editor, 4);
+    QCOMPARE(editor.currentHunk(), 1);
+    QCOMPARE(editor.currentLineNumber(), 5);
+
+    // Padding belongs to the hunk it pads.
+    moveToBlock(editor, 6);
+    QCOMPARE(editor.currentHunk(), 1);
+
+    moveToBlock(editor, 7);
+    QCOMPARE(editor.currentHunk(), 2);
+    QCOMPARE(editor.currentLineNumber(), 6);
+}
+
+void CodeEditorTest::benchmarkManyHunks()
+{
+    constexpr int hunks{20000};
+
+    QStringList lines;
+    QList<CodeEditor::BlockData> dataList;
+    for (int i = 0; i < hunks; ++i) {
+        dataList.append(CodeEditor::BlockData{static_cast<int>(lines.size()), 2, 3, i % 2 ? CodeEditor::Edited : CodeEditor::Unchanged, i});
+        lines << QStringLiteral("int a%1 = %1;").arg(i) << QStringLiteral("int b%1 = %1;").arg(i);
+    }
+
+    CodeEditor editor;
+    editor.resize(800, 600);
+    editor.setContent(lines, dataList, true);
+    QCOMPARE(editor.blockCount(), hunks * 3);
+
+    // Every lookup the sidebar and the scroll sync make while scrolling through it.
+    QBENCHMARK {
+        for (int block = 0; block < editor.blockCount(); block += 97) {
+            moveToBlock(editor, block);
+            QCOMPARE(editor.currentHunk(), block / 3);
+        }
+    }
+}
+
+#include "moc_codeeditortest.cpp"
@@ -0,0 +1,18 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class CodeEditorTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void lineNumbersOfFilledBlocks();
+    void benchmarkManyHunks();
+};
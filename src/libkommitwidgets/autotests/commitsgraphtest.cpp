@@ -0,0 +1,254 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "commitsgraphtest.h"
+#include "commitsgraph.h"
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include <algorithm>
+#include <cstring>
+
+QTEST_GUILESS_MAIN(CommitsGraphTest)
+
+namespace
+{
+
+struct SyntheticCommit {
+    git_oid oid;
+    QList<git_oid> parents;
+};
+
+git_oid makeOid(int n)
+{
+    git_oid oid{};
+    memcpy(oid.id, &n, sizeof(n));
+    oid.id[sizeof(oid.id) - 1] = 1;
+    return oid;
+}
+
+/**
+ * A history shaped like a busy project: a main line, up to @p maxTopics topic branches
+ * forked off it at any time, commits spread over all of them, and merges back into main
+ * that every now and then take several topics at once. Newest first, as a walk gives it.
+ */
+QList<SyntheticCommit> syntheticHistory(int count, int maxTopics, quint32 seed)
+{
+    QRandomGenerator random{seed};
+    QList<SyntheticCommit> history;
+    history.reserve(count);
+
+    int mainHead{-1};
+    QList<int> topics;
+
+    for (int i = 0; i < count; ++i) {
+        SyntheticCommit commit{makeOid(i + 1), {}};
+        const auto dice = random.bounded(100);
+
+        if (dice < 30 || (topics.isEmpty() && dice >= 45)) {
+            if (mainHead != -1)
+                commit.parents << makeOid(mainHead + 1);
+
+            if (!topics.isEmpty() && dice < 20) {
+                const int merged = random.bounded(10) ? 1 : qMin<int>(topics.size(), 6);
+                for (int m = 0; m < merged; ++m)
+                    commit.parents << makeOid(topics.takeAt(random.bounded(topics.size())) + 1);
+            }
+            mainHead = i;
+        } else if (dice < 45 && topics.size() < maxTopics) {
+            if (mainHead != -1)
+                commit.parents << makeOid(mainHead + 1);
+            topics << i;
+        } else {
+            auto &topic = topics[random.bounded(topics.size())];
+            commit.parents << makeOid(topic + 1);
+            topic = i;
+        }
+
+        history << commit;
+    }
+
+    std::reverse(history.begin(), history.end());
+    return history;
+}
+
+void layOut(CommitsGraph &graph, const QList<SyntheticCommit> &history)
+{
+    for (const auto &commit : history)
+        graph.append(commit.oid, commit.parents.constData(), commit.parents.size());
+}
+
+// A lane as its type, followed by a "v" and the column of each join down into it.
+QString describe(GraphLane::Type type, const QList<int> &bottomJoins = {})
+{
+    auto str = QString::number(type);
+    for (const auto &join : bottomJoins)
+        str.append(QStringLiteral("v%1").arg(join));
+    return str;
+}
+
+QString describe(const GraphRow &row)
+{
+    QStringList ret;
+    for (int column = 0; column < row.laneCount; ++column) {
+        QList<int> bottomJoins;
+        for (int i = 0; i < row.joinCount; ++i)
+            if (row.joins[i].column == column && row.joins[i].direction == GraphJoin::Down)
+                bottomJoins << row.joins[i].from;
+        ret << describe(row.lanes[column].type(), bottomJoins);
+    }
+    return ret.join(QLatin1Char(' '));
+}
+
+void compareLayouts(const CommitsGraph &graph, const CommitsGraph &expected)
+{
+    QCOMPARE(graph.rowCount(), expected.rowCount());
+    for (int row = 0; row < expected.rowCount(); ++row)
+        QCOMPARE(describe(graph.row(row)), describe(expected.row(row)));
+}
+
+}
+
+void CommitsGraphTest::linearHistory()
+{
+    const auto a = makeOid(1);
+    const auto b = makeOid(2);
+    const auto c = makeOid(3);
+
+    CommitsGraph graph;
+    graph.append(c, &b, 1);
+    graph.append(b, &a, 1);
+    graph.append(a, nullptr, 0);
+
+    QCOMPARE(graph.rowCount(), 3);
+    QCOMPARE(describe(graph.row(0)), describe(GraphLane::End));
+    QCOMPARE(describe(graph.row(1)), describe(GraphLane::Node));
+    QCOMPARE(describe(graph.row(2)), describe(GraphLane::Start));
+}
+
+void CommitsGraphTest::mergeAndFork()
+{
+    //  merge
+    //  |   \
+    //  main topic
+    //  |   /
+    //  root
+    const auto root = makeOid(1);
+    const auto topic = makeOid(2);
+    const auto main = makeOid(3);
+    const auto merge = makeOid(4);
+    const git_oid mergeParents[]{main, topic};
+
+    CommitsGraph graph;
+    graph.append(merge, mergeParents, 2);
+    graph.append(main, &root, 1);
+    graph.append(topic, &root, 1);
+    graph.append(root, nullptr, 0);
+
+    // The second parent gets a column of its own, joined from the merge.
+    QCOMPARE(describe(graph.row(0)), describe(GraphLane::End) + QLatin1Char(' ') + describe(GraphLane::Transparent, {0}));
+    QCOMPARE(describe(graph.row(1)), describe(GraphLane::Node) + QLatin1Char(' ') + describe(GraphLane::Pipe));
+    // The root is already waited for in the first column, so the topic joins into it.
+    QCOMPARE(describe(graph.row(2)), describe(GraphLane::Pipe, {1}) + QLatin1Char(' ') + describe(GraphLane::Start));
+    QCOMPARE(describe(graph.row(3)), describe(GraphLane::Start));
+}
+
+void CommitsGraphTest::restartTakesOverUnchangedRows()
+{
+    const auto history = syntheticHistory(20000, 24, 7);
+    const auto before = history.mid(20);
+
+    CommitsGraph expected;
+    layOut(expected, history);
+
+    CommitsGraph graph;
+    layOut(graph, before);
+    graph.restart();
+    layOut(graph, history);
+    graph.finish();
+
+    compareLayouts(graph, expected);
+    QVERIFY(graph.reusedRows() > history.size() / 2);
+}
+
+void CommitsGraphTest::restartAfterRewrittenHistory()
+{
+    const auto history = syntheticHistory(5000, 8, 11);
+    auto rewritten = history;
+    rewritten[2500].parents = {makeOid(1)};
+
+    CommitsGraph expected;
+    layOut(expected, rewritten);
+
+    CommitsGraph graph;
+    layOut(graph, history);
+    graph.restart();
+    layOut(graph, rewritten);
+    graph.finish();
+
+    // Rows are only taken over while the two histories agree; past the rewritten commit
+    // they are laid out again.
+    compareLayouts(graph, expected);
+}
+
+void CommitsGraphTest::saveAndRestore()
+{
+    const auto history = syntheticHistory(5000, 16, 5);
+    const auto before = history.mid(30);
+
+    CommitsGraph saved;
+    layOut(saved, before);
+    const auto data = saved.save();
+
+    CommitsGraph graph;
+    QVERIFY(graph.restore(data.constData(), data.size()));
+    compareLayouts(graph, saved);
+    QCOMPARE(graph.oids().size(), int(before.size()));
+
+    // A restored layout is as good a base for the next walk as the one it was saved from.
+    CommitsGraph expected;
+    layOut(expected, history);
+
+    graph.restart();
+    layOut(graph, history);
+    graph.finish();
+
+    compareLayouts(graph, expected);
+    QVERIFY(graph.reusedRows() > history.size() / 2);
+}
+
+void CommitsGraphTest::restoreRejectsDamagedData()
+{
+    CommitsGraph saved;
+    layOut(saved, syntheticHistory(500, 4, 9));
+    const auto data = saved.save();
+
+    CommitsGraph graph;
+    QVERIFY(!graph.restore(data.constData(), data.size() - 1));
+    QCOMPARE(graph.rowCount(), 0);
+
+    auto damaged = data;
+    damaged[0] = char(~damaged[0]);
+    QVERIFY(!graph.restore(damaged.constData(), damaged.size()));
+    QCOMPARE(graph.rowCount(), 0);
+
+    QVERIFY(!graph.restore(nullptr, 0));
+    QCOMPARE(graph.rowCount(), 0);
+}
+
+void CommitsGraphTest::benchmarkSyntheticHistory()
+{
+    const auto history = syntheticHistory(1000000, 48, 3);
+
+    QBENCHMARK_ONCE {
+        CommitsGraph graph;
+        layOut(graph, history);
+        QCOMPARE(graph.rowCount(), int(history.size()));
+    }
+}
+
+#include "moc_commitsgraphtest.cpp"
@@ -0,0 +1,23 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class CommitsGraphTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void linearHistory();
+    void mergeAndFork();
+    void restartTakesOverUnchangedRows();
+    void restartAfterRewrittenHistory();
+    void saveAndRestore();
+    void restoreRejectsDamagedData();
+    void benchmarkSyntheticHistory();
+};
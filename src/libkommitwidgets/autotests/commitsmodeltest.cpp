@@ -0,0 +1,100 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "commitsmodeltest.h"
+#include "entities/index.h"
+#include "models/commitsmodel.h"
+#include "repository.h"
+#include "testcommon.h"
+
+#include <QStandardPaths>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(CommitsModelTest)
+
+namespace
+{
+constexpr int commitsCount{5};
+}
+
+CommitsModelTest::CommitsModelTest(QObject *parent)
+    : QObject{parent}
+{
+}
+
+CommitsModelTest::~CommitsModelTest()
+{
+    delete mModel;
+    delete mManager;
+}
+
+void CommitsModelTest::initTestCase()
+{
+    // The model keeps the layout of the history in the cache directory.
+    QStandardPaths::setTestModeEnabled(true);
+
+    auto path = TestCommon::getTempPath();
+    mManager = new Git::Repository;
+
+    QVERIFY(mManager->init(path));
+    QVERIFY(mManager->isValid());
+
+    TestCommon::initSignature(mManager);
+
+    for (int i = 0; i < commitsCount; ++i) {
+        TestCommon::touch(mManager->path() + "/README.md");
+        auto index = mManager->index();
+        QVERIFY(index.addByPath("README.md"));
+        QVERIFY(index.writeTree());
+        QVERIFY(mManager->commit(QStringLiteral("commit %1").arg(i)));
+    }
+
+    mModel = new CommitsModel{mManager};
+}
+
+void CommitsModelTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
+
+void CommitsModelTest::load()
+{
+    mModel->load();
+    QTRY_COMPARE(mModel->status(), AbstractGitItemsModel::Loaded);
+    QCOMPARE(mModel->rowCount({}), commitsCount);
+}
+
+void CommitsModelTest::findByHash()
+{
+    for (int row = 0; row < commitsCount; ++row) {
+        const auto hash = mModel->at(row).commitHash();
+
+        QCOMPARE(mModel->findIndexByHash(hash).row(), row);
+        QCOMPARE(mModel->findLogByHash(hash).commitHash(), hash);
+    }
+
+    const auto hash = mModel->at(0).commitHash();
+    QVERIFY(!mModel->findIndexByHash(hash.left(12)).isValid());
+    QVERIFY(mModel->findLogByHash(hash.left(12)).isNull());
+    QVERIFY(!mModel->findIndexByHash(QString(40, QLatin1Char('0'))).isValid());
+    QVERIFY(!mModel->findIndexByHash(QStringLiteral("not a hash")).isValid());
+}
+
+void CommitsModelTest::findByAbbreviatedHash()
+{
+    for (int row = 0; row < commitsCount; ++row) {
+        const auto hash = mModel->at(row).commitHash();
+
+        QCOMPARE(mModel->findLogByHash(hash.left(12), CommitsModel::LogMatchType::BeginMatch).commitHash(), hash);
+        QCOMPARE(mModel->findLogByHash(hash, CommitsModel::LogMatchType::BeginMatch).commitHash(), hash);
+    }
+
+    // Every hash starts with the empty prefix; the newest commit is the first to.
+    QCOMPARE(mModel->findLogByHash({}, CommitsModel::LogMatchType::BeginMatch).commitHash(), mModel->at(0).commitHash());
+    QVERIFY(mModel->findLogByHash(QStringLiteral("xyz"), CommitsModel::LogMatchType::BeginMatch).isNull());
+}
+
+#include "moc_commitsmodeltest.cpp"
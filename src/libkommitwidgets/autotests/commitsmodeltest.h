@@ -0,0 +1,36 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class CommitsModel;
+
+namespace Git
+{
+class Repository;
+};
+
+class CommitsModelTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CommitsModelTest(QObject *parent = nullptr);
+    ~CommitsModelTest() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void load();
+    void findByHash();
+    void findByAbbreviatedHash();
+
+private:
+    Git::Repository *mManager;
+    CommitsModel *mModel;
+};
@@ -0,0 +1,451 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "commitsgraph.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+// Rows between two snapshots of the columns. A new walk can only be found to have caught
+// up with the previous one at a snapshot, and leaving the previous layout replays at most
+// this many rows.
+constexpr int checkpointInterval{1024};
+
+bool isFree(const git_oid &oid)
+{
+    return git_oid_is_zero(&oid);
+}
+
+// What save() writes starts with these, so restore() can tell a layout it is able to read.
+constexpr quint32 saveMagic{0x4b434731};
+constexpr quint32 saveVersion{2};
+
+template<typename T>
+void write(QByteArray &out, const T &value)
+{
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T>
+void writeArray(QByteArray &out, const QVector<T> &list)
+{
+    out.append(reinterpret_cast<const char *>(list.constData()), list.size() * sizeof(T));
+}
+
+class Reader
+{
+public:
+    Reader(const char *data, qsizetype size)
+        : mData{data}
+        , mSize{size}
+    {
+    }
+
+    template<typename T>
+    bool read(T &value)
+    {
+        if (mSize - mPos < qsizetype(sizeof(T)))
+            return false;
+        memcpy(&value, mData + mPos, sizeof(T));
+        mPos += sizeof(T);
+        return true;
+    }
+
+    template<typename T>
+    bool readArray(QVector<T> &list, qint32 count)
+    {
+        if (count < 0 || (mSize - mPos) / qsizetype(sizeof(T)) < count)
+            return false;
+        list.resize(count);
+        memcpy(list.data(), mData + mPos, count * sizeof(T));
+        mPos += count * sizeof(T);
+        return true;
+    }
+
+    [[nodiscard]] bool atEnd() const
+    {
+        return mPos == mSize;
+    }
+
+private:
+    const char *const mData;
+    const qsizetype mSize;
+    qsizetype mPos{0};
+};
+
+// Whether @p offsets are where each of @p rows rows starts in an array of @p count items.
+bool validOffsets(const QVector<int> &offsets, int rows, int count)
+{
+    if (offsets.size() != rows + 1 || offsets.first() != 0 || offsets.last() != count)
+        return false;
+    return std::is_sorted(offsets.cbegin(), offsets.cend());
+}
+
+template<typename T>
+void appendRange(QVector<T> &list, const QVector<T> &other, int first, int last)
+{
+    const auto at = list.size();
+    list.resize(at + last - first);
+    std::copy(other.cbegin() + first, other.cbegin() + last, list.begin() + at);
+}
+
+}
+
+CommitsGraph::CommitsGraph()
+{
+}
+
+void CommitsGraph::clear()
+{
+    mCurrent.clear();
+    mPrevious.clear();
+    mPreviousCheckpointRows.clear();
+    setColumns({});
+    mFollowing = false;
+    mReusedRows = 0;
+}
+
+void CommitsGraph::restart()
+{
+    // The columns after the last row go along as one more checkpoint, so a new walk that
+    // follows this one to its end can carry on past it.
+    if (mFollowing) {
+        resume(mCurrent.size());
+        mFollowing = false;
+    }
+    mCurrent.checkpoints.insert(mCurrent.size(), mColumns);
+
+    mPrevious = std::move(mCurrent);
+    mCurrent.clear();
+
+    mPreviousCheckpointRows.clear();
+    for (auto it = mPrevious.checkpoints.cbegin(); it != mPrevious.checkpoints.cend(); ++it)
+        if (it.key() < mPrevious.size())
+            mPreviousCheckpointRows.insert(mPrevious.oids.at(it.key()), it.key());
+
+    setColumns({});
+    mReusedRows = 0;
+}
+
+void CommitsGraph::finish()
+{
+    if (mFollowing) {
+        resume(mCurrent.size());
+        mFollowing = false;
+    }
+
+    mPrevious.clear();
+    mPreviousCheckpointRows.clear();
+}
+
+void CommitsGraph::append(const git_oid &oid, const git_oid *parents, int parentCount)
+{
+    const int row = mCurrent.size();
+
+    mCurrent.oids << oid;
+    for (int i = 0; i < parentCount; ++i)
+        mCurrent.parents << parents[i];
+    mCurrent.parentOffsets << mCurrent.parents.size();
+
+    if (!mFollowing && !mPreviousCheckpointRows.isEmpty()) {
+        const auto previousRow = mPreviousCheckpointRows.value(oid, -1);
+        if (previousRow != -1 && mPrevious.checkpoints.value(previousRow) == mColumns) {
+            mFollowing = true;
+            mFollowDelta = previousRow - row;
+        }
+    }
+
+    if (mFollowing) {
+        if (follow(row))
+            return;
+
+        mFollowing = false;
+        resume(row);
+    }
+
+    if (!(row % checkpointInterval))
+        mCurrent.checkpoints.insert(row, mColumns);
+
+    layOut(oid, parents, parentCount, &mCurrent);
+}
+
+int CommitsGraph::rowCount() const
+{
+    return mCurrent.laneOffsets.size() - 1;
+}
+
+GraphRow CommitsGraph::row(int row) const
+{
+    const auto firstLane = mCurrent.laneOffsets.at(row);
+    const auto firstJoin = mCurrent.joinOffsets.at(row);
+    return {mCurrent.lanes.constData() + firstLane,
+            mCurrent.laneOffsets.at(row + 1) - firstLane,
+            mCurrent.joins.constData() + firstJoin,
+            mCurrent.joinOffsets.at(row + 1) - firstJoin};
+}
+
+int CommitsGraph::reusedRows() const
+{
+    return mReusedRows;
+}
+
+const QVector<git_oid> &CommitsGraph::oids() const
+{
+    return mCurrent.oids;
+}
+
+const git_oid *CommitsGraph::parents(int row, int *count) const
+{
+    const auto first = mCurrent.parentOffsets.at(row);
+    *count = mCurrent.parentOffsets.at(row + 1) - first;
+    return mCurrent.parents.constData() + first;
+}
+
+QByteArray CommitsGraph::save() const
+{
+    // The columns are only up to date once the rows taken over have been replayed.
+    if (mFollowing)
+        return {};
+
+    QByteArray out;
+    write(out, saveMagic);
+    write(out, saveVersion);
+    write(out, qint32(mCurrent.size()));
+    write(out, qint32(mCurrent.parents.size()));
+    write(out, qint32(mCurrent.lanes.size()));
+    write(out, qint32(mCurrent.joins.size()));
+    write(out, qint32(mCurrent.checkpoints.size()));
+    write(out, qint32(mColumns.size()));
+
+    writeArray(out, mCurrent.oids);
+    writeArray(out, mCurrent.parentOffsets);
+    writeArray(out, mCurrent.parents);
+    writeArray(out, mCurrent.lanes);
+    writeArray(out, mCurrent.laneOffsets);
+    writeArray(out, mCurrent.joins);
+    writeArray(out, mCurrent.joinOffsets);
+
+    for (auto it = mCurrent.checkpoints.cbegin(); it != mCurrent.checkpoints.cend(); ++it) {
+        write(out, qint32(it.key()));
+        write(out, qint32(it->size()));
+        writeArray(out, *it);
+    }
+    writeArray(out, mColumns);
+
+    return out;
+}
+
+bool CommitsGraph::restore(const char *data, qsizetype size)
+{
+    clear();
+
+    Reader reader{data, size};
+    quint32 magic, version;
+    qint32 rows, parents, lanes, joins, checkpoints, columns;
+    if (!reader.read(magic) || magic != saveMagic || !reader.read(version) || version != saveVersion)
+        return false;
+    if (!reader.read(rows) || !reader.read(parents) || !reader.read(lanes) || !reader.read(joins) || !reader.read(checkpoints) || !reader.read(columns))
+        return false;
+
+    Layout layout;
+    bool ok = reader.readArray(layout.oids, rows) && reader.readArray(layout.parentOffsets, rows + 1) && reader.readArray(layout.parents, parents)
+        && reader.readArray(layout.lanes, lanes) && reader.readArray(layout.laneOffsets, rows + 1) && reader.readArray(layout.joins, joins)
+        && reader.readArray(layout.joinOffsets, rows + 1);
+
+    for (qint32 i = 0; ok && i < checkpoints; ++i) {
+        qint32 row, count;
+        Columns checkpoint;
+        ok = reader.read(row) && row >= 0 && row <= rows && reader.read(count) && reader.readArray(checkpoint, count);
+        if (ok)
+            layout.checkpoints.insert(row, checkpoint);
+    }
+
+    Columns endColumns;
+    ok = ok && reader.readArray(endColumns, columns) && reader.atEnd();
+
+    // Anything that would send a lookup out of bounds later on makes the whole thing unusable.
+    ok = ok && validOffsets(layout.parentOffsets, rows, parents) && validOffsets(layout.laneOffsets, rows, lanes)
+        && validOffsets(layout.joinOffsets, rows, joins) && (!rows || layout.checkpoints.contains(0));
+    ok = ok && std::all_of(layout.lanes.cbegin(), layout.lanes.cend(), [](const GraphLane &lane) {
+             return lane.type() <= GraphLane::Test;
+         });
+    ok = ok && std::all_of(layout.joins.cbegin(), layout.joins.cend(), [](const GraphJoin &join) {
+             return join.direction <= GraphJoin::Down && !join.reserved;
+         });
+    if (!ok)
+        return false;
+
+    mCurrent = std::move(layout);
+    setColumns(endColumns);
+    return true;
+}
+
+void CommitsGraph::layOut(const git_oid &oid, const git_oid *parents, int parentCount, Layout *layout)
+{
+    int column;
+    const auto waitingForMe = mColumnByOid.constFind(oid);
+    const bool fromAbove = waitingForMe != mColumnByOid.cend();
+    if (fromAbove) {
+        column = *waitingForMe;
+        mColumnByOid.erase(waitingForMe);
+        mColumns[column] = git_oid{};
+    } else {
+        column = takeFreeColumn(-1);
+    }
+
+    // The row goes straight to the end of the layout's lanes and joins.
+    const int firstLane = layout ? layout->lanes.size() : 0;
+    if (layout) {
+        for (const auto &waitingFor : std::as_const(mColumns))
+            layout->lanes.append(isFree(waitingFor) ? GraphLane::None : GraphLane::Pipe);
+    }
+
+    bool continues{false};
+    for (int i = 0; i < parentCount; ++i) {
+        const auto &parent = parents[i];
+
+        const auto waiting = mColumnByOid.value(parent, -1);
+        if (waiting == column)
+            continue;
+        if (waiting != -1) {
+            if (layout)
+                joinDown(*layout, firstLane, waiting, column);
+            continue;
+        }
+
+        const auto parentColumn = continues ? takeFreeColumn(column) : column;
+        mColumns[parentColumn] = parent;
+        mColumnByOid.insert(parent, parentColumn);
+
+        if (parentColumn == column)
+            continues = true;
+        else if (layout)
+            joinDown(*layout, firstLane, parentColumn, column);
+    }
+
+    if (layout) {
+        auto &lane = layout->lanes[firstLane + column];
+        if (fromAbove)
+            lane.setType(continues ? GraphLane::Node : GraphLane::Start);
+        else
+            lane.setType(continues ? GraphLane::End : GraphLane::Dot);
+
+        while (layout->lanes.size() > firstLane && layout->lanes.last().type() == GraphLane::None)
+            layout->lanes.removeLast();
+        layout->laneOffsets << layout->lanes.size();
+        layout->joinOffsets << layout->joins.size();
+    }
+
+    while (!mColumns.isEmpty() && isFree(mColumns.last()))
+        mColumns.removeLast();
+}
+
+bool CommitsGraph::follow(int row)
+{
+    const auto previousRow = row + mFollowDelta;
+
+    // Every row up to here matched, so the columns before this row are the ones before its
+    // counterpart, whether or not the row itself matches too.
+    const auto checkpoint = mPrevious.checkpoints.constFind(previousRow);
+    if (checkpoint != mPrevious.checkpoints.cend())
+        mCurrent.checkpoints.insert(row, *checkpoint);
+
+    if (previousRow >= mPrevious.size() || !mCurrent.sameRow(row, mPrevious, previousRow))
+        return false;
+
+    mCurrent.appendRow(mPrevious, previousRow);
+    ++mReusedRows;
+    return true;
+}
+
+void CommitsGraph::resume(int row)
+{
+    // The rows taken over did not keep the columns up to date. Start from the last
+    // snapshot before @p row and run the rows since then through again, for their effect
+    // on the columns only: their lanes are already there.
+    auto checkpoint = mCurrent.checkpoints.upperBound(row);
+    --checkpoint;
+    setColumns(*checkpoint);
+
+    for (int r = checkpoint.key(); r < row; ++r) {
+        const auto first = mCurrent.parentOffsets.at(r);
+        const auto count = mCurrent.parentOffsets.at(r + 1) - first;
+        layOut(mCurrent.oids.at(r), mCurrent.parents.constData() + first, count, nullptr);
+    }
+}
+
+void CommitsGraph::setColumns(const Columns &columns)
+{
+    mColumns = columns;
+    mColumnByOid.clear();
+    for (int i = 0; i < mColumns.size(); ++i)
+        if (!isFree(mColumns.at(i)))
+            mColumnByOid.insert(mColumns.at(i), i);
+}
+
+void CommitsGraph::joinDown(Layout &layout, int firstLane, int column, int from)
+{
+    if (layout.lanes.size() <= firstLane + column)
+        layout.lanes.resize(firstLane + column + 1);
+
+    auto &lane = layout.lanes[firstLane + column];
+    if (lane.type() == GraphLane::None)
+        lane.setType(GraphLane::Transparent);
+    layout.joins.append({quint16(column), quint16(from), GraphJoin::Down});
+}
+
+int CommitsGraph::takeFreeColumn(int reserved)
+{
+    for (int i = 0; i < mColumns.size(); ++i)
+        if (i != reserved && isFree(mColumns.at(i)))
+            return i;
+
+    mColumns.append(git_oid{});
+    return mColumns.size() - 1;
+}
+
+int CommitsGraph::Layout::size() const
+{
+    return oids.size();
+}
+
+bool CommitsGraph::Layout::sameRow(int row, const Layout &other, int otherRow) const
+{
+    if (oids.at(row) != other.oids.at(otherRow))
+        return false;
+
+    const auto first = parentOffsets.at(row);
+    const auto count = parentOffsets.at(row + 1) - first;
+    const auto otherFirst = other.parentOffsets.at(otherRow);
+    if (count != other.parentOffsets.at(otherRow + 1) - otherFirst)
+        return false;
+
+    return std::equal(parents.cbegin() + first, parents.cbegin() + first + count, other.parents.cbegin() + otherFirst);
+}
+
+void CommitsGraph::Layout::appendRow(const Layout &other, int otherRow)
+{
+    appendRange(lanes, other.lanes, other.laneOffsets.at(otherRow), other.laneOffsets.at(otherRow + 1));
+    laneOffsets << lanes.size();
+
+    appendRange(joins, other.joins, other.joinOffsets.at(otherRow), other.joinOffsets.at(otherRow + 1));
+    joinOffsets << joins.size();
+}
+
+void CommitsGraph::Layout::clear()
+{
+    oids.clear();
+    parentOffsets = {0};
+    parents.clear();
+    lanes.clear();
+    laneOffsets = {0};
+    joins.clear();
+    joinOffsets = {0};
+    checkpoints.clear();
+}
@@ -0,0 +1,122 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "gitgraphlane.h"
+#include "libkommitwidgets_export.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+
+#include <Kommit/Oid>
+
+/**
+ * Lays out the lanes of the history graph one row at a time, newest commit first, in the
+ * order a revision walk produces them.
+ *
+ * Each column waits for one commit: the parent of a commit drawn above it. A commit takes
+ * the column waiting for it, or a free one when it is the tip of a line of history, and
+ * hands it down to its first parent. Other parents start columns of their own, and a parent
+ * some column already waits for is joined into that column instead of getting a second one,
+ * so a history never has two columns waiting for the same commit.
+ *
+ * Rows can be added as the history streams in, since a row only depends on the rows above
+ * it. restart() keeps the previous layout around: once a new walk reaches a commit the
+ * previous one had with the columns in the same state, the rest of the previous layout is
+ * taken over row by row for as long as the two walks agree, so a fetch that adds a handful
+ * of commits on top does not lay out the whole history again.
+ */
+class LIBKOMMITWIDGETS_EXPORT CommitsGraph
+{
+public:
+    CommitsGraph();
+
+    /// Forgets everything, the previous layout included.
+    void clear();
+
+    /// Starts a new layout, keeping the current one to take rows over from.
+    void restart();
+
+    /// Lets go of the previous layout once the new one has all its rows.
+    void finish();
+
+    /// Lays out the next row, the commit @p oid whose parents are @p parents.
+    void append(const git_oid &oid, const git_oid *parents, int parentCount);
+
+    [[nodiscard]] int rowCount() const;
+    /// The lanes and joins of @p row, valid until the next call that changes the graph.
+    [[nodiscard]] GraphRow row(int row) const;
+
+    /// How many rows of the current layout were taken over from the previous one.
+    [[nodiscard]] int reusedRows() const;
+
+    /// The commit on every row of the current layout, in order.
+    [[nodiscard]] const QVector<git_oid> &oids() const;
+
+    /// The parents @p row was laid out with, @p count of them.
+    [[nodiscard]] const git_oid *parents(int row, int *count) const;
+
+    /**
+     * The current layout as a block of bytes that restore() reads back, for keeping it
+     * across sessions. It is meant to be read back by the same build on the same machine.
+     */
+    [[nodiscard]] QByteArray save() const;
+
+    /**
+     * Replaces everything with the layout @p data holds, as saved by save(), as if its
+     * rows had just been appended. Returns false, leaving the graph empty, when @p data
+     * is not such a layout.
+     */
+    bool restore(const char *data, qsizetype size);
+
+private:
+    using Columns = QVector<git_oid>;
+
+    struct Layout {
+        QVector<git_oid> oids;
+        QVector<int> parentOffsets{0};
+        QVector<git_oid> parents;
+        // The lanes and joins of every row, one after the other; row r has the ones from
+        // offset r up to offset r + 1.
+        QVector<GraphLane> lanes;
+        QVector<int> laneOffsets{0};
+        QVector<GraphJoin> joins;
+        QVector<int> joinOffsets{0};
+        // The columns as they were before the row used as key.
+        QMap<int, Columns> checkpoints;
+
+        [[nodiscard]] int size() const;
+        [[nodiscard]] bool sameRow(int row, const Layout &other, int otherRow) const;
+        void appendRow(const Layout &other, int otherRow);
+        void clear();
+    };
+
+    LIBKOMMITWIDGETS_NO_EXPORT void layOut(const git_oid &oid, const git_oid *parents, int parentCount, Layout *layout);
+    LIBKOMMITWIDGETS_NO_EXPORT bool follow(int row);
+    LIBKOMMITWIDGETS_NO_EXPORT void resume(int row);
+    LIBKOMMITWIDGETS_NO_EXPORT void setColumns(const Columns &columns);
+    LIBKOMMITWIDGETS_NO_EXPORT int takeFreeColumn(int reserved);
+    LIBKOMMITWIDGETS_NO_EXPORT static void joinDown(Layout &layout, int firstLane, int column, int from);
+
+    Layout mCurrent;
+    Layout mPrevious;
+
+    // Rows of the previous layout that have a checkpoint, by the commit on them: the only
+    // places a new walk can be checked for having caught up with the previous one.
+    QHash<git_oid, int> mPreviousCheckpointRows;
+
+    Columns mColumns;
+    QHash<git_oid, int> mColumnByOid;
+
+    // While following, row r of the current layout is row r + mFollowDelta of the previous
+    // one, and the columns are not kept up to date.
+    bool mFollowing{false};
+    int mFollowDelta{0};
+    int mReusedRows{0};
+};
@@ -0,0 +1,68 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "diffcache.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+DiffCache::DiffCache(qsizetype maxLines, qsizetype maxEntries)
+    : mMinCost{std::max<qsizetype>(1, maxLines / std::max<qsizetype>(1, maxEntries))}
+    , mCache{maxLines}
+{
+}
+
+DiffCache::Result DiffCache::find(const QByteArray &leftKey, const QByteArray &rightKey, const Diff::DiffOptions<QString> &opts) const
+{
+    QMutexLocker locker{&mMutex};
+    const auto result = mCache.object(key(leftKey, rightKey, opts));
+    return result ? *result : Result{};
+}
+
+void DiffCache::insert(const QByteArray &leftKey, const QByteArray &rightKey, const Diff::DiffOptions<QString> &opts, const Result &result)
+{
+    if (!result)
+        return;
+
+    // Small files cost as much as the share of one entry, so they cannot pile up past the
+    // entries allowed.
+    const auto cost = std::max(mMinCost, result->left.lineCount() + result->right.lineCount());
+
+    QMutexLocker locker{&mMutex};
+    mCache.insert(key(leftKey, rightKey, opts), new Result{result}, cost);
+}
+
+bool DiffCache::contains(const QByteArray &leftKey, const QByteArray &rightKey, const Diff::DiffOptions<QString> &opts) const
+{
+    QMutexLocker locker{&mMutex};
+    return mCache.contains(key(leftKey, rightKey, opts));
+}
+
+void DiffCache::clear()
+{
+    QMutexLocker locker{&mMutex};
+    mCache.clear();
+}
+
+DiffCache::Result DiffCache::compare(const Diff::TextView &left, const Diff::TextView &right, const Diff::DiffOptions<QString> &opts)
+{
+    return std::make_shared<const Diff::Diff2TextViewResult>(left, right, Diff::diff2(left, right, opts));
+}
+
+QByteArray DiffCache::key(const QByteArray &leftKey, const QByteArray &rightKey, const Diff::DiffOptions<QString> &opts)
+{
+    QByteArray key;
+    key.reserve(leftKey.size() + rightKey.size() + 4);
+    key.append(leftKey);
+    key.append('\0');
+    key.append(rightKey);
+    key.append('\0');
+    key.append(static_cast<char>(opts.ignoreCase));
+    key.append(static_cast<char>(opts.ignoreWhiteSpaces));
+    key.append(static_cast<char>(opts.algorithm));
+    return key;
+}
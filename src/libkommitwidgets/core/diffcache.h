@@ -0,0 +1,54 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommitwidgets_export.h"
+
+#include <diff2.h>
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+
+#include <memory>
+
+/**
+ * Diffs between pairs of files already computed, so going back to a file shows it at once.
+ *
+ * Each side is known by a key that changes whenever its content does, like the oid of a
+ * blob, so an entry never goes stale. Once the entries hold more lines between them than
+ * the cache allows, or there are more of them than it allows, the ones used least recently
+ * are dropped. A diff still on show is not
+ * freed with its entry; it is shared. The cache can be used from several threads at once.
+ */
+class LIBKOMMITWIDGETS_EXPORT DiffCache
+{
+public:
+    using Result = std::shared_ptr<const Diff::Diff2TextViewResult>;
+
+    explicit DiffCache(qsizetype maxLines = 2000000, qsizetype maxEntries = 256);
+
+    /// The diff between @p leftKey and @p rightKey compared with @p opts, or null if it is not cached.
+    [[nodiscard]] Result find(const QByteArray &leftKey, const QByteArray &rightKey, const Diff::DiffOptions<QString> &opts) const;
+    void insert(const QByteArray &leftKey, const QByteArray &rightKey, const Diff::DiffOptions<QString> &opts, const Result &result);
+    [[nodiscard]] bool contains(const QByteArray &leftKey, const QByteArray &rightKey, const Diff::DiffOptions<QString> &opts) const;
+
+    void clear();
+
+    /// What the diff between @p leftKey and @p rightKey compared with @p opts is cached by.
+    [[nodiscard]] static QByteArray key(const QByteArray &leftKey, const QByteArray &rightKey, const Diff::DiffOptions<QString> &opts);
+
+    /// Compares @p left and @p right, for the cache or for a widget to show.
+    [[nodiscard]] static Result compare(const Diff::TextView &left, const Diff::TextView &right, const Diff::DiffOptions<QString> &opts);
+
+private:
+    // What an entry costs at least, for no more than the entries allowed to fit.
+    const qsizetype mMinCost;
+    mutable QMutex mMutex;
+    // QCache bumps an entry on every lookup, which makes a lookup a change.
+    mutable QCache<QByteArray, Result> mCache;
+};
@@ -34,6 +34,7 @@ CommitPushDialog::CommitPushDialog(Git::Repository *git, QWidget *parent)
 {
     setupUi(this);
 
+    connect(mModel, &ChangedFilesModel::reloaded, this, &CommitPushDialog::slotModelReloaded);
     reload();
 
     mActions = new ChangedFileActions(mGit, this);
@@ -96,15 +97,6 @@ void CommitPushDialog::reload()
 {
     mModel->reload();
 
-    if (!mModel->size()) {
-        pushButtonCommit->setEnabled(false);
-        pushButtonPush->setEnabled(true);
-        groupBoxMakeCommit->setEnabled(false);
-        pushButtonPush->setText(i18n("Push"));
-    } else {
-        pushButtonPush->setText(i18n("Commit and push"));
-    }
-
     comboBoxBranch->clear();
     comboBoxRemote->clear();
     auto branches = mGit->branches()->names(Git::BranchType::LocalBranch);
@@ -118,8 +110,25 @@ void CommitPushDialog::reload()
         _words.insert(b);
     for (const auto &r : std::as_const(remotes))
         _words.insert(r);
-    auto data = mModel->data();
-    for (const auto &row : data) {
+    textEditMessage->addWords(_words.values());
+    textEditMessage->begin();
+}
+
+void CommitPushDialog::slotModelReloaded()
+{
+    if (!mModel->size()) {
+        pushButtonCommit->setEnabled(false);
+        pushButtonPush->setEnabled(true);
+        groupBoxMakeCommit->setEnabled(false);
+        pushButtonPush->setText(i18n("Push"));
+    } else {
+        groupBoxMakeCommit->setEnabled(true);
+        pushButtonPush->setText(i18n("Commit and push"));
+        checkButtonsEnable();
+    }
+
+    QSet<QString> _words;
+    for (const auto &row : mModel->data()) {
         const auto parts = row.filePath.split(QLatin1Char('/'));
         for (const auto &p : parts)
             _words.insert(p);
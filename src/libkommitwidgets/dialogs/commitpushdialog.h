@@ -43,6 +43,7 @@ private:
     };
     LIBKOMMITWIDGETS_NO_EXPORT void addFiles();
     LIBKOMMITWIDGETS_NO_EXPORT void reload();
+    LIBKOMMITWIDGETS_NO_EXPORT void slotModelReloaded();
     LIBKOMMITWIDGETS_NO_EXPORT void readConfig();
     LIBKOMMITWIDGETS_NO_EXPORT void writeConfig();
     ChangedFileActions *mActions = nullptr;
@@ -19,6 +19,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <Kommit/Repository>
 
 #include <fetch.h>
+#include <trigramindex.h>
 
 #include "certificateinfodialog.h"
 #include "credentialdialog.h"
@@ -160,6 +161,10 @@ void FetchDialog::slotFetchFinished(bool success)
 {
     if (success) {
         labelStatus->setText(i18n("Finished"));
+
+        // Indexes what came in, once a search has had the index built.
+        if (mIsChanged && Git::TrigramIndex::exists(Git::TrigramIndex::defaultDirectory(mGit->path())))
+            Git::TrigramIndex::updateInBackground(mGit->path());
     } else {
         labelStatus->setText(i18n("Finished with error"));
         textBrowser->append(i18n("Error %1: %2", Git::Error::klass(), Git::Error::message()));
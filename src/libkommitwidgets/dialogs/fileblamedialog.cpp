@@ -13,7 +13,9 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "models/commitsmodel.h"
 
 #include <KLocalizedString>
-#include <QThread>
+#include <QFile>
+#include <QPromise>
+#include <QtConcurrentRun>
 
 FileBlameDialog::FileBlameDialog(Git::Repository *git, const QString &file, QWidget *parent)
     : AppDialog(git, parent)
@@ -25,6 +27,8 @@ FileBlameDialog::FileBlameDialog(Git::Repository *git, const QString &file, QWid
     plainTextEdit->setShowTitleBar(false);
 
     connect(plainTextEdit, &BlameCodeView::blockSelected, this, &FileBlameDialog::slotPlainTextEditBlockSelected);
+    connect(&mBlameWatcher, &QFutureWatcherBase::resultsReadyAt, this, &FileBlameDialog::appendParts);
+    connect(&mBlameWatcher, &QFutureWatcherBase::finished, this, &FileBlameDialog::showBlocks);
 
     loadData();
 
@@ -33,28 +37,84 @@ FileBlameDialog::FileBlameDialog(Git::Repository *git, const QString &file, QWid
     widgetCommitDetails->setEnableFilesLinks(false);
 }
 
+FileBlameDialog::~FileBlameDialog()
+{
+    mBlameWatcher.cancel();
+}
+
 void FileBlameDialog::loadData()
 {
     plainTextEdit->setHighlighting(mFile);
+    setWindowTitle(i18nc("@title:window", "Blame file: %1", mFile));
+
+    QFile file{mGit->path() + QLatin1Char('/') + mFile};
+    if (!file.open(QIODevice::Text | QIODevice::ReadOnly))
+        return;
+
+    // The text is shown right away, and each part of the blame as it is done.
+    mBlameData = Git::Blame{mGit, QString{file.readAll()}.split(QLatin1Char('\n'))};
+    mShownHunks = 0;
+    mNextType = CodeEditor::BlockType::Odd;
+    plainTextEdit->setContent(mBlameData.content(), {unblamedBlock(0)}, false);
+
+    mBlameWatcher.setFuture(QtConcurrent::run([path = mGit->path(), fileName = mFile](QPromise<Git::Blame> &promise) {
+        git_blame_options opts;
+        if (git_blame_options_init(&opts, GIT_BLAME_OPTIONS_VERSION))
+            return;
+        Git::blameFile(path, fileName, opts, [&promise](const Git::Blame &part) {
+            promise.addResult(part);
+            return !promise.isCanceled();
+        });
+    }));
+}
+
+void FileBlameDialog::appendParts(int begin, int end)
+{
+    for (int i = begin; i < end; ++i)
+        mBlameData.append(mBlameWatcher.resultAt(i));
 
-    mBlameData = mGit->blame(mFile);
+    showBlocks();
+}
 
-    auto hunks = mBlameData.hunks();
-    auto type = CodeEditor::BlockType::Odd;
-    QList<CodeEditor::BlockData *> blocks;
-    for (auto &blame : hunks) {
-        auto data = new CodeEditor::BlockData{static_cast<int>(blame.startLine() - 1), static_cast<int>(blame.linesCount()), 0, type};
+// Only the hunks blamed since the last call are shown, in place of what stood for the lines
+// not blamed yet; the text stays as it is.
+void FileBlameDialog::showBlocks()
+{
+    auto blamed{0};
+    if (mShownHunks) {
+        const auto &last = mBlameData.at(mShownHunks - 1);
+        blamed = static_cast<int>(last.startLine() - 1 + last.linesCount());
+    }
+
+    QList<CodeEditor::BlockData> blocks;
+    blocks.reserve(mBlameData.size() - mShownHunks + 1);
+    for (auto i = mShownHunks; i < mBlameData.size(); ++i) {
+        const auto &blame = mBlameData.at(i);
+        auto &data = blocks.emplace_back(static_cast<int>(blame.startLine() - 1), static_cast<int>(blame.linesCount()), 0, mNextType, i);
         if (blame.finalCommit().isNull()) {
-            data->extraText = i18n("Uncommitted");
-            data->type = CodeEditor::BlockType::Empty;
+            data.extraText = i18n("Uncommitted");
+            data.type = CodeEditor::BlockType::Empty;
         } else {
-            data->extraText = blame.finalCommit().oid().toString();
-            type = type == CodeEditor::BlockType::Odd ? CodeEditor::BlockType::Even : CodeEditor::BlockType::Odd;
+            data.extraText = blame.finalCommit().oid().toString();
+            mNextType = mNextType == CodeEditor::BlockType::Odd ? CodeEditor::BlockType::Even : CodeEditor::BlockType::Odd;
         }
-        blocks << data;
+        blamed = data.lineNumber + data.lineCount;
     }
-    plainTextEdit->setContent(mBlameData.content(), blocks, false);
-    setWindowTitle(i18nc("@title:window", "Blame file: %1", mFile));
+
+    if (blamed < mBlameData.content().size())
+        blocks << unblamedBlock(blamed);
+
+    plainTextEdit->replaceBlockData(mShownHunks, blocks);
+    mShownHunks = static_cast<int>(mBlameData.size());
+}
+
+// The lines from @p from on, which the blame has not got to yet, or could not blame, the
+// file not being committed.
+CodeEditor::BlockData FileBlameDialog::unblamedBlock(int from) const
+{
+    CodeEditor::BlockData data{from, static_cast<int>(mBlameData.content().size()) - from, 0, CodeEditor::BlockType::Empty};
+    data.extraText = mBlameWatcher.isFinished() ? i18n("Uncommitted") : i18n("Blaming…");
+    return data;
 }
 
 void FileBlameDialog::slotPlainTextEditBlockSelected()
@@ -12,6 +12,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <Kommit/Blame>
 
+#include <QFutureWatcher>
+
 namespace Git
 {
 class Repository;
@@ -23,13 +25,21 @@ class LIBKOMMITWIDGETS_EXPORT FileBlameDialog : public AppDialog, private Ui::Fi
 
 public:
     explicit FileBlameDialog(Git::Repository *git, const QString &file, QWidget *parent = nullptr);
+    ~FileBlameDialog() override;
 
 private:
     LIBKOMMITWIDGETS_NO_EXPORT void loadData();
+    LIBKOMMITWIDGETS_NO_EXPORT void appendParts(int begin, int end);
+    LIBKOMMITWIDGETS_NO_EXPORT void showBlocks();
+    [[nodiscard]] LIBKOMMITWIDGETS_NO_EXPORT CodeEditor::BlockData unblamedBlock(int from) const;
 
     LIBKOMMITWIDGETS_NO_EXPORT void slotPlainTextEditBlockSelected();
 
     QString mFileName;
     QString mFile;
     Git::Blame mBlameData;
+    QFutureWatcher<Git::Blame> mBlameWatcher;
+    // The hunks of mBlameData on show, and the type the next committed one is shown with.
+    int mShownHunks{0};
+    CodeEditor::BlockType mNextType{CodeEditor::BlockType::Odd};
 };
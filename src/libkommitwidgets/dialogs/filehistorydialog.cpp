@@ -8,10 +8,19 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "models/commitsmodel.h"
 
 #include <caches/commitscache.h>
+#include <entities/blob.h>
 #include <entities/commit.h>
+#include <entities/oid.h>
 #include <repository.h>
 
 #include <KLocalizedString>
+#include <QPromise>
+#include <QtConcurrentRun>
+
+namespace
+{
+constexpr int walkPageSize{50};
+}
 
 FileHistoryDialog::FileHistoryDialog(Git::Repository *git, const QString &fileName, QWidget *parent)
     : AppDialog(git, parent)
@@ -19,24 +28,6 @@ FileHistoryDialog::FileHistoryDialog(Git::Repository *git, const QString &fileNa
 {
     setupUi(this);
 
-    const auto hashes = git->fileLog(fileName);
-
-    const auto logs = git->commits();
-
-    for (const auto &hash : hashes) {
-        auto log = logs->find(hash);
-        if (log.isNull())
-            continue;
-
-        auto item = new QListWidgetItem(log.message());
-        item->setData(dataRole, log.commitHash());
-        listWidget->addItem(item);
-
-        auto treeItem = new QTreeWidgetItem{treeWidget};
-        treeItem->setText(0, log.message());
-        treeItem->setData(0, dataRole, log.commitHash());
-        treeWidget->addTopLevelItem(treeItem);
-    }
     plainTextEdit->setHighlighting(fileName);
     setWindowTitle(i18nc("@title:window", "File log: %1", fileName));
 
@@ -44,6 +35,8 @@ FileHistoryDialog::FileHistoryDialog(Git::Repository *git, const QString &fileNa
     connect(treeWidget, &QTreeWidget::itemClicked, this, &FileHistoryDialog::slotTreeViewItemClicked);
     connect(radioButtonRegularView, &QRadioButton::toggled, this, &FileHistoryDialog::slotRadioButtonRegularViewToggled);
     connect(radioButtonDifferentialView, &QRadioButton::toggled, this, &FileHistoryDialog::slotRadioButtonDifferentialViewToggled);
+    connect(checkBoxFollowRenames, &QCheckBox::toggled, this, &FileHistoryDialog::startWalk);
+    connect(&mWalkWatcher, &QFutureWatcherBase::resultsReadyAt, this, &FileHistoryDialog::appendRevisions);
     widgetDiffView->showSameSize(true);
 
     treeWidget->header()->setSectionResizeMode(0, QHeaderView::Stretch);
@@ -51,6 +44,8 @@ FileHistoryDialog::FileHistoryDialog(Git::Repository *git, const QString &fileNa
     treeWidget->header()->setSectionResizeMode(2, QHeaderView::Fixed);
     treeWidget->header()->setStretchLastSection(false);
     radioButtonRegularView->setChecked(true);
+
+    startWalk();
 }
 
 FileHistoryDialog::FileHistoryDialog(Git::Repository *git, const Git::Blob &file, QWidget *parent)
@@ -58,10 +53,75 @@ FileHistoryDialog::FileHistoryDialog(Git::Repository *git, const Git::Blob &file
 {
 }
 
+FileHistoryDialog::~FileHistoryDialog()
+{
+    mWalkWatcher.cancel();
+}
+
+void FileHistoryDialog::startWalk()
+{
+    // Setting the next future on the watcher drops whatever the previous walk had queued.
+    mWalkWatcher.cancel();
+    mRevisions.clear();
+    mLeftFile = nullptr;
+    mRightFile = nullptr;
+    listWidget->clear();
+    treeWidget->clear();
+
+    // The walk opens a repository of its own and hands back object ids only; the commits
+    // they name are looked up here, as pages arrive.
+    const auto followRenames = checkBoxFollowRenames->isChecked();
+    mWalkWatcher.setFuture(QtConcurrent::run([path = mGit->path(), fileName = mFileName, followRenames](QPromise<QList<Git::FileRevision>> &promise) {
+        Git::walkFileHistory(path, fileName, followRenames, walkPageSize, [&promise](const QList<Git::FileRevision> &page) {
+            promise.addResult(page);
+            return !promise.isCanceled();
+        });
+    }));
+}
+
+void FileHistoryDialog::appendRevisions(int begin, int end)
+{
+    auto commits = mGit->commits();
+
+    for (int i = begin; i < end; ++i) {
+        const auto page = mWalkWatcher.resultAt(i);
+        for (const auto &revision : page) {
+            const auto commit = commits->findByOid(&revision.commit);
+            if (commit.isNull())
+                continue;
+
+            const auto index = mRevisions.size();
+            mRevisions << revision;
+            const auto toolTip = revision.path == mFileName ? QString{} : revision.path;
+
+            auto item = new QListWidgetItem(commit.message());
+            item->setData(dataRole, index);
+            item->setToolTip(toolTip);
+            listWidget->addItem(item);
+
+            auto treeItem = new QTreeWidgetItem{treeWidget};
+            treeItem->setText(0, commit.message());
+            treeItem->setData(0, dataRole, index);
+            treeItem->setToolTip(0, toolTip);
+            treeWidget->addTopLevelItem(treeItem);
+        }
+    }
+}
+
+QString FileHistoryDialog::content(int revision) const
+{
+    // Read by the id the walk found, with no revision or tree to resolve again.
+    const auto &blob = mRevisions.at(revision).blob;
+    if (git_oid_is_zero(&blob))
+        return {};
+    return Git::Blob{mGit, Git::Oid{blob}}.stringContent();
+}
+
 void FileHistoryDialog::slotListWidgetItemClicked(QListWidgetItem *item)
 {
-    const auto content = mGit->fileContent(item->data(dataRole).toString(), mFileName);
-    plainTextEdit->setPlainText(content);
+    if (!item)
+        return;
+    plainTextEdit->setPlainText(content(item->data(dataRole).toInt()));
 }
 
 void FileHistoryDialog::slotRadioButtonRegularViewToggled(bool toggle)
@@ -85,8 +145,8 @@ void FileHistoryDialog::compareFiles()
     if (!mLeftFile || !mRightFile)
         return;
 
-    const auto leftFileContent = mGit->fileContent(mLeftFile->data(0, dataRole).toString(), mFileName);
-    const auto rightFileContent = mGit->fileContent(mRightFile->data(0, dataRole).toString(), mFileName);
+    const auto leftFileContent = content(mLeftFile->data(0, dataRole).toInt());
+    const auto rightFileContent = content(mRightFile->data(0, dataRole).toInt());
 
     widgetDiffView->setOldFile(mFileName, leftFileContent);
     widgetDiffView->setNewFile(mFileName, rightFileContent);
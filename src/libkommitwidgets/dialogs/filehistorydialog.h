@@ -7,9 +7,12 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 
 #include "appdialog.h"
+#include "filehistory.h"
 #include "libkommitwidgets_export.h"
 #include "ui_filehistorydialog.h"
 
+#include <QFutureWatcher>
+
 namespace Git
 {
 class Repository;
@@ -23,10 +26,16 @@ class LIBKOMMITWIDGETS_EXPORT FileHistoryDialog : public AppDialog, private Ui::
 public:
     explicit FileHistoryDialog(Git::Repository *git, const QString &fileName, QWidget *parent = nullptr);
     explicit FileHistoryDialog(Git::Repository *git, const Git::Blob &file, QWidget *parent = nullptr);
+    ~FileHistoryDialog() override;
 
 private:
+    // Items hold the index of their revision in mRevisions.
     static constexpr int dataRole{Qt::UserRole + 1};
 
+    LIBKOMMITWIDGETS_NO_EXPORT void startWalk();
+    LIBKOMMITWIDGETS_NO_EXPORT void appendRevisions(int begin, int end);
+    [[nodiscard]] LIBKOMMITWIDGETS_NO_EXPORT QString content(int revision) const;
+
     LIBKOMMITWIDGETS_NO_EXPORT void slotListWidgetItemClicked(QListWidgetItem *item);
     LIBKOMMITWIDGETS_NO_EXPORT void slotTreeViewItemClicked(QTreeWidgetItem *item, int column);
     LIBKOMMITWIDGETS_NO_EXPORT void slotRadioButtonRegularViewToggled(bool toggle);
@@ -36,4 +45,7 @@ private:
     const QString mFileName;
     QTreeWidgetItem *mLeftFile{nullptr};
     QTreeWidgetItem *mRightFile{nullptr};
+
+    QFutureWatcher<QList<Git::FileRevision>> mWalkWatcher;
+    QList<Git::FileRevision> mRevisions;
 };
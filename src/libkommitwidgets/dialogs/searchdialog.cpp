@@ -6,16 +6,17 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "searchdialog.h"
 #include "caches/branchescache.h"
-#include "caches/commitscache.h"
 #include "fileviewerdialog.h"
 
-#include <entities/tree.h>
-
 #include <KLocalizedString>
+#include <QLocale>
+#include <QPromise>
 #include <QStandardItemModel>
 #include <QtConcurrentRun>
+#include <commitwalk.h>
+#include <trigramindex.h>
+#include <entities/branch.h>
 #include <entities/commit.h>
-#include <gitloglist.h>
 #include <repository.h>
 
 SearchDialog::SearchDialog(const QString &path, Git::Repository *git, QWidget *parent)
@@ -30,6 +31,8 @@ SearchDialog::SearchDialog(const QString &path, Git::Repository *git, QWidget *p
 
     connect(pushButtonSearch, &QPushButton::clicked, this, &SearchDialog::slotPushButtonSearchClicked);
     connect(treeView, &QTreeView::doubleClicked, this, &SearchDialog::slotTreeViewDoubleClicked);
+    connect(&mSearchWatcher, &QFutureWatcherBase::resultsReadyAt, this, &SearchDialog::appendResults);
+    connect(&mSearchWatcher, &QFutureWatcherBase::finished, this, &SearchDialog::searchFinished);
 }
 
 void SearchDialog::initModel()
@@ -50,16 +53,115 @@ SearchDialog::SearchDialog(Git::Repository *git, QWidget *parent)
 
     connect(pushButtonSearch, &QPushButton::clicked, this, &SearchDialog::slotPushButtonSearchClicked);
     connect(treeView, &QTreeView::doubleClicked, this, &SearchDialog::slotTreeViewDoubleClicked);
+    connect(&mSearchWatcher, &QFutureWatcherBase::resultsReadyAt, this, &SearchDialog::appendResults);
+    connect(&mSearchWatcher, &QFutureWatcherBase::finished, this, &SearchDialog::searchFinished);
+}
+
+SearchDialog::~SearchDialog()
+{
+    if (mSearch)
+        mSearch->cancel();
+    mSearchWatcher.cancel();
 }
 
 void SearchDialog::slotPushButtonSearchClicked()
 {
+    // The button stops a running search.
+    if (mSearch) {
+        mSearch->cancel();
+        return;
+    }
+
+    auto search = std::make_shared<Git::ContentSearch>(lineEditText->text(),
+                                                       checkBoxCaseSensetive->isChecked(),
+                                                       checkBoxRegularExpression->isChecked(),
+                                                       lineEditPath->text());
+    if (!search->isValid()) {
+        labelStats->setText(lineEditText->text().isEmpty() ? i18n("Nothing to search for") : i18n("Invalid regular expression"));
+        return;
+    }
+
     mModel->clear();
     initModel();
-    startTimer(500);
-    pushButtonSearch->setEnabled(false);
-    mProgress.total = mProgress.value = 0;
-    auto f = QtConcurrent::run(&SearchDialog::beginSearch, this);
+    progressBar->setValue(0);
+    labelStats->clear();
+    pushButtonSearch->setText(i18n("Stop"));
+
+    // Branches are few and resolved here; the commits are listed by the worker.
+    QList<Git::ContentSearch::Place> places;
+    const auto searchBranches = radioButtonSearchBranches->isChecked();
+    if (searchBranches) {
+        const auto branches = mGit->branches()->allBranches(Git::BranchType::LocalBranch);
+        for (auto branch : branches)
+            places << Git::ContentSearch::Place{branch.name(), *branch.commit().oid().data()};
+    }
+
+    // The history is searched right away with what is indexed of it, and indexed further in
+    // the background, one update at a time, for the searches after this one.
+    if (!searchBranches)
+        Git::TrigramIndex::updateInBackground(mGit->path());
+
+    mSearch = search;
+    mSearchWatcher.setFuture(QtConcurrent::run([search, path = mGit->path(), places, searchBranches](QPromise<Batch> &promise) mutable {
+        // Listing a long history takes a while too; stopping the search stops it.
+        const auto canceled = [&promise, &search] {
+            return promise.isCanceled() || search->isCanceled();
+        };
+        if (!searchBranches) {
+            Git::walkCommits(path, QString{}, 1024, [&places, &canceled](const QList<git_oid> &page) {
+                for (const auto &oid : page)
+                    places << Git::ContentSearch::Place{QString{}, oid};
+                return !canceled();
+            });
+            if (canceled())
+                return;
+        }
+
+        // Whatever is indexed so far rules blobs out; the rest are read as without an index.
+        auto index = std::make_shared<Git::TrigramIndex>(Git::TrigramIndex::defaultDirectory(path));
+        if (index->load())
+            search->setIndex(index);
+
+        const auto count = static_cast<int>(places.size());
+        search->run(path, places, [&promise, count](const QList<Git::ContentSearch::Match> &matches, const Git::ContentSearch::Stats &stats) {
+            promise.addResult(Batch{matches, stats, count});
+            return !promise.isCanceled();
+        });
+    }));
+}
+
+void SearchDialog::appendResults(int begin, int end)
+{
+    for (int i = begin; i < end; ++i) {
+        const auto batch = mSearchWatcher.resultAt(i);
+        for (const auto &match : batch.matches) {
+            const auto commit = match.branch.isEmpty() ? Git::Oid{match.commit}.toString() : QString{};
+            mModel->appendRow({new QStandardItem(match.path), new QStandardItem(match.branch), new QStandardItem(commit)});
+        }
+
+        progressBar->setMaximum(batch.places);
+        progressBar->setValue(batch.stats.places);
+        showStats(batch.stats);
+    }
+}
+
+void SearchDialog::searchFinished()
+{
+    mSearch.reset();
+    pushButtonSearch->setText(i18n("Search"));
+}
+
+void SearchDialog::showStats(const Git::ContentSearch::Stats &stats)
+{
+    const QLocale locale;
+    const auto seconds = qMax<qint64>(stats.elapsed, 1) / 1000.0;
+    labelStats->setText(i18n("%1 matches, %2 files scanned (%3 reused, %4 ruled out by the index) in %5 s, %6/s",
+                             stats.matches,
+                             stats.blobs,
+                             stats.reusedBlobs,
+                             stats.ruledOutBlobs,
+                             locale.toString(seconds, 'f', 1),
+                             locale.formattedDataSize(static_cast<qint64>(stats.bytes / seconds))));
 }
 
 void SearchDialog::slotTreeViewDoubleClicked(const QModelIndex &index)
@@ -83,58 +185,4 @@ void SearchDialog::slotTreeViewDoubleClicked(const QModelIndex &index)
     // d->show();
 }
 
-void SearchDialog::beginSearch()
-{
-    if (radioButtonSearchBranches->isChecked()) {
-        const auto branchesList = mGit->branches()->names(Git::BranchType::LocalBranch);
-        mProgress.total = branchesList.size();
-        for (const auto &branch : branchesList) {
-            searchOnPlace(branch, QString());
-            mProgress.value++;
-        }
-    } else {
-        auto commits = mGit->commits()->allCommits();
-        Git::LogList list;
-        list.load(mGit);
-
-        mProgress.total = list.size();
-        for (const auto &branch : std::as_const(list)) {
-            searchOnPlace(QString(), branch->commitHash());
-            mProgress.value++;
-        }
-    }
-
-    pushButtonSearch->setEnabled(true);
-}
-
-void SearchDialog::searchOnPlace(const QString &branch, const QString &commit)
-{
-    const QString place = branch.isEmpty() ? commit : branch;
-    const auto files = mGit->ls(place);
-
-    for (const auto &file : files) {
-        if (!lineEditPath->text().isEmpty() && !file.contains(lineEditPath->text()))
-            continue;
-
-        bool ok = mGit->fileContent(place, file).contains(lineEditText->text(), checkBoxCaseSensetive->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive);
-        if (ok) {
-            mModel->appendRow({new QStandardItem(file), new QStandardItem(branch), new QStandardItem(commit)});
-        }
-    }
-}
-
-void SearchDialog::searchOnCommit(QSharedPointer<Git::Commit> commit)
-{
-    mProgress.currentPlace = commit->message();
-    // auto tree = commit->tree();
-    // tree.create()
-}
-
-void SearchDialog::timerEvent(QTimerEvent *event)
-{
-    Q_UNUSED(event)
-    progressBar->setMaximum(mProgress.total);
-    progressBar->setValue(mProgress.value);
-}
-
 #include "moc_searchdialog.cpp"
@@ -10,10 +10,15 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "libkommitwidgets_export.h"
 #include "ui_searchdialog.h"
 
+#include <Kommit/ContentSearch>
+
+#include <QFutureWatcher>
+
+#include <memory>
+
 namespace Git
 {
 class Repository;
-class Commit;
 }
 
 class QStandardItemModel;
@@ -24,23 +29,27 @@ class LIBKOMMITWIDGETS_EXPORT SearchDialog : public AppDialog, private Ui::Searc
 public:
     explicit SearchDialog(const QString &path, Git::Repository *git, QWidget *parent = nullptr);
     explicit SearchDialog(Git::Repository *git, QWidget *parent = nullptr);
+    ~SearchDialog() override;
 
     void initModel();
 
-protected:
-    void timerEvent(QTimerEvent *event) override;
-
 private:
+    struct Batch {
+        QList<Git::ContentSearch::Match> matches;
+        Git::ContentSearch::Stats stats;
+        // How many places there are to search, known once the worker has listed them.
+        int places{0};
+    };
+
     LIBKOMMITWIDGETS_NO_EXPORT void slotPushButtonSearchClicked();
     LIBKOMMITWIDGETS_NO_EXPORT void slotTreeViewDoubleClicked(const QModelIndex &index);
-    LIBKOMMITWIDGETS_NO_EXPORT void beginSearch();
-    LIBKOMMITWIDGETS_NO_EXPORT void searchOnPlace(const QString &place, const QString &commit);
-    LIBKOMMITWIDGETS_NO_EXPORT void searchOnCommit(QSharedPointer<Git::Commit> commit);
-    struct {
-        int value;
-        int total;
-        QString message;
-        QString currentPlace;
-    } mProgress;
+    LIBKOMMITWIDGETS_NO_EXPORT void appendResults(int begin, int end);
+    LIBKOMMITWIDGETS_NO_EXPORT void searchFinished();
+    LIBKOMMITWIDGETS_NO_EXPORT void showStats(const Git::ContentSearch::Stats &stats);
+
     QStandardItemModel *const mModel;
+    // Shared with the worker, which can outlive the dialog for as long as it takes to notice
+    // it was canceled.
+    std::shared_ptr<Git::ContentSearch> mSearch;
+    QFutureWatcher<Batch> mSearchWatcher;
 };
@@ -6,39 +6,22 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "gitgraphlane.h"
 
-GraphLane::GraphLane()
-{
-    generateRandomColor();
-}
-
 GraphLane::Type GraphLane::type() const
 {
     return mType;
 }
 
-void GraphLane::generateRandomColor()
-{
-    //    auto r = QRandomGenerator::global();
-    //    _color = QColor(r->bounded(0, 150), r->bounded(0, 150), r->bounded(0, 150));
-}
-
 void GraphLane::setType(Type newType)
 {
     mType = newType;
 }
 
-const QList<int> &GraphLane::upJoins() const
-{
-    return mUpJoins;
-}
-
-const QList<int> &GraphLane::bottomJoins() const
+GraphLane::GraphLane(GraphLane::Type type)
+    : mType(type)
 {
-    return mBottomJoins;
 }
 
-GraphLane::GraphLane(GraphLane::Type type)
-    : mType(type)
+bool operator==(const GraphLane &lane, const GraphLane &other)
 {
-    generateRandomColor();
+    return lane.type() == other.type();
 }
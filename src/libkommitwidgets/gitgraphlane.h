@@ -6,42 +6,62 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
 #include "libkommitwidgets_export.h"
-#include <QList>
-
-namespace Impl
-{
-struct LanesFactory;
-}
+#include <QtGlobal>
 
+/**
+ * What is drawn in one column of one row of the history graph. It is a single byte, so a
+ * row costs as many bytes as it has columns.
+ */
 class LIBKOMMITWIDGETS_EXPORT GraphLane
 {
 public:
-    enum Type {
+    enum Type : quint8 {
         None,
         Start,
         Pipe,
         Node,
         End,
         Transparent,
+        Dot,
         Test,
     };
-    GraphLane();
+    GraphLane() = default;
     GraphLane(Type type);
 
     [[nodiscard]] Type type() const;
-    const QList<int> &bottomJoins() const;
-    const QList<int> &upJoins() const;
     void setType(Type newType);
 
 private:
-    LIBKOMMITWIDGETS_NO_EXPORT void generateRandomColor();
-
     Type mType{None};
-    QList<int> mBottomJoins;
-    QList<int> mUpJoins;
-
-    friend class LogList;
-    friend struct LanesFactory;
-    friend struct Impl::LanesFactory;
 };
 bool operator==(const GraphLane &, const GraphLane &);
+
+/**
+ * A curve in one row from the commit in column @c from to the top or the bottom edge of
+ * column @c column.
+ */
+struct GraphJoin {
+    enum Direction : quint8 {
+        Up,
+        Down,
+    };
+
+    quint16 column;
+    quint16 from;
+    Direction direction;
+    // Spelled out and always zero, so the joins saved as they are in memory have no stray
+    // padding byte in them.
+    quint8 reserved{0};
+};
+static_assert(sizeof(GraphJoin) == 6, "GraphJoin is saved as it is in memory");
+
+/**
+ * One row of the history graph, pointing into the storage of the graph it came from. It is
+ * only valid until rows are added to or removed from that graph.
+ */
+struct GraphRow {
+    const GraphLane *lanes{nullptr};
+    int laneCount{0};
+    const GraphJoin *joins{nullptr};
+    int joinCount{0};
+};
@@ -46,7 +46,9 @@ void AbstractGitItemsModel::setLoadOnDemand(bool loadOnDemand)
 
 void AbstractGitItemsModel::loadIfNeeded()
 {
-    if (mStale || m_status != Loaded)
+    // A model still filling itself in the background is as current as it gets; loading it
+    // again would only throw away the rows it has and start over.
+    if (mStale || m_status == NotLoaded)
         load();
 }
 
@@ -72,10 +74,23 @@ Git::Repository *AbstractGitItemsModel::manager() const
 void AbstractGitItemsModel::load()
 {
     setStatus(Loading);
+    mLoadDeferred = false;
     beginResetModel();
     reload();
     endResetModel();
     mStale = false;
+    if (!mLoadDeferred)
+        setStatus(Loaded);
+}
+
+void AbstractGitItemsModel::deferLoad()
+{
+    mLoadDeferred = true;
+}
+
+void AbstractGitItemsModel::finishLoad()
+{
+    mLoadDeferred = false;
     setStatus(Loaded);
 }
 
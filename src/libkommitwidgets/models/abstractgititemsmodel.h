@@ -57,6 +57,13 @@ protected:
     Git::Repository *mGit{nullptr};
     virtual void reload() = 0;
 
+    /**
+     * For a model that goes on filling itself after reload() returns: called from reload(),
+     * it keeps the model Loading until finishLoad() says the last rows are in.
+     */
+    void deferLoad();
+    void finishLoad();
+
 Q_SIGNALS:
     void loaded();
     void statusChanged();
@@ -67,4 +74,5 @@ private:
     Status m_status{NotLoaded};
     bool mLoadOnDemand{false};
     bool mStale{true};
+    bool mLoadDeferred{false};
 };
@@ -107,21 +107,37 @@ void ChangedFilesModel::reload()
         }
     }
 
-    auto files = mGit->changedFiles();
-    for (auto i = files.begin(); i != files.end(); ++i) {
-        if (i.value() == Git::ChangeStatus::Ignored)
-            continue;
-
-        Row d;
-        d.filePath = i.key();
-        d.status = i.value();
-        d.checked = true;
-
-        createIcon(d.status);
-        mData << d;
-    }
-
     endResetModel();
+
+    // The status may run the repository's fsmonitor hook, and otherwise reads the whole working
+    // tree; neither is for the GUI thread.
+    const auto reload = ++mReloads;
+    mGit->changedFilesInBackground().then(this, [this, reload](const QMap<QString, Git::ChangeStatus> &files) {
+        if (reload != mReloads)
+            return;
+
+        QList<Row> rows;
+        for (auto i = files.begin(); i != files.end(); ++i) {
+            if (i.value() == Git::ChangeStatus::Ignored)
+                continue;
+
+            Row d;
+            d.filePath = i.key();
+            d.status = i.value();
+            d.checked = true;
+
+            createIcon(d.status);
+            rows << d;
+        }
+
+        if (!rows.isEmpty()) {
+            beginInsertRows({}, mData.size(), mData.size() + rows.size() - 1);
+            mData << rows;
+            endInsertRows();
+            Q_EMIT checkedCountChanged();
+        }
+        Q_EMIT reloaded();
+    });
 }
 
 int ChangedFilesModel::rowCount(const QModelIndex &parent) const
@@ -18,6 +18,8 @@ class ChangedFilesModel : public QAbstractListModel
 
 public:
     explicit ChangedFilesModel(Git::Repository *git, bool checkable = false, QObject *parent = nullptr);
+    /// Lists the changed submodules at once and the changed files as the status running on a
+    /// worker thread finds them; reloaded() is emitted once they are in.
     void reload();
 
     [[nodiscard]] int rowCount(const QModelIndex &parent) const override;
@@ -45,6 +47,7 @@ public:
 
 Q_SIGNALS:
     void checkedCountChanged();
+    void reloaded();
 
 private:
     void createIcon(Git::ChangeStatus status);
@@ -53,4 +56,6 @@ private:
     QList<Row> mData;
     QMap<Git::ChangeStatus, QIcon> mIcons;
     bool mCheckable = false;
+    // Counts the reloads, so the files a replaced one finds are dropped.
+    int mReloads{0};
 };
@@ -6,205 +6,218 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "commitsmodel.h"
 #include "caches/commitscache.h"
+#include "commitsgraph.h"
+#include "commitwalk.h"
 #include "entities/commit.h"
 #include "repository.h"
 
 #include <Kommit/Branch>
+#include <Kommit/Oid>
 
 #include <KLocalizedString>
+#include <QBitArray>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QMultiHash>
+#include <QPromise>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrentRun>
 
 #include <git2/commit.h>
+#include <git2/repository.h>
 
-struct CommitsLaneData {
-    Git::Commit commit;
-    QVector<GraphLane> lanes;
-};
+#include <algorithm>
+#include <cstring>
+#include <memory>
 
-namespace Impl
+namespace
 {
+// Small enough for the first screen of history to show up as soon as the walk produces
+// it, big enough that each page is not mostly the cost of inserting its rows.
+constexpr int walkPageSize{1000};
+
+// Layout files not used for this long belong to repositories or branches that are gone, or
+// to histories rewritten since; past this size, the ones used least recently go first.
+constexpr int graphCacheMaxAgeDays{30};
+constexpr qint64 graphCacheMaxSize{256 * 1024 * 1024};
+
+struct OidRow {
+    git_oid oid;
+    int row;
+};
 
-struct LanesFactory {
-    QStringList _hashes;
-
-    QList<int> findByChild(const QString &hash)
-    {
-        int index{0};
-        QList<int> ret;
-        for (auto const &h : std::as_const(_hashes)) {
-            if (hash == h)
-                ret.append(index);
-            index++;
-        }
-        return ret;
-    }
-
-    int indexOfChild(const QString &hash)
-    {
-        int index{0};
-        for (auto const &h : std::as_const(_hashes)) {
-            if (hash == h)
-                return index;
-            index++;
-        }
-        return -1;
-    }
-
-    QVector<GraphLane> initLanes(const QString &myHash, int &myIndex)
-    {
-        if (_hashes.empty())
-            return {};
-
-        while (!_hashes.empty() && _hashes.last() == QString())
-            _hashes.removeLast();
+// A page of the walk with the parents of each of its commits, so its rows can be laid out
+// without looking a commit up on the thread the model lives in.
+struct WalkPage {
+    QList<git_oid> oids;
+    // The parents of the commit oids[i] are the ones from offset i up to offset i + 1.
+    QList<int> parentOffsets{0};
+    QList<git_oid> parents;
+};
 
-        int index{0};
-        QVector<GraphLane> lanes;
-        lanes.reserve(_hashes.size());
-        for (const auto &hash : std::as_const(_hashes)) {
-            if (hash == QString()) {
-                lanes.append(GraphLane::Transparent);
-            } else {
-                if (hash == myHash) {
-                    lanes.append(GraphLane::Node);
-                    myIndex = index;
-                } else {
-                    lanes.append(hash == myHash ? GraphLane::Node : GraphLane::Pipe);
-                }
-            }
-            index++;
-        }
-        return lanes;
-    }
+// What a walk hands back besides its pages. The walk writes it before its first page.
+struct WalkState {
+    QList<git_oid> tips;
+    // The layout read from the file, when the walk was asked to, and its tips.
+    std::shared_ptr<const CommitsGraph> restoredGraph;
+    QList<git_oid> restoredTips;
+};
 
-    QList<int> setHashes(const QStringList &children, int myIndex)
-    {
-        QList<int> ret;
-        bool myIndexSet{myIndex == -1};
-        int index;
-
-        for (const auto &h : children) {
-            index = -1;
-            if (!myIndexSet) {
-                index = myIndex;
-                myIndexSet = true;
-            }
-            if (index == -1)
-                index = indexOfChild(QString());
+// The layout of a history is kept in a file per repository and branch, which starts with
+// the tips it was walked from.
+QString graphCacheFileName(const QString &path, const QString &refName)
+{
+    const auto key = QCryptographicHash::hash((path + QLatin1Char('\n') + refName).toUtf8(), QCryptographicHash::Sha1);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/commitsgraph/") + QString::fromLatin1(key.toHex());
+}
 
-            if (index == -1) {
-                _hashes.append(h);
-                index = _hashes.size() - 1;
-            } else {
-                _hashes.replace(index, h);
-            }
-            ret.append(index);
-        }
-        return ret;
+bool readGraphCache(const QString &fileName, CommitsGraph &graph, QList<git_oid> &tips)
+{
+    QFile file{fileName};
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const auto size = file.size();
+    const auto data = reinterpret_cast<const char *>(file.map(0, size));
+    if (!data)
+        return false;
+
+    qint32 tipCount{-1};
+    if (size >= qint64(sizeof(tipCount)))
+        memcpy(&tipCount, data, sizeof(tipCount));
+
+    const qint64 tipsSize = qint64(sizeof(git_oid)) * tipCount;
+    bool ok = tipCount >= 0 && size - qint64(sizeof(tipCount)) >= tipsSize;
+    if (ok) {
+        tips.resize(tipCount);
+        memcpy(tips.data(), data + sizeof(tipCount), tipsSize);
+
+        const auto offset = sizeof(tipCount) + tipsSize;
+        ok = graph.restore(data + offset, size - offset);
     }
 
-    void start(const QString &hash, QVector<GraphLane> &lanes)
-    {
-        Q_UNUSED(hash)
-        _hashes.append(QString());
-        set(_hashes.size() - 1, GraphLane::Start, lanes);
+    file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
+    if (!ok) {
+        tips.clear();
+        return false;
     }
 
-    void join(const QString &hash, QVector<GraphLane> &lanes, int &myIndex)
-    {
-        // TODO: fix me
-        int firstIndex{-1};
-        const auto list = findByChild(hash);
+    // Used, so it is not pruned as stale.
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
 
-        for (auto i = list.begin(); i != list.end(); ++i) {
-            if (firstIndex == -1) {
-                firstIndex = *i;
-                set(*i, list.contains(myIndex) ? GraphLane::Node : GraphLane::End, lanes);
-            } else {
-                auto lane = lanes.at(*i);
-                lane.mBottomJoins.append(firstIndex);
-                lane.mType = GraphLane::Transparent;
-                set(*i, lane, lanes);
-            }
-            _hashes.replace(*i, QString());
-        }
-        myIndex = firstIndex;
+// Removes the layouts not used for long, and the least recently used ones past the size
+// limit. @p keep, just written, is always kept, even when it is past the limit on its own:
+// the larger a repository is, the more its layout is worth keeping.
+void pruneGraphCache(const QString &dirPath, const QString &keep)
+{
+    const auto oldest = QDateTime::currentDateTime().addDays(-graphCacheMaxAgeDays);
+    const QFileInfo kept{keep};
+    qint64 size{kept.size()};
+
+    // Newest first.
+    const auto files = QDir{dirPath}.entryInfoList(QDir::Files, QDir::Time);
+    for (const auto &info : files) {
+        if (info == kept)
+            continue;
+        size += info.size();
+        if (info.lastModified() < oldest || size > graphCacheMaxSize)
+            QFile::remove(info.absoluteFilePath());
     }
+}
 
-    void fork(const QStringList &childrenList, QVector<GraphLane> &lanes, int myInedx)
-    {
-        // TODO: fix me
-        const auto list = setHashes(childrenList, -1);
-        auto children = childrenList;
-        lanes.reserve(_hashes.size());
-
-        if (myInedx != -1 && lanes.size() <= myInedx)
-            lanes.resize(myInedx + 1);
-
-        if (myInedx != -1 && childrenList.size() == 1) {
-            auto &l = lanes[list.first()];
-
-            if (list.first() == myInedx) {
-                if (l.type() == GraphLane::None)
-                    l.mType = GraphLane::Transparent;
-                if (l.type() == GraphLane::End)
-                    l.mType = GraphLane::Node;
-            } else {
-                l.mUpJoins.append(myInedx);
-                lanes[myInedx].mType = GraphLane::End;
-            }
-
-            return;
-        }
-        for (int i : list) {
-            if (lanes.size() <= i)
-                lanes.resize(i + 1);
-
-            auto &l = lanes[i];
-            if (i == myInedx) {
-                l.mType = GraphLane::Node;
-            } else {
-                if (l.type() == GraphLane::None)
-                    l.mType = GraphLane::Transparent;
-                if (l.type() == GraphLane::End)
-                    l.mType = GraphLane::Node;
+void writeGraphCache(const QString &fileName, const QList<git_oid> &tips, const QByteArray &graph)
+{
+    QByteArray out;
+    const qint32 tipCount = tips.size();
+    out.reserve(sizeof(tipCount) + tips.size() * sizeof(git_oid) + graph.size());
+    out.append(reinterpret_cast<const char *>(&tipCount), sizeof(tipCount));
+    out.append(reinterpret_cast<const char *>(tips.constData()), tips.size() * sizeof(git_oid));
+    out.append(graph);
+
+    const auto dirPath = QFileInfo{fileName}.absolutePath();
+    QDir().mkpath(dirPath);
+    QSaveFile file{fileName};
+    if (file.open(QIODevice::WriteOnly) && file.write(out) == out.size())
+        file.commit();
+
+    pruneGraphCache(dirPath, fileName);
+}
 
-                l.mUpJoins.append(myInedx);
-            }
-            _hashes.replace(i, children.takeFirst());
+// Reads a walk on a worker thread, page by page, along with the parents of its commits. The
+// parents of the commits the base layout already has are taken from it, in the order the
+// walk hands that layout back over; the others are looked up in a repository of its own.
+void readWalk(QPromise<WalkPage> &promise,
+              const QString &path,
+              const QString &refName,
+              const QString &restoreFrom,
+              std::shared_ptr<const CommitsGraph> base,
+              const QList<git_oid> &baseTips,
+              const std::shared_ptr<WalkState> &state)
+{
+    QList<git_oid> tips = baseTips;
+    if (!restoreFrom.isEmpty()) {
+        auto restored = std::make_shared<CommitsGraph>();
+        if (readGraphCache(restoreFrom, *restored, tips)) {
+            state->restoredGraph = restored;
+            state->restoredTips = tips;
+            base = std::move(restored);
+        } else {
+            base.reset();
         }
     }
 
-    void set(int index, const GraphLane &lane, QVector<GraphLane> &lanes)
-    {
-        if (index < lanes.size())
-            lanes.replace(index, lane);
-        else
-            lanes.append(lane);
+    Git::CommitWalkBase walkBase;
+    if (base && !tips.isEmpty()) {
+        walkBase.tips = tips;
+        walkBase.oids = base->oids();
     }
-    QVector<GraphLane> apply(const Git::Commit &log)
-    {
-        int myIndex = -1;
-        QVector<GraphLane> lanes = initLanes(log.commitHash(), myIndex);
-        // TODO: fix me
-        if (!log.parents().empty())
-            join(log.commitHash(), lanes, myIndex);
-        else if (!log.children().empty()) {
-            start(log.children().first(), lanes);
-            myIndex = _hashes.size() - 1;
-        }
 
-        if (!log.children().empty()) {
-            fork(log.children(), lanes, myIndex);
-        } else if (myIndex != -1) {
-            lanes[myIndex].mType = GraphLane::End;
+    git_repository *repo{nullptr};
+    int baseRow{0};
+
+    const auto handler = [&](const QList<git_oid> &oids) {
+        WalkPage page;
+        page.oids = oids;
+        page.parentOffsets.reserve(oids.size() + 1);
+        page.parents.reserve(oids.size());
+
+        for (const auto &oid : oids) {
+            if (base && baseRow < base->rowCount() && base->oids().at(baseRow) == oid) {
+                int count;
+                const auto parents = base->parents(baseRow++, &count);
+                for (int i = 0; i < count; ++i)
+                    page.parents << parents[i];
+            } else {
+                git_commit *commit{nullptr};
+                if (repo || !git_repository_open_ext(&repo, path.toUtf8().constData(), 0, nullptr)) {
+                    if (!git_commit_lookup(&commit, repo, &oid)) {
+                        const auto count = git_commit_parentcount(commit);
+                        for (unsigned int i = 0; i < count; ++i)
+                            page.parents << *git_commit_parent_id(commit, i);
+                        git_commit_free(commit);
+                    }
+                }
+            }
+            page.parentOffsets << page.parents.size();
         }
 
-        return lanes;
-    }
-};
+        promise.addResult(page);
+        return !promise.isCanceled();
+    };
 
-} // namespace Impl
+    Git::walkCommits(path, refName, walkPageSize, handler, walkBase, &state->tips);
+    git_repository_free(repo);
+}
+}
 
 class CommitsModelPrivate
 {
@@ -214,18 +227,43 @@ class CommitsModelPrivate
 public:
     explicit CommitsModelPrivate(CommitsModel *parent);
 
-    void initChilds();
-    void initGraph();
+    void startWalk(const QString &restoreFrom, std::shared_ptr<const CommitsGraph> base, const QList<git_oid> &baseTips);
+    bool cancelWalk();
+    void takeRestoredGraph();
+    void appendPages(int begin, int end);
+    void finishWalk();
+    [[nodiscard]] Git::Commit commitAt(int row) const;
+    void clearRows();
+    [[nodiscard]] int findRow(const QString &hash, CommitsModel::LogMatchType matchType) const;
+    void sortOids() const;
+
+    QFutureWatcher<WalkPage> walkWatcher;
+    bool walkActive{false};
+    std::shared_ptr<WalkState> walkState;
+
+    // The file the layout in graph is kept in, the tips that layout was walked from when
+    // it is complete, and the tips of the layout the file holds.
+    QString graphFileName;
+    QList<git_oid> graphTips;
+    QList<git_oid> savedTips;
+    QFuture<void> graphSaved;
 
     bool fullDetails{false};
     Git::Branch branch;
-    QList<CommitsLaneData *> data;
-    QList<Git::Commit> list;
+    CommitsGraph graph;
+    QList<git_oid> oids;
+    // The commit on each row, looked up the first time it is asked for.
+    mutable QList<Git::Commit> list;
+    mutable QBitArray looked;
     QStringList branches;
-    QMap<QString, Git::Commit> dataByCommitHashLong;
-    QMap<QString, Git::Commit> dataByCommitHashShort;
+    QHash<git_oid, int> rowByOid;
+    // The rows of the children of each commit, to link a commit up once it is looked up.
+    QMultiHash<git_oid, int> childRows;
+    // Every row by its oid in ascending order, for looking an abbreviated hash up. It is
+    // only sorted when such a lookup comes after new rows, not as the rows stream in.
+    mutable QVector<OidRow> sortedOids;
+    mutable bool sortedOidsValid{false};
     QCalendar calendar;
-    QSet<QString> seenHashes;
 };
 
 CommitsModel::CommitsModel(Git::Repository *git, QObject *parent)
@@ -236,10 +274,21 @@ CommitsModel::CommitsModel(Git::Repository *git, QObject *parent)
     // the model reset the views need. A second, direct pathChanged connection would walk
     // the history again, and would do it without ever telling the views.
     connect(git->commits(), &Git::CommitsCache::added, this, &CommitsModel::load);
+
+    connect(&d_ptr->walkWatcher, &QFutureWatcherBase::resultsReadyAt, this, [this](int begin, int end) {
+        Q_D(CommitsModel);
+        d->appendPages(begin, end);
+    });
+    connect(&d_ptr->walkWatcher, &QFutureWatcherBase::finished, this, [this] {
+        Q_D(CommitsModel);
+        d->finishWalk();
+    });
 }
 
 CommitsModel::~CommitsModel()
 {
+    Q_D(CommitsModel);
+    d->cancelWalk();
 }
 
 const Git::Branch &CommitsModel::branch() const
@@ -267,7 +316,7 @@ int CommitsModel::rowCount(const QModelIndex &parent) const
     Q_UNUSED(parent)
     Q_D(const CommitsModel);
 
-    return d->list.size();
+    return d->oids.size();
 }
 
 int CommitsModel::columnCount(const QModelIndex &parent) const
@@ -312,10 +361,10 @@ Git::Commit CommitsModel::at(int index) const
 {
     Q_D(const CommitsModel);
 
-    if (index < 0 || index >= d->list.size())
+    if (index < 0 || index >= d->oids.size())
         return Git::Commit{};
 
-    return d->list.at(index);
+    return d->commitAt(index);
 }
 
 QVariant CommitsModel::data(const QModelIndex &index, int role) const
@@ -357,83 +406,92 @@ Git::Commit CommitsModel::fromIndex(const QModelIndex &index) const
 {
     Q_D(const CommitsModel);
 
-    if (!index.isValid() || index.row() < 0 || index.row() >= d->list.size())
+    if (!index.isValid() || index.row() < 0 || index.row() >= d->oids.size())
         return Git::Commit{};
 
-    return d->list.at(index.row());
+    return d->commitAt(index.row());
 }
 
-QVector<GraphLane> CommitsModel::lanesFromIndex(const QModelIndex &index) const
+GraphRow CommitsModel::lanesFromIndex(const QModelIndex &index) const
 {
     Q_D(const CommitsModel);
 
-    if (!index.isValid() || index.row() < 0 || index.row() >= d->data.size())
+    if (!index.isValid() || index.row() < 0 || index.row() >= d->graph.rowCount())
         return {};
 
-    return d->data.at(index.row())->lanes;
+    return d->graph.row(index.row());
 }
 
 QModelIndex CommitsModel::findIndexByHash(const QString &hash) const
 {
     Q_D(const CommitsModel);
 
-    int idx{0};
-    for (auto &log : d->list)
-        if (log.commitHash() == hash)
-            return index(idx);
-        else
-            idx++;
-    return {};
+    const auto row = d->findRow(hash, LogMatchType::ExactMatch);
+    if (row == -1)
+        return {};
+    return index(row);
 }
 
 Git::Commit CommitsModel::findLogByHash(const QString &hash, LogMatchType matchType) const
 {
     Q_D(const CommitsModel);
 
-    QList<Git::Commit>::ConstIterator i;
-
-    switch (matchType) {
-    case LogMatchType::ExactMatch:
-        i = std::find_if(d->list.begin(), d->list.end(), [&hash](const Git::Commit &log) {
-            return log.commitHash() == hash;
-        });
-        break;
-    case LogMatchType::BeginMatch:
-        i = std::find_if(d->list.begin(), d->list.end(), [&hash](const Git::Commit &log) {
-            return log.commitHash().startsWith(hash);
-        });
-        break;
-    }
-    if (i == d->list.end())
+    const auto row = d->findRow(hash, matchType);
+    if (row == -1)
         return Git::Commit{};
-    return *i;
+    return d->commitAt(row);
 }
 
 void CommitsModel::reload()
 {
     Q_D(CommitsModel);
 
-    qDeleteAll(d->data);
-    d->data.clear();
+    // Whatever walk is still running belongs to the branch or repository being left; it
+    // stops at its next page instead of finishing behind the new one.
+    d->cancelWalk();
 
-    if (mGit->isValid()) {
-        if (d->branch.isNull())
-            d->list = mGit->commits()->allCommits();
-        else
-            d->list = mGit->commits()->commitsInBranch(d->branch);
-        d->dataByCommitHashLong.clear();
+    d->clearRows();
 
-        d->data.reserve(d->list.size());
-        for (auto const &commit : std::as_const(d->list)) {
-            d->dataByCommitHashLong.insert(commit.commitHash(), commit);
-            d->data << new CommitsLaneData{commit, {}};
-        }
-    } else {
-        d->list.clear();
-        d->dataByCommitHashLong.clear();
+    if (!mGit->isValid()) {
+        d->graph.clear();
+        d->graphFileName.clear();
+        d->graphTips.clear();
+        return;
+    }
+
+    // Opening a repository, or another branch of it, starts from the layout it had the
+    // last time it was shown, so only the commits that came since have to be walked.
+    // That layout is read, and copied out of its file, by the walk; the one in memory only
+    // has to be shared with it, which copies nothing.
+    const auto fileName = graphCacheFileName(mGit->path(), d->branch.isNull() ? QString{} : d->branch.refName());
+    QString restoreFrom;
+    std::shared_ptr<const CommitsGraph> base;
+    const auto baseTips = std::exchange(d->graphTips, {});
+    if (fileName != d->graphFileName) {
+        d->graphFileName = fileName;
+        d->savedTips.clear();
+        restoreFrom = fileName;
+    } else if (!baseTips.isEmpty()) {
+        base = std::make_shared<const CommitsGraph>(d->graph);
     }
-    d->initChilds();
-    d->initGraph();
+
+    // The previous layout is kept for the new one to take over the rows the two histories
+    // share, which after a fetch is nearly all of them.
+    d->graph.restart();
+
+    // The rows stream in after the reset that wraps this, page by page, so the history
+    // shows up while the rest of it is still being walked.
+    mGit->commits()->clearChildren();
+    deferLoad();
+    d->startWalk(restoreFrom, std::move(base), baseTips);
+}
+
+void CommitsModel::cancelLoading()
+{
+    Q_D(CommitsModel);
+
+    if (d->walkActive)
+        d->walkWatcher.cancel();
 }
 
 bool CommitsModel::fullDetails() const
@@ -455,25 +513,6 @@ void CommitsModel::setFullDetails(bool newFullDetails)
     endResetModel();
 }
 
-void CommitsModelPrivate::initChilds()
-{
-    // for (auto &d : data) {
-    // auto &log = *i;
-    // TODO: check this
-    // for (auto &p : d.commit->parents())
-    // mDataByCommitHashLong.value(p)->mChildren.append(log.commitHash());
-    // }
-}
-
-void CommitsModelPrivate::initGraph()
-{
-    Impl::LanesFactory factory;
-    for (auto i = data.rbegin(); i != data.rend(); i++) {
-        auto d = *i;
-        d->lanes = factory.apply(d->commit);
-    }
-}
-
 QString CommitsModel::calendarType() const
 {
     Q_D(const CommitsModel);
@@ -496,11 +535,209 @@ void CommitsModel::clear()
 {
     Q_D(CommitsModel);
 
+    if (d->cancelWalk())
+        setStatus(NotLoaded);
+
     beginResetModel();
-    d->list.clear();
+    d->clearRows();
+    d->graph.clear();
+    d->graphFileName.clear();
+    d->graphTips.clear();
     endResetModel();
 }
 
+void CommitsModelPrivate::startWalk(const QString &restoreFrom, std::shared_ptr<const CommitsGraph> base, const QList<git_oid> &baseTips)
+{
+    Q_Q(CommitsModel);
+
+    const auto path = q->manager()->path();
+    const auto refName = branch.isNull() ? QString{} : branch.refName();
+
+    // The worker opens a repository of its own and hands object ids and their parents back,
+    // which is all the rows and the graph need. The commits themselves are looked up here,
+    // as rows are shown.
+    walkActive = true;
+    walkState = std::make_shared<WalkState>();
+    walkWatcher.setFuture(QtConcurrent::run(readWalk, path, refName, restoreFrom, std::move(base), baseTips, walkState));
+}
+
+void CommitsModelPrivate::takeRestoredGraph()
+{
+    if (!walkState->restoredGraph)
+        return;
+
+    // A copy, the walk still reading the parents from its own; the two share their data.
+    graph = *walkState->restoredGraph;
+    graph.restart();
+    savedTips = walkState->restoredTips;
+    walkState->restoredGraph.reset();
+}
+
+bool CommitsModelPrivate::cancelWalk()
+{
+    if (!walkActive)
+        return false;
+
+    // Setting the next future on the watcher drops anything the old one still had queued,
+    // and walkActive keeps a late signal of this one from landing on the next load.
+    walkActive = false;
+    walkWatcher.cancel();
+    return true;
+}
+
+void CommitsModelPrivate::appendPages(int begin, int end)
+{
+    Q_Q(CommitsModel);
+
+    if (!walkActive)
+        return;
+
+    // The layout read from the file is only there once the walk has got going.
+    takeRestoredGraph();
+
+    for (int i = begin; i < end; ++i) {
+        const auto page = walkWatcher.resultAt(i);
+        if (page.oids.isEmpty())
+            continue;
+
+        const auto first = oids.size();
+        q->beginInsertRows({}, first, first + page.oids.size() - 1);
+        oids.reserve(first + page.oids.size());
+        rowByOid.reserve(first + page.oids.size());
+        for (int r = 0; r < page.oids.size(); ++r) {
+            const auto &oid = page.oids.at(r);
+            const auto parentsBegin = page.parentOffsets.at(r);
+            const auto parentCount = page.parentOffsets.at(r + 1) - parentsBegin;
+
+            rowByOid.insert(oid, oids.size());
+            for (int p = parentsBegin; p < parentsBegin + parentCount; ++p)
+                childRows.insert(page.parents.at(p), oids.size());
+            oids << oid;
+            graph.append(oid, page.parents.constData() + parentsBegin, parentCount);
+        }
+        list.resize(oids.size());
+        looked.resize(oids.size());
+        sortedOidsValid = false;
+        q->endInsertRows();
+    }
+
+    Q_EMIT q->loadingProgress(oids.size());
+}
+
+void CommitsModelPrivate::finishWalk()
+{
+    Q_Q(CommitsModel);
+
+    if (!walkActive)
+        return;
+    walkActive = false;
+
+    takeRestoredGraph();
+    graph.finish();
+
+    // A walk stopped halfway leaves a layout that is no base for the next one.
+    if (!walkWatcher.isCanceled()) {
+        graphTips = walkState->tips;
+        if (graphTips != savedTips) {
+            savedTips = graphTips;
+            graphSaved = QtConcurrent::run(writeGraphCache, graphFileName, graphTips, graph.save());
+        }
+    }
+
+    q->finishLoad();
+}
+
+Git::Commit CommitsModelPrivate::commitAt(int row) const
+{
+    Q_Q(const CommitsModel);
+
+    if (looked.testBit(row))
+        return list.at(row);
+    looked.setBit(row);
+
+    // Children come before their parents in a walk, so every row that can be a child of
+    // this one is already there.
+    const auto &oid = oids.at(row);
+    QList<git_oid> children;
+    for (auto it = childRows.constFind(oid); it != childRows.cend() && it.key() == oid; ++it)
+        children.prepend(oids.at(*it));
+
+    auto cache = q->mGit->commits();
+    const auto commit = cache->linkedCommit(oid, children);
+    // Pinned, so looking one up again gives back the one on the row, children and all,
+    // however much else goes through the cache meanwhile.
+    if (!commit.isNull())
+        cache->pin(commit.data());
+    list[row] = commit;
+    return commit;
+}
+
+void CommitsModelPrivate::clearRows()
+{
+    Q_Q(CommitsModel);
+
+    auto cache = q->mGit->commits();
+    for (const auto &commit : std::as_const(list))
+        if (!commit.isNull())
+            cache->unpin(commit.data());
+
+    oids.clear();
+    list.clear();
+    looked.clear();
+    rowByOid.clear();
+    childRows.clear();
+    sortedOids.clear();
+    sortedOidsValid = false;
+}
+
+int CommitsModelPrivate::findRow(const QString &hash, CommitsModel::LogMatchType matchType) const
+{
+    const auto hex = hash.toLatin1();
+    if (hex.size() > GIT_OID_SHA1_HEXSIZE)
+        return -1;
+
+    git_oid oid;
+    if (matchType == CommitsModel::LogMatchType::ExactMatch) {
+        if (hex.size() != GIT_OID_SHA1_HEXSIZE || git_oid_fromstrn(&oid, hex.constData(), hex.size()))
+            return -1;
+        return rowByOid.value(oid, -1);
+    }
+
+    if (hex.isEmpty())
+        return oids.isEmpty() ? -1 : 0;
+    // The prefix padded with zeros is the smallest oid it can be the start of.
+    if (git_oid_fromstrn(&oid, hex.constData(), hex.size()))
+        return -1;
+
+    sortOids();
+    auto it = std::lower_bound(sortedOids.cbegin(), sortedOids.cend(), oid, [](const OidRow &oidRow, const git_oid &oid) {
+        return git_oid_cmp(&oidRow.oid, &oid) < 0;
+    });
+
+    // An ambiguous prefix gives the newest of the commits it matches, the one a scan of
+    // the history from the top would find first.
+    int row{-1};
+    for (; it != sortedOids.cend() && !git_oid_ncmp(&it->oid, &oid, hex.size()); ++it)
+        if (row == -1 || it->row < row)
+            row = it->row;
+    return row;
+}
+
+void CommitsModelPrivate::sortOids() const
+{
+    if (sortedOidsValid)
+        return;
+
+    sortedOids.clear();
+    sortedOids.reserve(rowByOid.size());
+    for (auto it = rowByOid.cbegin(); it != rowByOid.cend(); ++it)
+        sortedOids.append({it.key(), it.value()});
+    std::sort(sortedOids.begin(), sortedOids.end(), [](const OidRow &oidRow1, const OidRow &oidRow2) {
+        return git_oid_cmp(&oidRow1.oid, &oidRow2.oid) < 0;
+    });
+    sortedOidsValid = true;
+}
+
 CommitsModelPrivate::CommitsModelPrivate(CommitsModel *parent)
     : q_ptr(parent)
 {
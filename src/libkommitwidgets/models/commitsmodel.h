@@ -41,7 +41,7 @@ public:
 
     Git::Commit at(int index) const;
     Git::Commit fromIndex(const QModelIndex &index) const;
-    QVector<GraphLane> lanesFromIndex(const QModelIndex &index) const;
+    GraphRow lanesFromIndex(const QModelIndex &index) const;
 
     QModelIndex findIndexByHash(const QString &hash) const;
     Git::Commit findLogByHash(const QString &hash, LogMatchType matchType = LogMatchType::ExactMatch) const;
@@ -57,6 +57,16 @@ public:
 
     void clear() override;
 
+    /**
+     * Stops a history load that is still streaming in. The commits read so far stay in the
+     * model and get their graph; the rest are not read.
+     */
+    void cancelLoading();
+
+Q_SIGNALS:
+    /// How many commits have been read so far while the history streams in.
+    void loadingProgress(int count);
+
 protected:
     void reload() override;
 
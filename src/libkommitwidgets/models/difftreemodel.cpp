@@ -6,14 +6,19 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "difftreemodel.h"
 
+#include <KLocalizedString>
+
 #include <QHash>
 #include <QIcon>
 #include <QSet>
 
 struct DiffNodeData : public NodeData {
-    explicit DiffNodeData(Diff::DiffType diffType);
+    DiffNodeData(const QString &file, Diff::DiffType diffType);
 
+    QString file;
     Diff::DiffType diffType;
+    bool hasStats{false};
+    Diff::DiffStats stats;
 };
 
 DiffTreeModel::DiffTreeModel(QObject *parent)
@@ -29,9 +34,7 @@ void DiffTreeModel::addFile(const Git::FileStatus &file)
 
 void DiffTreeModel::addFile(const QString &file, Diff::DiffType type)
 {
-    auto data = new DiffNodeData{type};
-
-    addItem(file, data);
+    mNodeByFile.insert(file, addItem(file, new DiffNodeData{file, type}));
     // const auto parts = file.split(separator());
     // TreeNode *node;
 
@@ -43,6 +46,11 @@ void DiffTreeModel::addFile(const QString &file, Diff::DiffType type)
     // node->metaData = type;
 }
 
+void DiffTreeModel::insertFile(const QString &file, Diff::DiffType type)
+{
+    mNodeByFile.insert(file, insertItem(file, new DiffNodeData{file, type}));
+}
+
 void DiffTreeModel::addFile(const Git::TreeDiffEntry &file)
 {
     addFile(file.newFile(), toDiffType(file.status()));
@@ -56,7 +64,7 @@ TreeNode *DiffTreeModel::createPath(const QStringList &path, Diff::DiffType stat
         if (!child) {
             child = parent->appendChild();
             child->title = p;
-            child->nodeData = new DiffNodeData{Diff::DiffType::Unchanged};
+            child->nodeData = new DiffNodeData{{}, Diff::DiffType::Unchanged};
         } else {
             auto diffData = static_cast<DiffNodeData *>(child->nodeData);
             if (status != Diff::DiffType::Unchanged && diffData->diffType != status)
@@ -192,12 +200,18 @@ QVariant DiffTreeModel::data(const QModelIndex &index, int role) const
         auto item = static_cast<TreeNode *>(index.internalPointer());
 
         switch (index.column()) {
-        case 0:
+        case NameColumn:
             return item->title;
-        case 1:
-            return static_cast<int>(static_cast<DiffNodeData *>(item->nodeData)->diffType);
+        case StatsColumn: {
+            const auto diffData = static_cast<DiffNodeData *>(item->nodeData);
+            if (diffData && diffData->hasStats)
+                return i18nc("lines added, lines removed", "+%1 −%2", diffData->stats.added, diffData->stats.removed);
+            return {};
+        }
         }
-    } else if (role == Qt::DecorationRole) {
+    } else if (role == Qt::TextAlignmentRole && index.column() == StatsColumn) {
+        return QVariant{Qt::AlignRight | Qt::AlignVCenter};
+    } else if (role == Qt::DecorationRole && index.column() == NameColumn) {
         auto item = static_cast<TreeNode *>(index.internalPointer());
 
         //        return statusColor(item->metaData);
@@ -232,8 +246,88 @@ void DiffTreeModel::emitAll()
     endResetModel();
 }
 
-DiffNodeData::DiffNodeData(Diff::DiffType diffType)
-    : diffType(diffType)
+int DiffTreeModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return 2;
+}
+
+QVariant DiffTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section == StatsColumn)
+        return i18n("Changes");
+    return TreeModel::headerData(section, orientation, role);
+}
+
+void DiffTreeModel::clear()
+{
+    mNodeByFile.clear();
+    mStatsChanged.clear();
+    TreeModel::clear();
+}
+
+QString DiffTreeModel::fileAt(const QString &file, int offset) const
+{
+    auto node = mNodeByFile.value(file);
+    if (!node && file.startsWith(QLatin1Char('/')))
+        node = mNodeByFile.value(file.mid(1));
+
+    const auto root = rootNode();
+    // The node after and before @p node, the tree walked depth first.
+    const auto next = [root](TreeNode *node) -> TreeNode * {
+        if (!node->children.isEmpty())
+            return node->children.first();
+        for (; node != root; node = node->parent) {
+            const auto row = node->row();
+            if (row + 1 < node->parent->children.size())
+                return node->parent->children.at(row + 1);
+        }
+        return nullptr;
+    };
+    const auto previous = [root](TreeNode *node) -> TreeNode * {
+        const auto row = node->row();
+        if (!row)
+            return node->parent == root ? nullptr : node->parent;
+        node = node->parent->children.at(row - 1);
+        while (!node->children.isEmpty())
+            node = node->children.last();
+        return node;
+    };
+
+    while (node && offset) {
+        node = offset > 0 ? next(node) : previous(node);
+        const auto diffData = node ? static_cast<DiffNodeData *>(node->nodeData) : nullptr;
+        if (diffData && !diffData->file.isEmpty())
+            offset += offset > 0 ? -1 : 1;
+    }
+
+    return node ? static_cast<DiffNodeData *>(node->nodeData)->file : QString{};
+}
+
+void DiffTreeModel::setStats(const QString &file, const Diff::DiffStats &stats)
+{
+    const auto node = mNodeByFile.value(file);
+    if (!node)
+        return;
+
+    const auto data = static_cast<DiffNodeData *>(node->nodeData);
+    data->stats = stats;
+    data->hasStats = true;
+    mStatsChanged << node;
+}
+
+void DiffTreeModel::emitStatsChanged()
+{
+    for (const auto node : std::as_const(mStatsChanged)) {
+        const auto index = createIndex(node->row(), StatsColumn, node);
+        Q_EMIT dataChanged(index, index, {Qt::DisplayRole});
+    }
+    mStatsChanged.clear();
+}
+
+DiffNodeData::DiffNodeData(const QString &file, Diff::DiffType diffType)
+    : file(file)
+    , diffType(diffType)
 {
 }
 
@@ -12,25 +12,57 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "treemodel.h"
 #include <entities/treediff.h>
 
+#include <QHash>
+
 class TreeNode;
+struct DiffNodeData;
 class DiffTreeModel : public TreeModel
 {
     Q_OBJECT
 
 public:
+    enum Column {
+        NameColumn,
+        // How many lines the file adds and removes, once counted.
+        StatsColumn,
+    };
+
     explicit DiffTreeModel(QObject *parent = nullptr);
 
     void addFile(const Git::FileStatus &file);
     void addFile(const QString &file, Diff::DiffType type);
     void addFile(const Git::TreeDiffEntry &diffEntry);
+    /// Like addFile(), telling the views about the rows it adds, for a tree shown as it fills.
+    void insertFile(const QString &file, Diff::DiffType type);
 
+    [[nodiscard]] int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     [[nodiscard]] QVariant data(const QModelIndex &index, int role) const override;
+    [[nodiscard]] QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 
     void emitAll();
 
+    void clear() override;
+
+    /**
+     * The file @p offset files after @p file in the order the tree shows them, or before it
+     * when @p offset is negative; empty when there is none.
+     */
+    [[nodiscard]] QString fileAt(const QString &file, int offset) const;
+
+    /**
+     * Shows how many lines @p file has added and removed in StatsColumn. Call
+     * emitStatsChanged() once a batch is set to have it painted.
+     */
+    void setStats(const QString &file, const Diff::DiffStats &stats);
+    void emitStatsChanged();
+
 private:
     [[nodiscard]] Diff::DiffType toDiffType(Git::FileStatus::Status status) const;
     [[nodiscard]] Diff::DiffType toDiffType(Git::ChangeStatus status) const;
     TreeNode *createPath(const QStringList &path, Diff::DiffType status);
     Diff::DiffType calculateNodeType(TreeNode *node) const;
+
+    QHash<QString, TreeNode *> mNodeByFile;
+    // The nodes whose stats were set since the last emitStatsChanged().
+    QList<TreeNode *> mStatsChanged;
 };
@@ -128,7 +128,7 @@ QVariant TreeModel::headerData(int section, Qt::Orientation orientation, int rol
     return {};
 }
 
-TreeNode *TreeModel::createPath(const QStringList &path)
+TreeNode *TreeModel::createPath(const QStringList &path, bool notify)
 {
     Q_D(TreeModel);
     auto parent = d->rootNode;
@@ -136,9 +136,14 @@ TreeNode *TreeModel::createPath(const QStringList &path)
     for (const auto &p : path) {
         auto child = parent->find(p);
         if (!child) {
+            const auto row = parent->children.size();
+            if (notify)
+                beginInsertRows(parent == d->rootNode ? QModelIndex{} : createIndex(parent->row(), 0, parent), row, row);
             child = parent->appendChild();
             child->title = p;
             child->path = childPath;
+            if (notify)
+                endInsertRows();
         }
         if (!childPath.isEmpty())
             childPath.append(d->separator);
@@ -148,7 +153,17 @@ TreeNode *TreeModel::createPath(const QStringList &path)
     return parent;
 }
 
-void TreeModel::addItem(const QString &p, NodeData *data)
+TreeNode *TreeModel::addItem(const QString &path, NodeData *data)
+{
+    return addNode(path, data, false);
+}
+
+TreeNode *TreeModel::insertItem(const QString &path, NodeData *data)
+{
+    return addNode(path, data, true);
+}
+
+TreeNode *TreeModel::addNode(const QString &p, NodeData *data, bool notify)
 {
     Q_D(TreeModel);
 
@@ -163,11 +178,12 @@ void TreeModel::addItem(const QString &p, NodeData *data)
     if (d->showRoot && !path.isEmpty())
         parts.prepend("");
 
-    node = createPath(parts);
+    node = createPath(parts, notify);
 
     if (node && data) {
         node->nodeData = data;
     }
+    return node;
 }
 
 void TreeModel::addItems(QMap<QString, NodeData *> items)
@@ -256,9 +272,21 @@ void TreeModel::clear()
 void TreeModel::sortItems()
 {
     Q_D(TreeModel);
-    beginResetModel();
+
+    // A layout change rather than a reset: the indexes the views hold on to, for what is
+    // expanded, selected and current, follow their nodes to where the sort puts them.
+    Q_EMIT layoutAboutToBeChanged();
+    const auto before = persistentIndexList();
     d->sortNode(d->rootNode);
-    endResetModel();
+
+    QModelIndexList after;
+    after.reserve(before.size());
+    for (const auto &index : before) {
+        const auto node = static_cast<TreeNode *>(index.internalPointer());
+        after << createIndex(node->row(), index.column(), node);
+    }
+    changePersistentIndexList(before, after);
+    Q_EMIT layoutChanged();
 }
 
 void TreeModel::emitReset()
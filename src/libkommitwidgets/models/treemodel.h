@@ -96,7 +96,10 @@ public:
     [[nodiscard]] Qt::ItemFlags flags(const QModelIndex &index) const override;
     [[nodiscard]] QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 
-    void addItem(const QString &path, NodeData *data = nullptr);
+    TreeNode *addItem(const QString &path, NodeData *data = nullptr);
+    /// Like addItem(), telling the views about each row it adds, for a tree that fills in
+    /// while it is shown.
+    TreeNode *insertItem(const QString &path, NodeData *data = nullptr);
     void addItems(QMap<QString, NodeData *> items);
     void addItems(const QStringList &items);
 
@@ -123,13 +126,15 @@ public:
 
     void setDefaultIcon(const QIcon &newDefaultIcon);
 
-    void clear();
+    virtual void clear();
 
+    /// Sorts the tree, folders first, keeping what the views have expanded and selected.
     void sortItems();
     void emitReset();
 
 private:
     QScopedPointer<TreeModelPrivate> d_ptr;
     Q_DECLARE_PRIVATE(TreeModel)
-    TreeNode *createPath(const QStringList &path);
+    TreeNode *createPath(const QStringList &path, bool notify);
+    TreeNode *addNode(const QString &path, NodeData *data, bool notify);
 };
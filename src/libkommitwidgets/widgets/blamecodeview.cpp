@@ -8,7 +8,6 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <Kommit/Commit>
 
-#include <KLocalizedString>
 #include <KSyntaxHighlighting/SyntaxHighlighter>
 
 BlameCodeView::BlameCodeView(QWidget *parent)
@@ -33,10 +32,6 @@ void BlameCodeView::setBlameData(const Git::Blame &newBlameData)
             type = type == Odd ? Even : Odd;
         }
 
-        auto data = new BlockData{-1, nullptr, type};
-        data->extraText = blame.finalCommit().isNull() ? i18n("Uncommitted") : blame.finalCommit().committer().name();
-        data->data = blame.finalCommit().data();
-
         appendCode(mBlameData.codeLines(blame), type);
         lastCommit = commitHash;
     }
@@ -5,13 +5,12 @@ SPDX-License-Identifier: GPL-3.0-or-later
 */
 
 #include "codeeditor.h"
+#include "codehighlighter.h"
 #include "codeeditorsidebar.h"
 #include "kommitwidgetsglobaloptions.h"
 #include "libkommitwidgets_appdebug.h"
 
 #include <KSyntaxHighlighting/Definition>
-#include <KSyntaxHighlighting/FoldingRegion>
-#include <KSyntaxHighlighting/SyntaxHighlighter>
 #include <KSyntaxHighlighting/Theme>
 
 #include <QApplication>
@@ -19,10 +18,13 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <QLabel>
 #include <QPainter>
 #include <QPalette>
+#include <QPointer>
 #include <QStyleHints>
 
 #include <QtMath>
 
+#include <functional>
+
 class CodeEditorPrivate
 {
     CodeEditor *q_ptr;
@@ -32,11 +34,14 @@ public:
     CodeEditorPrivate(CodeEditor *parent);
 
     int lastPlaceholderIndex{};
-    QList<CodeEditor::BlockData *> dataList;
+    QList<CodeEditor::BlockData> dataList;
     bool fill{false};
     bool isEmpty{true};
 
-    KSyntaxHighlighting::SyntaxHighlighter *const mHighlighter;
+    // Belongs to the document, and is shared with the editors that show it too.
+    CodeHighlighter *mHighlighter;
+    // Editors showing the document of this one, see CodeEditor::showDocumentOf().
+    QList<QPointer<CodeEditor>> followers;
     CodeEditorSidebar *const mSideBar;
     QLabel *mTitleBar;
 
@@ -65,59 +70,68 @@ public:
     QMap<int, PlaceholderInfo> placeholderBlocks;
     QList<QPair<int, int>> emptyBlocks;
 
-    CodeEditor::BlockData *findBlockData(const QTextBlock &block)
-    {
-        if (!dataList.size())
-            return nullptr;
-        auto ln = block.firstLineNumber();
+    // Fills the editor from @p dataList, taking the text of a block from @p lines.
+    void setContent(const std::function<QStringList(int from, int count)> &lines, const QList<CodeEditor::BlockData> &dataList, bool fill);
 
-        for (auto &data : dataList) {
-            auto &max = fill ? data->maxLineCount : data->lineCount;
+    // Where each entry of dataList starts, in blocks of the document and in lines of the
+    // text it shows; entry i covers the blocks from blockStarts[i] up to blockStarts[i + 1].
+    // Both have one more item than dataList, so lookups are a binary search rather than a
+    // walk over every hunk.
+    QList<int> blockStarts{0};
+    QList<int> lineStarts{0};
+    qsizetype longestExtraText{0};
 
-            if (data->lineNumber <= ln && ln <= data->lineNumber + max)
-                return data;
+    void indexBlocks();
 
-            ln += max;
-        }
-        return nullptr;
-
-        auto it = fill ? std::find_if(dataList.begin(),
-                                      dataList.end(),
-                                      [&ln](auto data) {
-                                          return data->lineNumber >= ln && data->maxLineCount + data->lineNumber <= ln;
-                                      })
-                       : std::find_if(dataList.begin(), dataList.end(), [&ln](CodeEditor::BlockData *data) {
-                             return data->lineNumber >= ln && data->lineCount + data->lineNumber <= ln;
-                         });
-        if (it != dataList.end())
-            return *it;
-        return nullptr;
+    // The index in dataList of the entry block @p blockNumber shows, or -1.
+    [[nodiscard]] qsizetype dataIndexOfBlock(int blockNumber) const
+    {
+        if (blockNumber < 0 || blockNumber >= blockStarts.last())
+            return -1;
+        return std::upper_bound(blockStarts.begin(), blockStarts.end(), blockNumber) - blockStarts.begin() - 1;
+    }
+
+    const CodeEditor::BlockData *findBlockData(const QTextBlock &block) const
+    {
+        const auto index = dataIndexOfBlock(block.blockNumber());
+        return index == -1 ? nullptr : &dataList.at(index);
     }
 
-    int mapBlockNumber(int blockNumber)
+    // The line of the text block @p blockNumber shows, counted from one; -1 for a block that
+    // only fills up space, and 0 past the end.
+    int mapBlockNumber(int blockNumber) const
     {
         if (!fill)
             return blockNumber + 1;
 
-        auto ln = blockNumber + 1;
-
-        auto n{0};
-        for (auto &data : std::as_const(dataList)) {
-            if (ln <= n + data->maxLineCount) {
-                if (ln > n + data->lineCount)
-                    return -1;
+        const auto index = dataIndexOfBlock(blockNumber);
+        if (index == -1)
+            return 0;
 
-                return ln;
-            }
-            n += data->lineCount;
-            ln -= data->maxLineCount - data->lineCount;
-        }
-        return 0;
+        const auto offset = blockNumber - blockStarts.at(index);
+        if (offset >= dataList.at(index).lineCount)
+            return -1;
+        return lineStarts.at(index) + offset + 1;
     }
 };
+
+void CodeEditorPrivate::indexBlocks()
+{
+    blockStarts.resize(dataList.size() + 1);
+    lineStarts.resize(dataList.size() + 1);
+    longestExtraText = 0;
+
+    for (qsizetype i = 0; i < dataList.size(); ++i) {
+        const auto &data = dataList.at(i);
+        blockStarts[i + 1] = blockStarts.at(i) + (fill ? data.maxLineCount : data.lineCount);
+        lineStarts[i + 1] = lineStarts.at(i) + data.lineCount;
+        longestExtraText = std::max(longestExtraText, data.extraText.size());
+    }
+}
+
 CodeEditorPrivate::CodeEditorPrivate(CodeEditor *parent)
     : q_ptr{parent}
-    , mHighlighter{new KSyntaxHighlighting::SyntaxHighlighter{parent->document()}}
+    , mHighlighter{CodeHighlighter::forDocument(parent->document())}
     , mSideBar{new CodeEditorSidebar{parent}}
     , mTitleBar{new QLabel{parent}}
 {
@@ -181,6 +195,7 @@ CodeEditor::CodeEditor(QWidget *parent)
 
     connect(this, &QPlainTextEdit::blockCountChanged, this, &CodeEditor::updateViewPortGeometry);
     connect(this, &QPlainTextEdit::updateRequest, this, &CodeEditor::updateSidebarArea);
+    connect(this, &QPlainTextEdit::updateRequest, this, &CodeEditor::highlightVisibleBlocks);
     connect(this, &QPlainTextEdit::cursorPositionChanged, this, &CodeEditor::highlightCurrentLine);
 
     highlightCurrentLine();
@@ -240,8 +255,8 @@ void CodeEditor::setTheme(const KSyntaxHighlighting::Theme &theme)
     setPalette(pal);
 
     d->mHighlighter->setTheme(theme);
-    d->mHighlighter->rehighlight();
     highlightCurrentLine();
+    highlightVisibleBlocks();
 
     d->mTitleBar->setPalette(pal);
     d->mTitleBar->setStyleSheet(QStringLiteral("border: 1px solid %1; border-width: 0 0 1 0;")
@@ -251,12 +266,9 @@ void CodeEditor::setTheme(const KSyntaxHighlighting::Theme &theme)
 int CodeEditor::sidebarWidth() const
 {
     Q_D(const CodeEditor);
-    const auto longestText = std::max_element(d->dataList.begin(), d->dataList.end(), [](BlockData *d1, BlockData *d2) {
-        return d1->extraText.size() < d2->extraText.size();
-    });
     int count = int(std::log10(blockCount() + 1));
-    if (longestText != d->dataList.end())
-        count += (*longestText)->extraText.size() + 3;
+    if (!d->dataList.isEmpty())
+        count += int(d->longestExtraText) + 3;
     return 4 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * count + fontMetrics().lineSpacing();
 }
 
@@ -293,14 +305,10 @@ void CodeEditor::sidebarPaintEvent(QPaintEvent *event)
     //     return p.first > lineNumber;
     // });
 
-    QList<CodeEditor::BlockData *>::iterator it;
-
-    if (blockNumber)
-        it = std::find_if(d->dataList.begin(), d->dataList.end(), [&blockNumber](BlockData *data) {
-            return data->lineNumber >= blockNumber;
-        });
-    else
-        it = d->dataList.begin();
+    // The entries are in order of their line numbers.
+    auto it = std::partition_point(d->dataList.cbegin(), d->dataList.cend(), [&blockNumber](const BlockData &data) {
+        return data.lineNumber < blockNumber;
+    });
 
     bool extraDataPrinted{false};
     while (block.isValid() && lineNumber <= lines.first + lines.second) {
@@ -326,7 +334,7 @@ void CodeEditor::sidebarPaintEvent(QPaintEvent *event)
         if (block.blockNumber() >= d->highlightStart && block.blockNumber() <= d->highlightEnd)
             bg = Qt::yellow;
         else
-            bg = document()->findBlockByNumber(blockNumber).blockFormat().background();
+            bg = block.blockFormat().background();
         painter.fillRect(QRect{0, top, d->mSideBar->width(), 1 + fontMetrics().height()}, bg);
 
         if (n == -1) { // lineNumber < data->lineNumber + data->maxLineCount) {
@@ -345,13 +353,13 @@ void CodeEditor::sidebarPaintEvent(QPaintEvent *event)
         if (data && !data->extraText.isEmpty()) {
             painter.drawText(0, top, d->mSideBar->width() - 2 - foldingMarkerSize, fontMetrics().height(), Qt::AlignLeft, data->extraText);
         }
-        if (d->dataList.size() && it != d->dataList.end()) {
-            if (lineNumber >= (*it)->lineNumber + (d->fill ? (*it)->maxLineCount : (*it)->lineCount)) {
+        if (d->dataList.size() && it != d->dataList.cend()) {
+            if (lineNumber >= it->lineNumber + (d->fill ? it->maxLineCount : it->lineCount)) {
                 ++it;
                 extraDataPrinted = false;
             }
-            if (!extraDataPrinted && it != d->dataList.end()) {
-                painter.drawText(0, top, d->mSideBar->width() - 2 - foldingMarkerSize, fontMetrics().height(), Qt::AlignLeft, (*it)->extraText);
+            if (!extraDataPrinted && it != d->dataList.cend()) {
+                painter.drawText(0, top, d->mSideBar->width() - 2 - foldingMarkerSize, fontMetrics().height(), Qt::AlignLeft, it->extraText);
                 extraDataPrinted = true;
             }
         }
@@ -400,27 +408,16 @@ void CodeEditor::sidebarPaintEvent(QPaintEvent *event)
     }
 }
 
-CodeEditor::BlockData *CodeEditor::currentBlockData() const
+const CodeEditor::BlockData *CodeEditor::currentBlockData() const
 {
-    // Q_D(const CodeEditor);
     Q_D(const CodeEditor);
-    auto ln = textCursor().block().firstLineNumber() + 1;
-    if (!d->fill) {
-        auto it = std::find_if(d->dataList.begin(), d->dataList.end(), [&ln](BlockData *data) {
-            return data->lineNumber >= ln && data->lineCount + data->lineNumber <= ln;
-        });
-        if (it != d->dataList.end())
-            return *it;
-        return nullptr;
-    }
-    auto n{0};
-    for (auto &data : std::as_const(d->dataList)) {
-        if (ln <= n + data->maxLineCount) {
-            return data;
-        }
-        n += data->maxLineCount;
-    }
-    return nullptr;
+    return d->findBlockData(textCursor().block());
+}
+
+int CodeEditor::currentHunk() const
+{
+    const auto data = currentBlockData();
+    return data ? data->hunk : -1;
 }
 
 void CodeEditor::setBlocksData(QList<BlockData *> list)
@@ -452,6 +449,26 @@ void CodeEditor::updateSidebarArea(const QRect &rect, int dy)
         d->mSideBar->update(0, rect.y(), d->mSideBar->width(), rect.height());
 }
 
+void CodeEditor::highlightVisibleBlocks()
+{
+    Q_D(CodeEditor);
+
+    auto block = firstVisibleBlock();
+    if (!block.isValid())
+        return;
+
+    const auto first = block;
+    auto last = block;
+    const auto offset = contentOffset();
+    const auto bottom = viewport()->height();
+    while (block.isValid() && blockBoundingGeometry(block).translated(offset).top() <= bottom) {
+        last = block;
+        block = block.next();
+    }
+
+    d->mHighlighter->highlight(first, last);
+}
+
 void CodeEditor::highlightCurrentLine()
 {
     Q_D(CodeEditor);
@@ -632,6 +649,28 @@ void CodeEditor::setHighlighting(const QString &fileName)
     const auto def = d->mRepository.definitionForFileName(fileName);
     d->mHighlighter->setDefinition(def);
     d->mTitleBar->setText(fileName);
+    highlightVisibleBlocks();
+}
+
+void CodeEditor::showDocumentOf(CodeEditor *editor)
+{
+    Q_D(CodeEditor);
+
+    setDocument(editor->document());
+    d->mHighlighter = CodeHighlighter::forDocument(document());
+    d->dataList = editor->d_func()->dataList;
+    d->fill = editor->d_func()->fill;
+    d->indexBlocks();
+    editor->d_func()->followers.append(this);
+
+    // The document goes with the editor it belongs to, so this one needs one of its own again.
+    connect(editor, &QObject::destroyed, this, [this] {
+        Q_D(CodeEditor);
+        setDocument(new QTextDocument{this});
+        d->mHighlighter = CodeHighlighter::forDocument(document());
+        d->dataList.clear();
+        d->indexBlocks();
+    });
 }
 
 void CodeEditor::append(const QString &code, CodeEditor::BlockType type, Diff::Segment *segment)
@@ -762,36 +801,117 @@ void CodeEditor::appendLines(const QStringList &content, BlockData *data, bool f
         data->firstBlock = cursor.block();
 }
 
-void CodeEditor::setContent(const QStringList &content, QList<BlockData *> dataList, bool fill)
+void CodeEditor::setContent(const QStringList &content, const QList<BlockData> &dataList, bool fill)
+{
+    Q_D(CodeEditor);
+    d->setContent(
+        [&content](int from, int count) {
+            return content.mid(from, count);
+        },
+        dataList,
+        fill);
+}
+
+void CodeEditor::setContent(const Diff::TextView &content, const QList<BlockData> &dataList, bool fill)
 {
     Q_D(CodeEditor);
+    d->setContent(
+        [&content](int from, int count) {
+            return content.lineRange(from, count);
+        },
+        dataList,
+        fill);
+}
+
+void CodeEditorPrivate::setContent(const std::function<QStringList(int, int)> &lines, const QList<CodeEditor::BlockData> &dataList, bool fill)
+{
+    Q_Q(CodeEditor);
 
-    d->dataList = dataList;
-    d->fill = fill;
+    this->dataList = dataList;
+    this->fill = fill;
+    indexBlocks();
 
     bool first{true};
 
-    clear();
-    auto t = textCursor();
+    q->clear();
 
-    for (auto &data : dataList) {
+    // Filling the document is not something to undo, and keeping it undoable would keep a
+    // second copy of the text. One edit block has the layout and the highlighter see a
+    // single change at the end instead of one per hunk.
+    const auto document = q->document();
+    document->setUndoRedoEnabled(false);
+    auto t = q->textCursor();
+    t.beginEditBlock();
+
+    for (const auto &data : dataList) {
         QString s;
-        if (data->lineCount)
-            s = content.mid(data->lineNumber, data->lineCount).join('\n');
-        if (fill && data->maxLineCount > data->lineCount)
-            s += QString{data->maxLineCount - data->lineCount - (data->lineCount ? 0 : 1), QLatin1Char('\n')};
+        if (data.lineCount)
+            s = lines(data.lineNumber, data.lineCount).join('\n');
+        if (fill && data.maxLineCount > data.lineCount)
+            s += QString{data.maxLineCount - data.lineCount - (data.lineCount ? 0 : 1), QLatin1Char('\n')};
 
-        if (data->lineCount || (fill && data->maxLineCount)) {
+        if (data.lineCount || (fill && data.maxLineCount)) {
             if (Q_UNLIKELY(first)) {
                 first = false;
             } else {
                 t.insertBlock();
             }
-            QTextCursor c(t.block());
-            t.setBlockFormat(d->mFormats.value(data->type));
-            c.insertText(s);
+            t.setBlockFormat(mFormats.value(data.type));
+            t.insertText(s);
         }
     }
+
+    t.endEditBlock();
+    document->setUndoRedoEnabled(true);
+
+    for (const auto &follower : std::as_const(followers)) {
+        if (!follower)
+            continue;
+        follower->d_func()->dataList = dataList;
+        follower->d_func()->fill = fill;
+        follower->d_func()->indexBlocks();
+        follower->updateViewPortGeometry();
+    }
+
+    q->highlightVisibleBlocks();
+}
+
+void CodeEditor::replaceBlockData(int index, const QList<BlockData> &dataList)
+{
+    Q_D(CodeEditor);
+
+    index = qBound(0, index, static_cast<int>(d->dataList.size()));
+    d->dataList.erase(d->dataList.begin() + index, d->dataList.end());
+    d->dataList.append(dataList);
+    d->indexBlocks();
+
+    const auto document = this->document();
+    document->setUndoRedoEnabled(false);
+    QTextCursor t{document};
+    t.beginEditBlock();
+    for (auto i = index; i < d->dataList.size(); ++i) {
+        const auto first = document->findBlockByNumber(d->blockStarts.at(i));
+        const auto last = document->findBlockByNumber(d->blockStarts.at(i + 1) - 1);
+        if (!first.isValid() || !last.isValid())
+            continue;
+        t.setPosition(first.position());
+        t.setPosition(last.position(), QTextCursor::KeepAnchor);
+        t.setBlockFormat(d->mFormats.value(d->dataList.at(i).type));
+    }
+    t.endEditBlock();
+    document->setUndoRedoEnabled(true);
+
+    for (const auto &follower : std::as_const(d->followers)) {
+        if (!follower)
+            continue;
+        follower->d_func()->dataList = d->dataList;
+        follower->d_func()->indexBlocks();
+        follower->updateViewPortGeometry();
+        follower->d_func()->mSideBar->update();
+    }
+
+    updateViewPortGeometry();
+    d->mSideBar->update();
 }
 
 void CodeEditor::appendCode(const QStringList &code, BlockType type, int fillSize)
@@ -854,12 +974,13 @@ void CodeEditor::setFrameText(int index, const QStringList &lines)
     // Move cursor to the start block position
     cursor.setPosition(startBlock.position());
 
-    cursor.movePosition(QTextCursor::StartOfBlock);
-    // Remove `linesCount` blocks starting from the `startBlock`
-    for (int i = 0; i < linesCount - 1; ++i) {
-        cursor.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor);
-    }
-    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    // Remove `linesCount` blocks starting from the `startBlock`, found by number rather
+    // than by moving down a line at a time.
+    const auto endBlock = document()->findBlockByNumber(startBlock.blockNumber() + std::max<int>(1, linesCount) - 1);
+    if (endBlock.isValid())
+        cursor.setPosition(endBlock.position() + endBlock.length() - 1, QTextCursor::KeepAnchor);
+    else
+        cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
 
     cursor.removeSelectedText();
     // cursor.deletePreviousChar(); // This will remove the block itself
@@ -990,18 +1111,15 @@ void CodeEditor::highlightSegment(Diff::Segment *segment)
 int CodeEditor::currentLineNumber() const
 {
     Q_D(const CodeEditor);
-    auto ln = textCursor().block().firstLineNumber() + 1;
+    const auto row = textCursor().block().firstLineNumber();
     if (!d->fill)
-        return ln;
+        return row + 1;
 
-    auto n{0};
-    for (auto &data : std::as_const(d->dataList)) {
-        if (ln <= n + data->maxLineCount) {
-            return std::min(data->lineNumber + data->lineCount, ln);
-        }
-        n += data->maxLineCount;
-    }
-    return 0;
+    const auto index = d->dataIndexOfBlock(row);
+    if (index == -1)
+        return 0;
+    const auto &data = d->dataList.at(index);
+    return std::min(data.lineNumber + data.lineCount, row + 1);
 }
 
 void CodeEditor::clearAll()
@@ -1025,11 +1143,12 @@ CodeEditor::BlockData::BlockData(int lineNumber, Diff::Segment *segment, CodeEdi
 {
 }
 
-CodeEditor::BlockData::BlockData(int lineNumber, int lineCount, int maxLineCount, BlockType type)
+CodeEditor::BlockData::BlockData(int lineNumber, int lineCount, int maxLineCount, BlockType type, int hunk)
     : lineNumber{lineNumber}
     , lineCount{lineCount}
     , maxLineCount{maxLineCount}
     , type{type}
+    , hunk{hunk}
 {
 }
 
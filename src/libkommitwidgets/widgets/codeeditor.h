@@ -20,6 +20,15 @@
 class CodeEditorSidebar;
 
 class CodeEditorPrivate;
+
+/**
+ * A QPlainTextEdit showing code, highlighted only where it is in view, with line numbers,
+ * folding and the blocks of a diff.
+ *
+ * It is not virtualized: setContent() decodes every line it is given and puts it in the
+ * QTextDocument, so a diff of a large file still takes that file in UTF-16 and a block per
+ * line, however little of it is in view.
+ */
 class LIBKOMMITWIDGETS_EXPORT CodeEditor : public QPlainTextEdit
 {
     Q_OBJECT
@@ -39,16 +48,18 @@ public:
         int lineCount;
         int maxLineCount;
 
-        Diff::Segment *segment;
+        Diff::Segment *segment{nullptr};
         BlockType type;
         QString extraText;
-        void *data;
+        void *data{nullptr};
+        /// The index of the hunk this shows in the diff it comes from, or -1.
+        int hunk{-1};
 
         QTextBlock firstBlock;
         QTextBlock endBlock;
 
         BlockData(int lineNumber, Diff::Segment *segment, CodeEditor::BlockType type);
-        BlockData(int lineNumber, int lineCount, int maxLineCount, CodeEditor::BlockType type);
+        BlockData(int lineNumber, int lineCount, int maxLineCount, CodeEditor::BlockType type, int hunk = -1);
     };
 
     explicit CodeEditor(QWidget *parent = nullptr);
@@ -67,7 +78,22 @@ public:
     int append(const QString &code, CodeEditor::BlockType type, BlockData *data);
 
     void appendLines(const QStringList &content, BlockData *data, bool fill);
-    void setContent(const QStringList &content, QList<BlockData *> dataList, bool fill);
+    void setContent(const QStringList &content, const QList<BlockData> &dataList, bool fill);
+    /// Same as above, decoding only the lines that go into blocks.
+    void setContent(const Diff::TextView &content, const QList<BlockData> &dataList, bool fill);
+    /**
+     * Replaces the entries of the list given to setContent() from @p index on with
+     * @p dataList, which covers the same blocks. The text is left as it is and only the
+     * blocks of the new entries are formatted again, for a view whose text is on show before
+     * all of what describes it is known.
+     */
+    void replaceBlockData(int index, const QList<BlockData> &dataList);
+
+    /**
+     * Shows the document of @p editor, and whatever it is filled with later, instead of
+     * a copy of its own, with the same highlighting.
+     */
+    void showDocumentOf(CodeEditor *editor);
 
     void appendCode(const QStringList &code, CodeEditor::BlockType type = Unchanged, int fillSize = -1);
     int addFrame(const QStringList &lines, CodeEditor::BlockType type = Removed);
@@ -97,7 +123,10 @@ public:
     [[nodiscard]] bool showFoldMarks() const;
     void setShowFoldMarks(bool newShowFoldMarks);
 
-    [[nodiscard]] BlockData *currentBlockData() const;
+    /// The entry of the list given to setContent() the cursor is in, valid until the next one.
+    [[nodiscard]] const BlockData *currentBlockData() const;
+    /// The hunk of that entry, or -1.
+    [[nodiscard]] int currentHunk() const;
 
     void setBlocksData(QList<BlockData *> list);
 Q_SIGNALS:
@@ -121,6 +150,7 @@ private:
     LIBKOMMITWIDGETS_NO_EXPORT void updateViewPortGeometry();
     LIBKOMMITWIDGETS_NO_EXPORT void updateSidebarArea(const QRect &rect, int dy);
     LIBKOMMITWIDGETS_NO_EXPORT void highlightCurrentLine();
+    LIBKOMMITWIDGETS_NO_EXPORT void highlightVisibleBlocks();
 
     [[nodiscard]] LIBKOMMITWIDGETS_NO_EXPORT QTextBlock blockAtPosition(int y) const;
     [[nodiscard]] LIBKOMMITWIDGETS_NO_EXPORT bool isFoldable(const QTextBlock &block) const;
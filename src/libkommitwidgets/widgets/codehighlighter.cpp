@@ -0,0 +1,232 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "codehighlighter.h"
+
+#include <KSyntaxHighlighting/Definition>
+#include <KSyntaxHighlighting/Format>
+#include <KSyntaxHighlighting/Theme>
+
+#include <QTextDocument>
+
+namespace
+{
+
+// What highlighting found in a block that is needed again after.
+class HighlightData : public QTextBlockUserData
+{
+public:
+    // The generation it was found in; it is stale in any other.
+    int generation{-1};
+    QList<int> openedRegions;
+};
+
+}
+
+CodeHighlighter *CodeHighlighter::forDocument(QTextDocument *document)
+{
+    auto highlighter = document->findChild<CodeHighlighter *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!highlighter)
+        highlighter = new CodeHighlighter{document};
+    return highlighter;
+}
+
+CodeHighlighter::CodeHighlighter(QTextDocument *document)
+    : QObject{document}
+    , mCheckpoints{KSyntaxHighlighting::State{}}
+{
+    connect(document, &QTextDocument::contentsChange, this, [this](int position, int, int) {
+        contentsChanged(position);
+    });
+}
+
+QTextDocument *CodeHighlighter::document() const
+{
+    return static_cast<QTextDocument *>(parent());
+}
+
+void CodeHighlighter::setDefinition(const KSyntaxHighlighting::Definition &definition)
+{
+    if (definition == this->definition())
+        return;
+    AbstractHighlighter::setDefinition(definition);
+    invalidate();
+}
+
+void CodeHighlighter::setTheme(const KSyntaxHighlighting::Theme &theme)
+{
+    AbstractHighlighter::setTheme(theme);
+    invalidate();
+}
+
+void CodeHighlighter::invalidate()
+{
+    // Blocks keep what they had until they are next on show; nothing else is touched.
+    mCheckpoints = {KSyntaxHighlighting::State{}};
+    ++mGeneration;
+}
+
+void CodeHighlighter::contentsChanged(int position)
+{
+    if (mApplying)
+        return;
+
+    // A line can change the state it leaves behind, so everything after it may be stale;
+    // the checkpoints up to it are not.
+    const auto blockNumber = document()->findBlock(position).blockNumber();
+    mCheckpoints.resize(std::max(1, blockNumber / CheckpointInterval + 1));
+    ++mGeneration;
+}
+
+KSyntaxHighlighting::State CodeHighlighter::highlightBlock(const QTextBlock &block, const KSyntaxHighlighting::State &state, bool collect)
+{
+    mFormats.clear();
+    mRegions.clear();
+    mCollecting = collect;
+    const auto next = highlightLine(block.text(), state);
+    mCollecting = false;
+
+    // Keep the state after this block when the next one is due a checkpoint.
+    const auto nextNumber = block.blockNumber() + 1;
+    if (nextNumber % CheckpointInterval == 0 && nextNumber / CheckpointInterval == mCheckpoints.size())
+        mCheckpoints.append(next);
+
+    return next;
+}
+
+KSyntaxHighlighting::State CodeHighlighter::stateBefore(const QTextBlock &block)
+{
+    const auto blockNumber = block.blockNumber();
+    const auto index = std::min<qsizetype>(blockNumber / CheckpointInterval, mCheckpoints.size() - 1);
+
+    auto state = mCheckpoints.at(index);
+    for (auto b = document()->findBlockByNumber(index * CheckpointInterval); b.isValid() && b != block; b = b.next())
+        state = highlightBlock(b, state, false);
+    return state;
+}
+
+void CodeHighlighter::highlight(const QTextBlock &first, const QTextBlock &last)
+{
+    if (!definition().isValid())
+        return;
+
+    auto block = first;
+    while (block.isValid() && block.userState() == mGeneration && block != last)
+        block = block.next();
+    if (!block.isValid() || block.userState() == mGeneration)
+        return;
+
+    auto state = stateBefore(block);
+    const auto from = block.position();
+    auto end = block;
+
+    mApplying = true;
+    for (; block.isValid(); block = block.next()) {
+        state = highlightBlock(block, state, true);
+        block.layout()->setFormats(mFormats);
+        block.setUserState(mGeneration);
+        keepOpenedRegions(block);
+        end = block;
+        if (block == last)
+            break;
+    }
+    document()->markContentsDirty(from, end.position() + end.length() - from);
+    mApplying = false;
+}
+
+void CodeHighlighter::applyFormat(int offset, int length, const KSyntaxHighlighting::Format &format)
+{
+    if (!mCollecting || !length || format.isDefaultTextStyle(theme()))
+        return;
+
+    QTextCharFormat textFormat;
+    if (format.hasTextColor(theme()))
+        textFormat.setForeground(format.textColor(theme()));
+    if (format.hasBackgroundColor(theme()))
+        textFormat.setBackground(format.backgroundColor(theme()));
+    if (format.isBold(theme()))
+        textFormat.setFontWeight(QFont::Bold);
+    if (format.isItalic(theme()))
+        textFormat.setFontItalic(true);
+    if (format.isUnderline(theme()))
+        textFormat.setFontUnderline(true);
+    if (format.isStrikeThrough(theme()))
+        textFormat.setFontStrikeOut(true);
+
+    mFormats.append(QTextLayout::FormatRange{offset, length, textFormat});
+}
+
+void CodeHighlighter::applyFolding(int offset, int length, KSyntaxHighlighting::FoldingRegion region)
+{
+    Q_UNUSED(offset)
+    Q_UNUSED(length)
+
+    if (mCollecting)
+        mRegions.append(region);
+}
+
+QList<int> CodeHighlighter::openedRegions(const QTextBlock &block)
+{
+    if (!definition().isValid() || !block.isValid())
+        return {};
+
+    const auto data = static_cast<HighlightData *>(block.userData());
+    if (data && data->generation == mGeneration)
+        return data->openedRegions;
+
+    // Not on show yet, or not since the last change.
+    highlightBlock(block, stateBefore(block), true);
+    return keepOpenedRegions(block);
+}
+
+QList<int> CodeHighlighter::keepOpenedRegions(QTextBlock block)
+{
+    QList<int> opened;
+    for (const auto &region : std::as_const(mRegions)) {
+        if (region.type() == KSyntaxHighlighting::FoldingRegion::Begin)
+            opened.append(region.id());
+        else if (region.type() == KSyntaxHighlighting::FoldingRegion::End && opened.contains(region.id()))
+            opened.removeAt(opened.lastIndexOf(region.id()));
+    }
+
+    auto data = static_cast<HighlightData *>(block.userData());
+    if (!data) {
+        data = new HighlightData;
+        block.setUserData(data);
+    }
+    data->generation = mGeneration;
+    data->openedRegions = opened;
+    return opened;
+}
+
+bool CodeHighlighter::startsFoldingRegion(const QTextBlock &block)
+{
+    return !openedRegions(block).isEmpty();
+}
+
+QTextBlock CodeHighlighter::findFoldingRegionEnd(const QTextBlock &startBlock)
+{
+    const auto opened = openedRegions(startBlock);
+    if (opened.isEmpty())
+        return {};
+
+    const auto id = opened.first();
+    auto depth = static_cast<int>(opened.count(id));
+    auto state = stateBefore(startBlock.next());
+    for (auto block = startBlock.next(); block.isValid(); block = block.next()) {
+        state = highlightBlock(block, state, true);
+        for (const auto &region : std::as_const(mRegions)) {
+            if (region.id() != id)
+                continue;
+            depth += region.type() == KSyntaxHighlighting::FoldingRegion::Begin ? 1 : -1;
+            if (!depth)
+                return block;
+        }
+    }
+    return {};
+}
+
+#include "moc_codehighlighter.cpp"
@@ -0,0 +1,82 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <KSyntaxHighlighting/AbstractHighlighter>
+#include <KSyntaxHighlighting/FoldingRegion>
+#include <KSyntaxHighlighting/State>
+
+#include <QList>
+#include <QObject>
+#include <QTextBlock>
+#include <QTextLayout>
+
+class QTextDocument;
+
+/**
+ * Syntax highlighting of a document done only for the blocks on show, as they come into
+ * view.
+ *
+ * Highlighting a line needs the state the lines before it leave behind, so the state is
+ * kept every CheckpointInterval blocks as the document is gone through. Getting to a block
+ * starts from the checkpoint before it instead of from the top, and a document that is
+ * never scrolled to its end is never highlighted to its end. A change to the document only
+ * drops the checkpoints after it.
+ *
+ * The folding regions a block opens are kept on it as it is highlighted, so painting the
+ * fold markers of the lines on show reads them back instead of highlighting again.
+ *
+ * There is one per document, shared by every editor that shows it; see forDocument().
+ */
+class CodeHighlighter : public QObject, public KSyntaxHighlighting::AbstractHighlighter
+{
+    Q_OBJECT
+
+public:
+    static constexpr int CheckpointInterval{128};
+
+    /// The highlighter of @p document, made the first time it is asked for.
+    static CodeHighlighter *forDocument(QTextDocument *document);
+
+    void setDefinition(const KSyntaxHighlighting::Definition &definition) override;
+    void setTheme(const KSyntaxHighlighting::Theme &theme) override;
+
+    /// Highlights the blocks from @p first to @p last that are not yet, or not any more.
+    void highlight(const QTextBlock &first, const QTextBlock &last);
+
+    [[nodiscard]] bool startsFoldingRegion(const QTextBlock &block);
+    /// The block that closes the region @p block starts, or an invalid one.
+    [[nodiscard]] QTextBlock findFoldingRegionEnd(const QTextBlock &block);
+
+protected:
+    void applyFormat(int offset, int length, const KSyntaxHighlighting::Format &format) override;
+    void applyFolding(int offset, int length, KSyntaxHighlighting::FoldingRegion region) override;
+
+private:
+    explicit CodeHighlighter(QTextDocument *document);
+
+    [[nodiscard]] QTextDocument *document() const;
+    [[nodiscard]] KSyntaxHighlighting::State stateBefore(const QTextBlock &block);
+    KSyntaxHighlighting::State highlightBlock(const QTextBlock &block, const KSyntaxHighlighting::State &state, bool collect);
+    [[nodiscard]] QList<int> openedRegions(const QTextBlock &block);
+    // The regions the last line highlighted opens and leaves open, kept on @p block.
+    QList<int> keepOpenedRegions(QTextBlock block);
+    void contentsChanged(int position);
+    void invalidate();
+
+    // The state before block i * CheckpointInterval at i.
+    QList<KSyntaxHighlighting::State> mCheckpoints;
+    // A block is highlighted when its user state is the current generation, which moves on
+    // with every change that can make highlighting stale.
+    int mGeneration{0};
+    bool mApplying{false};
+
+    // What highlighting the current line gives, while it is being collected.
+    bool mCollecting{false};
+    QList<QTextLayout::FormatRange> mFormats;
+    QList<KSyntaxHighlighting::FoldingRegion> mRegions;
+};
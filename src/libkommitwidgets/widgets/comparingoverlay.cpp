@@ -0,0 +1,53 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "comparingoverlay.h"
+
+#include <KLocalizedString>
+
+ComparingOverlay::ComparingOverlay(QWidget *parent)
+    : QLabel{parent}
+{
+    setAlignment(Qt::AlignCenter);
+    setAutoFillBackground(true);
+    setFrameShape(QFrame::StyledPanel);
+    setMargin(12);
+    hide();
+
+    mTimer.setInterval(150);
+    connect(&mTimer, &QTimer::timeout, this, &ComparingOverlay::refresh);
+}
+
+void ComparingOverlay::start(std::shared_ptr<Diff::DiffControl> control)
+{
+    mControl = std::move(control);
+    hide();
+    mTimer.start();
+}
+
+void ComparingOverlay::stop()
+{
+    mTimer.stop();
+    mControl.reset();
+    hide();
+}
+
+void ComparingOverlay::refresh()
+{
+    if (!mControl)
+        return;
+
+    const auto percent = mControl->progress.load(std::memory_order_relaxed) / 10;
+    setText(i18nc("@info:status", "Comparing… %1%", percent));
+    adjustSize();
+    move((parentWidget()->width() - width()) / 2, (parentWidget()->height() - height()) / 2);
+    show();
+    raise();
+
+    Q_EMIT progress(percent);
+}
+
+#include "moc_comparingoverlay.cpp"
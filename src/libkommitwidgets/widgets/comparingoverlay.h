@@ -0,0 +1,44 @@
+/*
+SPDX-FileCopyrightText: 2026 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <types.h>
+
+#include <QLabel>
+#include <QTimer>
+
+#include <memory>
+
+/**
+ * The "Comparing…" placeholder shown over a diff or merge view while its comparison runs on
+ * a worker thread, with the progress the worker reports to its Diff::DiffControl.
+ *
+ * It only shows up once a comparison has taken longer than a moment, so small files do not
+ * flicker.
+ */
+class ComparingOverlay : public QLabel
+{
+    Q_OBJECT
+
+public:
+    explicit ComparingOverlay(QWidget *parent);
+
+    /// Starts following @p control, the one of the comparison that has just started.
+    void start(std::shared_ptr<Diff::DiffControl> control);
+    /// Hides the placeholder and lets go of the control.
+    void stop();
+
+Q_SIGNALS:
+    /// How far the comparison has got, from 0 to 100.
+    void progress(int percent);
+
+private:
+    void refresh();
+
+    std::shared_ptr<Diff::DiffControl> mControl;
+    QTimer mTimer;
+};
@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "models/difftreemodel.h"
 #include "models/filesmodel.h"
 
+#include <QHeaderView>
 #include <QKeyEvent>
 #include <QSortFilterProxyModel>
 
@@ -25,6 +26,9 @@ void DiffTreeView::setModels(DiffTreeModel *newDiffModel, FilesModel *filesModel
     listView->setModel(mFilterModel);
 
     treeView->setModel(mDiffModel);
+    treeView->header()->setStretchLastSection(false);
+    treeView->header()->setSectionResizeMode(DiffTreeModel::NameColumn, QHeaderView::Stretch);
+    treeView->header()->setSectionResizeMode(DiffTreeModel::StatsColumn, QHeaderView::ResizeToContents);
 }
 
 DiffTreeView::DiffTreeView(QWidget *parent)
@@ -53,8 +57,10 @@ void DiffTreeView::lineEditFilterTextChanged(const QString &text)
     mFilterModel->setFilterRegularExpression(QStringLiteral(".*") + text + QStringLiteral(".*"));
 }
 
-void DiffTreeView::slotTreeViewClicked(const QModelIndex &index)
+void DiffTreeView::slotTreeViewClicked(const QModelIndex &clicked)
 {
+    // Only the first column has children.
+    const auto index = clicked.siblingAtColumn(DiffTreeModel::NameColumn);
     if (!mDiffModel->rowCount(index)) {
         const auto fileName = mDiffModel->fullPath(index);
         Q_EMIT fileSelected(fileName);
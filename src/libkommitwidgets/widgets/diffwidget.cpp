@@ -6,12 +6,14 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "diffwidget.h"
 #include "codeeditor.h"
+#include "comparingoverlay.h"
 #include <diff.h>
 
 #include <QFile>
 #include <QFileInfo>
 #include <QScrollBar>
 #include <QTextBlock>
+#include <QtConcurrentRun>
 
 class DiffWidgetPrivate
 {
@@ -29,30 +31,52 @@ public:
     CodeEditor *mPreviewEditorRight = nullptr;
     bool mSameSize{false};
 
-    Diff::Diff2TextResult lastDiff;
     // QString leftContentWithSpaces;
     // QString rightContentWithSpaces;
 
-    QList<CodeEditor::BlockData *> leftBlockDataList;
-    QList<CodeEditor::BlockData *> rightBlockDataList;
+    QList<CodeEditor::BlockData> leftBlockDataList;
+    QList<CodeEditor::BlockData> rightBlockDataList;
 
-    QString mOldContent;
-    QString mNewContent;
+    // Views of the files, borrowed from blobs where possible rather than decoded into strings.
+    Diff::TextView mOldText;
+    Diff::TextView mNewText;
     QString mOldFileName;
     QString mNewFileName;
     QTextOption mDefaultOption;
-    QList<Diff::DiffHunk *> mSegments;
+    // The diff on show, possibly shared with a cache.
+    std::shared_ptr<const Diff::Diff2TextViewResult> mDiff;
+
+    Diff::DiffOptions<QString> mOptions;
+    // The control of the comparison running, if any. Every run has one of its own, so a
+    // result that comes in after its run was canceled or replaced is told apart and dropped.
+    std::shared_ptr<Diff::DiffControl> mControl;
+    ComparingOverlay *mComparingOverlay{nullptr};
 
     void init();
+    void cancel();
     void recalculateInfoPaneSize();
     void createPreviewWidget();
-    void setEditorsContents(QList<Diff::DiffHunk *> segments);
+    void setEditorsContents(const QList<Diff::DiffHunk> &segments);
+
+    [[nodiscard]] QList<Diff::DiffHunk> segments() const
+    {
+        return mDiff ? mDiff->hunks : QList<Diff::DiffHunk>{};
+    }
 };
 
 DiffWidgetPrivate::DiffWidgetPrivate(DiffWidget *parent)
     : q_ptr{parent}
 {
 }
+
+void DiffWidgetPrivate::cancel()
+{
+    if (mControl) {
+        mControl->canceled = true;
+        mControl.reset();
+    }
+    mComparingOverlay->stop();
+}
 DiffWidget::DiffWidget(QWidget *parent)
     : QWidget{parent}
     , d_ptr{new DiffWidgetPrivate{this}}
@@ -76,6 +100,8 @@ DiffWidget::~DiffWidget()
 {
     Q_D(DiffWidget);
 
+    d->cancel();
+
     leftCodeEditor->clearAll();
     rightCodeEditor->clearAll();
 
@@ -92,7 +118,7 @@ void DiffWidget::setOldFileText(const QString &newOldFile)
 
 void DiffWidget::setOldFile(QSharedPointer<Git::Blob> newOldFile)
 {
-    setOldFile(newOldFile->name(), newOldFile->content());
+    setOldFile(newOldFile->name(), Diff::TextView::borrow(newOldFile->rawContent(), std::make_shared<Git::Blob>(*newOldFile)));
 }
 
 void DiffWidget::setNewFileText(const QString &newNewFile)
@@ -102,7 +128,7 @@ void DiffWidget::setNewFileText(const QString &newNewFile)
 
 void DiffWidget::setNewFile(QSharedPointer<Git::Blob> newNewFile)
 {
-    setNewFile(newNewFile->name(), newNewFile->content());
+    setNewFile(newNewFile->name(), Diff::TextView::borrow(newNewFile->rawContent(), std::make_shared<Git::Blob>(*newNewFile)));
 }
 
 void DiffWidget::setOldFile(QSharedPointer<Git::File> newOldFile)
@@ -125,12 +151,7 @@ void DiffWidget::setOldFile(const QString &filePath)
         return;
 
     d->mOldFileName = fi.fileName();
-    QFile f{filePath};
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
-        return;
-
-    d->mOldContent = f.readAll();
-    f.close();
+    d->mOldText = Diff::TextView::readFile(filePath);
 }
 
 void DiffWidget::setNewFile(const QString &filePath)
@@ -143,15 +164,15 @@ void DiffWidget::setNewFile(const QString &filePath)
         return;
 
     d->mNewFileName = fi.fileName();
-    QFile f{filePath};
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
-        return;
-
-    d->mNewContent = f.readAll();
-    f.close();
+    d->mNewText = Diff::TextView::readFile(filePath);
 }
 
 void DiffWidget::setOldFile(const QString &title, const QString &content)
+{
+    setOldFile(title, Diff::TextView{content});
+}
+
+void DiffWidget::setOldFile(const QString &title, const Diff::TextView &text)
 {
     Q_D(DiffWidget);
 
@@ -161,11 +182,16 @@ void DiffWidget::setOldFile(const QString &title, const QString &content)
     leftCodeEditor->setHighlighting(title);
     d->mPreviewEditorLeft->setHighlighting(title);
 
-    d->mOldContent = content;
+    d->mOldText = text;
     d->mOldFileName = title;
 }
 
 void DiffWidget::setNewFile(const QString &title, const QString &content)
+{
+    setNewFile(title, Diff::TextView{content});
+}
+
+void DiffWidget::setNewFile(const QString &title, const Diff::TextView &text)
 {
     Q_D(DiffWidget);
 
@@ -175,7 +201,7 @@ void DiffWidget::setNewFile(const QString &title, const QString &content)
     rightCodeEditor->setHighlighting(title);
     d->mPreviewEditorRight->setHighlighting(title);
 
-    d->mNewContent = content;
+    d->mNewText = text;
     d->mNewFileName = title;
 }
 
@@ -183,22 +209,77 @@ void DiffWidget::compare()
 {
     Q_D(DiffWidget);
 
-    d->lastDiff = Diff::diff2(d->mOldContent, d->mNewContent);
-    const auto segments = d->lastDiff.hunks();
+    d->cancel();
+
+    auto control = std::make_shared<Diff::DiffControl>();
+    auto options = d->mOptions;
+    options.control = control.get();
+    d->mControl = control;
+    d->mComparingOverlay->start(control);
+
+    // The views share what they read from, and the worker holds on to them, so the files
+    // can be replaced while it runs.
+    QtConcurrent::run([left = d->mOldText, right = d->mNewText, options, control] {
+        return std::make_shared<const Diff::Diff2TextViewResult>(left, right, Diff::diff2(left, right, options));
+    }).then(this, [this, control](std::shared_ptr<const Diff::Diff2TextViewResult> diff) {
+        Q_D(DiffWidget);
+        if (d->mControl != control)
+            return;
+
+        setDiff(diff);
+        Q_EMIT compared(diff);
+    });
+}
+
+void DiffWidget::cancel()
+{
+    Q_D(DiffWidget);
+    d->cancel();
+}
+
+bool DiffWidget::isComparing() const
+{
+    Q_D(const DiffWidget);
+    return d->mControl != nullptr;
+}
+
+const Diff::DiffOptions<QString> &DiffWidget::options() const
+{
+    Q_D(const DiffWidget);
+    return d->mOptions;
+}
+
+void DiffWidget::setOptions(const Diff::DiffOptions<QString> &options)
+{
+    Q_D(DiffWidget);
+    d->mOptions = options;
+    d->mOptions.control = nullptr;
+}
+
+void DiffWidget::setDiff(std::shared_ptr<const Diff::Diff2TextViewResult> diff)
+{
+    Q_D(DiffWidget);
+
+    d->cancel();
+
+    d->mOldText = diff->left;
+    d->mNewText = diff->right;
+    const auto &segments = diff->hunks;
 
     // QString tmpLeftContentWithSpaces;
     // QString tmpRightContentWithSpaces;
 
-    QList<CodeEditor::BlockData *> tmpLeftBlockDataList;
-    QList<CodeEditor::BlockData *> tmpRightBlockDataList;
+    QList<CodeEditor::BlockData> tmpLeftBlockDataList;
+    QList<CodeEditor::BlockData> tmpRightBlockDataList;
 
     tmpLeftBlockDataList.reserve(segments.size());
     tmpRightBlockDataList.reserve(segments.size());
 
-    for (auto &segment : segments) {
+    for (int i = 0; i < segments.size(); ++i) {
+        const auto &segment = segments.at(i);
         CodeEditor::BlockType leftBlockType{CodeEditor::BlockType::Unchanged};
         CodeEditor::BlockType rightBlockType{CodeEditor::BlockType::Unchanged};
-        switch (segment->type) {
+        switch (segment.type) {
         case Diff::SegmentType::SameOnBoth:
             // tmpLeftContentWithSpaces += segment->oldText.join('\n');
             // tmpRightContentWithSpaces += segment->newText.join('\n');
@@ -232,11 +313,11 @@ void DiffWidget::compare()
             break;
         }
 
-        Q_ASSERT(segment->left.size >= 0);
-        Q_ASSERT(segment->right.size >= 0);
-        auto m = qMax(segment->left.size, segment->right.size);
-        tmpLeftBlockDataList.append(new CodeEditor::BlockData{segment->left.begin, segment->left.size, m, leftBlockType});
-        tmpRightBlockDataList.append(new CodeEditor::BlockData{segment->right.begin, segment->right.size, m, rightBlockType});
+        Q_ASSERT(segment.left.size >= 0);
+        Q_ASSERT(segment.right.size >= 0);
+        auto m = qMax(segment.left.size, segment.right.size);
+        tmpLeftBlockDataList.emplace_back(segment.left.begin, segment.left.size, m, leftBlockType, i);
+        tmpRightBlockDataList.emplace_back(segment.right.begin, segment.right.size, m, rightBlockType, i);
 
         // if (!tmpLeftContentWithSpaces.endsWith('\n'))
         //     tmpLeftContentWithSpaces == '\n';
@@ -251,9 +332,7 @@ void DiffWidget::compare()
     // d->rightContentWithSpaces = tmpRightContentWithSpaces;
 
     d->setEditorsContents(segments);
-
-    // qDeleteAll(d->mSegments);
-    d->mSegments = segments;
+    d->mDiff = std::move(diff);
 }
 
 void DiffWidget::showHiddenChars(bool show)
@@ -287,7 +366,7 @@ void DiffWidget::showSameSize(bool show)
     d->mSameSize = show;
     segmentConnector->setSameSize(show);
     // compare();
-    d->setEditorsContents(d->mSegments);
+    d->setEditorsContents(d->segments());
 }
 
 void DiffWidget::slotSegmentsScrollbarHover(int y, double pos)
@@ -403,7 +482,7 @@ void DiffWidget::setSameSize(bool newSameSize)
     if (d->mSameSize == newSameSize)
         return;
     d->mSameSize = newSameSize;
-    d->setEditorsContents(d->mSegments);
+    d->setEditorsContents(d->segments());
     Q_EMIT sameSizeChanged();
 }
 
@@ -421,6 +500,10 @@ void DiffWidgetPrivate::init()
     Q_Q(DiffWidget);
 
     createPreviewWidget();
+
+    mComparingOverlay = new ComparingOverlay(q);
+    QObject::connect(mComparingOverlay, &ComparingOverlay::progress, q, &DiffWidget::progress);
+
     q->segmentConnector->setMinimumWidth(80);
     q->segmentConnector->setMaximumWidth(80);
     q->segmentConnector->setLeft(q->leftCodeEditor);
@@ -465,6 +548,9 @@ void DiffWidgetPrivate::createPreviewWidget()
     mPreviewEditorRight->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     layout->addWidget(mPreviewEditorRight);
 
+    mPreviewEditorLeft->showDocumentOf(q->leftCodeEditor);
+    mPreviewEditorRight->showDocumentOf(q->rightCodeEditor);
+
     layout->setContentsMargins({});
     layout->setSpacing(q->segmentConnector->width() + 2 * (q->splitter->handleWidth()));
 
@@ -473,7 +559,7 @@ void DiffWidgetPrivate::createPreviewWidget()
     mPreviewWidget->hide();
 }
 
-void DiffWidgetPrivate::setEditorsContents(QList<Diff::DiffHunk *> segments)
+void DiffWidgetPrivate::setEditorsContents(const QList<Diff::DiffHunk> &segments)
 {
     Q_Q(DiffWidget);
 
@@ -486,11 +572,9 @@ void DiffWidgetPrivate::setEditorsContents(QList<Diff::DiffHunk *> segments)
     q->segmentConnector->setSegments(segments);
     q->segmentConnector->update();
 
-    q->leftCodeEditor->setContent(lastDiff.left().lines, leftBlockDataList, mSameSize);
-    q->rightCodeEditor->setContent(lastDiff.right().lines, rightBlockDataList, mSameSize);
-
-    mPreviewEditorLeft->setContent(lastDiff.left().lines, leftBlockDataList, mSameSize);
-    mPreviewEditorRight->setContent(lastDiff.right().lines, rightBlockDataList, mSameSize);
+    // The preview editors show the same documents, so this fills them too.
+    q->leftCodeEditor->setContent(mOldText, leftBlockDataList, mSameSize);
+    q->rightCodeEditor->setContent(mNewText, rightBlockDataList, mSameSize);
 
     q->scrollToTop();
 }
@@ -11,12 +11,22 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <entities/blob.h>
 #include <entities/file.h>
 
+#include <text.h>
+#include <types.h>
+
 #include "libkommitwidgets_export.h"
 
 #include <QScopedPointer>
 #include <QTextOption>
 #include <QWidget>
 
+#include <memory>
+
+namespace Diff
+{
+struct Diff2TextViewResult;
+}
+
 class DiffWidgetPrivate;
 class CodeEditor;
 class LIBKOMMITWIDGETS_EXPORT DiffWidget : public QWidget, private Ui::DiffWIdget
@@ -42,7 +52,28 @@ public:
     void setOldFile(const QString &title, const QString &content);
     void setNewFile(const QString &title, const QString &content);
 
+    void setOldFile(const QString &title, const Diff::TextView &text);
+    void setNewFile(const QString &title, const Diff::TextView &text);
+
+    /**
+     * Compares the files on a worker thread. A placeholder shows over the editors until the
+     * diff is ready, and compared() is emitted once it is on show. A comparison still
+     * running is canceled first, rather than left to finish.
+     */
     void compare();
+    /// Cancels the comparison running, if any, keeping what is on show.
+    void cancel();
+    [[nodiscard]] bool isComparing() const;
+
+    [[nodiscard]] const Diff::DiffOptions<QString> &options() const;
+    /// Sets how lines are compared from the next compare() on.
+    void setOptions(const Diff::DiffOptions<QString> &options);
+
+    /**
+     * Shows @p diff, computed elsewhere, in place of comparing the files again; the views
+     * it holds replace the ones set before. A comparison still running is canceled.
+     */
+    void setDiff(std::shared_ptr<const Diff::Diff2TextViewResult> diff);
 
     CodeEditor *oldCodeEditor() const;
     CodeEditor *newCodeEditor() const;
@@ -62,6 +93,9 @@ public Q_SLOTS:
 
 Q_SIGNALS:
     void sameSizeChanged();
+    /// How far the comparison running has got, from 0 to 100.
+    void progress(int percent);
+    void compared(std::shared_ptr<const Diff::Diff2TextViewResult> diff);
 
 private Q_SLOTS:
     LIBKOMMITWIDGETS_NO_EXPORT void slotSegmentsScrollbarHover(int y, double pos);
@@ -32,7 +32,8 @@ public:
     QVector<QColor> colors;
 
     int colX(int col) const;
-    void paintLane(QPainter *painter, const GraphLane &lane, int index) const;
+    void setColumnColor(QPainter *painter, int column) const;
+    void paintLane(QPainter *painter, GraphLane::Type type, int index) const;
     void drawReference(QPainter *painter, const Git::Reference &reference, int &x) const;
     QPoint center(int x) const;
     QPoint centerEdge(int x, Qt::Edge edge) const;
@@ -57,8 +58,8 @@ GraphPainter::~GraphPainter()
 void GraphPainter::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
     Q_D(const GraphPainter);
-    auto lanes = d->model->lanesFromIndex(index);
-    auto log = d->model->fromIndex(index);
+    const auto row = d->model->lanesFromIndex(index);
+    const auto log = d->model->fromIndex(index);
 
     painter->setRenderHints(QPainter::Antialiasing);
 
@@ -76,34 +77,35 @@ void GraphPainter::paint(QPainter *painter, const QStyleOptionViewItem &option,
     painter->setClipRect(option.rect, Qt::IntersectClip);
     painter->translate(option.rect.topLeft());
 
-    int x{-1};
-    for (auto &l : lanes) {
-        ++x;
-        if (l.type() == GraphLane::None)
+    for (int x = 0; x < row.laneCount; ++x) {
+        const auto type = row.lanes[x].type();
+        if (type == GraphLane::None)
             continue;
 
-        if (x >= d->colors.size()) {
-            painter->setPen(Qt::black);
-            painter->setBrush(Qt::black);
-        } else {
-            painter->setPen(d->colors.at(x));
-            painter->setBrush(d->colors.at(x));
-        }
-        //        painter->setPen(l.color());
-        //        painter->setBrush(l.color());
-        d->paintLane(painter, l, x);
+        d->setColumnColor(painter, x);
+        d->paintLane(painter, type, x);
+    }
+    for (int i = 0; i < row.joinCount; ++i) {
+        const auto &join = row.joins[i];
+
+        d->setColumnColor(painter, join.column);
+        if (join.direction == GraphJoin::Up)
+            d->paintPathToTop(painter, join.from, join.column);
+        else
+            d->paintPathToDown(painter, join.from, join.column);
     }
 
-    QRect rc(lanes.size() * WIDTH, 0, painter->fontMetrics().horizontalAdvance(log.summary()), HEIGHT);
+    const auto summary = log.summary();
+    QRect rc(row.laneCount * WIDTH, 0, painter->fontMetrics().horizontalAdvance(summary), HEIGHT);
 
     painter->setPen(option.palette.color(QPalette::Text));
-    auto refs = log.references();
-    int refBoxX = lanes.size() * WIDTH;
+    const auto &refs = log.references();
+    int refBoxX = row.laneCount * WIDTH;
     for (auto const &ref : refs) {
         d->drawReference(painter, ref, refBoxX);
     }
     rc.moveLeft(refBoxX + 6);
-    painter->drawText(rc, Qt::AlignVCenter, log.summary());
+    painter->drawText(rc, Qt::AlignVCenter, summary);
 
     painter->restore();
 }
@@ -149,9 +151,20 @@ int GraphPainterPrivate::colX(int col) const
     return col * WIDTH;
 }
 
-void GraphPainterPrivate::paintLane(QPainter *painter, const GraphLane &lane, int index) const
+void GraphPainterPrivate::setColumnColor(QPainter *painter, int column) const
+{
+    if (column >= colors.size()) {
+        painter->setPen(Qt::black);
+        painter->setBrush(Qt::black);
+    } else {
+        painter->setPen(colors.at(column));
+        painter->setBrush(colors.at(column));
+    }
+}
+
+void GraphPainterPrivate::paintLane(QPainter *painter, GraphLane::Type type, int index) const
 {
-    switch (lane.type()) {
+    switch (type) {
     case GraphLane::Start:
         painter->drawLine(point(index), point(index, Qt::AlignTop));
         painter->setBrush(Qt::white);
@@ -170,6 +183,10 @@ void GraphPainterPrivate::paintLane(QPainter *painter, const GraphLane &lane, in
         painter->setBrush(Qt::white);
         painter->drawEllipse(point(index), Sizes::dotSize, Sizes::dotSize);
         break;
+    case GraphLane::Dot:
+        painter->setBrush(Qt::white);
+        painter->drawEllipse(point(index), Sizes::dotSize, Sizes::dotSize);
+        break;
     case GraphLane::Test:
         painter->drawLine(point(index, Qt::AlignTop | Qt::AlignLeft), point(index, Qt::AlignBottom | Qt::AlignRight));
         painter->drawLine(point(index, Qt::AlignTop | Qt::AlignRight), point(index, Qt::AlignBottom | Qt::AlignLeft));
@@ -179,14 +196,6 @@ void GraphPainterPrivate::paintLane(QPainter *painter, const GraphLane &lane, in
     case GraphLane::Transparent:
         break; // just to avoid compiler warning
     }
-
-    for (const auto &i : lane.upJoins()) {
-        paintPathToTop(painter, i, index);
-    }
-    for (const auto &i : lane.bottomJoins()) {
-        // painter->drawEllipse(point(i), 2, 2);
-        paintPathToDown(painter, i, index);
-    }
 }
 
 QPoint GraphPainterPrivate::center(int x) const
@@ -5,10 +5,13 @@ SPDX-License-Identifier: GPL-3.0-or-later
 */
 
 #include "mergewidget.h"
+#include "comparingoverlay.h"
+#include "diff3.h"
 #include "results.h"
 
 #include <QAction>
 #include <QScrollBar>
+#include <QtConcurrentRun>
 
 class MergeWidgetPrivate
 {
@@ -39,21 +42,33 @@ public:
     QString resultTitle;
 
     Diff::MergeResult<Diff::Text> lastMergeResult;
-    QList<Diff::MergeSegment2 *>::iterator currentSegment;
+    // The index of the segment selected in lastMergeResult, or -1.
+    int currentSegment{-1};
 
-    QList<CodeEditor::BlockData *> baseBlockDataList;
-    QList<CodeEditor::BlockData *> localBlockDataList;
-    QList<CodeEditor::BlockData *> remoteBlockDataList;
-    QList<CodeEditor::BlockData *> resultBlockDataList;
+    QList<CodeEditor::BlockData> baseBlockDataList;
+    QList<CodeEditor::BlockData> localBlockDataList;
+    QList<CodeEditor::BlockData> remoteBlockDataList;
+    QList<CodeEditor::BlockData> resultBlockDataList;
 
     bool isModified;
 
-    QMap<Diff::MergeSegment2 *, int> conflictIndexes;
-    QList<Diff::MergeSegment2 *> conflictSegments;
-
-    void resolveConflict(Diff::MergeSegment2 *segment);
-    void setEditorContents(QList<Diff::MergeSegment2 *> segments);
-    void setCurrentSegment(QList<Diff::MergeSegment2 *>::iterator currentSegment);
+    // The frame in the result editor of every conflicting segment, by segment index.
+    QMap<int, int> conflictIndexes;
+    // The conflicting segments left to resolve, by index.
+    QList<int> conflictSegments;
+
+    Diff::DiffOptions<QString> options;
+    // The control of the merge running, if any; see DiffWidgetPrivate::mControl.
+    std::shared_ptr<Diff::DiffControl> control;
+    ComparingOverlay *comparingOverlay;
+
+    void cancel();
+    void setMergeResult(Diff::MergeResult<Diff::Text> result);
+    void resolveConflict(int index);
+    void setEditorContents();
+    void setCurrentSegment(int index);
+    void keepCurrentSegment(Diff::MergeSide first, Diff::MergeSide second);
+    void gotoConflict(int step);
 };
 MergeWidgetPrivate::MergeWidgetPrivate(MergeWidget *parent)
     : q_ptr{parent}
@@ -65,7 +80,9 @@ MergeWidgetPrivate::MergeWidgetPrivate(MergeWidget *parent)
     , keepTheirFileAction{new QAction{parent}}
     , gotoPrevDiffAction{new QAction{parent}}
     , gotoNextDiffAction{new QAction{parent}}
+    , comparingOverlay{new ComparingOverlay{parent}}
 {
+    QObject::connect(comparingOverlay, &ComparingOverlay::progress, parent, &MergeWidget::progress);
     QObject::connect(keepMineAction, &QAction::triggered, parent, &MergeWidget::slotKeepMineActionTriggered);
     QObject::connect(keepTheirAction, &QAction::triggered, parent, &MergeWidget::slotKeepTheirActionTriggered);
     QObject::connect(keepMineBeforeTheirAction, &QAction::triggered, parent, &MergeWidget::slotKeepMineBeforeTheirActionTriggered);
@@ -85,14 +102,14 @@ MergeWidgetPrivate::MergeWidgetPrivate(MergeWidget *parent)
     gotoNextDiffAction->setEnabled(false);
 }
 
-void MergeWidgetPrivate::resolveConflict(Diff::MergeSegment2 *segment)
+void MergeWidgetPrivate::resolveConflict(int index)
 {
     Q_Q(MergeWidget);
 
-    if (segment->type != Diff::MergeSegment2::Type::ChangedOnBoth)
+    if (lastMergeResult.segments.at(index).type != Diff::MergeSegment2::Type::ChangedOnBoth)
         return;
 
-    if (conflictSegments.removeOne(segment)) {
+    if (conflictSegments.removeOne(index)) {
         Q_EMIT q->conflictsChanged(conflictSegments.size());
         gotoPrevDiffAction->setEnabled(conflictSegments.size());
         gotoNextDiffAction->setEnabled(conflictSegments.size());
@@ -100,7 +117,7 @@ void MergeWidgetPrivate::resolveConflict(Diff::MergeSegment2 *segment)
     Q_EMIT q->isModifiedChanged(true);
 }
 
-void MergeWidgetPrivate::setEditorContents(QList<Diff::MergeSegment2 *> segments)
+void MergeWidgetPrivate::setEditorContents()
 {
     Q_Q(MergeWidget);
 
@@ -121,28 +138,31 @@ void MergeWidgetPrivate::setEditorContents(QList<Diff::MergeSegment2 *> segments
     // q->codeEditorResult->setContent(lastMergeResult.base.lines, resultBlockDataList, sameSize);
 }
 
-void MergeWidgetPrivate::setCurrentSegment(QList<Diff::MergeSegment2 *>::iterator currentSegment)
+void MergeWidgetPrivate::setCurrentSegment(int index)
 {
     Q_Q(MergeWidget);
-    if (currentSegment != lastMergeResult.segments.end()) {
-        keepMineAction->setEnabled((*currentSegment)->type != Diff::MergeSegment2::Type::Unchanged);
-        keepTheirAction->setEnabled((*currentSegment)->type != Diff::MergeSegment2::Type::Unchanged);
-        keepMineBeforeTheirAction->setEnabled((*currentSegment)->type != Diff::MergeSegment2::Type::Unchanged);
-        keepTheirBeforeMineAction->setEnabled((*currentSegment)->type != Diff::MergeSegment2::Type::Unchanged);
+    if (index < 0 || index >= lastMergeResult.segments.size())
+        index = -1;
+
+    if (index != -1) {
+        const auto changed = lastMergeResult.segments.at(index).type != Diff::MergeSegment2::Type::Unchanged;
+        keepMineAction->setEnabled(changed);
+        keepTheirAction->setEnabled(changed);
+        keepMineBeforeTheirAction->setEnabled(changed);
+        keepTheirBeforeMineAction->setEnabled(changed);
     }
-    this->currentSegment = currentSegment;
-
-    if (currentSegment != lastMergeResult.segments.end()) {
-        auto s = *currentSegment;
+    currentSegment = index;
 
+    if (index != -1) {
         int base{0};
         int local{0};
         int remote{0};
-        for (auto &segment : lastMergeResult.segments) {
+        for (int i = 0; i < lastMergeResult.segments.size(); ++i) {
+            const auto &segment = lastMergeResult.segments.at(i);
             if (sameSize) {
-                auto m = std::max(std::max(segment->baseSize, segment->localSize), std::max(segment->baseSize, segment->remoteSize));
+                auto m = std::max(std::max(segment.baseSize, segment.localSize), std::max(segment.baseSize, segment.remoteSize));
 
-                if (segment == s) {
+                if (i == index) {
                     q->codeEditorBase->highLight(base, base + m - 1);
                     q->codeEditorLocal->highLight(local, local + m - 1);
                     q->codeEditorRemote->highLight(remote, remote + m - 1);
@@ -152,20 +172,149 @@ void MergeWidgetPrivate::setCurrentSegment(QList<Diff::MergeSegment2 *>::iterato
                 local += m;
                 remote += m;
             } else {
-                if (segment == s) {
-                    q->codeEditorBase->highLight(base, base + segment->baseSize - 1);
-                    q->codeEditorLocal->highLight(local, local + segment->localSize - 1);
-                    q->codeEditorRemote->highLight(remote, remote + segment->remoteSize - 1);
+                if (i == index) {
+                    q->codeEditorBase->highLight(base, base + segment.baseSize - 1);
+                    q->codeEditorLocal->highLight(local, local + segment.localSize - 1);
+                    q->codeEditorRemote->highLight(remote, remote + segment.remoteSize - 1);
                     break;
                 }
-                base += segment->baseSize;
-                local += segment->localSize;
-                remote += segment->remoteSize;
+                base += segment.baseSize;
+                local += segment.localSize;
+                remote += segment.remoteSize;
             }
         }
     }
 }
 
+void MergeWidgetPrivate::keepCurrentSegment(Diff::MergeSide first, Diff::MergeSide second)
+{
+    Q_Q(MergeWidget);
+
+    const auto index = conflictIndexes.value(currentSegment, -1);
+    if (index == -1)
+        return;
+
+    const auto &segment = lastMergeResult.segments.at(currentSegment);
+    auto code = lastMergeResult.part(segment, first);
+    if (second != first)
+        code.append(lastMergeResult.part(segment, second));
+    q->codeEditorResult->setFrameText(index, code);
+    resolveConflict(currentSegment);
+}
+
+void MergeWidgetPrivate::gotoConflict(int step)
+{
+    const auto count = static_cast<int>(lastMergeResult.segments.size());
+    if (!count)
+        return;
+
+    // Wraps around, and only lands back on the current segment when it is the only conflict.
+    const auto from = currentSegment == -1 ? (step > 0 ? count - 1 : 0) : currentSegment;
+    for (int i = 1; i <= count; ++i) {
+        const auto index = ((from + i * step) % count + count) % count;
+        if (lastMergeResult.segments.at(index).type == Diff::MergeSegment2::Type::ChangedOnBoth) {
+            setCurrentSegment(index);
+            return;
+        }
+    }
+}
+
+void MergeWidgetPrivate::cancel()
+{
+    if (control) {
+        control->canceled = true;
+        control.reset();
+    }
+    comparingOverlay->stop();
+}
+
+void MergeWidgetPrivate::setMergeResult(Diff::MergeResult<Diff::Text> result)
+{
+    Q_Q(MergeWidget);
+
+    // The result editor is filled again from the start.
+    lastMergeResult = std::move(result);
+    conflictSegments.clear();
+    conflictIndexes.clear();
+    q->codeEditorResult->clearAll();
+
+    currentSegment = lastMergeResult.segments.isEmpty() ? -1 : 0;
+
+    QList<CodeEditor::BlockData> tmpBaseBlockDataList;
+    QList<CodeEditor::BlockData> tmpLocalBlockDataList;
+    QList<CodeEditor::BlockData> tmpRemoteBlockDataList;
+    QList<CodeEditor::BlockData> tmpResultBlockDataList;
+
+    CodeEditor::BlockType baseType;
+    CodeEditor::BlockType localType;
+    CodeEditor::BlockType remoteType;
+    CodeEditor::BlockType resultType;
+
+    tmpBaseBlockDataList.reserve(lastMergeResult.segments.size());
+    tmpLocalBlockDataList.reserve(lastMergeResult.segments.size());
+    tmpRemoteBlockDataList.reserve(lastMergeResult.segments.size());
+    tmpResultBlockDataList.reserve(lastMergeResult.segments.size());
+
+    for (int i = 0; i < lastMergeResult.segments.size(); ++i) {
+        const auto &segment = lastMergeResult.segments.at(i);
+        switch (segment.type) {
+        case Diff::MergeSegment2::Type::Unchanged:
+            baseType = CodeEditor::BlockType::Unchanged;
+            localType = CodeEditor::BlockType::Unchanged;
+            remoteType = CodeEditor::BlockType::Unchanged;
+            resultType = CodeEditor::BlockType::Unchanged;
+            q->codeEditorResult->appendCode(lastMergeResult.part(segment, Diff::MergeSide::Base));
+            // ->append(lastMergeResult.part(segment, Diff::MergeSide::Base), CodeEditor::Unchanged);
+            break;
+        case Diff::MergeSegment2::Type::OnlyOnLocal:
+            baseType = CodeEditor::BlockType::Edited;
+            localType = CodeEditor::BlockType::Added;
+            remoteType = CodeEditor::BlockType::Removed;
+            resultType = CodeEditor::BlockType::Unchanged;
+            q->codeEditorResult->appendCode(lastMergeResult.part(segment, Diff::MergeSide::Local), CodeEditor::Added);
+            break;
+        case Diff::MergeSegment2::Type::OnlyOnRemote:
+            baseType = CodeEditor::BlockType::Edited;
+            localType = CodeEditor::BlockType::Removed;
+            remoteType = CodeEditor::BlockType::Added;
+            resultType = CodeEditor::BlockType::Unchanged;
+            q->codeEditorResult->appendCode(lastMergeResult.part(segment, Diff::MergeSide::Remote), CodeEditor::Added);
+
+            break;
+        case Diff::MergeSegment2::Type::ChangedOnBoth:
+            baseType = CodeEditor::BlockType::Edited;
+            localType = CodeEditor::BlockType::Edited;
+            remoteType = CodeEditor::BlockType::Edited;
+            resultType = CodeEditor::BlockType::Removed;
+
+            conflictSegments.append(i);
+            conflictIndexes.insert(i, q->codeEditorResult->addFrame(QStringList{QLatin1String()}));
+            break;
+        }
+
+        auto m = std::max(std::max(segment.baseSize, segment.localSize), std::max(segment.baseSize, segment.remoteSize));
+        tmpBaseBlockDataList.emplace_back(segment.baseStart, segment.baseSize, m, baseType, i);
+        tmpLocalBlockDataList.emplace_back(segment.localStart, segment.localSize, m, localType, i);
+        tmpRemoteBlockDataList.emplace_back(segment.remoteStart, segment.remoteSize, m, remoteType, i);
+        tmpResultBlockDataList.emplace_back(segment.baseStart, segment.baseSize, m, resultType, i);
+    }
+
+    baseBlockDataList = tmpBaseBlockDataList;
+    localBlockDataList = tmpLocalBlockDataList;
+    remoteBlockDataList = tmpRemoteBlockDataList;
+    resultBlockDataList = tmpResultBlockDataList;
+    setEditorContents();
+
+    gotoNextDiffAction->setEnabled(conflictSegments.size());
+    gotoPrevDiffAction->setEnabled(conflictSegments.size());
+
+    keepMyFileAction->setEnabled(true);
+    keepTheirFileAction->setEnabled(true);
+
+    Q_EMIT q->isModifiedChanged(false);
+    Q_EMIT q->conflictsChanged(conflictSegments.size());
+}
+
 MergeWidget::MergeWidget(QWidget *parent)
     : QWidget(parent)
     , d_ptr{new MergeWidgetPrivate{this}}
@@ -185,6 +334,8 @@ MergeWidget::MergeWidget(QWidget *parent)
 
 MergeWidget::~MergeWidget()
 {
+    Q_D(MergeWidget);
+    d->cancel();
 }
 
 bool MergeWidget::ShowPreview() const
@@ -227,78 +378,58 @@ void MergeWidget::setResultFile(const QString &title)
 void MergeWidget::compare()
 {
     Q_D(MergeWidget);
-    d->lastMergeResult = Diff::diff3String(d->baseContent, d->localContent, d->remoteContent);
-
-    if (d->lastMergeResult.segments.size())
-        d->currentSegment = d->lastMergeResult.segments.begin();
 
-    QList<CodeEditor::BlockData *> tmpBaseBlockDataList;
-    QList<CodeEditor::BlockData *> tmpLocalBlockDataList;
-    QList<CodeEditor::BlockData *> tmpRemoteBlockDataList;
-    QList<CodeEditor::BlockData *> tmpResultBlockDataList;
-
-    CodeEditor::BlockType baseType;
-    CodeEditor::BlockType localType;
-    CodeEditor::BlockType remoteType;
-    CodeEditor::BlockType resultType;
-
-    for (auto &segment : d->lastMergeResult.segments) {
-        switch (segment->type) {
-        case Diff::MergeSegment2::Type::Unchanged:
-            baseType = CodeEditor::BlockType::Unchanged;
-            localType = CodeEditor::BlockType::Unchanged;
-            remoteType = CodeEditor::BlockType::Unchanged;
-            resultType = CodeEditor::BlockType::Unchanged;
-            codeEditorResult->appendCode(d->lastMergeResult.part(segment, Diff::MergeSide::Base));
-            // ->append(d->lastMergeResult.part(segment, Diff::MergeSide::Base), CodeEditor::Unchanged);
-            break;
-        case Diff::MergeSegment2::Type::OnlyOnLocal:
-            baseType = CodeEditor::BlockType::Edited;
-            localType = CodeEditor::BlockType::Added;
-            remoteType = CodeEditor::BlockType::Removed;
-            resultType = CodeEditor::BlockType::Unchanged;
-            codeEditorResult->appendCode(d->lastMergeResult.part(segment, Diff::MergeSide::Local), CodeEditor::Added);
-            break;
-        case Diff::MergeSegment2::Type::OnlyOnRemote:
-            baseType = CodeEditor::BlockType::Edited;
-            localType = CodeEditor::BlockType::Removed;
-            remoteType = CodeEditor::BlockType::Added;
-            resultType = CodeEditor::BlockType::Unchanged;
-            codeEditorResult->appendCode(d->lastMergeResult.part(segment, Diff::MergeSide::Remote), CodeEditor::Added);
-
-            break;
-        case Diff::MergeSegment2::Type::ChangedOnBoth:
-            baseType = CodeEditor::BlockType::Edited;
-            localType = CodeEditor::BlockType::Edited;
-            remoteType = CodeEditor::BlockType::Edited;
-            resultType = CodeEditor::BlockType::Removed;
-
-            d->conflictSegments.append(segment);
-            d->conflictIndexes.insert(segment, codeEditorResult->addFrame(QStringList{QLatin1String()}));
-            break;
-        }
-
-        auto m = std::max(std::max(segment->baseSize, segment->localSize), std::max(segment->baseSize, segment->remoteSize));
-        tmpBaseBlockDataList.append(new CodeEditor::BlockData{segment->baseStart, segment->baseSize, m, baseType});
-        tmpLocalBlockDataList.append(new CodeEditor::BlockData{segment->localStart, segment->localSize, m, localType});
-        tmpRemoteBlockDataList.append(new CodeEditor::BlockData{segment->remoteStart, segment->remoteSize, m, remoteType});
-        tmpResultBlockDataList.append(new CodeEditor::BlockData{segment->baseStart, segment->baseSize, m, resultType});
-    }
+    const auto wasComparing = isComparing();
+    d->cancel();
+
+    auto control = std::make_shared<Diff::DiffControl>();
+    auto options = d->options;
+    options.control = control.get();
+    d->control = control;
+    d->comparingOverlay->start(control);
+    if (!wasComparing)
+        Q_EMIT isComparingChanged(true);
+
+    QtConcurrent::run([base = d->baseContent, local = d->localContent, remote = d->remoteContent, options, control] {
+        return Diff::diff3String(base, local, remote, options);
+    }).then(this, [this, control](Diff::MergeResult<Diff::Text> result) {
+        Q_D(MergeWidget);
+        if (d->control != control)
+            return;
+
+        d->control.reset();
+        d->comparingOverlay->stop();
+        d->setMergeResult(std::move(result));
+        Q_EMIT isComparingChanged(false);
+    });
+}
 
-    d->baseBlockDataList = tmpBaseBlockDataList;
-    d->localBlockDataList = tmpLocalBlockDataList;
-    d->remoteBlockDataList = tmpRemoteBlockDataList;
-    d->resultBlockDataList = tmpResultBlockDataList;
-    d->setEditorContents(d->lastMergeResult.segments);
+void MergeWidget::cancel()
+{
+    Q_D(MergeWidget);
+    const auto wasComparing = isComparing();
+    d->cancel();
+    if (wasComparing)
+        Q_EMIT isComparingChanged(false);
+}
 
-    d->gotoNextDiffAction->setEnabled(d->conflictSegments.size());
-    d->gotoPrevDiffAction->setEnabled(d->conflictSegments.size());
+bool MergeWidget::isComparing() const
+{
+    Q_D(const MergeWidget);
+    return d->control != nullptr;
+}
 
-    d->keepMyFileAction->setEnabled(true);
-    d->keepTheirFileAction->setEnabled(true);
+const Diff::DiffOptions<QString> &MergeWidget::options() const
+{
+    Q_D(const MergeWidget);
+    return d->options;
+}
 
-    Q_EMIT isModifiedChanged(false);
-    Q_EMIT conflictsChanged(d->conflictSegments.size());
+void MergeWidget::setOptions(const Diff::DiffOptions<QString> &options)
+{
+    Q_D(MergeWidget);
+    d->options = options;
+    d->options.control = nullptr;
 }
 
 QString MergeWidget::result() const
@@ -316,7 +447,7 @@ void MergeWidget::setSameSize(bool sameSize)
 {
     Q_D(MergeWidget);
     d->sameSize = sameSize;
-    d->setEditorContents(d->lastMergeResult.segments);
+    d->setEditorContents();
 }
 
 QAction *MergeWidget::keepMineAction()
@@ -370,51 +501,25 @@ QAction *MergeWidget::gotoNextDiffAction()
 void MergeWidget::slotKeepMineActionTriggered()
 {
     Q_D(MergeWidget);
-    auto index = d->conflictIndexes.value(*d->currentSegment, -1);
-
-    if (index == -1)
-        return;
-
-    codeEditorResult->setFrameText(index, (d->lastMergeResult.part(*d->currentSegment, Diff::MergeSide::Local)));
-    d->resolveConflict(*d->currentSegment);
+    d->keepCurrentSegment(Diff::MergeSide::Local, Diff::MergeSide::Local);
 }
 
 void MergeWidget::slotKeepTheirActionTriggered()
 {
     Q_D(MergeWidget);
-    auto index = d->conflictIndexes.value(*d->currentSegment, -1);
-
-    if (index == -1)
-        return;
-
-    codeEditorResult->setFrameText(index, (d->lastMergeResult.part(*d->currentSegment, Diff::MergeSide::Remote)));
-    d->resolveConflict(*d->currentSegment);
+    d->keepCurrentSegment(Diff::MergeSide::Remote, Diff::MergeSide::Remote);
 }
 
 void MergeWidget::slotKeepMineBeforeTheirActionTriggered()
 {
     Q_D(MergeWidget);
-    auto index = d->conflictIndexes.value(*d->currentSegment, -1);
-
-    if (index == -1)
-        return;
-    auto code = d->lastMergeResult.part(*d->currentSegment, Diff::MergeSide::Local);
-    code.append(d->lastMergeResult.part(*d->currentSegment, Diff::MergeSide::Remote));
-    codeEditorResult->setFrameText(index, code);
-    d->resolveConflict(*d->currentSegment);
+    d->keepCurrentSegment(Diff::MergeSide::Local, Diff::MergeSide::Remote);
 }
 
 void MergeWidget::slotKeepTheirBeforeMineActionTriggered()
 {
     Q_D(MergeWidget);
-    auto index = d->conflictIndexes.value(*d->currentSegment, -1);
-
-    if (index == -1)
-        return;
-    auto code = d->lastMergeResult.part(*d->currentSegment, Diff::MergeSide::Remote);
-    code.append(d->lastMergeResult.part(*d->currentSegment, Diff::MergeSide::Local));
-    codeEditorResult->setFrameText(index, code);
-    d->resolveConflict(*d->currentSegment);
+    d->keepCurrentSegment(Diff::MergeSide::Remote, Diff::MergeSide::Local);
 }
 
 void MergeWidget::slotKeepMyFileActionTriggered()
@@ -444,55 +549,13 @@ void MergeWidget::slotKeepTheirFileActionTriggered()
 void MergeWidget::slotGotoPrevDiffActionTriggered()
 {
     Q_D(MergeWidget);
-
-    auto pred = [](Diff::MergeSegment2 *segment) {
-        return segment->type == Diff::MergeSegment2::Type::ChangedOnBoth;
-    };
-
-    auto &list = d->lastMergeResult.segments;
-    QList<Diff::MergeSegment2 *>::iterator startPoint;
-    if (d->currentSegment == list.end())
-        startPoint = list.begin();
-    else
-        startPoint = d->currentSegment;
-
-    --startPoint;
-    auto it = std::find_if(std::make_reverse_iterator(startPoint), list.rend(), pred);
-
-    if (it == list.rend())
-        it = std::find_if(list.rbegin(), std::make_reverse_iterator(startPoint), pred);
-
-    if (it != std::make_reverse_iterator(startPoint)) {
-        qDebug() << "find";
-        d->setCurrentSegment(--it.base());
-    }
+    d->gotoConflict(-1);
 }
 
 void MergeWidget::slotGotoNextDiffActionTriggered()
 {
     Q_D(MergeWidget);
-
-    auto pred = [](Diff::MergeSegment2 *segment) {
-        return segment->type == Diff::MergeSegment2::Type::ChangedOnBoth;
-    };
-
-    auto &list = d->lastMergeResult.segments;
-    QList<Diff::MergeSegment2 *>::iterator startPoint;
-    if (d->currentSegment == list.end())
-        startPoint = list.begin();
-    else
-        startPoint = d->currentSegment;
-
-    ++startPoint;
-    auto it = std::find_if(startPoint, list.end(), pred);
-
-    if (it == list.end())
-        it = std::find_if(list.begin(), startPoint, pred);
-
-    if (it != startPoint) {
-        qDebug() << "find";
-        d->setCurrentSegment(it);
-    }
+    d->gotoConflict(1);
 }
 
 void MergeWidget::slotCodeEditorScroll()
@@ -516,32 +579,11 @@ void MergeWidget::slotCodeBlockSelected()
 {
     Q_D(MergeWidget);
     auto editor = qobject_cast<CodeEditor *>(sender());
-    auto ln = editor->currentLineNumber();
-    qDebug() << "current line:" << ln;
-    Diff::MergeSide side;
-
-    if (editor == codeEditorBase)
-        side = Diff::MergeSide::Base;
-    else if (editor == codeEditorLocal)
-        side = Diff::MergeSide::Local;
-    else if (editor == codeEditorRemote)
-        side = Diff::MergeSide::Remote;
-    else
+    if (editor != codeEditorBase && editor != codeEditorLocal && editor != codeEditorRemote)
         return;
 
-    auto it = std::find_if(d->lastMergeResult.segments.begin(), d->lastMergeResult.segments.end(), [&ln, &side](Diff::MergeSegment2 *segment) {
-        switch (side) {
-        case Diff::MergeSide::Base:
-            return segment->baseStart <= ln && segment->baseStart + segment->baseSize >= ln;
-        case Diff::MergeSide::Local:
-            return segment->localStart <= ln && segment->localStart + segment->localSize >= ln;
-        case Diff::MergeSide::Remote:
-            return segment->remoteStart <= ln && segment->remoteStart + segment->remoteSize >= ln;
-        }
-        return false;
-    });
-
-    d->setCurrentSegment(it);
+    // The blocks of the three editors know the segment they show.
+    d->setCurrentSegment(editor->currentHunk());
 }
 
 bool MergeWidget::isModified() const
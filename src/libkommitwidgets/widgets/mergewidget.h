@@ -9,6 +9,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "libkommitwidgets_export.h"
 #include "ui_mergewidget.h"
 
+#include <types.h>
+
 #include <QScopedPointer>
 
 class MergeWidgetPrivate;
@@ -31,7 +33,19 @@ public:
     void setLocalFile(const QString &title, const QString &content);
     void setRemoteFile(const QString &title, const QString &content);
     void setResultFile(const QString &title);
+
+    /**
+     * Merges the files on a worker thread. A placeholder shows over the editors until the
+     * merge is ready; a merge still running is canceled first.
+     */
     void compare();
+    /// Cancels the merge running, if any, keeping what is on show.
+    void cancel();
+    [[nodiscard]] bool isComparing() const;
+
+    [[nodiscard]] const Diff::DiffOptions<QString> &options() const;
+    /// Sets how lines are compared from the next compare() on.
+    void setOptions(const Diff::DiffOptions<QString> &options);
 
     [[nodiscard]] QString result() const;
 
@@ -55,6 +69,10 @@ public:
 signals:
     void isModifiedChanged(bool modified);
     void conflictsChanged(int conflicts);
+    /// Emitted as a merge starts running and as it finishes or is canceled.
+    void isComparingChanged(bool comparing);
+    /// How far the merge running has got, from 0 to 100 for each side compared with the base.
+    void progress(int percent);
 
 private:
     void slotKeepMineActionTriggered();
@@ -18,49 +18,47 @@ SegmentConnector::SegmentConnector(QWidget *parent)
 {
 }
 
-SegmentConnector::~SegmentConnector()
-{
-    // qDeleteAll(mSegments);
-}
+SegmentConnector::~SegmentConnector() = default;
 
-const QList<Diff::DiffHunk *> &SegmentConnector::segments() const
+const QList<Diff::DiffHunk> &SegmentConnector::segments() const
 {
     return mSegments;
 }
 
-void SegmentConnector::setSegments(const QList<Diff::DiffHunk *> &newSegments)
+void SegmentConnector::setSegments(const QList<Diff::DiffHunk> &newSegments)
 {
     mSegments = newSegments;
 
     int oldIndex{0};
     int newIndex{0};
     mSegmentPos.clear();
+    mSegmentPos.reserve(mSegments.size());
 
     for (auto &s : std::as_const(mSegments)) {
         if (mSameSize) {
-            auto sizeMax = qMax(s->left.size, s->right.size);
+            auto sizeMax = qMax(s.left.size, s.right.size);
 
-            SegmentPos pos{oldIndex, static_cast<int>(oldIndex + s->left.size - 1), newIndex, static_cast<int>(newIndex + s->right.size - 1)};
+            SegmentPos pos{oldIndex, static_cast<int>(oldIndex + s.left.size - 1), newIndex, static_cast<int>(newIndex + s.right.size - 1)};
 
             //            if (s->oldText.isEmpty())
             //                pos.leftEnd = -1;
             //            if (s->newText.isEmpty())
             //                pos.rightEnd = -1;
-            mSegmentPos.insert(s, pos);
+            mSegmentPos.append(pos);
 
             oldIndex += sizeMax;
             newIndex += sizeMax;
         } else {
-            SegmentPos pos{oldIndex, static_cast<int>(oldIndex + s->left.size - 1), newIndex, static_cast<int>(newIndex + s->right.size - 1)};
+            SegmentPos pos{oldIndex, static_cast<int>(oldIndex + s.left.size - 1), newIndex, static_cast<int>(newIndex + s.right.size - 1)};
 
-            if (!s->left.size)
+            if (!s.left.size)
                 pos.leftEnd = -1;
-            if (!s->right.size)
+            if (!s.right.size)
                 pos.rightEnd = -1;
-            mSegmentPos.insert(s, pos);
+            mSegmentPos.append(pos);
 
-            oldIndex += s->left.size;
-            newIndex += s->right.size;
+            oldIndex += s.left.size;
+            newIndex += s.right.size;
         }
     }
     Q_EMIT segmentsChanged();
@@ -123,16 +121,18 @@ void SegmentConnector::paintEvent(QPaintEvent *event)
     painter.setRenderHint(QPainter::Antialiasing, true);
     painter.fillRect(rect(), palette().base());
 
-    for (auto s = mSegmentPos.begin(); s != mSegmentPos.end(); ++s) {
-        if (s.key()->type == Diff::SegmentType::SameOnBoth)
+    for (qsizetype i = 0; i < mSegments.size(); ++i) {
+        const auto type = mSegments.at(i).type;
+        if (type == Diff::SegmentType::SameOnBoth)
             continue;
-        const auto leftArea = mLeft->blockArea(s->leftStart, s->leftEnd);
-        const auto rightArea = mRight->blockArea(s->rightStart, s->rightEnd);
+        const auto &pos = mSegmentPos.at(i);
+        const auto leftArea = mLeft->blockArea(pos.leftStart, pos.leftEnd);
+        const auto rightArea = mRight->blockArea(pos.rightStart, pos.rightEnd);
 
         //        if (s == _currentSegment)
         //            painter.setBrush(Qt::yellow);
         //        else
-        switch (s.key()->type) {
+        switch (type) {
         case Diff::SegmentType::SameOnBoth:
             //            painter.setBrush(Qt::magenta);
             continue;
@@ -136,12 +136,12 @@ void SegmentsScrollBar::reload()
     d->leftCount = d->rightCount = 0;
     for (const auto &segment : std::as_const(d->mSegmentConnector->segments())) {
         if (d->mSegmentConnector->sameSize()) {
-            auto m = qMax(segment->left.size, segment->right.size);
+            auto m = qMax(segment.left.size, segment.right.size);
             d->leftCount += m;
             d->rightCount += m;
         } else {
-            d->leftCount += segment->left.size;
-            d->rightCount += segment->right.size;
+            d->leftCount += segment.left.size;
+            d->rightCount += segment.right.size;
         }
     }
     update();
@@ -160,7 +160,7 @@ void SegmentsScrollBarPrivate::generateSegmentsImage()
 
     for (const auto &segment : std::as_const(mSegmentConnector->segments())) {
         QBrush brush;
-        switch (segment->type) {
+        switch (segment.type) {
         case Diff::SegmentType::OnlyOnLeft:
             brush = KommitWidgetsGlobalOptions::instance()->statucColor(Git::ChangeStatus::Removed);
             break;
@@ -177,20 +177,20 @@ void SegmentsScrollBarPrivate::generateSegmentsImage()
             break;
         }
 
-        paintSection(painter, Side::Left, countLeft, segment->left.size, brush);
-        paintSection(painter, Side::Right, countRight, segment->right.size, brush);
+        paintSection(painter, Side::Left, countLeft, segment.left.size, brush);
+        paintSection(painter, Side::Right, countRight, segment.right.size, brush);
 
         if (mSegmentConnector->sameSize()) {
-            auto m = qMax(segment->left.size, segment->right.size);
+            auto m = qMax(segment.left.size, segment.right.size);
 
-            paintSection(painter, Side::Left, countLeft + segment->left.size, m - segment->left.size, Qt::darkGray);
-            paintSection(painter, Side::Right, countRight + segment->right.size, m - segment->right.size, Qt::darkGray);
+            paintSection(painter, Side::Left, countLeft + segment.left.size, m - segment.left.size, Qt::darkGray);
+            paintSection(painter, Side::Right, countRight + segment.right.size, m - segment.right.size, Qt::darkGray);
 
             countLeft += m;
             countRight += m;
         } else {
-            countLeft += segment->left.size;
-            countRight += segment->right.size;
+            countLeft += segment.left.size;
+            countRight += segment.right.size;
         }
     }
     /*
@@ -10,9 +10,20 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <KActionCollection>
 #include <KLocalizedString>
 
+#include <QDateTime>
 #include <QDockWidget>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSet>
+#include <QStatusBar>
+#include <QTimer>
 #include <QTreeView>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 
+#include <core/diffcache.h>
 #include <core/editactionsmapper.h>
 #include <dialogs/diffopendialog.h>
 #include <entities/branch.h>
@@ -24,9 +35,32 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <widgets/difftreeview.h>
 #include <widgets/diffwidget.h>
 
+#include <git2/blob.h>
+#include <git2/repository.h>
+#include <git2/tree.h>
+
 namespace Impl
 {
 
+// Files of a tree view come with a leading slash at the top level only.
+QString dirFilePath(const QString &dirPath, const QString &file)
+{
+    if (file.startsWith(QLatin1Char('/')) || dirPath.endsWith(QLatin1Char('/')))
+        return dirPath + file;
+    return dirPath + QLatin1Char('/') + file;
+}
+
+// A handle of the repository either side of a worker's files is read from, opened for that
+// worker alone, as a libgit2 handle is not to be used by two threads at once; null when
+// neither side is a tree.
+std::shared_ptr<git_repository> openRepository(const QString &repositoryPath)
+{
+    git_repository *repo{nullptr};
+    if (repositoryPath.isEmpty() || git_repository_open_ext(&repo, repositoryPath.toUtf8().constData(), 0, nullptr))
+        return {};
+    return {repo, git_repository_free};
+}
+
 class Storage
 {
 public:
@@ -38,6 +72,58 @@ public:
         Dir
     };
 
+    /**
+     * What a worker thread reads the files of a side from, with nothing of the window's
+     * repository handle: files on disk are read as they are, and the blobs of a tree are
+     * looked up through the worker's own handle and copied, so nothing cached keeps a blob
+     * of a handle the worker frees.
+     */
+    struct Source {
+        Mode mode{Mode::NotSet};
+        QString path;
+        // Of the repository the tree is in.
+        QString repositoryPath;
+        git_oid tree{};
+        // A blob is read on the window's thread, once.
+        Diff::TextView blobText;
+
+        Diff::TextView text(const QString &file, git_repository *repo) const
+        {
+            switch (mode) {
+            case Mode::NotSet:
+                break;
+
+            case Mode::Blob:
+                return blobText;
+
+            case Mode::File:
+                return Diff::TextView::readFile(path);
+
+            case Mode::Dir:
+                return Diff::TextView::readFile(dirFilePath(path, file));
+
+            case Mode::Tree: {
+                git_tree *root{nullptr};
+                git_tree_entry *entry{nullptr};
+                git_blob *blob{nullptr};
+                Diff::TextView view;
+                const auto relative = file.startsWith(QLatin1Char('/')) ? file.mid(1) : file;
+                if (repo && !git_tree_lookup(&root, repo, &tree) && !git_tree_entry_bypath(&entry, root, relative.toUtf8().constData())
+                    && !git_blob_lookup(&blob, repo, git_tree_entry_id(entry))) {
+                    const auto content = static_cast<const char *>(git_blob_rawcontent(blob));
+                    view = Diff::TextView{QByteArray{content, static_cast<qsizetype>(git_blob_rawsize(blob))}};
+                }
+                git_blob_free(blob);
+                git_tree_entry_free(entry);
+                git_tree_free(root);
+                return view;
+            }
+            }
+
+            return {};
+        }
+    };
+
     Mode _mode{Mode::NotSet};
     QString _path;
     QString _title;
@@ -87,40 +173,110 @@ public:
         return {};
     }
 
-    QByteArray content(const QString &file) const
+    // The text of @p file, read from disk or borrowed from its blob rather than copied.
+    Diff::TextView text(const QString &file) const
     {
         switch (_mode) {
         case Mode::Blob:
-            return _blob.content();
+            return Diff::TextView::borrow(_blob.rawContent(), std::make_shared<Git::Blob>(_blob));
+
+        case Mode::File:
+            return Diff::TextView::readFile(_filePath);
+
+        case Mode::Dir:
+            return Diff::TextView::readFile(dirFilePath(_path, file));
 
-        case Mode::File: {
-            QFile f{_filePath};
-            if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
-                return {};
-            auto buffer = f.readAll();
-            f.close();
-            return buffer;
-        }
-        case Mode::Dir: {
-            QFile f{_path + file};
-            if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
-                return {};
-            auto buffer = f.readAll();
-            f.close();
-            return buffer;
-        }
         case Mode::Tree: {
             auto f = _tree.file(file);
             if (f.isNull())
                 return {};
-            return f.content();
+            return Diff::TextView::borrow(f.rawContent(), std::make_shared<Git::Blob>(f));
         }
         }
 
         return {};
     }
+
+    // A key for the content of @p file that changes whenever the content does: the oid of
+    // a blob, or where a file is on disk and when it last changed. Empty when there is no
+    // such file.
+    QByteArray key(const QString &file) const
+    {
+        switch (_mode) {
+        case Mode::NotSet:
+            break;
+
+        case Mode::Blob:
+            return _blob.isNull() ? QByteArray{} : oidKey(_blob.oid());
+
+        case Mode::File:
+            return fileKey(_filePath);
+
+        case Mode::Dir:
+            return fileKey(dirFilePath(_path, file));
+
+        case Mode::Tree: {
+            const auto f = _tree.file(file);
+            return f.isNull() ? QByteArray{} : oidKey(f.oid());
+        }
+        }
+
+        return {};
+    }
+
+    [[nodiscard]] Source source() const
+    {
+        Source source;
+        source.mode = _mode;
+        switch (_mode) {
+        case Mode::NotSet:
+            break;
+
+        case Mode::Blob:
+            source.blobText = text({});
+            break;
+
+        case Mode::File:
+            source.path = _filePath;
+            break;
+
+        case Mode::Dir:
+            source.path = _path;
+            break;
+
+        case Mode::Tree:
+            if (!_tree.isNull()) {
+                source.repositoryPath = QString::fromUtf8(git_repository_path(git_tree_owner(_tree.constData())));
+                git_oid_cpy(&source.tree, git_tree_id(_tree.constData()));
+            }
+            break;
+        }
+        return source;
+    }
+
+private:
+    static QByteArray oidKey(const Git::Oid &oid)
+    {
+        return QByteArray{reinterpret_cast<const char *>(oid.constData()->id), GIT_OID_SHA1_SIZE};
+    }
+
+    static QByteArray fileKey(const QString &path)
+    {
+        const QFileInfo info{path};
+        if (!info.exists())
+            return {};
+        return path.toUtf8() + '\0' + QByteArray::number(info.size()) + '\0' + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+    }
+};
+
+struct FileStats {
+    QString file;
+    Diff::DiffStats stats;
 };
 
+// How many files a worker counts the lines of on one repository handle.
+constexpr qsizetype filesPerStatsTask{32};
+
 }
 
 class DiffWindowPrivate
@@ -149,11 +305,37 @@ public:
 
     Mode mode{Mode::None};
 
+    // Comparing two directories on disk runs in the background; the tree fills in as files
+    // are found, and is sorted once they all are.
+    QFutureWatcher<Diff::DirDiffEntry> dirsWatcher;
+    QProgressBar *dirsProgress{nullptr};
+    QPushButton *cancelDirsButton{nullptr};
+
+    // Diffs of files looked at or about to be, shared with the threads that prefetch them.
+    std::shared_ptr<DiffCache> diffCache{std::make_shared<DiffCache>()};
+    Diff::DiffOptions<QString> diffOptions;
+    QSet<QByteArray> prefetching;
+    // The file on show, and the keys its diff goes into the cache with once the widget
+    // has computed it; empty when it came from the cache.
+    QString currentFile;
+    QByteArray comparingLeftKey;
+    QByteArray comparingRightKey;
+
+    // Files that differ, for counting the lines they add and remove in the background.
+    QStringList changedFiles;
+    QFutureWatcher<QList<Impl::FileStats>> statsWatcher;
+    QTimer statsRefreshTimer;
+
     void setFiles(const QString &file);
 
     void compareFile(const QString &file);
+    void setOptions(const Diff::DiffOptions<QString> &options);
+    void prefetch(const QString &file);
+    void countChangedLines();
 
     void compareDirs();
+    void addDirsResults(int begin, int end);
+    void dirsFinished();
     void initActions();
 
     void init(bool showSideBar);
@@ -180,13 +362,99 @@ void DiffWindowPrivate::setFiles(const QString &file)
 
 void DiffWindowPrivate::compareFile(const QString &file)
 {
-    diffWidget->setOldFile(left.title(file), left.content(file));
-    diffWidget->setNewFile(right.title(file), right.content(file));
-    diffWidget->compare();
+    const auto leftKey = left.key(file);
+    const auto rightKey = right.key(file);
+    currentFile = file;
+
+    if (auto diff = diffCache->find(leftKey, rightKey, diffOptions)) {
+        comparingLeftKey.clear();
+        comparingRightKey.clear();
+        diffWidget->setOldFile(left.title(file), diff->left);
+        diffWidget->setNewFile(right.title(file), diff->right);
+        diffWidget->setDiff(diff);
+    } else {
+        // Compared in the background by the widget, which cancels whatever it was still
+        // comparing; the result is cached once it arrives.
+        comparingLeftKey = leftKey;
+        comparingRightKey = rightKey;
+        diffWidget->setOldFile(left.title(file), left.text(file));
+        diffWidget->setNewFile(right.title(file), right.text(file));
+        diffWidget->compare();
+    }
+
+    if (file.isEmpty())
+        return;
+
+    // The files either side of this one in the tree are likely looked at next.
+    for (const auto offset : {1, -1, 2}) {
+        const auto neighbour = diffModel->fileAt(file, offset);
+        if (!neighbour.isEmpty())
+            prefetch(neighbour);
+    }
+}
+
+void DiffWindowPrivate::setOptions(const Diff::DiffOptions<QString> &options)
+{
+    diffOptions = options;
+    diffWidget->setOptions(options);
+    prefetching.clear();
+
+    // A pair of files is on show, or one file of the two trees or directories.
+    const auto comparingFiles = left._mode == Impl::Storage::Mode::File || left._mode == Impl::Storage::Mode::Blob;
+    if (comparingFiles || !currentFile.isEmpty())
+        compareFile(currentFile);
+    if (!changedFiles.isEmpty()) {
+        statsWatcher.cancel();
+        countChangedLines();
+    }
+}
+
+void DiffWindowPrivate::prefetch(const QString &file)
+{
+    Q_Q(DiffWindow);
+
+    const auto leftKey = left.key(file);
+    const auto rightKey = right.key(file);
+    if (leftKey.isEmpty() && rightKey.isEmpty())
+        return;
+
+    // With the options: a prefetch with the options before still running cannot take the
+    // place of one with the current ones.
+    const auto pendingKey = DiffCache::key(leftKey, rightKey, diffOptions);
+    if (prefetching.contains(pendingKey) || diffCache->contains(leftKey, rightKey, diffOptions))
+        return;
+    prefetching.insert(pendingKey);
+
+    QtConcurrent::run([left = left.source(), right = right.source(), file, leftKey, rightKey, cache = diffCache, opts = diffOptions] {
+        const auto repo = Impl::openRepository(left.repositoryPath.isEmpty() ? right.repositoryPath : left.repositoryPath);
+        cache->insert(leftKey, rightKey, opts, DiffCache::compare(left.text(file, repo.get()), right.text(file, repo.get()), opts));
+    }).then(q, [this, pendingKey] {
+        prefetching.remove(pendingKey);
+    });
+}
+
+void DiffWindowPrivate::countChangedLines()
+{
+    QList<QStringList> tasks;
+    for (qsizetype i = 0; i < changedFiles.size(); i += Impl::filesPerStatsTask)
+        tasks << changedFiles.mid(i, Impl::filesPerStatsTask);
+
+    statsWatcher.setFuture(QtConcurrent::mapped(tasks, [left = left.source(), right = right.source(), opts = diffOptions](const QStringList &files) {
+        const auto repo = Impl::openRepository(left.repositoryPath.isEmpty() ? right.repositoryPath : left.repositoryPath);
+        QList<Impl::FileStats> stats;
+        stats.reserve(files.size());
+        for (const auto &file : files)
+            stats << Impl::FileStats{file, Diff::diffStats(left.text(file, repo.get()), right.text(file, repo.get()), opts)};
+        return stats;
+    }));
 }
 
 void DiffWindowPrivate::compareDirs()
 {
+    currentFile.clear();
+    statsWatcher.cancel();
+    changedFiles.clear();
+
     if (left._mode == Impl::Storage::Mode::Tree) {
         auto diff = manager->diff(left._tree, right._tree);
 
@@ -218,16 +486,43 @@ void DiffWindowPrivate::compareDirs()
             }
 
             diffModel->addFile(d.newFile(), type);
+            if (type != Diff::DiffType::Unchanged)
+                changedFiles.append(d.newFile());
         }
     } else {
-        auto map = Diff::diffDirs(left._path, right._path);
+        dirsWatcher.cancel();
         diffModel->clear();
-        for (auto i = map.begin(); i != map.end(); ++i) {
-            diffModel->addFile(i.key(), i.value());
-        }
+        diffModel->emitReset();
+
+        dirsProgress->setValue(0);
+        dirsProgress->show();
+        cancelDirsButton->show();
+        dirsWatcher.setFuture(Diff::diffDirsAsync(left._path, right._path));
+        dock->show();
+        return;
     }
     diffModel->sortItems();
     dock->show();
+    countChangedLines();
+}
+
+void DiffWindowPrivate::addDirsResults(int begin, int end)
+{
+    for (auto i = begin; i < end; ++i) {
+        const auto entry = dirsWatcher.resultAt(i);
+        diffModel->insertFile(entry.file, entry.type);
+        if (entry.type != Diff::DiffType::Unchanged)
+            changedFiles.append(entry.file);
+    }
+}
+
+void DiffWindowPrivate::dirsFinished()
+{
+    diffModel->sortItems();
+    dirsProgress->hide();
+    cancelDirsButton->hide();
+    if (!dirsWatcher.isCanceled())
+        countChangedLines();
 }
 
 void DiffWindowPrivate::initActions()
@@ -250,6 +545,24 @@ void DiffWindowPrivate::initActions()
     viewFilesInfo->setCheckable(true);
     viewFilesInfo->setChecked(true);
 
+    auto ignoreWhiteSpacesAction = actionCollection->addAction(QStringLiteral("diff_ignore_white_spaces"));
+    ignoreWhiteSpacesAction->setText(i18n("Ignore white spaces"));
+    ignoreWhiteSpacesAction->setCheckable(true);
+    QObject::connect(ignoreWhiteSpacesAction, &QAction::triggered, q, [this](bool checked) {
+        auto options = diffOptions;
+        options.ignoreWhiteSpaces = checked;
+        setOptions(options);
+    });
+
+    auto ignoreCaseAction = actionCollection->addAction(QStringLiteral("diff_ignore_case"));
+    ignoreCaseAction->setText(i18n("Ignore case"));
+    ignoreCaseAction->setCheckable(true);
+    QObject::connect(ignoreCaseAction, &QAction::triggered, q, [this](bool checked) {
+        auto options = diffOptions;
+        options.ignoreCase = checked;
+        setOptions(options);
+    });
+
     auto showTreeDockAction = dock->toggleViewAction();
     actionCollection->addAction(QStringLiteral("show_tree_dock"), showTreeDockAction);
     showTreeDockAction->setText(i18n("Show Tree"));
@@ -293,6 +606,47 @@ void DiffWindowPrivate::init(bool showSideBar)
 
     dock->setVisible(showSideBar);
     treeView->setModels(diffModel, filesModel);
+
+    dirsProgress = new QProgressBar(q->statusBar());
+    dirsProgress->setMaximumWidth(200);
+    dirsProgress->hide();
+    cancelDirsButton = new QPushButton(i18n("Cancel"), q->statusBar());
+    cancelDirsButton->hide();
+    q->statusBar()->addPermanentWidget(dirsProgress);
+    q->statusBar()->addPermanentWidget(cancelDirsButton);
+
+    QObject::connect(diffWidget, &DiffWidget::compared, q, [this](std::shared_ptr<const Diff::Diff2TextViewResult> diff) {
+        if (!comparingLeftKey.isEmpty() || !comparingRightKey.isEmpty())
+            diffCache->insert(comparingLeftKey, comparingRightKey, diffOptions, std::move(diff));
+    });
+
+    QObject::connect(&dirsWatcher, &QFutureWatcherBase::resultsReadyAt, q, [this](int begin, int end) {
+        addDirsResults(begin, end);
+    });
+    QObject::connect(&dirsWatcher, &QFutureWatcherBase::finished, q, [this] {
+        dirsFinished();
+    });
+    QObject::connect(&dirsWatcher, &QFutureWatcherBase::progressRangeChanged, dirsProgress, &QProgressBar::setRange);
+    QObject::connect(&dirsWatcher, &QFutureWatcherBase::progressValueChanged, dirsProgress, &QProgressBar::setValue);
+    QObject::connect(cancelDirsButton, &QPushButton::clicked, &dirsWatcher, &QFutureWatcherBase::cancel);
+
+    statsRefreshTimer.setInterval(250);
+    statsRefreshTimer.setSingleShot(true);
+    QObject::connect(&statsRefreshTimer, &QTimer::timeout, diffModel, &DiffTreeModel::emitStatsChanged);
+
+    QObject::connect(&statsWatcher, &QFutureWatcherBase::resultsReadyAt, q, [this](int begin, int end) {
+        for (auto i = begin; i < end; ++i) {
+            const auto entries = statsWatcher.resultAt(i);
+            for (const auto &entry : entries)
+                diffModel->setStats(entry.file, entry.stats);
+        }
+        if (!statsRefreshTimer.isActive())
+            statsRefreshTimer.start();
+    });
+    QObject::connect(&statsWatcher, &QFutureWatcherBase::finished, q, [this] {
+        statsRefreshTimer.stop();
+        diffModel->emitStatsChanged();
+    });
 }
 
 DiffWindow::DiffWindow()
@@ -365,6 +719,9 @@ DiffWindow::DiffWindow(Mode mode, const QString &left, const QString &right)
 
 DiffWindow::~DiffWindow()
 {
+    Q_D(DiffWindow);
+    d->dirsWatcher.cancel();
+    d->statsWatcher.cancel();
 }
 
 void DiffWindow::setLeft(const QString &filePath)
@@ -116,6 +116,8 @@ public:
 
     QLabel *conflictsLabel = nullptr;
     QAction *actionViewSameSizeBlocks = nullptr;
+    QAction *actionSave = nullptr;
+    QAction *actionSaveAs = nullptr;
 
     // QAction *actionKeepMine = nullptr;
     // QAction *actionKeepTheir = nullptr;
@@ -128,6 +130,7 @@ public:
 
     void initActions();
     bool saveResult(const QString &filePath);
+    bool save(bool askFilePath);
 };
 MergeWindowPrivate::MergeWindowPrivate(MergeWindow *parent)
     : q_ptr{parent}
@@ -186,8 +189,8 @@ void MergeWindowPrivate::initActions()
     actionViewSameSizeBlocks->setChecked(true);
 
     KStandardAction::open(q, &MergeWindow::fileOpen, actionCollection);
-    KStandardAction::save(q, &MergeWindow::fileSave, actionCollection);
-    KStandardAction::saveAs(q, &MergeWindow::fileSaveAs, actionCollection);
+    actionSave = KStandardAction::save(q, &MergeWindow::fileSave, actionCollection);
+    actionSaveAs = KStandardAction::saveAs(q, &MergeWindow::fileSaveAs, actionCollection);
     KStandardAction::quit(q, &MergeWindow::close, actionCollection);
 
 #ifdef UNDEF
@@ -217,6 +220,31 @@ bool MergeWindowPrivate::saveResult(const QString &filePath)
     return true;
 }
 
+bool MergeWindowPrivate::save(bool askFilePath)
+{
+    Q_Q(MergeWindow);
+
+    // Until the merge is ready the result editor holds only part of it.
+    if (mergeWidget->isComparing()) {
+        KMessageBoxHelper::information(q, i18n("The files are still being merged, save once the merge is ready."));
+        return false;
+    }
+
+    if (askFilePath || resultFilePath.isEmpty()) {
+        auto filePath = QFileDialog::getSaveFileName(q, i18n("Save result"));
+        if (filePath.isEmpty())
+            return false;
+        resultFilePath = filePath;
+        q->setWindowFilePath(resultFilePath);
+    }
+
+    if (!saveResult(resultFilePath)) {
+        KMessageBoxHelper::information(q, i18n("Unable to open the file %1", resultFilePath));
+        return false;
+    }
+    return true;
+}
+
 MergeWindow::MergeWindow(Git::Repository *git, Mode mode, QWidget *parent)
     : AppMainWindow(parent)
     , d_ptr{new MergeWindowPrivate{this}}
@@ -247,6 +275,10 @@ MergeWindow::MergeWindow(Git::Repository *git, Mode mode, QWidget *parent)
 
     connect(d->mergeWidget, &MergeWidget::conflictsChanged, this, &MergeWindow::slotMergeWidgetConflictsChanged);
     connect(d->mergeWidget, &MergeWidget::isModifiedChanged, this, &MergeWindow::setWindowModified);
+    connect(d->mergeWidget, &MergeWidget::isComparingChanged, this, [d](bool comparing) {
+        d->actionSave->setEnabled(!comparing);
+        d->actionSaveAs->setEnabled(!comparing);
+    });
 }
 
 MergeWindow::~MergeWindow()
@@ -287,24 +319,26 @@ void MergeWindow::compare()
 void MergeWindow::closeEvent(QCloseEvent *event)
 {
     Q_D(MergeWindow);
-    if (d->mergeWidget->isModified()) {
-        MergeCloseEventDialog d(this);
-        auto r = d.exec();
+    if (!d->mergeWidget->isModified()) {
+        accept();
+        return;
+    }
 
-        switch (r) {
-        case MergeCloseEventDialog::MarkAsResolved:
-            fileSave();
+    MergeCloseEventDialog dialog(this);
+    switch (dialog.exec()) {
+    case MergeCloseEventDialog::MarkAsResolved:
+        if (d->save(false))
             accept();
-            break;
-        case MergeCloseEventDialog::LeaveAsIs:
-            reject();
-            break;
-        case MergeCloseEventDialog::DontExit:
+        else
             event->ignore();
-            break;
-        }
+        break;
+    case MergeCloseEventDialog::LeaveAsIs:
+        reject();
+        break;
+    case MergeCloseEventDialog::DontExit:
+        event->ignore();
+        break;
     }
-    accept();
 }
 
 void MergeWindow::setResultFile(const QString &newFilePathResult)
@@ -317,26 +351,13 @@ void MergeWindow::setResultFile(const QString &newFilePathResult)
 void MergeWindow::fileSave()
 {
     Q_D(MergeWindow);
-    if (d->resultFilePath.isEmpty()) {
-        fileSaveAs();
-        return;
-    }
-    if (!d->saveResult(d->resultFilePath))
-        KMessageBoxHelper::information(this, i18n("Unable to open the file %1", d->resultFilePath));
+    d->save(false);
 }
 
 void MergeWindow::fileSaveAs()
 {
     Q_D(MergeWindow);
-
-    d->resultFilePath = QFileDialog::getSaveFileName(this, i18n("Save result"));
-
-    if (d->resultFilePath.isEmpty())
-        return;
-
-    setWindowFilePath(d->resultFilePath);
-    if (!d->saveResult(d->resultFilePath))
-        KMessageBoxHelper::information(this, i18n("Unable to open the file %1", d->resultFilePath));
+    d->save(true);
 }
 
 void MergeWindow::fileOpen()